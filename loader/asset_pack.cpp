@@ -0,0 +1,371 @@
+#include <loader/asset_pack.h>
+
+#include <algorithm>
+#include <memory>
+
+#include <assert.h>
+#include <string.h>
+
+#define ASSET_PACK_READ_BUFFER_SIZE     (256 * 1024)
+
+#define ZIP_LOCAL_HEADER_SIGNATURE      0x04034b50
+#define ZIP_LOCAL_HEADER_SIZE           30
+#define ZIP_METHOD_STORED               0
+#define ZIP_METHOD_DEFLATED             8
+
+namespace Loader
+{
+    std::map<std::string, std::unique_ptr<CAssetPack>>     gaAssetPacks;
+    std::vector<CAssetPack*>                                gapMountedAssetPacks;
+    std::mutex                                              gAssetPackMutex;
+
+    /*
+    **
+    */
+    CAssetPack::~CAssetPack()
+    {
+        close();
+    }
+
+    /*
+    **
+    */
+    bool CAssetPack::open(std::string const& filePath)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        assert(!mbOpened);
+        memset(&mZipArchive, 0, sizeof(mZipArchive));
+
+        // only reads the central directory, the file handle stays open for later extraction
+        mz_bool status = mz_zip_reader_init_file(&mZipArchive, filePath.c_str(), 0);
+        if(!status)
+        {
+            // packs are optional, a missing one falls back to the loose files without a message
+            mz_zip_error error = mz_zip_get_last_error(&mZipArchive);
+            if(error != MZ_ZIP_FILE_OPEN_FAILED)
+            {
+                printf("%s : %d can\'t open asset pack \"%s\" status = %d\n",
+                    __FILE__,
+                    __LINE__,
+                    filePath.c_str(),
+                    (uint32_t)error);
+            }
+            return false;
+        }
+
+        mFilePath = filePath;
+        mbOpened = true;
+
+        uint32_t iNumFiles = mz_zip_reader_get_num_files(&mZipArchive);
+        for(uint32_t iFile = 0; iFile < iNumFiles; iFile++)
+        {
+            mz_zip_archive_file_stat fileStat;
+            if(!mz_zip_reader_file_stat(&mZipArchive, iFile, &fileStat) || fileStat.m_is_directory)
+            {
+                continue;
+            }
+
+            Entry entry;
+            entry.miFileIndex = iFile;
+            entry.miMethod = fileStat.m_method;
+            entry.miCRC32 = fileStat.m_crc32;
+            entry.miLocalHeaderOffset = fileStat.m_local_header_ofs;
+            entry.miUncompressedSize = fileStat.m_uncomp_size;
+            entry.miCompressedSize = fileStat.m_comp_size;
+
+            std::string entryName = fileStat.m_filename;
+            maEntries[entryName] = entry;
+
+            auto directoryEnd = entryName.rfind("/");
+            std::string fileName = (directoryEnd != std::string::npos) ? entryName.substr(directoryEnd + 1) : entryName;
+            if(maFileNameToEntry.find(fileName) != maFileNameToEntry.end())
+            {
+                maAmbiguousFileNames.insert(fileName);
+            }
+            maFileNameToEntry[fileName] = entryName;
+        }
+
+        // a file name shared by several entries can't say which one it means
+        for(auto const& fileName : maAmbiguousFileNames)
+        {
+            maFileNameToEntry.erase(fileName);
+        }
+
+        macReadBuffer.resize(ASSET_PACK_READ_BUFFER_SIZE);
+
+        printf("%s : %d opened asset pack \"%s\" with %d entries\n",
+            __FILE__,
+            __LINE__,
+            filePath.c_str(),
+            (uint32_t)maEntries.size());
+
+        return true;
+    }
+
+    /*
+    **
+    */
+    void CAssetPack::close()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        if(mbOpened)
+        {
+            mz_zip_reader_end(&mZipArchive);
+            mbOpened = false;
+        }
+
+        maEntries.clear();
+        maFileNameToEntry.clear();
+        maAmbiguousFileNames.clear();
+        macReadBuffer.clear();
+    }
+
+    /*
+    **
+    */
+    CAssetPack::Entry const* CAssetPack::findEntry(std::string const& entryName) const
+    {
+        auto iter = maEntries.find(entryName);
+        if(iter != maEntries.end())
+        {
+            return &iter->second;
+        }
+
+        // fall back to matching without the directory, unless the name is in more than one
+        auto directoryEnd = entryName.rfind("/");
+        std::string fileName = (directoryEnd != std::string::npos) ? entryName.substr(directoryEnd + 1) : entryName;
+        if(maAmbiguousFileNames.find(fileName) != maAmbiguousFileNames.end())
+        {
+            printf("%s : %d \"%s\" matches more than one entry in asset pack \"%s\" by name, not using the pack\n",
+                __FILE__,
+                __LINE__,
+                entryName.c_str(),
+                mFilePath.c_str());
+            return nullptr;
+        }
+
+        auto nameIter = maFileNameToEntry.find(fileName);
+        if(nameIter != maFileNameToEntry.end())
+        {
+            return &maEntries.find(nameIter->second)->second;
+        }
+
+        return nullptr;
+    }
+
+    /*
+    **
+    */
+    bool CAssetPack::extract(
+        Entry const& entry,
+        void* pDestination,
+        uint64_t iDestinationSize)
+    {
+        assert(iDestinationSize >= entry.miUncompressedSize);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        assert(mbOpened);
+
+        // inflate from the file directly into the destination, no intermediate heap copy
+        mz_bool status = mz_zip_reader_extract_to_mem_no_alloc(
+            &mZipArchive,
+            entry.miFileIndex,
+            pDestination,
+            (size_t)entry.miUncompressedSize,
+            0,
+            macReadBuffer.data(),
+            macReadBuffer.size());
+        if(!status)
+        {
+            printf("%s : %d can\'t extract entry %d from \"%s\" error = %d\n",
+                __FILE__,
+                __LINE__,
+                entry.miFileIndex,
+                mFilePath.c_str(),
+                (uint32_t)mz_zip_get_last_error(&mZipArchive));
+            return false;
+        }
+
+        return true;
+    }
+
+    /*
+    **
+    */
+    bool CAssetPack::readCompressed(
+        Entry const& entry,
+        std::vector<char>& acCompressedData)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        assert(mbOpened);
+
+        // local header has variable length name and extra fields before the data
+        uint8_t aiLocalHeader[ZIP_LOCAL_HEADER_SIZE];
+        size_t iRead = mZipArchive.m_pRead(
+            mZipArchive.m_pIO_opaque,
+            entry.miLocalHeaderOffset,
+            aiLocalHeader,
+            ZIP_LOCAL_HEADER_SIZE);
+        uint32_t iSignature = aiLocalHeader[0] | (aiLocalHeader[1] << 8) | (aiLocalHeader[2] << 16) | (aiLocalHeader[3] << 24);
+        if(iRead != ZIP_LOCAL_HEADER_SIZE || iSignature != ZIP_LOCAL_HEADER_SIGNATURE)
+        {
+            printf("%s : %d invalid local header for entry %d in \"%s\"\n",
+                __FILE__,
+                __LINE__,
+                entry.miFileIndex,
+                mFilePath.c_str());
+            return false;
+        }
+
+        uint32_t iFileNameLength = aiLocalHeader[26] | (aiLocalHeader[27] << 8);
+        uint32_t iExtraLength = aiLocalHeader[28] | (aiLocalHeader[29] << 8);
+        uint64_t iDataOffset = entry.miLocalHeaderOffset + ZIP_LOCAL_HEADER_SIZE + iFileNameLength + iExtraLength;
+
+        acCompressedData.resize((size_t)entry.miCompressedSize);
+        iRead = mZipArchive.m_pRead(
+            mZipArchive.m_pIO_opaque,
+            iDataOffset,
+            acCompressedData.data(),
+            (size_t)entry.miCompressedSize);
+
+        return iRead == entry.miCompressedSize;
+    }
+
+    /*
+    **
+    */
+    bool CAssetPack::inflate(
+        Entry const& entry,
+        char const* pCompressedData,
+        uint64_t iCompressedSize,
+        void* pDestination,
+        uint64_t iDestinationSize)
+    {
+        assert(iDestinationSize >= entry.miUncompressedSize);
+
+        if(entry.miMethod == ZIP_METHOD_STORED)
+        {
+            assert(iCompressedSize == entry.miUncompressedSize);
+            memcpy(pDestination, pCompressedData, (size_t)entry.miUncompressedSize);
+        }
+        else if(entry.miMethod == ZIP_METHOD_DEFLATED)
+        {
+            // raw deflate stream, no zlib header
+            size_t iInflatedSize = tinfl_decompress_mem_to_mem(
+                pDestination,
+                (size_t)entry.miUncompressedSize,
+                pCompressedData,
+                (size_t)iCompressedSize,
+                TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF);
+            if(iInflatedSize != entry.miUncompressedSize)
+            {
+                printf("%s : %d failed to inflate entry %d\n",
+                    __FILE__,
+                    __LINE__,
+                    entry.miFileIndex);
+                return false;
+            }
+        }
+        else
+        {
+            printf("%s : %d unsupported compression method %d\n",
+                __FILE__,
+                __LINE__,
+                entry.miMethod);
+            return false;
+        }
+
+        uint32_t iCRC32 = (uint32_t)mz_crc32(MZ_CRC32_INIT, (unsigned char const*)pDestination, (size_t)entry.miUncompressedSize);
+        if(iCRC32 != entry.miCRC32)
+        {
+            printf("%s : %d crc mismatch for entry %d\n",
+                __FILE__,
+                __LINE__,
+                entry.miFileIndex);
+            return false;
+        }
+
+        return true;
+    }
+
+    /*
+    **
+    */
+    CAssetPack* getAssetPack(std::string const& filePath)
+    {
+        std::lock_guard<std::mutex> lock(gAssetPackMutex);
+
+        auto iter = gaAssetPacks.find(filePath);
+        if(iter != gaAssetPacks.end())
+        {
+            return iter->second.get();
+        }
+
+        std::unique_ptr<CAssetPack> pAssetPack = std::make_unique<CAssetPack>();
+        CAssetPack* pRet = nullptr;
+        if(pAssetPack->open(filePath))
+        {
+            pRet = pAssetPack.get();
+        }
+
+        // remember failed opens as well so missing packs aren't probed again on every load
+        gaAssetPacks[filePath] = pRet ? std::move(pAssetPack) : nullptr;
+
+        return pRet;
+    }
+
+    /*
+    **
+    */
+    CAssetPack* mountAssetPack(std::string const& filePath)
+    {
+        CAssetPack* pAssetPack = getAssetPack(filePath);
+        if(pAssetPack)
+        {
+            std::lock_guard<std::mutex> lock(gAssetPackMutex);
+            if(std::find(gapMountedAssetPacks.begin(), gapMountedAssetPacks.end(), pAssetPack) == gapMountedAssetPacks.end())
+            {
+                gapMountedAssetPacks.push_back(pAssetPack);
+            }
+        }
+
+        return pAssetPack;
+    }
+
+    /*
+    **
+    */
+    void unmountAllAssetPacks()
+    {
+        std::lock_guard<std::mutex> lock(gAssetPackMutex);
+        gapMountedAssetPacks.clear();
+        gaAssetPacks.clear();
+    }
+
+    /*
+    **
+    */
+    CAssetPack::Entry const* findInMountedAssetPacks(
+        CAssetPack** ppAssetPack,
+        std::string const& filePath)
+    {
+        std::lock_guard<std::mutex> lock(gAssetPackMutex);
+
+        // later mounts override earlier ones
+        for(auto iter = gapMountedAssetPacks.rbegin(); iter != gapMountedAssetPacks.rend(); ++iter)
+        {
+            CAssetPack::Entry const* pEntry = (*iter)->findEntry(filePath);
+            if(pEntry)
+            {
+                *ppAssetPack = *iter;
+                return pEntry;
+            }
+        }
+
+        *ppAssetPack = nullptr;
+        return nullptr;
+    }
+
+}   // Loader
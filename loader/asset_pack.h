@@ -0,0 +1,92 @@
+#pragma once
+
+#include <tinyexr/miniz.h>
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace Loader
+{
+    /*
+    ** zip archive opened once with its central directory kept resident,
+    ** entries are inflated on demand straight into the caller's buffer
+    */
+    class CAssetPack
+    {
+    public:
+        struct Entry
+        {
+            uint32_t            miFileIndex;
+            uint32_t            miMethod;
+            uint32_t            miCRC32;
+            uint64_t            miUncompressedSize;
+            uint64_t            miCompressedSize;
+            uint64_t            miLocalHeaderOffset;
+        };
+
+    public:
+        CAssetPack() = default;
+        virtual ~CAssetPack();
+
+        bool open(std::string const& filePath);
+        void close();
+
+        Entry const* findEntry(std::string const& entryName) const;
+
+        bool extract(
+            Entry const& entry,
+            void* pDestination,
+            uint64_t iDestinationSize);
+
+        // split extraction, the read is serialized on the pack's file handle while inflate can run on any thread
+        bool readCompressed(
+            Entry const& entry,
+            std::vector<char>& acCompressedData);
+
+        static bool inflate(
+            Entry const& entry,
+            char const* pCompressedData,
+            uint64_t iCompressedSize,
+            void* pDestination,
+            uint64_t iDestinationSize);
+
+        inline std::string const& getFilePath() const
+        {
+            return mFilePath;
+        }
+
+        inline uint32_t getNumEntries() const
+        {
+            return (uint32_t)maEntries.size();
+        }
+
+    protected:
+        std::string                             mFilePath;
+        mz_zip_archive                          mZipArchive;
+        bool                                    mbOpened = false;
+
+        // central directory index, full entry path and file name without directory both map to the entry
+        std::map<std::string, Entry>            maEntries;
+        std::map<std::string, std::string>      maFileNameToEntry;
+
+        // file names in more than one directory, these only match by full path
+        std::set<std::string>                   maAmbiguousFileNames;
+
+        // scratch buffer for reading compressed data, reused across extractions
+        std::vector<char>                       macReadBuffer;
+
+        std::mutex                              mMutex;
+    };
+
+    CAssetPack* mountAssetPack(std::string const& filePath);
+    CAssetPack* getAssetPack(std::string const& filePath);
+    void unmountAllAssetPacks();
+
+    CAssetPack::Entry const* findInMountedAssetPacks(
+        CAssetPack** ppAssetPack,
+        std::string const& filePath);
+
+}   // Loader
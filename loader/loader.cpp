@@ -1,4 +1,6 @@
 #include <loader/loader.h>
+#include <loader/asset_pack.h>
+#include <loader/loader_metrics.h>
 
 #if defined(__EMSCRIPTEN__)
 #include <emscripten/emscripten.h>
@@ -8,12 +10,55 @@
 #include <curl/curl.h>
 #endif // __EMSCRIPTEN__
 
+#include <utils/thread_pool.h>
+
 #include <assert.h>
 
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+
 #include <tinyexr/miniz.h>
 
+#define NUM_DOWNLOAD_THREADS                4
+#define DEFAULT_DECOMPRESSION_BUDGET        (256ull * 1024ull * 1024ull)
+
 namespace Loader
 {
+    struct PrefetchRequest
+    {
+        std::string             mFilePath;
+        std::vector<char>       macData;
+        bool                    mbDone = false;
+        bool                    mbSucceeded = false;
+
+        // set once the request holds its budget, requests taken or cleared before then are cancelled
+        bool                    mbStarted = false;
+        std::atomic<bool>       mbCancelled{false};
+
+        // budget held by macData until the file is taken
+        uint64_t                miHeldBudgetBytes = 0;
+
+        RequestMetrics          mMetrics;
+        TimePoint               mQueuedTime;
+    };
+
+    Utils::CThreadPool                                          gDownloadThreadPool;
+    Utils::CThreadPool                                          gDecompressionThreadPool;
+    std::once_flag                                              gLoaderThreadsInitialized;
+
+    std::map<std::string, std::shared_ptr<PrefetchRequest>>     gaPrefetchRequests;
+    std::mutex                                                  gPrefetchMutex;
+    std::condition_variable                                     gPrefetchDone;
+
+    // compressed plus inflated bytes of requests still decompressing, and inflated bytes of
+    // prefetched files nobody has taken yet
+    uint64_t                                                    giDecompressionBudget = DEFAULT_DECOMPRESSION_BUDGET;
+    uint64_t                                                    giInFlightBytes = 0;
+    std::mutex                                                  gBudgetMutex;
+    std::condition_variable                                     gBudgetAvailable;
+
     // Callback function to write data to file
     size_t writeData(void* ptr, size_t size, size_t nmemb, void* pData) {
         size_t iTotalSize = size * nmemb;
@@ -27,6 +72,180 @@ namespace Loader
         return iTotalSize;
     }
 
+    /*
+    **
+    */
+    bool acquireDecompressionBudget(
+        uint64_t iNumBytes,
+        std::atomic<bool> const& bCancelled)
+    {
+        std::unique_lock<std::mutex> lock(gBudgetMutex);
+
+        // a request larger than the whole budget is let through once nothing else is in flight
+        gBudgetAvailable.wait(lock, [&]
+        {
+            return bCancelled || giInFlightBytes == 0 || giInFlightBytes + iNumBytes <= giDecompressionBudget;
+        });
+        if(bCancelled)
+        {
+            return false;
+        }
+
+        giInFlightBytes += iNumBytes;
+        return true;
+    }
+
+    /*
+    **
+    */
+    void holdDecompressionBudget(uint64_t iNumBytes)
+    {
+        // already in memory, counts against the requests still waiting
+        std::lock_guard<std::mutex> lock(gBudgetMutex);
+        giInFlightBytes += iNumBytes;
+    }
+
+    /*
+    **
+    */
+    void releaseDecompressionBudget(uint64_t iNumBytes)
+    {
+        if(iNumBytes == 0)
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(gBudgetMutex);
+            assert(giInFlightBytes >= iNumBytes);
+            giInFlightBytes -= iNumBytes;
+        }
+        gBudgetAvailable.notify_all();
+    }
+
+    /*
+    **
+    */
+    void finishPrefetchRequest(
+        std::shared_ptr<PrefetchRequest> pRequest,
+        bool bSucceeded,
+        uint64_t iHeldBudgetBytes = 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(gPrefetchMutex);
+            pRequest->mbSucceeded = bSucceeded;
+            pRequest->mbDone = true;
+            if(!pRequest->mbCancelled)
+            {
+                pRequest->miHeldBudgetBytes = iHeldBudgetBytes;
+                iHeldBudgetBytes = 0;
+            }
+        }
+        gPrefetchDone.notify_all();
+
+        // cleared while in flight, nobody will take it
+        if(iHeldBudgetBytes > 0)
+        {
+            pRequest->macData.clear();
+            pRequest->macData.shrink_to_fit();
+            releaseDecompressionBudget(iHeldBudgetBytes);
+        }
+    }
+
+    /*
+    **
+    */
+    bool startPrefetchRequest(
+        std::shared_ptr<PrefetchRequest> pRequest,
+        uint64_t iBudgetBytes)
+    {
+        if(!acquireDecompressionBudget(iBudgetBytes, pRequest->mbCancelled))
+        {
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(gPrefetchMutex);
+            if(!pRequest->mbCancelled)
+            {
+                pRequest->mbStarted = true;
+                return true;
+            }
+        }
+
+        releaseDecompressionBudget(iBudgetBytes);
+        return false;
+    }
+
+    /*
+    **
+    */
+    void cancelPrefetchRequest(std::shared_ptr<PrefetchRequest> pRequest)
+    {
+        pRequest->mbCancelled = true;
+
+        // wakes the request if it's waiting for the budget
+        {
+            std::lock_guard<std::mutex> lock(gBudgetMutex);
+        }
+        gBudgetAvailable.notify_all();
+    }
+
+    /*
+    **
+    */
+    bool takePrefetchedFile(
+        std::vector<char>& acFileContentBuffer,
+        RequestMetrics& metrics,
+        std::string const& filePath)
+    {
+        std::unique_lock<std::mutex> lock(gPrefetchMutex);
+        auto iter = gaPrefetchRequests.find(filePath);
+        if(iter == gaPrefetchRequests.end())
+        {
+            return false;
+        }
+
+        std::shared_ptr<PrefetchRequest> pRequest = iter->second;
+        gaPrefetchRequests.erase(iter);
+
+        // files resident but not taken hold the budget, one not started yet could wait on them forever,
+        // load it directly instead
+        if(!pRequest->mbStarted && !pRequest->mbDone)
+        {
+            lock.unlock();
+            cancelPrefetchRequest(pRequest);
+            return false;
+        }
+
+        bool bReady = pRequest->mbDone;
+        TimePoint waitStart = getTime();
+        gPrefetchDone.wait(lock, [&]
+        {
+            return pRequest->mbDone;
+        });
+        lock.unlock();
+
+        // the request's timeline starts when it was queued
+        metrics = pRequest->mMetrics;
+        metrics.mbCacheHit = true;
+        metrics.mbPrefetchReady = bReady;
+        metrics.mfWaitTime = getElapsedMS(waitStart);
+        metrics.mfTotalTime = getElapsedMS(pRequest->mQueuedTime);
+
+        if(!pRequest->mbSucceeded)
+        {
+            return false;
+        }
+
+        // the caller owns the data from here
+        acFileContentBuffer.swap(pRequest->macData);
+        releaseDecompressionBudget(pRequest->miHeldBudgetBytes);
+        pRequest->miHeldBudgetBytes = 0;
+
+        return true;
+    }
+
 #if defined(__EMSCRIPTEN__)
     bool bDoneLoading = false;
 
@@ -34,6 +253,22 @@ namespace Loader
     uint32_t giTempMemorySize = 0;
     emscripten_fetch_t* gpFetch = nullptr;
 
+    // first progress callback marks the first byte of the current fetch
+    bool gbReceivedFirstByte = false;
+    TimePoint gFirstByteTime;
+
+    /*
+    **
+    */
+    void downloadProgress(emscripten_fetch_t* fetch)
+    {
+        if(!gbReceivedFirstByte)
+        {
+            gFirstByteTime = getTime();
+            gbReceivedFirstByte = true;
+        }
+    }
+
     /*
     **
     */
@@ -66,21 +301,129 @@ namespace Loader
     }
 #endif // __EMSCRIPTEN__
 
+    /*
+    **
+    */
+    bool extractFromAssetPackWithMetrics(
+        void* pDestination,
+        uint64_t iDestinationSize,
+        RequestMetrics& metrics,
+        CAssetPack* pAssetPack,
+        CAssetPack::Entry const& entry,
+        Backend backend)
+    {
+        // read and inflate are interleaved by miniz, the whole extraction counts as decompression
+        TimePoint start = getTime();
+        bool bExtracted = pAssetPack->extract(entry, pDestination, iDestinationSize);
+        metrics.mfDecompressionTime = getElapsedMS(start);
+        metrics.mBackend = backend;
+        metrics.miNumBytes = entry.miCompressedSize;
+        metrics.miNumDecompressedBytes = entry.miUncompressedSize;
+        metrics.mbSucceeded = bExtracted;
+
+        return bExtracted;
+    }
+
 #if defined(__EMSCRIPTEN__)
 
+    /*
+    **
+    */
+    bool takePrefetchedFileToHeap(
+        char** pacFileContentBuffer,
+        uint32_t& iFileSize,
+        RequestMetrics& metrics,
+        std::string const& filePath,
+        bool bTextFile)
+    {
+#if defined(THREAD_POOL_ENABLED)
+        std::vector<char> acFileContentBuffer;
+        if(!takePrefetchedFile(acFileContentBuffer, metrics, filePath))
+        {
+            return false;
+        }
+
+        iFileSize = (uint32_t)acFileContentBuffer.size() + (bTextFile ? 1 : 0);
+        gacTempMemory = (char*)malloc(iFileSize);
+        memcpy(gacTempMemory, acFileContentBuffer.data(), acFileContentBuffer.size());
+        if(bTextFile)
+        {
+            *(gacTempMemory + (iFileSize - 1)) = 0;
+        }
+        giTempMemorySize = iFileSize;
+        *pacFileContentBuffer = gacTempMemory;
+
+        return true;
+#else
+        return false;
+#endif // THREAD_POOL_ENABLED
+    }
+
 #if defined(EMBEDDED_FILES)
-    uint32_t loadFile(
+    /*
+    **
+    */
+    uint32_t extractFromAssetPack(
         char** pacFileContentBuffer,
+        RequestMetrics& metrics,
+        CAssetPack* pAssetPack,
+        CAssetPack::Entry const& entry,
+        Backend backend,
+        bool bTextFile)
+    {
+        size_t iFileSize = (size_t)entry.miUncompressedSize;
+        if(bTextFile)
+        {
+            iFileSize += 1;
+        }
+
+        gacTempMemory = (char*)malloc(iFileSize);
+        bool bExtracted = extractFromAssetPackWithMetrics(gacTempMemory, iFileSize, metrics, pAssetPack, entry, backend);
+        assert(bExtracted);
+        if(bTextFile)
+        {
+            *(gacTempMemory + (iFileSize - 1)) = 0;
+        }
+        giTempMemorySize = (uint32_t)iFileSize;
+
+        printf("%s : %d \"%s\" uncompressed size: %d\n",
+            __FILE__,
+            __LINE__,
+            pAssetPack->getFilePath().c_str(),
+            (uint32_t)entry.miUncompressedSize);
+
+        *pacFileContentBuffer = gacTempMemory;
+
+        return (uint32_t)iFileSize;
+    }
+
+    /*
+    **
+    */
+    uint32_t loadEmbeddedFile(
+        char** pacFileContentBuffer,
+        RequestMetrics& metrics,
         std::string const& filePath,
         bool bTextFile)
     {
-        printf("load %s\n", filePath.c_str());
-        
+        uint32_t iPrefetchedSize = 0;
+        if(takePrefetchedFileToHeap(pacFileContentBuffer, iPrefetchedSize, metrics, filePath, bTextFile))
+        {
+            return iPrefetchedSize;
+        }
+
+        // mounted packs take precedence over loose files
+        CAssetPack* pAssetPack = nullptr;
+        CAssetPack::Entry const* pEntry = findInMountedAssetPacks(&pAssetPack, filePath);
+        if(pEntry)
+        {
+            return extractFromAssetPack(pacFileContentBuffer, metrics, pAssetPack, *pEntry, Backend::AssetPack, bTextFile);
+        }
+
         auto fileExtensionStart = filePath.rfind(".") - 1;
         auto directoryEnd = filePath.rfind("/");
         std::string baseName = filePath.substr(directoryEnd + 1, fileExtensionStart - directoryEnd);
 
-        bool bZipFile = false;
         FILE* fp = fopen(filePath.c_str(), "rb");
         if(fp == nullptr)
         {
@@ -95,15 +438,31 @@ namespace Loader
                     __LINE__,
                     baseName.c_str());
 
+                // per-file zip, opened once and kept resident for subsequent loads
                 newPath = std::string("assets/") + baseName + ".zip";
-                fp = fopen(newPath.c_str(), "rb");
-                printf("new path: %s\n", newPath.c_str());
+                pAssetPack = getAssetPack(newPath);
+
+                std::string fileName = baseName + ".bin";
+                pEntry = (pAssetPack != nullptr) ? pAssetPack->findEntry(fileName) : nullptr;
+                if(pEntry == nullptr)
+                {
+                    printf("%s : %d can\'t find file \"%s\"\n",
+                        __FILE__,
+                        __LINE__,
+                        filePath.c_str());
 
-                bZipFile = true;
+                    metrics.mbSucceeded = false;
+                    *pacFileContentBuffer = nullptr;
+                    return 0;
+                }
+
+                return extractFromAssetPack(pacFileContentBuffer, metrics, pAssetPack, *pEntry, Backend::Zip, bTextFile);
             }
         }
         assert(fp);
 
+        TimePoint readStart = getTime();
+
         fseek(fp, 0, SEEK_END);
         size_t iFileSize = ftell(fp);
         if(bTextFile)
@@ -115,98 +474,117 @@ namespace Loader
         printf("file size: %d\n", (uint32_t)iFileSize);
 
         gacTempMemory = (char*)malloc(iFileSize);
-        fread(gacTempMemory, sizeof(char), iFileSize, fp);
+        size_t iNumRead = fread(gacTempMemory, sizeof(char), iFileSize, fp);
         if(bTextFile)
         {
             *(gacTempMemory + (iFileSize - 1)) = 0;
         }
-        giTempMemorySize = iFileSize;
+        giTempMemorySize = (uint32_t)iFileSize;
 
         fclose(fp);
 
-        if(bZipFile)
-        {
-            std::string fileName = baseName + ".bin";
-            printf("%s : %d zip file to extract: %s\n",
-                __FILE__,
-                __LINE__,
-                fileName.c_str());
-
-            mz_zip_archive zipArchive;
-            memset(&zipArchive, 0, sizeof(zipArchive));
-
-            mz_bool status = mz_zip_reader_init_mem(&zipArchive, gacTempMemory, giTempMemorySize, 0);
-            if(!status)
-            {
-                printf("%s : %d status = %d\n",
-                    __FILE__,
-                    __LINE__,
-                    status);
-                assert(0);
-            }
-
-            int32_t iFileIndex = mz_zip_reader_locate_file(&zipArchive, fileName.c_str(), nullptr, 0);
-            if(iFileIndex == -1)
-            {
-                printf("%s : %d can\'t find file \"%s\"\n",
-                    __FILE__,
-                    __LINE__,
-                    fileName.c_str());
-                assert(0);
-            }
-            printf("%s : %d file index = %d\n",
-                __FILE__,
-                __LINE__,
-                iFileIndex);
+        metrics.mBackend = Backend::EmbeddedFile;
+        metrics.mfTransferTime = getElapsedMS(readStart);
+        metrics.miNumBytes = iNumRead;
+        metrics.mbSucceeded = (iNumRead > 0);
 
-            size_t iUncompressedSize;
-            void* buffer = mz_zip_reader_extract_file_to_heap(&zipArchive, fileName.c_str(), &iUncompressedSize, 0);
-            if(buffer == nullptr)
-            {
-                printf("%s : %d can\'t uncompress file \"%s\"\n",
-                    __FILE__,
-                    __LINE__,
-                    fileName.c_str());
-                assert(0);
-            }
-            free(gacTempMemory);
-            gacTempMemory = (char*)malloc(iUncompressedSize);
-            memcpy(gacTempMemory, buffer, iUncompressedSize);
-            giTempMemorySize = (uint32_t)iUncompressedSize;
+        *pacFileContentBuffer = gacTempMemory;
 
-            mz_free(buffer);
-            mz_zip_reader_end(&zipArchive);
+        return (uint32_t)iFileSize;
+    }
 
-            printf("%s : %d \"%s\" uncompressed size: %d\n",
-                __FILE__,
-                __LINE__,
-                fileName.c_str(),
-                (uint32_t)iUncompressedSize);
+    /*
+    **
+    */
+    bool loadFileRangeFromBackend(
+        std::vector<char>& acBuffer,
+        RequestMetrics& metrics,
+        std::string const& filePath,
+        uint64_t iOffset,
+        uint64_t iSize)
+    {
+        FILE* fp = fopen(filePath.c_str(), "rb");
+        if(fp == nullptr)
+        {
+            fp = fopen((std::string("assets/") + filePath).c_str(), "rb");
+        }
+        if(fp == nullptr)
+        {
+            return false;
         }
 
-        *pacFileContentBuffer = gacTempMemory;
+        TimePoint readStart = getTime();
+        acBuffer.resize((size_t)iSize);
+        fseek(fp, (long)iOffset, SEEK_SET);
+        size_t iNumRead = fread(acBuffer.data(), sizeof(char), (size_t)iSize, fp);
+        fclose(fp);
 
-        return (uint32_t)iFileSize;
+        metrics.mBackend = Backend::EmbeddedFile;
+        metrics.mfTransferTime = getElapsedMS(readStart);
+        metrics.miNumBytes = iNumRead;
+        metrics.mbSucceeded = (iNumRead == iSize);
+
+        return metrics.mbSucceeded;
     }
-#else
+
+    /*
+    **
+    */
     uint32_t loadFile(
         char** pacFileContentBuffer,
         std::string const& filePath,
         bool bTextFile)
     {
-        std::string url = "http://127.0.0.1:8080/" + filePath;
+        printf("load %s\n", filePath.c_str());
+        
+        TimePoint start = getTime();
+        RequestMetrics metrics;
+        metrics.mFilePath = filePath;
+        metrics.mfStartTime = getMetricsTime(start);
+
+        uint32_t iFileSize = loadEmbeddedFile(pacFileContentBuffer, metrics, filePath, bTextFile);
+
+        if(!metrics.mbCacheHit)
+        {
+            metrics.mfTotalTime = getElapsedMS(start);
+        }
+        recordRequestMetrics(metrics);
 
+        return iFileSize;
+    }
+#else
+    /*
+    **
+    */
+    uint32_t fetchURL(
+        char** pacFileContentBuffer,
+        RequestMetrics& metrics,
+        std::string const& url,
+        char const* szRange)
+    {
         emscripten_fetch_attr_t attr;
         emscripten_fetch_attr_init(&attr);
         strcpy(attr.requestMethod, "GET");
         attr.attributes = /*EMSCRIPTEN_FETCH_SYNCHRONOUS | */EMSCRIPTEN_FETCH_LOAD_TO_MEMORY;; // Load response into memory
         attr.onsuccess = downloadSucceeded;
         attr.onerror = downloadFailed;
+        attr.onprogress = downloadProgress;
         attr.userData = (void*)pacFileContentBuffer;
 
+        std::string rangeHeader;
+        char const* aszRequestHeaders[] = {"Range", nullptr, nullptr};
+        if(szRange)
+        {
+            rangeHeader = std::string("bytes=") + szRange;
+            aszRequestHeaders[1] = rangeHeader.c_str();
+            attr.requestHeaders = aszRequestHeaders;
+        }
+
         printf("load %s\n", url.c_str());
         gacTempMemory = nullptr;
         giTempMemorySize = 0;
+        gbReceivedFirstByte = false;
+        TimePoint requestStart = getTime();
         emscripten_fetch(&attr, url.c_str());
         
         bDoneLoading = false;
@@ -215,6 +593,15 @@ namespace Loader
             emscripten_sleep(100);
         }
 
+        // polling granularity is 100ms, first byte and transfer times are upper bounds
+        TimePoint requestEnd = getTime();
+        TimePoint firstByte = gbReceivedFirstByte ? gFirstByteTime : requestEnd;
+        metrics.mBackend = Backend::Fetch;
+        metrics.mfTimeToFirstByte = getElapsedMS(requestStart, firstByte);
+        metrics.mfTransferTime = getElapsedMS(firstByte, requestEnd);
+        metrics.miNumBytes = giTempMemorySize;
+        metrics.mbSucceeded = (giTempMemorySize > 0);
+
         //*pacFileContentBuffer = (char*)gpFetch->data;
         *pacFileContentBuffer = gacTempMemory;
 
@@ -225,12 +612,73 @@ namespace Loader
 
         return giTempMemorySize;
     }
+
+    /*
+    **
+    */
+    uint32_t loadFile(
+        char** pacFileContentBuffer,
+        std::string const& filePath,
+        bool bTextFile)
+    {
+        TimePoint start = getTime();
+        RequestMetrics metrics;
+        metrics.mFilePath = filePath;
+        metrics.mfStartTime = getMetricsTime(start);
+
+        uint32_t iPrefetchedSize = 0;
+        if(takePrefetchedFileToHeap(pacFileContentBuffer, iPrefetchedSize, metrics, filePath, bTextFile))
+        {
+            recordRequestMetrics(metrics);
+            return iPrefetchedSize;
+        }
+
+        uint32_t iFileSize = fetchURL(
+            pacFileContentBuffer,
+            metrics,
+            "http://127.0.0.1:8080/" + filePath,
+            nullptr);
+
+        metrics.mfTotalTime = getElapsedMS(start);
+        recordRequestMetrics(metrics);
+
+        return iFileSize;
+    }
+
+    /*
+    **
+    */
+    bool loadFileRangeFromBackend(
+        std::vector<char>& acBuffer,
+        RequestMetrics& metrics,
+        std::string const& filePath,
+        uint64_t iOffset,
+        uint64_t iSize)
+    {
+        char szRange[64];
+        snprintf(szRange, sizeof(szRange), "%llu-%llu", (unsigned long long)iOffset, (unsigned long long)(iOffset + iSize - 1));
+
+        char* acData = nullptr;
+        uint32_t iFetchedSize = fetchURL(&acData, metrics, "http://127.0.0.1:8080/" + filePath, szRange);
+        if(acData == nullptr)
+        {
+            return false;
+        }
+
+        // servers without range support send the whole file
+        uint64_t iStart = (iFetchedSize > iSize && iFetchedSize >= iOffset + iSize) ? iOffset : 0;
+        uint64_t iCopySize = std::min<uint64_t>(iSize, iFetchedSize - iStart);
+        acBuffer.assign(acData + iStart, acData + iStart + iCopySize);
+        free(acData);
+
+        return iCopySize == iSize;
+    }
 #endif // EMBEDDED_FILES
 
     void loadFileFree(void* pData)
     {
         //emscripten_fetch_close(gpFetch);
-        free(gacTempMemory);
+        free(pData);
     }
 
 #else 
@@ -238,20 +686,27 @@ namespace Loader
     /*
     **
     */
-    void loadFile(
+    void downloadFile(
         std::vector<char>& acFileContentBuffer,
+        RequestMetrics& metrics,
         std::string const& filePath,
-        bool bTextFile)
+        char const* szRange = nullptr)
     {
         std::string url = "http://127.0.0.1:8000/" + filePath;
         
         CURL* curl;
         CURLcode res;
 
+        metrics.mBackend = Backend::HTTP;
+
         curl = curl_easy_init();
         if(curl)
         {
             curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+            if(szRange)
+            {
+                curl_easy_setopt(curl, CURLOPT_RANGE, szRange);
+            }
             curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeData);
             curl_easy_setopt(curl, CURLOPT_WRITEDATA, &acFileContentBuffer);
             
@@ -263,18 +718,335 @@ namespace Loader
                 curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
                 res = curl_easy_perform(curl);
             }
-            else
+
+            // timings are for the last transfer, in seconds from the start of it
+            double fStartTransferTime = 0.0, fTotalTime = 0.0;
+            curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME, &fStartTransferTime);
+            curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME, &fTotalTime);
+            metrics.mfTimeToFirstByte = fStartTransferTime * 1000.0;
+            metrics.mfTransferTime = (fTotalTime - fStartTransferTime) * 1000.0;
+            metrics.miNumBytes = acFileContentBuffer.size();
+            metrics.mbSucceeded = (res == CURLE_OK && acFileContentBuffer.size() > 0);
+
+            curl_easy_cleanup(curl);
+        }
+    }
+
+    /*
+    **
+    */
+    void loadFile(
+        std::vector<char>& acFileContentBuffer,
+        std::string const& filePath,
+        bool bTextFile)
+    {
+        TimePoint start = getTime();
+        RequestMetrics metrics;
+        metrics.mFilePath = filePath;
+        metrics.mfStartTime = getMetricsTime(start);
+
+        bool bLoaded = takePrefetchedFile(acFileContentBuffer, metrics, filePath);
+        if(!bLoaded)
+        {
+            CAssetPack* pAssetPack = nullptr;
+            CAssetPack::Entry const* pEntry = findInMountedAssetPacks(&pAssetPack, filePath);
+            if(pEntry)
             {
-                int iDebug = 1;
+                acFileContentBuffer.resize((size_t)pEntry->miUncompressedSize);
+                bLoaded = extractFromAssetPackWithMetrics(
+                    acFileContentBuffer.data(),
+                    acFileContentBuffer.size(),
+                    metrics,
+                    pAssetPack,
+                    *pEntry,
+                    Backend::AssetPack);
+                assert(bLoaded);
             }
+        }
 
-            curl_easy_cleanup(curl);
+        if(!bLoaded)
+        {
+            // failed prefetches fall back to a synchronous load, the timeline restarts here
+            metrics = RequestMetrics();
+            metrics.mFilePath = filePath;
+            metrics.mfStartTime = getMetricsTime(start);
+
+            acFileContentBuffer.clear();
+            downloadFile(acFileContentBuffer, metrics, filePath);
         }
 
         if(bTextFile)
         {
             acFileContentBuffer.push_back(0);
         }
+
+        if(!metrics.mbCacheHit)
+        {
+            metrics.mfTotalTime = getElapsedMS(start);
+        }
+        recordRequestMetrics(metrics);
+    }
+
+    /*
+    **
+    */
+    bool loadFileRangeFromBackend(
+        std::vector<char>& acBuffer,
+        RequestMetrics& metrics,
+        std::string const& filePath,
+        uint64_t iOffset,
+        uint64_t iSize)
+    {
+        char szRange[64];
+        snprintf(szRange, sizeof(szRange), "%llu-%llu", (unsigned long long)iOffset, (unsigned long long)(iOffset + iSize - 1));
+
+        acBuffer.clear();
+        downloadFile(acBuffer, metrics, filePath, szRange);
+
+        // servers without range support send the whole file
+        if(acBuffer.size() > iSize && acBuffer.size() >= iOffset + iSize)
+        {
+            acBuffer.erase(acBuffer.begin() + (size_t)(iOffset + iSize), acBuffer.end());
+            acBuffer.erase(acBuffer.begin(), acBuffer.begin() + (size_t)iOffset);
+        }
+        metrics.mbSucceeded = (acBuffer.size() == iSize);
+
+        return metrics.mbSucceeded;
     }
 #endif // __EMSCRIPTEN__
+
+    /*
+    **
+    */
+    void initLoaderThreads()
+    {
+#if defined(THREAD_POOL_ENABLED)
+        std::call_once(gLoaderThreadsInitialized, []
+        {
+#if !defined(__EMSCRIPTEN__)
+            // curl's global state isn't thread safe to initialize lazily from the download threads
+            curl_global_init(CURL_GLOBAL_DEFAULT);
+#endif // __EMSCRIPTEN__
+            gDownloadThreadPool.start(NUM_DOWNLOAD_THREADS, "Download");
+            gDecompressionThreadPool.start(Utils::getDefaultNumWorkerThreads(), "Decompression");
+        });
+#endif // THREAD_POOL_ENABLED
+    }
+
+    /*
+    **
+    */
+    bool loadFileRange(
+        std::vector<char>& acBuffer,
+        std::string const& filePath,
+        uint64_t iOffset,
+        uint64_t iSize)
+    {
+        TimePoint start = getTime();
+        RequestMetrics metrics;
+        metrics.mFilePath = filePath + " [" + std::to_string(iOffset) + ", " + std::to_string(iOffset + iSize) + ")";
+        metrics.mfStartTime = getMetricsTime(start);
+
+        bool bLoaded = loadFileRangeFromBackend(acBuffer, metrics, filePath, iOffset, iSize);
+
+        metrics.mfTotalTime = getElapsedMS(start);
+        recordRequestMetrics(metrics);
+
+        return bLoaded;
+    }
+
+    /*
+    **
+    */
+    void requestFileRange(
+        std::string const& filePath,
+        uint64_t iOffset,
+        uint64_t iSize,
+        std::function<void(std::vector<char>&, bool)> const& callback)
+    {
+#if defined(THREAD_POOL_ENABLED) && !defined(__EMSCRIPTEN__)
+        initLoaderThreads();
+        gDownloadThreadPool.submit([filePath, iOffset, iSize, callback]
+        {
+            std::vector<char> acBuffer;
+            bool bLoaded = loadFileRange(acBuffer, filePath, iOffset, iSize);
+            callback(acBuffer, bLoaded);
+        });
+#else
+        // fetch callbacks share global state on web, load in place
+        std::vector<char> acBuffer;
+        bool bLoaded = loadFileRange(acBuffer, filePath, iOffset, iSize);
+        callback(acBuffer, bLoaded);
+#endif // THREAD_POOL_ENABLED
+    }
+
+    /*
+    **
+    */
+    void setDecompressionMemoryBudget(uint64_t iNumBytes)
+    {
+        std::lock_guard<std::mutex> lock(gBudgetMutex);
+        giDecompressionBudget = iNumBytes;
+    }
+
+    /*
+    **
+    */
+    void prefetchFiles(std::vector<std::string> const& aFilePaths)
+    {
+#if defined(THREAD_POOL_ENABLED)
+        initLoaderThreads();
+
+        for(auto const& filePath : aFilePaths)
+        {
+            std::shared_ptr<PrefetchRequest> pRequest = std::make_shared<PrefetchRequest>();
+            pRequest->mFilePath = filePath;
+            pRequest->mQueuedTime = getTime();
+            pRequest->mMetrics.mFilePath = filePath;
+            pRequest->mMetrics.mfStartTime = getMetricsTime(pRequest->mQueuedTime);
+
+            CAssetPack* pAssetPack = nullptr;
+            CAssetPack::Entry const* pEntry = findInMountedAssetPacks(&pAssetPack, filePath);
+#if defined(__EMSCRIPTEN__)
+            // fetch callbacks share global state, only pack entries are prefetched on web
+            if(pEntry == nullptr)
+            {
+                continue;
+            }
+#endif // __EMSCRIPTEN__
+
+            {
+                std::lock_guard<std::mutex> lock(gPrefetchMutex);
+                if(gaPrefetchRequests.find(filePath) != gaPrefetchRequests.end())
+                {
+                    continue;
+                }
+                gaPrefetchRequests[filePath] = pRequest;
+            }
+
+            if(pEntry)
+            {
+                // read compressed bytes on the download threads, inflate on the decompression threads
+                CAssetPack::Entry entry = *pEntry;
+                gDownloadThreadPool.submit([pRequest, pAssetPack, entry]
+                {
+                    RequestMetrics& metrics = pRequest->mMetrics;
+                    metrics.mBackend = Backend::AssetPack;
+                    metrics.miNumBytes = entry.miCompressedSize;
+                    metrics.miNumDecompressedBytes = entry.miUncompressedSize;
+
+                    // time spent waiting for a thread and for the memory budget both count as queued
+                    uint64_t iBudgetBytes = entry.miCompressedSize + entry.miUncompressedSize;
+                    if(!startPrefetchRequest(pRequest, iBudgetBytes))
+                    {
+                        finishPrefetchRequest(pRequest, false);
+                        return;
+                    }
+                    metrics.mfQueueTime = getElapsedMS(pRequest->mQueuedTime);
+
+                    TimePoint readStart = getTime();
+                    std::shared_ptr<std::vector<char>> pacCompressedData = std::make_shared<std::vector<char>>();
+                    bool bRead = pAssetPack->readCompressed(entry, *pacCompressedData);
+                    metrics.mfTransferTime = getElapsedMS(readStart);
+                    if(!bRead)
+                    {
+                        releaseDecompressionBudget(iBudgetBytes);
+                        finishPrefetchRequest(pRequest, false);
+                        return;
+                    }
+
+                    gDecompressionThreadPool.submit([pRequest, pacCompressedData, entry, iBudgetBytes]
+                    {
+                        TimePoint inflateStart = getTime();
+                        pRequest->macData.resize((size_t)entry.miUncompressedSize);
+                        bool bInflated = CAssetPack::inflate(
+                            entry,
+                            pacCompressedData->data(),
+                            pacCompressedData->size(),
+                            pRequest->macData.data(),
+                            pRequest->macData.size());
+                        
+                        pRequest->mMetrics.mfDecompressionTime = getElapsedMS(inflateStart);
+                        pRequest->mMetrics.mbSucceeded = bInflated;
+
+                        pacCompressedData->clear();
+                        pacCompressedData->shrink_to_fit();
+
+                        // the inflated part stays held until the file is taken
+                        uint64_t iHeldBytes = bInflated ? entry.miUncompressedSize : 0;
+                        releaseDecompressionBudget(iBudgetBytes - iHeldBytes);
+
+                        finishPrefetchRequest(pRequest, bInflated, iHeldBytes);
+                    });
+                });
+            }
+#if !defined(__EMSCRIPTEN__)
+            else
+            {
+                gDownloadThreadPool.submit([pRequest]
+                {
+                    // the size isn't known up front, waits for the budget to drain then holds what it read
+                    if(!startPrefetchRequest(pRequest, 0))
+                    {
+                        finishPrefetchRequest(pRequest, false);
+                        return;
+                    }
+
+                    pRequest->mMetrics.mfQueueTime = getElapsedMS(pRequest->mQueuedTime);
+                    downloadFile(pRequest->macData, pRequest->mMetrics, pRequest->mFilePath);
+
+                    uint64_t iHeldBytes = pRequest->macData.size();
+                    holdDecompressionBudget(iHeldBytes);
+                    finishPrefetchRequest(pRequest, iHeldBytes > 0, iHeldBytes);
+                });
+            }
+#endif // __EMSCRIPTEN__
+        }
+#endif // THREAD_POOL_ENABLED
+    }
+
+    /*
+    **
+    */
+    void clearPrefetchedFiles()
+    {
+        std::vector<std::shared_ptr<PrefetchRequest>> apRequests;
+        {
+            std::lock_guard<std::mutex> lock(gPrefetchMutex);
+            for(auto& keyValue : gaPrefetchRequests)
+            {
+                apRequests.push_back(keyValue.second);
+            }
+            gaPrefetchRequests.clear();
+        }
+
+        // done ones are freed here, ones still loading free themselves when they finish
+        uint32_t iNumCleared = 0;
+        for(auto& pRequest : apRequests)
+        {
+            uint64_t iHeldBytes = 0;
+            {
+                std::lock_guard<std::mutex> lock(gPrefetchMutex);
+                pRequest->mbCancelled = true;
+                if(pRequest->mbDone)
+                {
+                    iHeldBytes = pRequest->miHeldBudgetBytes;
+                    pRequest->miHeldBudgetBytes = 0;
+                    pRequest->macData.clear();
+                    pRequest->macData.shrink_to_fit();
+                }
+            }
+            cancelPrefetchRequest(pRequest);
+            releaseDecompressionBudget(iHeldBytes);
+            ++iNumCleared;
+        }
+
+        if(iNumCleared > 0)
+        {
+            printf("%s : %d cleared %d prefetched files nobody asked for\n",
+                __FILE__,
+                __LINE__,
+                iNumCleared);
+        }
+    }
 }
\ No newline at end of file
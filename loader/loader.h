@@ -1,8 +1,11 @@
 #pragma once
 
+#include <functional>
 #include <string>
 #include <vector>
 
+#include <stdint.h>
+
 namespace Loader
 {
 #if defined(__EMSCRIPTEN__)
@@ -18,4 +21,22 @@ namespace Loader
         bool bTextFile = false);
 #endif // __EMSCRIPTEN__
 
+    // starts loading the files in the background, loadFile() picks up the results when they're asked for
+    void prefetchFiles(std::vector<std::string> const& aFilePaths);
+    // frees prefetched files nobody took, and their share of the memory budget
+    void clearPrefetchedFiles();
+    void setDecompressionMemoryBudget(uint64_t iNumBytes);
+
+    // byte range [iOffset, iOffset + iSize) of a loose file, the request version calls back from a loader thread
+    bool loadFileRange(
+        std::vector<char>& acBuffer,
+        std::string const& filePath,
+        uint64_t iOffset,
+        uint64_t iSize);
+    void requestFileRange(
+        std::string const& filePath,
+        uint64_t iOffset,
+        uint64_t iSize,
+        std::function<void(std::vector<char>&, bool)> const& callback);
+
 }   // Loader
\ No newline at end of file
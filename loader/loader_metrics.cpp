@@ -0,0 +1,207 @@
+#include <loader/loader_metrics.h>
+
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+
+#include <algorithm>
+#include <mutex>
+
+#include <stdio.h>
+
+namespace Loader
+{
+    std::vector<RequestMetrics>     gaRequestMetrics;
+    std::mutex                      gMetricsMutex;
+    TimePoint                       gMetricsStartTime = getTime();
+
+    /*
+    **
+    */
+    double getMetricsTime(TimePoint const& time)
+    {
+        return getElapsedMS(gMetricsStartTime, time);
+    }
+
+    /*
+    **
+    */
+    char const* getBackendName(Backend backend)
+    {
+        static char const* saszBackendNames[] =
+        {
+            "none",
+            "http",
+            "fetch",
+            "embedded-file",
+            "asset-pack",
+            "zip",
+        };
+        static_assert(sizeof(saszBackendNames) / sizeof(*saszBackendNames) == (uint32_t)Backend::NumBackends);
+
+        return saszBackendNames[(uint32_t)backend];
+    }
+
+    /*
+    **
+    */
+    void recordRequestMetrics(RequestMetrics const& metrics)
+    {
+        std::lock_guard<std::mutex> lock(gMetricsMutex);
+        gaRequestMetrics.push_back(metrics);
+    }
+
+    /*
+    **
+    */
+    void resetMetrics()
+    {
+        std::lock_guard<std::mutex> lock(gMetricsMutex);
+        gaRequestMetrics.clear();
+    }
+
+    /*
+    **
+    */
+    std::vector<RequestMetrics> getRequestMetrics()
+    {
+        std::lock_guard<std::mutex> lock(gMetricsMutex);
+        return gaRequestMetrics;
+    }
+
+    /*
+    **
+    */
+    std::string getMetricsJSON()
+    {
+        std::vector<RequestMetrics> aRequestMetrics = getRequestMetrics();
+
+        struct BackendTotals
+        {
+            uint32_t        miNumRequests = 0;
+            uint64_t        miNumBytes = 0;
+            double          mfTransferTime = 0.0;
+        };
+        BackendTotals aBackendTotals[(uint32_t)Backend::NumBackends];
+
+        uint32_t iNumCacheHits = 0, iNumPrefetchReady = 0, iNumFailed = 0;
+        uint64_t iTotalBytes = 0, iTotalDecompressedBytes = 0;
+        double fTotalTransferTime = 0.0, fTotalDecompressionTime = 0.0, fTotalWaitTime = 0.0;
+        double fFirstStart = aRequestMetrics.size() > 0 ? aRequestMetrics[0].mfStartTime : 0.0;
+        double fLastEnd = 0.0;
+        for(auto const& metrics : aRequestMetrics)
+        {
+            iNumCacheHits += metrics.mbCacheHit ? 1 : 0;
+            iNumPrefetchReady += metrics.mbPrefetchReady ? 1 : 0;
+            iNumFailed += metrics.mbSucceeded ? 0 : 1;
+            iTotalBytes += metrics.miNumBytes;
+            iTotalDecompressedBytes += metrics.miNumDecompressedBytes;
+            fTotalTransferTime += metrics.mfTransferTime;
+            fTotalDecompressionTime += metrics.mfDecompressionTime;
+            fTotalWaitTime += metrics.mfWaitTime;
+            fFirstStart = std::min(fFirstStart, metrics.mfStartTime);
+            fLastEnd = std::max(fLastEnd, metrics.mfStartTime + metrics.mfTotalTime);
+
+            BackendTotals& backendTotals = aBackendTotals[(uint32_t)metrics.mBackend];
+            backendTotals.miNumRequests += 1;
+            backendTotals.miNumBytes += metrics.miNumBytes;
+            backendTotals.mfTransferTime += metrics.mfTransferTime;
+        }
+        double fWallTime = fLastEnd - fFirstStart;
+
+        rapidjson::StringBuffer buffer;
+        rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+        writer.StartObject();
+
+        writer.Key("Summary");
+        writer.StartObject();
+        writer.Key("NumRequests");              writer.Uint((uint32_t)aRequestMetrics.size());
+        writer.Key("NumFailed");                writer.Uint(iNumFailed);
+        writer.Key("NumCacheHits");             writer.Uint(iNumCacheHits);
+        writer.Key("NumPrefetchReady");         writer.Uint(iNumPrefetchReady);
+        writer.Key("TotalBytes");               writer.Uint64(iTotalBytes);
+        writer.Key("TotalDecompressedBytes");   writer.Uint64(iTotalDecompressedBytes);
+        writer.Key("TotalTransferTimeMS");      writer.Double(fTotalTransferTime);
+        writer.Key("TotalDecompressionTimeMS"); writer.Double(fTotalDecompressionTime);
+        writer.Key("TotalWaitTimeMS");          writer.Double(fTotalWaitTime);
+        writer.Key("WallTimeMS");               writer.Double(fWallTime);
+        writer.Key("ThroughputMBPerSecond");    writer.Double(fWallTime > 0.0 ? ((double)iTotalBytes / (1024.0 * 1024.0)) / (fWallTime / 1000.0) : 0.0);
+
+        writer.Key("Backends");
+        writer.StartObject();
+        for(uint32_t iBackend = 0; iBackend < (uint32_t)Backend::NumBackends; iBackend++)
+        {
+            BackendTotals const& backendTotals = aBackendTotals[iBackend];
+            if(backendTotals.miNumRequests == 0)
+            {
+                continue;
+            }
+
+            writer.Key(getBackendName((Backend)iBackend));
+            writer.StartObject();
+            writer.Key("NumRequests");          writer.Uint(backendTotals.miNumRequests);
+            writer.Key("Bytes");                writer.Uint64(backendTotals.miNumBytes);
+            writer.Key("TransferTimeMS");       writer.Double(backendTotals.mfTransferTime);
+            writer.EndObject();
+        }
+        writer.EndObject();
+
+        writer.EndObject();
+
+        writer.Key("Requests");
+        writer.StartArray();
+        for(auto const& metrics : aRequestMetrics)
+        {
+            writer.StartObject();
+            writer.Key("File");                 writer.String(metrics.mFilePath.c_str());
+            writer.Key("Backend");              writer.String(getBackendName(metrics.mBackend));
+            writer.Key("Succeeded");            writer.Bool(metrics.mbSucceeded);
+            writer.Key("CacheHit");             writer.Bool(metrics.mbCacheHit);
+            writer.Key("PrefetchReady");        writer.Bool(metrics.mbPrefetchReady);
+            writer.Key("StartMS");              writer.Double(metrics.mfStartTime);
+            writer.Key("QueueTimeMS");          writer.Double(metrics.mfQueueTime);
+            writer.Key("TimeToFirstByteMS");    writer.Double(metrics.mfTimeToFirstByte);
+            writer.Key("TransferTimeMS");       writer.Double(metrics.mfTransferTime);
+            writer.Key("DecompressionTimeMS");  writer.Double(metrics.mfDecompressionTime);
+            writer.Key("WaitTimeMS");           writer.Double(metrics.mfWaitTime);
+            writer.Key("TotalTimeMS");          writer.Double(metrics.mfTotalTime);
+            writer.Key("Bytes");                writer.Uint64(metrics.miNumBytes);
+            writer.Key("DecompressedBytes");    writer.Uint64(metrics.miNumDecompressedBytes);
+            writer.EndObject();
+        }
+        writer.EndArray();
+
+        writer.EndObject();
+
+        return std::string(buffer.GetString(), buffer.GetSize());
+    }
+
+    /*
+    **
+    */
+    void dumpMetrics(std::string const& outputFilePath)
+    {
+        std::string json = getMetricsJSON();
+
+#if defined(__EMSCRIPTEN__)
+        // no writable file system worth keeping on web, the console is the output
+        printf("%s\n", json.c_str());
+#else
+        FILE* fp = fopen(outputFilePath.c_str(), "wb");
+        if(fp == nullptr)
+        {
+            printf("%s : %d can\'t write loader metrics to \"%s\"\n",
+                __FILE__,
+                __LINE__,
+                outputFilePath.c_str());
+            return;
+        }
+        fwrite(json.data(), sizeof(char), json.size(), fp);
+        fclose(fp);
+
+        printf("wrote loader metrics for %d requests to \"%s\"\n",
+            (uint32_t)getRequestMetrics().size(),
+            outputFilePath.c_str());
+#endif // __EMSCRIPTEN__
+    }
+
+}   // Loader
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace Loader
+{
+    enum class Backend
+    {
+        None = 0,
+        HTTP,
+        Fetch,
+        EmbeddedFile,
+        AssetPack,
+        Zip,
+
+        NumBackends,
+    };
+
+    struct RequestMetrics
+    {
+        std::string         mFilePath;
+        Backend             mBackend = Backend::None;
+
+        // served from the prefetch cache, mbPrefetchReady is set when it finished before being asked for
+        bool                mbCacheHit = false;
+        bool                mbPrefetchReady = false;
+        bool                mbSucceeded = false;
+
+        // milliseconds
+        double              mfStartTime = 0.0;
+        double              mfQueueTime = 0.0;
+        double              mfTimeToFirstByte = 0.0;
+        double              mfTransferTime = 0.0;
+        double              mfDecompressionTime = 0.0;
+        double              mfWaitTime = 0.0;
+        double              mfTotalTime = 0.0;
+
+        uint64_t            miNumBytes = 0;
+        uint64_t            miNumDecompressedBytes = 0;
+    };
+
+    typedef std::chrono::high_resolution_clock::time_point TimePoint;
+
+    inline TimePoint getTime()
+    {
+        return std::chrono::high_resolution_clock::now();
+    }
+
+    inline double getElapsedMS(TimePoint const& start, TimePoint const& end = getTime())
+    {
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    // milliseconds since the first metrics call, puts all requests on one timeline
+    double getMetricsTime(TimePoint const& time = getTime());
+
+    void recordRequestMetrics(RequestMetrics const& metrics);
+    void resetMetrics();
+
+    std::vector<RequestMetrics> getRequestMetrics();
+    std::string getMetricsJSON();
+    void dumpMetrics(std::string const& outputFilePath);
+
+    char const* getBackendName(Backend backend);
+
+}   // Loader
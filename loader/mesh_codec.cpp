@@ -0,0 +1,765 @@
+#include <loader/mesh_codec.h>
+
+#include <tinyexr/miniz.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include <assert.h>
+#include <string.h>
+
+#define MESH_CODEC_SIGNATURE            (('M') | ('S' << 8) | ('H' << 16) | ('C' << 24))
+#define MESH_CODEC_VERSION              2
+
+#define MESH_CODEC_FLAG_DEFLATE         (1 << 0)
+#define MESH_CODEC_FLAG_FLOAT_UVS       (1 << 1)
+
+// uv ranges wider than this lose too much precision in 16 bits and are kept as floats
+#define MAX_QUANTIZED_UV_RANGE          4.0f
+
+// grid cells stay exact in a float
+#define MAX_POSITION_GRID_CELLS         16777215.0f
+
+namespace Loader
+{
+    namespace MeshCodec
+    {
+        struct Header
+        {
+            uint32_t        miSignature;
+            uint32_t        miVersion;
+            uint32_t        miFlags;
+            uint32_t        miNumMeshes;
+            uint32_t        miNumVertices;
+            uint32_t        miNumTriangles;
+            uint32_t        miPayloadSize;
+            uint32_t        miDecodedPayloadSize;
+        };
+
+        // one grid step for every mesh, a mesh's positions are 16 bit offsets from its first cell
+        struct PositionGrid
+        {
+            float           mfMinX;
+            float           mfMinY;
+            float           mfMinZ;
+            float           mfStep;
+        };
+
+        struct UVRange
+        {
+            float           mfMinU;
+            float           mfMinV;
+            float           mfRangeU;
+            float           mfRangeV;
+        };
+
+        /*
+        **
+        */
+        inline uint16_t zigzag16(int16_t iValue)
+        {
+            return (uint16_t)(((uint16_t)iValue << 1) ^ (uint16_t)(iValue >> 15));
+        }
+
+        /*
+        **
+        */
+        inline int16_t unzigzag16(uint16_t iValue)
+        {
+            return (int16_t)((iValue >> 1) ^ (uint16_t)(-(int16_t)(iValue & 1)));
+        }
+
+        /*
+        **
+        */
+        inline uint32_t zigzag32(int32_t iValue)
+        {
+            return ((uint32_t)iValue << 1) ^ (uint32_t)(iValue >> 31);
+        }
+
+        /*
+        **
+        */
+        inline int32_t unzigzag32(uint32_t iValue)
+        {
+            return (int32_t)((iValue >> 1) ^ (uint32_t)(-(int32_t)(iValue & 1)));
+        }
+
+        /*
+        ** split the elements' bytes into separate planes, low bytes of every element first
+        */
+        void appendBytePlanes(
+            std::vector<uint8_t>& aiStream,
+            uint8_t const* pElements,
+            uint32_t iNumElements,
+            uint32_t iElementSize)
+        {
+            uint64_t iStart = aiStream.size();
+            aiStream.resize(iStart + (uint64_t)iNumElements * iElementSize);
+            uint8_t* pPlanes = aiStream.data() + iStart;
+            for(uint32_t iByte = 0; iByte < iElementSize; iByte++)
+            {
+                uint8_t* pPlane = pPlanes + (uint64_t)iByte * iNumElements;
+                for(uint32_t i = 0; i < iNumElements; i++)
+                {
+                    pPlane[i] = pElements[(uint64_t)i * iElementSize + iByte];
+                }
+            }
+        }
+
+        /*
+        **
+        */
+        uint16_t quantize16(float fValue, float fMin, float fRange)
+        {
+            if(fRange <= 0.0f)
+            {
+                return 0;
+            }
+
+            float fPct = std::clamp((fValue - fMin) / fRange, 0.0f, 1.0f);
+            return (uint16_t)(fPct * 65535.0f + 0.5f);
+        }
+
+        /*
+        **
+        */
+        void encodeOctahedral(int16_t& iX, int16_t& iY, float4 const& normal)
+        {
+            float fLength = fabsf(normal.x) + fabsf(normal.y) + fabsf(normal.z);
+            if(fLength <= 0.0f)
+            {
+                iX = iY = 0;
+                return;
+            }
+
+            float fX = normal.x / fLength;
+            float fY = normal.y / fLength;
+            if(normal.z < 0.0f)
+            {
+                float fFoldedX = (1.0f - fabsf(fY)) * (fX >= 0.0f ? 1.0f : -1.0f);
+                float fFoldedY = (1.0f - fabsf(fX)) * (fY >= 0.0f ? 1.0f : -1.0f);
+                fX = fFoldedX;
+                fY = fFoldedY;
+            }
+
+            iX = (int16_t)roundf(std::clamp(fX, -1.0f, 1.0f) * 32767.0f);
+            iY = (int16_t)roundf(std::clamp(fY, -1.0f, 1.0f) * 32767.0f);
+        }
+
+        /*
+        **
+        */
+        inline void decodeOctahedral(float4& normal, int16_t iX, int16_t iY)
+        {
+            float fX = (float)iX * (1.0f / 32767.0f);
+            float fY = (float)iY * (1.0f / 32767.0f);
+            float fZ = 1.0f - fabsf(fX) - fabsf(fY);
+            float fT = std::max(-fZ, 0.0f);
+            fX += (fX >= 0.0f) ? -fT : fT;
+            fY += (fY >= 0.0f) ? -fT : fT;
+
+            float fOneOverLength = 1.0f / sqrtf(fX * fX + fY * fY + fZ * fZ);
+            normal = float4(fX * fOneOverLength, fY * fOneOverLength, fZ * fOneOverLength, 1.0f);
+        }
+
+        /*
+        **
+        */
+        bool isEncoded(
+            void const* pData,
+            uint64_t iSize)
+        {
+            if(iSize < sizeof(Header))
+            {
+                return false;
+            }
+
+            uint32_t iSignature = 0;
+            memcpy(&iSignature, pData, sizeof(uint32_t));
+
+            return iSignature == MESH_CODEC_SIGNATURE;
+        }
+
+        /*
+        **
+        */
+        bool encode(
+            std::vector<char>& acOutput,
+            EncodeStats& stats,
+            std::vector<Vertex> const& aVertices,
+            std::vector<Range> const& aRanges,
+            std::vector<Extent> const& aExtents,
+            std::vector<uint32_t> const& aiTriangleIndices,
+            EncodeOptions const& options)
+        {
+            uint32_t iNumMeshes = (uint32_t)aRanges.size();
+            uint32_t iNumVertices = (uint32_t)aVertices.size();
+            if(aExtents.size() != iNumMeshes + 1 || aiTriangleIndices.size() % 3 != 0)
+            {
+                return false;
+            }
+
+            // per vertex mesh index and the implicit attribute components
+            std::vector<uint32_t> aiMeshIDs(iNumVertices);
+            for(uint32_t i = 0; i < iNumVertices; i++)
+            {
+                Vertex const& vertex = aVertices[i];
+                uint32_t iMesh = (uint32_t)vertex.mPosition.w;
+                if(vertex.mPosition.w != (float)iMesh || iMesh >= iNumMeshes ||
+                   vertex.mUV.z != vertex.mPosition.w || vertex.mUV.w != 1.0f || vertex.mNormal.w != 1.0f)
+                {
+                    printf("%s : %d vertex %d doesn\'t fit the mesh codec layout\n",
+                        __FILE__,
+                        __LINE__,
+                        i);
+                    return false;
+                }
+                aiMeshIDs[i] = iMesh;
+            }
+
+            // uv ranges per mesh
+            std::vector<UVRange> aUVRanges(iNumMeshes);
+            {
+                std::vector<float4> aMinUV(iNumMeshes, float4(FLT_MAX, FLT_MAX, 0.0f, 0.0f));
+                std::vector<float4> aMaxUV(iNumMeshes, float4(-FLT_MAX, -FLT_MAX, 0.0f, 0.0f));
+                for(uint32_t i = 0; i < iNumVertices; i++)
+                {
+                    uint32_t iMesh = aiMeshIDs[i];
+                    aMinUV[iMesh].x = std::min(aMinUV[iMesh].x, aVertices[i].mUV.x);
+                    aMinUV[iMesh].y = std::min(aMinUV[iMesh].y, aVertices[i].mUV.y);
+                    aMaxUV[iMesh].x = std::max(aMaxUV[iMesh].x, aVertices[i].mUV.x);
+                    aMaxUV[iMesh].y = std::max(aMaxUV[iMesh].y, aVertices[i].mUV.y);
+                }
+
+                stats.mbFloatUVs = false;
+                for(uint32_t iMesh = 0; iMesh < iNumMeshes; iMesh++)
+                {
+                    if(aMinUV[iMesh].x > aMaxUV[iMesh].x)
+                    {
+                        // mesh without vertices
+                        aUVRanges[iMesh] = {0.0f, 0.0f, 0.0f, 0.0f};
+                        continue;
+                    }
+
+                    aUVRanges[iMesh].mfMinU = aMinUV[iMesh].x;
+                    aUVRanges[iMesh].mfMinV = aMinUV[iMesh].y;
+                    aUVRanges[iMesh].mfRangeU = aMaxUV[iMesh].x - aMinUV[iMesh].x;
+                    aUVRanges[iMesh].mfRangeV = aMaxUV[iMesh].y - aMinUV[iMesh].y;
+                    if(!(aUVRanges[iMesh].mfRangeU <= MAX_QUANTIZED_UV_RANGE && aUVRanges[iMesh].mfRangeV <= MAX_QUANTIZED_UV_RANGE))
+                    {
+                        stats.mbFloatUVs = true;
+                    }
+                }
+            }
+
+            std::vector<uint8_t> aiPayload;
+            aiPayload.reserve((uint64_t)iNumVertices * 24 + aiTriangleIndices.size() * 4);
+
+            // mesh ids, delta coded, runs of the same mesh end up as zeros
+            {
+                std::vector<uint32_t> aiDeltas(iNumVertices);
+                uint32_t iPrev = 0;
+                for(uint32_t i = 0; i < iNumVertices; i++)
+                {
+                    aiDeltas[i] = zigzag32((int32_t)(aiMeshIDs[i] - iPrev));
+                    iPrev = aiMeshIDs[i];
+                }
+                appendBytePlanes(aiPayload, (uint8_t const*)aiDeltas.data(), iNumVertices, sizeof(uint32_t));
+            }
+
+            // positions on one grid for the whole scene so vertices shared across mesh seams decode to the
+            // same position, the step fits the largest mesh in 16 bits
+            {
+                std::vector<float> afMeshMin((uint64_t)iNumMeshes * 3, FLT_MAX);
+                std::vector<float> afMeshMax((uint64_t)iNumMeshes * 3, -FLT_MAX);
+                for(uint32_t i = 0; i < iNumVertices; i++)
+                {
+                    float const* pfPosition = &aVertices[i].mPosition.x;
+                    for(uint32_t iComp = 0; iComp < 3; iComp++)
+                    {
+                        float& fMin = afMeshMin[aiMeshIDs[i] * 3 + iComp];
+                        float& fMax = afMeshMax[aiMeshIDs[i] * 3 + iComp];
+                        fMin = std::min(fMin, pfPosition[iComp]);
+                        fMax = std::max(fMax, pfPosition[iComp]);
+                    }
+                }
+
+                float afSceneMin[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+                float afSceneMax[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+                float fLargestMeshRange = 0.0f;
+                for(uint32_t iMesh = 0; iMesh < iNumMeshes; iMesh++)
+                {
+                    for(uint32_t iComp = 0; iComp < 3; iComp++)
+                    {
+                        float fMin = afMeshMin[iMesh * 3 + iComp];
+                        float fMax = afMeshMax[iMesh * 3 + iComp];
+                        if(fMin > fMax)
+                        {
+                            // mesh without vertices
+                            continue;
+                        }
+                        afSceneMin[iComp] = std::min(afSceneMin[iComp], fMin);
+                        afSceneMax[iComp] = std::max(afSceneMax[iComp], fMax);
+                        fLargestMeshRange = std::max(fLargestMeshRange, fMax - fMin);
+                    }
+                }
+
+                PositionGrid grid = {0.0f, 0.0f, 0.0f, 0.0f};
+                float fLargestSceneRange = 0.0f;
+                if(iNumVertices > 0)
+                {
+                    grid = {afSceneMin[0], afSceneMin[1], afSceneMin[2], 0.0f};
+                    for(uint32_t iComp = 0; iComp < 3; iComp++)
+                    {
+                        fLargestSceneRange = std::max(fLargestSceneRange, afSceneMax[iComp] - afSceneMin[iComp]);
+                    }
+                }
+
+                // one cell of slack for the mesh's first cell rounding down
+                grid.mfStep = std::max(fLargestMeshRange / 65534.0f, fLargestSceneRange / MAX_POSITION_GRID_CELLS);
+                if(grid.mfStep <= 0.0f)
+                {
+                    grid.mfStep = 1.0f;
+                }
+                float const afGridMin[3] = {grid.mfMinX, grid.mfMinY, grid.mfMinZ};
+
+                std::vector<uint32_t> aiMeshCells((uint64_t)iNumMeshes * 3, 0);
+                for(uint32_t iMesh = 0; iMesh < iNumMeshes; iMesh++)
+                {
+                    for(uint32_t iComp = 0; iComp < 3; iComp++)
+                    {
+                        float fMin = afMeshMin[iMesh * 3 + iComp];
+                        if(fMin <= afMeshMax[iMesh * 3 + iComp])
+                        {
+                            aiMeshCells[iMesh * 3 + iComp] = (uint32_t)std::max(floorf((fMin - afGridMin[iComp]) / grid.mfStep), 0.0f);
+                        }
+                    }
+                }
+
+                uint8_t const* pGrid = (uint8_t const*)&grid;
+                aiPayload.insert(aiPayload.end(), pGrid, pGrid + sizeof(PositionGrid));
+                uint8_t const* pMeshCells = (uint8_t const*)aiMeshCells.data();
+                aiPayload.insert(aiPayload.end(), pMeshCells, pMeshCells + aiMeshCells.size() * sizeof(uint32_t));
+
+                std::vector<uint16_t> aiQuantized((uint64_t)iNumVertices * 3);
+                uint16_t aiPrev[3] = {0, 0, 0};
+                for(uint32_t i = 0; i < iNumVertices; i++)
+                {
+                    float const* pfPosition = &aVertices[i].mPosition.x;
+                    for(uint32_t iComp = 0; iComp < 3; iComp++)
+                    {
+                        float fCell = roundf((pfPosition[iComp] - afGridMin[iComp]) / grid.mfStep);
+                        float fOffset = fCell - (float)aiMeshCells[aiMeshIDs[i] * 3 + iComp];
+                        uint16_t iQuantized = (uint16_t)std::clamp(fOffset, 0.0f, 65535.0f);
+                        aiQuantized[i * 3 + iComp] = zigzag16((int16_t)(uint16_t)(iQuantized - aiPrev[iComp]));
+                        aiPrev[iComp] = iQuantized;
+                    }
+                }
+
+                // one plane per component byte so each component decodes with a flat loop
+                for(uint32_t iComp = 0; iComp < 3; iComp++)
+                {
+                    std::vector<uint16_t> aiComponent(iNumVertices);
+                    for(uint32_t i = 0; i < iNumVertices; i++)
+                    {
+                        aiComponent[i] = aiQuantized[i * 3 + iComp];
+                    }
+                    appendBytePlanes(aiPayload, (uint8_t const*)aiComponent.data(), iNumVertices, sizeof(uint16_t));
+                }
+            }
+
+            // octahedral normals
+            {
+                std::vector<uint16_t> aiX(iNumVertices), aiY(iNumVertices);
+                int16_t iPrevX = 0, iPrevY = 0;
+                for(uint32_t i = 0; i < iNumVertices; i++)
+                {
+                    int16_t iX = 0, iY = 0;
+                    encodeOctahedral(iX, iY, aVertices[i].mNormal);
+                    aiX[i] = zigzag16((int16_t)(uint16_t)((uint16_t)iX - (uint16_t)iPrevX));
+                    aiY[i] = zigzag16((int16_t)(uint16_t)((uint16_t)iY - (uint16_t)iPrevY));
+                    iPrevX = iX;
+                    iPrevY = iY;
+                }
+                appendBytePlanes(aiPayload, (uint8_t const*)aiX.data(), iNumVertices, sizeof(uint16_t));
+                appendBytePlanes(aiPayload, (uint8_t const*)aiY.data(), iNumVertices, sizeof(uint16_t));
+            }
+
+            // uvs
+            if(stats.mbFloatUVs)
+            {
+                std::vector<float> afU(iNumVertices), afV(iNumVertices);
+                for(uint32_t i = 0; i < iNumVertices; i++)
+                {
+                    afU[i] = aVertices[i].mUV.x;
+                    afV[i] = aVertices[i].mUV.y;
+                }
+                appendBytePlanes(aiPayload, (uint8_t const*)afU.data(), iNumVertices, sizeof(float));
+                appendBytePlanes(aiPayload, (uint8_t const*)afV.data(), iNumVertices, sizeof(float));
+            }
+            else
+            {
+                uint8_t const* pUVRanges = (uint8_t const*)aUVRanges.data();
+                aiPayload.insert(aiPayload.end(), pUVRanges, pUVRanges + aUVRanges.size() * sizeof(UVRange));
+
+                std::vector<uint16_t> aiU(iNumVertices), aiV(iNumVertices);
+                uint16_t iPrevU = 0, iPrevV = 0;
+                for(uint32_t i = 0; i < iNumVertices; i++)
+                {
+                    UVRange const& uvRange = aUVRanges[aiMeshIDs[i]];
+                    uint16_t iU = quantize16(aVertices[i].mUV.x, uvRange.mfMinU, uvRange.mfRangeU);
+                    uint16_t iV = quantize16(aVertices[i].mUV.y, uvRange.mfMinV, uvRange.mfRangeV);
+                    aiU[i] = zigzag16((int16_t)(uint16_t)(iU - iPrevU));
+                    aiV[i] = zigzag16((int16_t)(uint16_t)(iV - iPrevV));
+                    iPrevU = iU;
+                    iPrevV = iV;
+                }
+                appendBytePlanes(aiPayload, (uint8_t const*)aiU.data(), iNumVertices, sizeof(uint16_t));
+                appendBytePlanes(aiPayload, (uint8_t const*)aiV.data(), iNumVertices, sizeof(uint16_t));
+            }
+
+            // triangle indices, zigzag delta from the previous index in byte planes, the high planes are
+            // mostly zeros for deflate
+            {
+                uint32_t iNumIndices = (uint32_t)aiTriangleIndices.size();
+                std::vector<uint32_t> aiDeltas(iNumIndices);
+                uint32_t iPrev = 0;
+                for(uint32_t i = 0; i < iNumIndices; i++)
+                {
+                    aiDeltas[i] = zigzag32((int32_t)(aiTriangleIndices[i] - iPrev));
+                    iPrev = aiTriangleIndices[i];
+                }
+                appendBytePlanes(aiPayload, (uint8_t const*)aiDeltas.data(), iNumIndices, sizeof(uint32_t));
+            }
+
+            Header header = {};
+            header.miSignature = MESH_CODEC_SIGNATURE;
+            header.miVersion = MESH_CODEC_VERSION;
+            header.miFlags = stats.mbFloatUVs ? MESH_CODEC_FLAG_FLOAT_UVS : 0;
+            header.miNumMeshes = iNumMeshes;
+            header.miNumVertices = iNumVertices;
+            header.miNumTriangles = (uint32_t)aiTriangleIndices.size() / 3;
+            header.miDecodedPayloadSize = (uint32_t)aiPayload.size();
+            header.miPayloadSize = (uint32_t)aiPayload.size();
+
+            std::vector<uint8_t> aiDeflated;
+            if(options.mbDeflate)
+            {
+                mz_ulong iDeflatedSize = mz_compressBound((mz_ulong)aiPayload.size());
+                aiDeflated.resize(iDeflatedSize);
+                int iRet = mz_compress2(
+                    aiDeflated.data(),
+                    &iDeflatedSize,
+                    aiPayload.data(),
+                    (mz_ulong)aiPayload.size(),
+                    options.miDeflateLevel);
+
+                // only keep the deflated stream if it actually helps
+                if(iRet == MZ_OK && iDeflatedSize < aiPayload.size())
+                {
+                    aiDeflated.resize(iDeflatedSize);
+                    header.miFlags |= MESH_CODEC_FLAG_DEFLATE;
+                    header.miPayloadSize = (uint32_t)iDeflatedSize;
+                }
+            }
+
+            std::vector<uint8_t> const& aiStoredPayload = (header.miFlags & MESH_CODEC_FLAG_DEFLATE) ? aiDeflated : aiPayload;
+
+            acOutput.clear();
+            acOutput.insert(acOutput.end(), (char const*)&header, (char const*)&header + sizeof(Header));
+            acOutput.insert(acOutput.end(), (char const*)aRanges.data(), (char const*)(aRanges.data() + iNumMeshes));
+            acOutput.insert(acOutput.end(), (char const*)aExtents.data(), (char const*)(aExtents.data() + iNumMeshes + 1));
+            acOutput.insert(acOutput.end(), (char const*)aiStoredPayload.data(), (char const*)(aiStoredPayload.data() + aiStoredPayload.size()));
+
+            stats.miRawSize = sizeof(uint32_t) * 5 + sizeof(Range) * iNumMeshes + sizeof(Extent) * (iNumMeshes + 1) +
+                sizeof(Vertex) * (uint64_t)iNumVertices + sizeof(uint32_t) * aiTriangleIndices.size();
+            stats.miEncodedSize = acOutput.size();
+            stats.miPayloadSize = aiPayload.size();
+
+            return true;
+        }
+
+        /*
+        **
+        */
+        bool decode(
+            std::vector<Range>& aRanges,
+            std::vector<Extent>& aExtents,
+            Vertex* pVertices,
+            uint32_t* piTriangleIndices,
+            char const* pData,
+            uint64_t iSize)
+        {
+            if(!isEncoded(pData, iSize))
+            {
+                return false;
+            }
+
+            Header header;
+            memcpy(&header, pData, sizeof(Header));
+            if(header.miVersion != MESH_CODEC_VERSION)
+            {
+                printf("%s : %d unsupported mesh codec version %d\n",
+                    __FILE__,
+                    __LINE__,
+                    header.miVersion);
+                return false;
+            }
+
+            uint32_t iNumMeshes = header.miNumMeshes;
+            uint32_t iNumVertices = header.miNumVertices;
+            uint64_t iTableSize = sizeof(Range) * (uint64_t)iNumMeshes + sizeof(Extent) * ((uint64_t)iNumMeshes + 1);
+            if(sizeof(Header) + iTableSize + header.miPayloadSize > iSize)
+            {
+                return false;
+            }
+
+            char const* pCurr = pData + sizeof(Header);
+            aRanges.resize(iNumMeshes);
+            memcpy(aRanges.data(), pCurr, sizeof(Range) * iNumMeshes);
+            pCurr += sizeof(Range) * iNumMeshes;
+
+            aExtents.resize(iNumMeshes + 1);
+            memcpy(aExtents.data(), pCurr, sizeof(Extent) * (iNumMeshes + 1));
+            pCurr += sizeof(Extent) * (iNumMeshes + 1);
+
+            std::vector<uint8_t> aiInflated;
+            uint8_t const* pPayload = (uint8_t const*)pCurr;
+            if(header.miFlags & MESH_CODEC_FLAG_DEFLATE)
+            {
+                aiInflated.resize(header.miDecodedPayloadSize);
+                mz_ulong iInflatedSize = (mz_ulong)header.miDecodedPayloadSize;
+                int iRet = mz_uncompress(aiInflated.data(), &iInflatedSize, pPayload, header.miPayloadSize);
+                if(iRet != MZ_OK || iInflatedSize != header.miDecodedPayloadSize)
+                {
+                    printf("%s : %d failed to inflate mesh payload (%d)\n",
+                        __FILE__,
+                        __LINE__,
+                        iRet);
+                    return false;
+                }
+                pPayload = aiInflated.data();
+            }
+            uint8_t const* pEnd = pPayload + header.miDecodedPayloadSize;
+
+            // merge byte planes and undo delta coding, the merges are flat loops the compiler can vectorize
+            auto decodeDeltas32 = [&](uint32_t* piValues, uint32_t iNumValues)
+            {
+                uint8_t const* pPlane0 = pPayload;
+                uint8_t const* pPlane1 = pPlane0 + iNumValues;
+                uint8_t const* pPlane2 = pPlane1 + iNumValues;
+                uint8_t const* pPlane3 = pPlane2 + iNumValues;
+                for(uint32_t i = 0; i < iNumValues; i++)
+                {
+                    piValues[i] =
+                        (uint32_t)pPlane0[i] |
+                        ((uint32_t)pPlane1[i] << 8) |
+                        ((uint32_t)pPlane2[i] << 16) |
+                        ((uint32_t)pPlane3[i] << 24);
+                }
+
+                uint32_t iPrev = 0;
+                for(uint32_t i = 0; i < iNumValues; i++)
+                {
+                    iPrev += (uint32_t)unzigzag32(piValues[i]);
+                    piValues[i] = iPrev;
+                }
+
+                pPayload += (uint64_t)iNumValues * 4;
+            };
+
+            uint64_t iNumIndices = (uint64_t)header.miNumTriangles * 3;
+            uint64_t iAttributeSize =
+                (uint64_t)iNumVertices * sizeof(uint32_t) +
+                sizeof(PositionGrid) + sizeof(uint32_t) * 3 * (uint64_t)iNumMeshes +
+                (uint64_t)iNumVertices * sizeof(uint16_t) * 5 +
+                iNumIndices * sizeof(uint32_t);
+            if(header.miFlags & MESH_CODEC_FLAG_FLOAT_UVS)
+            {
+                iAttributeSize += (uint64_t)iNumVertices * sizeof(float) * 2;
+            }
+            else
+            {
+                iAttributeSize += (uint64_t)iNumVertices * sizeof(uint16_t) * 2 + sizeof(UVRange) * iNumMeshes;
+            }
+            if(pPayload + iAttributeSize > pEnd)
+            {
+                return false;
+            }
+
+            // mesh ids
+            std::vector<uint32_t> aiMeshIDs(iNumVertices);
+            decodeDeltas32(aiMeshIDs.data(), iNumVertices);
+            for(uint32_t i = 0; i < iNumVertices; i++)
+            {
+                if(aiMeshIDs[i] >= iNumMeshes)
+                {
+                    return false;
+                }
+            }
+
+            auto decodeComponent16 = [&](std::vector<uint16_t>& aiComponent)
+            {
+                uint8_t const* pLow = pPayload;
+                uint8_t const* pHigh = pPayload + iNumVertices;
+                aiComponent.resize(iNumVertices);
+                for(uint32_t i = 0; i < iNumVertices; i++)
+                {
+                    aiComponent[i] = (uint16_t)(pLow[i] | (pHigh[i] << 8));
+                }
+
+                uint16_t iPrev = 0;
+                for(uint32_t i = 0; i < iNumVertices; i++)
+                {
+                    iPrev = (uint16_t)(iPrev + (uint16_t)unzigzag16(aiComponent[i]));
+                    aiComponent[i] = iPrev;
+                }
+
+                pPayload += (uint64_t)iNumVertices * 2;
+            };
+
+            // positions, the same cell decodes to the same position whichever mesh it's in
+            {
+                PositionGrid grid;
+                memcpy(&grid, pPayload, sizeof(PositionGrid));
+                pPayload += sizeof(PositionGrid);
+                float const afGridMin[3] = {grid.mfMinX, grid.mfMinY, grid.mfMinZ};
+
+                std::vector<uint32_t> aiMeshCells((uint64_t)iNumMeshes * 3);
+                memcpy(aiMeshCells.data(), pPayload, sizeof(uint32_t) * aiMeshCells.size());
+                pPayload += sizeof(uint32_t) * aiMeshCells.size();
+
+                std::vector<uint16_t> aiComponent;
+                for(uint32_t iComp = 0; iComp < 3; iComp++)
+                {
+                    decodeComponent16(aiComponent);
+                    for(uint32_t i = 0; i < iNumVertices; i++)
+                    {
+                        uint32_t iCell = aiMeshCells[aiMeshIDs[i] * 3 + iComp] + (uint32_t)aiComponent[i];
+                        float* pfPosition = &pVertices[i].mPosition.x;
+                        pfPosition[iComp] = afGridMin[iComp] + (float)iCell * grid.mfStep;
+                    }
+                }
+
+                for(uint32_t i = 0; i < iNumVertices; i++)
+                {
+                    pVertices[i].mPosition.w = (float)aiMeshIDs[i];
+                }
+            }
+
+            // normals
+            {
+                std::vector<uint16_t> aiX, aiY;
+                decodeComponent16(aiX);
+                decodeComponent16(aiY);
+                for(uint32_t i = 0; i < iNumVertices; i++)
+                {
+                    decodeOctahedral(pVertices[i].mNormal, (int16_t)aiX[i], (int16_t)aiY[i]);
+                }
+            }
+
+            // uvs
+            if(header.miFlags & MESH_CODEC_FLAG_FLOAT_UVS)
+            {
+                for(uint32_t iComp = 0; iComp < 2; iComp++)
+                {
+                    for(uint32_t i = 0; i < iNumVertices; i++)
+                    {
+                        uint32_t iBits =
+                            (uint32_t)pPayload[i] |
+                            ((uint32_t)pPayload[i + iNumVertices] << 8) |
+                            ((uint32_t)pPayload[i + iNumVertices * 2] << 16) |
+                            ((uint32_t)pPayload[i + iNumVertices * 3] << 24);
+                        float* pfUV = &pVertices[i].mUV.x;
+                        memcpy(&pfUV[iComp], &iBits, sizeof(float));
+                    }
+                    pPayload += (uint64_t)iNumVertices * 4;
+                }
+            }
+            else
+            {
+                std::vector<UVRange> aUVRanges(iNumMeshes);
+                memcpy(aUVRanges.data(), pPayload, sizeof(UVRange) * iNumMeshes);
+                pPayload += sizeof(UVRange) * iNumMeshes;
+
+                std::vector<uint16_t> aiU, aiV;
+                decodeComponent16(aiU);
+                decodeComponent16(aiV);
+                for(uint32_t i = 0; i < iNumVertices; i++)
+                {
+                    UVRange const& uvRange = aUVRanges[aiMeshIDs[i]];
+                    pVertices[i].mUV.x = uvRange.mfMinU + (float)aiU[i] * (1.0f / 65535.0f) * uvRange.mfRangeU;
+                    pVertices[i].mUV.y = uvRange.mfMinV + (float)aiV[i] * (1.0f / 65535.0f) * uvRange.mfRangeV;
+                }
+            }
+
+            for(uint32_t i = 0; i < iNumVertices; i++)
+            {
+                pVertices[i].mUV.z = (float)aiMeshIDs[i];
+                pVertices[i].mUV.w = 1.0f;
+            }
+
+            // triangle indices
+            decodeDeltas32(piTriangleIndices, (uint32_t)iNumIndices);
+
+            return true;
+        }
+
+        /*
+        **
+        */
+        bool getDecodedCounts(
+            uint32_t& iNumMeshes,
+            uint32_t& iNumVertices,
+            uint32_t& iNumTriangles,
+            void const* pData,
+            uint64_t iSize)
+        {
+            if(!isEncoded(pData, iSize))
+            {
+                return false;
+            }
+
+            Header header;
+            memcpy(&header, pData, sizeof(Header));
+            iNumMeshes = header.miNumMeshes;
+            iNumVertices = header.miNumVertices;
+            iNumTriangles = header.miNumTriangles;
+
+            return true;
+        }
+
+        /*
+        **
+        */
+        bool decode(
+            std::vector<Range>& aRanges,
+            std::vector<Extent>& aExtents,
+            std::vector<Vertex>& aVertices,
+            std::vector<uint32_t>& aiTriangleIndices,
+            char const* pData,
+            uint64_t iSize)
+        {
+            uint32_t iNumMeshes = 0, iNumVertices = 0, iNumTriangles = 0;
+            if(!getDecodedCounts(iNumMeshes, iNumVertices, iNumTriangles, pData, iSize))
+            {
+                return false;
+            }
+
+            aVertices.resize(iNumVertices);
+            aiTriangleIndices.resize((uint64_t)iNumTriangles * 3);
+
+            return decode(
+                aRanges,
+                aExtents,
+                aVertices.data(),
+                aiTriangleIndices.data(),
+                pData,
+                iSize);
+        }
+
+    }   // MeshCodec
+
+}   // Loader
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <math/vec.h>
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace Loader
+{
+    namespace MeshCodec
+    {
+        // same layout as the raw -triangles.bin file
+        struct Range
+        {
+            uint32_t        miStart;
+            uint32_t        miEnd;
+        };
+
+        struct Extent
+        {
+            float4          mMinPosition;
+            float4          mMaxPosition;
+        };
+
+        struct Vertex
+        {
+            float4          mPosition;
+            float4          mUV;
+            float4          mNormal;
+        };
+
+        struct EncodeOptions
+        {
+            bool            mbDeflate = true;
+            int32_t         miDeflateLevel = 9;
+        };
+
+        struct EncodeStats
+        {
+            uint64_t        miRawSize = 0;
+            uint64_t        miEncodedSize = 0;
+            uint64_t        miPayloadSize = 0;
+            bool            mbFloatUVs = false;
+        };
+
+        bool isEncoded(
+            void const* pData,
+            uint64_t iSize);
+
+        /*
+        ** positions are quantized to 16 bits on one grid shared by every mesh, normals are
+        ** octahedral 16 bit pairs, all attributes and indices are delta coded and split into byte planes.
+        ** expects position.w and uv.z to hold the mesh index and uv.w, normal.w to be 1,
+        ** returns false if the vertices don't follow that and the raw format should be used
+        */
+        bool encode(
+            std::vector<char>& acOutput,
+            EncodeStats& stats,
+            std::vector<Vertex> const& aVertices,
+            std::vector<Range> const& aRanges,
+            std::vector<Extent> const& aExtents,
+            std::vector<uint32_t> const& aiTriangleIndices,
+            EncodeOptions const& options);
+
+        // vertex and index counts from the header, for sizing the destination of the pointer decode
+        bool getDecodedCounts(
+            uint32_t& iNumMeshes,
+            uint32_t& iNumVertices,
+            uint32_t& iNumTriangles,
+            void const* pData,
+            uint64_t iSize);
+
+        // decodes straight into caller memory, e.g. a mapped GPU buffer
+        bool decode(
+            std::vector<Range>& aRanges,
+            std::vector<Extent>& aExtents,
+            Vertex* pVertices,
+            uint32_t* piTriangleIndices,
+            char const* pData,
+            uint64_t iSize);
+
+        bool decode(
+            std::vector<Range>& aRanges,
+            std::vector<Extent>& aExtents,
+            std::vector<Vertex>& aVertices,
+            std::vector<uint32_t>& aiTriangleIndices,
+            char const* pData,
+            uint64_t iSize);
+
+    }   // MeshCodec
+
+}   // Loader
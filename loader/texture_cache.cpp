@@ -0,0 +1,260 @@
+#include <loader/texture_cache.h>
+
+#include <algorithm>
+
+#include <assert.h>
+#include <string.h>
+
+#define TEXTURE_CACHE_SIGNATURE         (('R') | ('T' << 8) | ('E' << 16) | ('X' << 24))
+#define TEXTURE_CACHE_VERSION           1
+
+namespace Loader
+{
+    namespace TextureCache
+    {
+        /*
+        **
+        */
+        std::string getCachePath(std::string const& imagePath)
+        {
+            auto iter = imagePath.rfind(".");
+            auto separatorIter = imagePath.find_last_of("/\\");
+            if(iter == std::string::npos || (separatorIter != std::string::npos && iter < separatorIter))
+            {
+                return imagePath + ".rtex";
+            }
+
+            return imagePath.substr(0, iter) + ".rtex";
+        }
+
+        /*
+        **
+        */
+        uint32_t getMaxMipLevels(
+            uint32_t iWidth,
+            uint32_t iHeight)
+        {
+            uint32_t iNumMipLevels = 1;
+            uint32_t iSize = std::max(iWidth, iHeight);
+            while(iSize > 1)
+            {
+                iSize >>= 1;
+                ++iNumMipLevels;
+            }
+
+            return iNumMipLevels;
+        }
+
+        /*
+        **
+        */
+        uint32_t getBytesPerBlock(uint32_t iFormat)
+        {
+            switch(iFormat)
+            {
+                case Format::BC1RGBAUnorm:
+                    return 8;
+                case Format::BC7RGBAUnorm:
+                    return 16;
+                default:
+                    return 0;
+            }
+        }
+
+        /*
+        **
+        */
+        uint64_t getLevelSize(
+            uint32_t iFormat,
+            uint32_t iWidth,
+            uint32_t iHeight)
+        {
+            uint32_t iBytesPerBlock = getBytesPerBlock(iFormat);
+            if(iBytesPerBlock == 0)
+            {
+                return (uint64_t)iWidth * iHeight * 4;
+            }
+
+            return (uint64_t)((iWidth + 3) / 4) * ((iHeight + 3) / 4) * iBytesPerBlock;
+        }
+
+        /*
+        **
+        */
+        uint64_t getFileSize(Header const& header)
+        {
+            uint64_t iSize = sizeof(Header) + sizeof(Level) * header.miNumMipLevels;
+            for(uint32_t iMip = 0; iMip < header.miNumMipLevels; iMip++)
+            {
+                uint32_t iMipWidth = std::max(header.miWidth >> iMip, 1u);
+                uint32_t iMipHeight = std::max(header.miHeight >> iMip, 1u);
+                iSize += getLevelSize(header.miFormat, iMipWidth, iMipHeight);
+            }
+
+            return iSize;
+        }
+
+        /*
+        **
+        */
+        void halveImage(
+            std::vector<uint8_t>& aiDest,
+            uint8_t const* pImageData,
+            uint32_t iWidth,
+            uint32_t iHeight)
+        {
+            uint32_t iMipWidth = std::max(iWidth >> 1, 1u);
+            uint32_t iMipHeight = std::max(iHeight >> 1, 1u);
+            aiDest.resize((size_t)iMipWidth * iMipHeight * 4);
+            for(uint32_t iY = 0; iY < iMipHeight; iY++)
+            {
+                for(uint32_t iX = 0; iX < iMipWidth; iX++)
+                {
+                    for(uint32_t iChannel = 0; iChannel < 4; iChannel++)
+                    {
+                        uint32_t iTotal = 0;
+                        for(uint32_t iSample = 0; iSample < 4; iSample++)
+                        {
+                            uint32_t iSrcX = std::min(iX * 2 + (iSample & 1), iWidth - 1);
+                            uint32_t iSrcY = std::min(iY * 2 + (iSample >> 1), iHeight - 1);
+                            iTotal += pImageData[((size_t)iSrcY * iWidth + iSrcX) * 4 + iChannel];
+                        }
+                        aiDest[((size_t)iY * iMipWidth + iX) * 4 + iChannel] = (uint8_t)((iTotal + 2) / 4);
+                    }
+                }
+            }
+        }
+
+        /*
+        **
+        */
+        void buildMipChain(
+            std::vector<std::vector<uint8_t>>& aaiLevels,
+            uint8_t const* pImageData,
+            uint32_t iWidth,
+            uint32_t iHeight,
+            uint32_t iNumMipLevels)
+        {
+            iNumMipLevels = std::clamp(iNumMipLevels, 1u, getMaxMipLevels(iWidth, iHeight));
+            aaiLevels.resize(iNumMipLevels);
+            aaiLevels[0].assign(pImageData, pImageData + (size_t)iWidth * iHeight * 4);
+
+            // each level is filtered from the one above
+            for(uint32_t iMip = 1; iMip < iNumMipLevels; iMip++)
+            {
+                halveImage(
+                    aaiLevels[iMip],
+                    aaiLevels[iMip - 1].data(),
+                    std::max(iWidth >> (iMip - 1), 1u),
+                    std::max(iHeight >> (iMip - 1), 1u));
+            }
+        }
+
+        /*
+        **
+        */
+        void write(
+            std::vector<char>& acOutput,
+            uint32_t iFormat,
+            uint32_t iWidth,
+            uint32_t iHeight,
+            std::vector<std::vector<uint8_t>> const& aaiLevels)
+        {
+            Header header = {};
+            header.miSignature = TEXTURE_CACHE_SIGNATURE;
+            header.miVersion = TEXTURE_CACHE_VERSION;
+            header.miFormat = iFormat;
+            header.miWidth = iWidth;
+            header.miHeight = iHeight;
+            header.miNumMipLevels = (uint32_t)aaiLevels.size();
+
+            acOutput.resize(getFileSize(header));
+            memcpy(acOutput.data(), &header, sizeof(Header));
+
+            Level* pLevels = (Level*)(acOutput.data() + sizeof(Header));
+            uint64_t iOffset = sizeof(Header) + sizeof(Level) * header.miNumMipLevels;
+            for(uint32_t iMip = 0; iMip < header.miNumMipLevels; iMip++)
+            {
+                Level level = {};
+                level.miOffset = iOffset;
+                level.miWidth = std::max(iWidth >> iMip, 1u);
+                level.miHeight = std::max(iHeight >> iMip, 1u);
+                level.miSize = getLevelSize(iFormat, level.miWidth, level.miHeight);
+                assert(aaiLevels[iMip].size() == level.miSize);
+                memcpy(&pLevels[iMip], &level, sizeof(Level));
+                memcpy(acOutput.data() + iOffset, aaiLevels[iMip].data(), level.miSize);
+
+                iOffset += level.miSize;
+            }
+            assert(iOffset == acOutput.size());
+        }
+
+        /*
+        **
+        */
+        void encode(
+            std::vector<char>& acOutput,
+            uint8_t const* pImageData,
+            uint32_t iWidth,
+            uint32_t iHeight,
+            uint32_t iNumMipLevels)
+        {
+            std::vector<std::vector<uint8_t>> aaiLevels;
+            buildMipChain(aaiLevels, pImageData, iWidth, iHeight, iNumMipLevels);
+            write(acOutput, Format::RGBA8Unorm, iWidth, iHeight, aaiLevels);
+        }
+
+        /*
+        **
+        */
+        bool parseHeader(
+            Header& header,
+            void const* pData,
+            uint64_t iSize)
+        {
+            if(pData == nullptr || iSize < sizeof(Header))
+            {
+                return false;
+            }
+
+            memcpy(&header, pData, sizeof(Header));
+            return header.miSignature == TEXTURE_CACHE_SIGNATURE &&
+                header.miVersion == TEXTURE_CACHE_VERSION &&
+                header.miFormat <= Format::BC7RGBAUnorm &&
+                header.miWidth > 0 &&
+                header.miHeight > 0 &&
+                header.miNumMipLevels >= 1 &&
+                header.miNumMipLevels <= getMaxMipLevels(header.miWidth, header.miHeight);
+        }
+
+        /*
+        **
+        */
+        bool parse(
+            Header& header,
+            std::vector<Level>& aLevels,
+            void const* pData,
+            uint64_t iSize)
+        {
+            if(!parseHeader(header, pData, iSize) || iSize < getFileSize(header))
+            {
+                return false;
+            }
+
+            aLevels.resize(header.miNumMipLevels);
+            memcpy(aLevels.data(), (char const*)pData + sizeof(Header), sizeof(Level) * header.miNumMipLevels);
+            for(auto const& level : aLevels)
+            {
+                if(level.miOffset + level.miSize > iSize ||
+                   level.miSize != getLevelSize(header.miFormat, level.miWidth, level.miHeight))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+    }   // TextureCache
+
+}   // Loader
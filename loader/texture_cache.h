@@ -0,0 +1,107 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace Loader
+{
+    namespace TextureCache
+    {
+        /*
+        ** .rtex, pre-decoded RGBA8 or block compressed image with an optional mip chain. a header and
+        ** a level index like KTX2's, followed by the levels from the largest down with tightly packed
+        ** rows of texels or 4 x 4 blocks, so a level goes to WriteTexture or a mapped staging buffer as it is
+        */
+        struct Header
+        {
+            uint32_t        miSignature;
+            uint32_t        miVersion;
+            uint32_t        miFormat;
+            uint32_t        miWidth;
+            uint32_t        miHeight;
+            uint32_t        miNumMipLevels;
+        };
+
+        struct Level
+        {
+            uint64_t        miOffset;
+            uint64_t        miSize;
+            uint32_t        miWidth;
+            uint32_t        miHeight;
+        };
+
+        enum Format : uint32_t
+        {
+            RGBA8Unorm = 0,
+            BC1RGBAUnorm,
+            BC7RGBAUnorm,
+        };
+
+        // 0 for uncompressed formats
+        uint32_t getBytesPerBlock(uint32_t iFormat);
+
+        // block compressed levels round up to whole blocks
+        uint64_t getLevelSize(
+            uint32_t iFormat,
+            uint32_t iWidth,
+            uint32_t iHeight);
+
+        // foo.png -> foo.rtex, where the renderer looks for the cached version of an image
+        std::string getCachePath(std::string const& imagePath);
+
+        // full chain down to 1 x 1
+        uint32_t getMaxMipLevels(
+            uint32_t iWidth,
+            uint32_t iHeight);
+
+        // bytes of the whole file, for reserving memory from the header alone
+        uint64_t getFileSize(Header const& header);
+
+        // 2 x 2 box filter, odd edges repeat the last texel
+        void halveImage(
+            std::vector<uint8_t>& aiDest,
+            uint8_t const* pImageData,
+            uint32_t iWidth,
+            uint32_t iHeight);
+
+        // RGBA8 levels from the image down, iNumMipLevels is clamped to the full chain
+        void buildMipChain(
+            std::vector<std::vector<uint8_t>>& aaiLevels,
+            uint8_t const* pImageData,
+            uint32_t iWidth,
+            uint32_t iHeight,
+            uint32_t iNumMipLevels);
+
+        // levels already in the format, e.g. block compressed by the caller
+        void write(
+            std::vector<char>& acOutput,
+            uint32_t iFormat,
+            uint32_t iWidth,
+            uint32_t iHeight,
+            std::vector<std::vector<uint8_t>> const& aaiLevels);
+
+        // builds iNumMipLevels levels from the RGBA8 image, clamped to the full chain
+        void encode(
+            std::vector<char>& acOutput,
+            uint8_t const* pImageData,
+            uint32_t iWidth,
+            uint32_t iHeight,
+            uint32_t iNumMipLevels);
+
+        bool parseHeader(
+            Header& header,
+            void const* pData,
+            uint64_t iSize);
+
+        // level offsets are into pData, false if the file is truncated or not a cache file
+        bool parse(
+            Header& header,
+            std::vector<Level>& aLevels,
+            void const* pData,
+            uint64_t iSize);
+
+    }   // TextureCache
+
+}   // Loader
@@ -47,8 +47,10 @@ enum State
 
 CCamera gCamera;
 Render::CRenderer gRenderer;
+Render::CPipelineCache gPipelineCache;
 wgpu::Sampler gSampler;
-wgpu::BindGroup gBindGroup;
+// swap chain output on even and odd frames, ping-pong outputs alternate textures
+wgpu::BindGroup gaBindGroups[2];
 wgpu::BindGroupLayout gBindGroupLayout;
 float4x4                                gPrevViewProjectionMatrix;
 
@@ -278,28 +280,31 @@ void createRenderPipeline()
     bindGroupLayoutDesc.entryCount = (uint32_t)aBindingLayouts.size();
     gBindGroupLayout = device.CreateBindGroupLayout(&bindGroupLayoutDesc);
 
-    // create bind group
-    std::vector<wgpu::BindGroupEntry> aBindGroupEntries;
-
-    // texture binding in group
-    wgpu::BindGroupEntry bindGroupEntry = {};
-    bindGroupEntry.binding = (uint32_t)aBindGroupEntries.size();
-    bindGroupEntry.textureView = gRenderer.getSwapChainTexture().CreateView();
-    bindGroupEntry.sampler = nullptr;
-    aBindGroupEntries.push_back(bindGroupEntry);
-
-    // sample binding in group
-    bindGroupEntry = {};
-    bindGroupEntry.binding = (uint32_t)aBindGroupEntries.size();
-    bindGroupEntry.sampler = gSampler;
-    aBindGroupEntries.push_back(bindGroupEntry);
-
-    // create bind group
-    wgpu::BindGroupDescriptor bindGroupDesc = {};
-    bindGroupDesc.layout = gBindGroupLayout;
-    bindGroupDesc.entries = aBindGroupEntries.data();
-    bindGroupDesc.entryCount = (uint32_t)aBindGroupEntries.size();
-    gBindGroup = device.CreateBindGroup(&bindGroupDesc);
+    for(uint32_t iFrame = 0; iFrame < 2; iFrame++)
+    {
+        // create bind group
+        std::vector<wgpu::BindGroupEntry> aBindGroupEntries;
+
+        // texture binding in group
+        wgpu::BindGroupEntry bindGroupEntry = {};
+        bindGroupEntry.binding = (uint32_t)aBindGroupEntries.size();
+        bindGroupEntry.textureView = gRenderer.getSwapChainTexture(iFrame).CreateView();
+        bindGroupEntry.sampler = nullptr;
+        aBindGroupEntries.push_back(bindGroupEntry);
+
+        // sample binding in group
+        bindGroupEntry = {};
+        bindGroupEntry.binding = (uint32_t)aBindGroupEntries.size();
+        bindGroupEntry.sampler = gSampler;
+        aBindGroupEntries.push_back(bindGroupEntry);
+
+        // create bind group
+        wgpu::BindGroupDescriptor bindGroupDesc = {};
+        bindGroupDesc.layout = gBindGroupLayout;
+        bindGroupDesc.entries = aBindGroupEntries.data();
+        bindGroupDesc.entryCount = (uint32_t)aBindGroupEntries.size();
+        gaBindGroups[iFrame] = device.CreateBindGroup(&bindGroupDesc);
+    }
 
     // layout for creating pipeline
     wgpu::PipelineLayoutDescriptor layoutDesc = {};
@@ -381,12 +386,16 @@ void render()
 
         float4 worldPosition = inverseViewMatrix * test;
 
+        // looked up once, render() runs after setup
+        static uint32_t siCompositeUniformHandle = gRenderer.getUniformBufferHandle("Ray Tracing Composite Graphics", "uniformData");
+
         Render::CRenderer::QueueData data;
         data.miSize = sizeof(float4x4);
         data.miStart = 0;
         data.mJobName = "Ray Tracing Composite Graphics";
         data.mpData = &inverseProjectionMatrix;
         data.mShaderResourceName = "uniformData";
+        data.miBufferHandle = siCompositeUniformHandle;
         gRenderer.addQueueData(data);
     }
 
@@ -438,6 +447,7 @@ void render()
         gRenderer.setBufferData("default-uniform-buffer", &defaultUniformData, 0, sizeof(DefaultUniformData));
     }
 
+    uint32_t iDrawFrame = gRenderer.getFrameIndex();
     gRenderer.draw(drawDesc);
 
     gPrevViewProjectionMatrix = gCamera.getViewProjectionMatrix();
@@ -458,7 +468,7 @@ void render()
     wgpu::CommandEncoder encoder = device.CreateCommandEncoder();
     wgpu::RenderPassEncoder pass = encoder.BeginRenderPass(&renderpass);
 
-    pass.SetBindGroup(0, gBindGroup);
+    pass.SetBindGroup(0, gaBindGroups[iDrawFrame & 1]);
     pass.SetPipeline(pipeline);
     pass.Draw(3);
     pass.End();
@@ -488,6 +498,11 @@ void initGraphics()
     desc.mMeshFilePath = "ramen-shop-with-light";
     desc.mRenderJobPipelineFilePath = "render-jobs.json";
     desc.mpSampler = &gSampler;
+    //desc.mbProgressiveMeshLoading = true;
+    desc.miNumStreamedMeshesPerFrame = 16;
+#if !defined(__EMSCRIPTEN__)
+    desc.mpPipelineCache = &gPipelineCache;
+#endif // !__EMSCRIPTEN__
     gRenderer.setup(desc);
     
     createRenderPipeline();
@@ -827,6 +842,13 @@ void start()
         data.mpData = &gDeferredIndirectUniformData;
         gRenderer.addQueueData(data);
 
+        // the depth passes place the meshes the same way
+        data.mJobName = "Mesh Occluder Depth Graphics";
+        gRenderer.addQueueData(data);
+
+        data.mJobName = "Deferred Depth Prepass Graphics";
+        gRenderer.addQueueData(data);
+
         data.mJobName = "Deferred Indirect Front Face Graphics";
         //gRenderer.addQueueData(data);
 
@@ -1272,8 +1294,20 @@ int main()
     requiredLimits.limits.maxBufferSize = 400000000;
     requiredLimits.limits.maxStorageBufferBindingSize = 400000000;
     requiredLimits.limits.maxColorAttachmentBytesPerSample = 64;
+    std::vector<wgpu::FeatureName> aFeatureNames;
+    if(adapter.HasFeature(wgpu::FeatureName::TextureCompressionBC))
+    {
+        aFeatureNames.push_back(wgpu::FeatureName::TextureCompressionBC);
+    }
+    // lets "radiance_rgb" render targets use rg11b10ufloat
+    if(adapter.HasFeature(wgpu::FeatureName::RG11B10UfloatRenderable))
+    {
+        aFeatureNames.push_back(wgpu::FeatureName::RG11B10UfloatRenderable);
+    }
     wgpu::DeviceDescriptor deviceDesc = {};
     deviceDesc.requiredLimits = &requiredLimits;
+    deviceDesc.requiredFeatures = aFeatureNames.data();
+    deviceDesc.requiredFeatureCount = aFeatureNames.size();
     adapter.RequestDevice(
         &deviceDesc,
         [](WGPURequestDeviceStatus status,
@@ -1335,25 +1369,54 @@ int main()
         "allow_unsafe_apis",
         "disable_symbol_renaming"
     };
-    wgpu::FeatureName aFeatureNames[] =
+    std::vector<wgpu::FeatureName> aFeatureNames =
     {
     #if defined(_MSC_VER)
         wgpu::FeatureName::MultiDrawIndirect,
     #endif // _MSC_VER
         wgpu::FeatureName::Float32Filterable,
     };
+
+    // block compressed atlas pages when the adapter can sample them
+    if(adapter.HasFeature(wgpu::FeatureName::TextureCompressionBC))
+    {
+        aFeatureNames.push_back(wgpu::FeatureName::TextureCompressionBC);
+    }
+    // lets "radiance_rgb" render targets use rg11b10ufloat
+    if(adapter.HasFeature(wgpu::FeatureName::RG11B10UfloatRenderable))
+    {
+        aFeatureNames.push_back(wgpu::FeatureName::RG11B10UfloatRenderable);
+    }
     wgpu::Limits requireLimits = {};
     requireLimits.maxBufferSize = 1000000000;
     requireLimits.maxStorageBufferBindingSize = 1000000000;
     requireLimits.maxColorAttachmentBytesPerSample = 64;
 
+    // compiled shaders and pipelines persist on disk through Dawn's blob cache, the adapter and
+    // driver go in the isolation key so a driver update starts a fresh set
+    wgpu::AdapterInfo adapterInfo = {};
+    adapter.GetInfo(&adapterInfo);
+    char szAdapterKey[256];
+    snprintf(szAdapterKey, sizeof(szAdapterKey), "%04x-%04x-%d-%.*s",
+        adapterInfo.vendorID,
+        adapterInfo.deviceID,
+        (uint32_t)adapterInfo.backendType,
+        (int32_t)adapterInfo.description.length,
+        adapterInfo.description.data);
+    Render::CPipelineCache::CreateDescriptor pipelineCacheDesc = {};
+    pipelineCacheDesc.mAdapterKey = szAdapterKey;
+    gPipelineCache.setup(pipelineCacheDesc);
+    wgpu::DawnCacheDeviceDescriptor cacheDesc = {};
+    gPipelineCache.fillDeviceDescriptor(cacheDesc);
+
     wgpu::DawnTogglesDescriptor toggleDesc = {};
+    toggleDesc.nextInChain = &cacheDesc;
     toggleDesc.enabledToggles = (const char* const*)&aszToggleNames;
     toggleDesc.enabledToggleCount = sizeof(aszToggleNames) / sizeof(*aszToggleNames);
     wgpu::DeviceDescriptor deviceDesc = {};
     deviceDesc.nextInChain = &toggleDesc;
-    deviceDesc.requiredFeatures = aFeatureNames;
-    deviceDesc.requiredFeatureCount = sizeof(aFeatureNames) / sizeof(*aFeatureNames);
+    deviceDesc.requiredFeatures = aFeatureNames.data();
+    deviceDesc.requiredFeatureCount = aFeatureNames.size();
     deviceDesc.requiredLimits = &requireLimits;
 
     deviceDesc.SetUncapturedErrorCallback(
@@ -1630,27 +1693,30 @@ extern "C"
             szRenderJobName,
             szOutputAttachmentName);
 
-        std::vector<wgpu::BindGroupEntry> aBindGroupEntries;
-
-        // texture binding in group
-        wgpu::BindGroupEntry bindGroupEntry = {};
-        bindGroupEntry.binding = (uint32_t)aBindGroupEntries.size();
-        bindGroupEntry.textureView = gRenderer.getSwapChainTexture().CreateView();
-        bindGroupEntry.sampler = nullptr;
-        aBindGroupEntries.push_back(bindGroupEntry);
-
-        // sample binding in group
-        bindGroupEntry = {};
-        bindGroupEntry.binding = (uint32_t)aBindGroupEntries.size();
-        bindGroupEntry.sampler = gSampler;
-        aBindGroupEntries.push_back(bindGroupEntry);
-
-        // create bind group
-        wgpu::BindGroupDescriptor bindGroupDesc = {};
-        bindGroupDesc.layout = gBindGroupLayout;
-        bindGroupDesc.entries = aBindGroupEntries.data();
-        bindGroupDesc.entryCount = (uint32_t)aBindGroupEntries.size();
-        gBindGroup = device.CreateBindGroup(&bindGroupDesc);
+        for(uint32_t iFrame = 0; iFrame < 2; iFrame++)
+        {
+            std::vector<wgpu::BindGroupEntry> aBindGroupEntries;
+
+            // texture binding in group
+            wgpu::BindGroupEntry bindGroupEntry = {};
+            bindGroupEntry.binding = (uint32_t)aBindGroupEntries.size();
+            bindGroupEntry.textureView = gRenderer.getSwapChainTexture(iFrame).CreateView();
+            bindGroupEntry.sampler = nullptr;
+            aBindGroupEntries.push_back(bindGroupEntry);
+
+            // sample binding in group
+            bindGroupEntry = {};
+            bindGroupEntry.binding = (uint32_t)aBindGroupEntries.size();
+            bindGroupEntry.sampler = gSampler;
+            aBindGroupEntries.push_back(bindGroupEntry);
+
+            // create bind group
+            wgpu::BindGroupDescriptor bindGroupDesc = {};
+            bindGroupDesc.layout = gBindGroupLayout;
+            bindGroupDesc.entries = aBindGroupEntries.data();
+            bindGroupDesc.entryCount = (uint32_t)aBindGroupEntries.size();
+            gaBindGroups[iFrame] = device.CreateBindGroup(&bindGroupDesc);
+        }
     }
 
     /*
@@ -1702,6 +1768,12 @@ extern "C"
         data.mpData = &gDeferredIndirectUniformData;
         gRenderer.addQueueData(data);
 
+        data.mJobName = "Mesh Occluder Depth Graphics";
+        gRenderer.addQueueData(data);
+
+        data.mJobName = "Deferred Depth Prepass Graphics";
+        gRenderer.addQueueData(data);
+
         data.mJobName = "Deferred Indirect Front Face Graphics";
         gRenderer.addQueueData(data);
     }
@@ -1765,6 +1837,12 @@ extern "C"
         data.mpData = &gDeferredIndirectUniformData;
         gRenderer.addQueueData(data);
 
+        data.mJobName = "Mesh Occluder Depth Graphics";
+        gRenderer.addQueueData(data);
+
+        data.mJobName = "Deferred Depth Prepass Graphics";
+        gRenderer.addQueueData(data);
+
         data.mJobName = "Deferred Indirect Front Face Graphics";
         gRenderer.addQueueData(data);
     }
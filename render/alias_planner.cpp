@@ -0,0 +1,96 @@
+#include <render/alias_planner.h>
+#include <render/format_policy.h>
+
+#include <algorithm>
+#include <numeric>
+
+#include <stdio.h>
+
+namespace Render
+{
+    /*
+    **
+    */
+    uint32_t CAliasPlanner::plan(std::vector<Attachment>& aAttachments)
+    {
+        struct Physical
+        {
+            wgpu::TextureFormat     mFormat;
+            uint32_t                miWidth;
+            uint32_t                miHeight;
+            uint32_t                miLastUse;
+        };
+
+        mStats = Stats();
+        mStats.miNumAttachments = (uint32_t)aAttachments.size();
+
+        std::vector<uint32_t> aiOrder(aAttachments.size());
+        std::iota(aiOrder.begin(), aiOrder.end(), 0);
+        std::stable_sort(
+            aiOrder.begin(),
+            aiOrder.end(),
+            [&](uint32_t iLeft, uint32_t iRight)
+            {
+                return aAttachments[iLeft].miFirstUse < aAttachments[iRight].miFirstUse;
+            });
+
+        std::vector<Physical> aPhysical;
+        for(uint32_t iAttachment : aiOrder)
+        {
+            Attachment& attachment = aAttachments[iAttachment];
+            uint64_t iSize = (uint64_t)attachment.miWidth * attachment.miHeight * FormatPolicy::getBytesPerPixel(attachment.mFormat);
+            mStats.miBytesBefore += iSize;
+
+            // the job reading the previous occupant last can't also be writing this one
+            uint32_t iPhysical = UINT32_MAX;
+            if(!attachment.mbPersistent)
+            {
+                for(uint32_t i = 0; i < (uint32_t)aPhysical.size(); i++)
+                {
+                    Physical const& physical = aPhysical[i];
+                    if(physical.miLastUse != UINT32_MAX &&
+                       physical.mFormat == attachment.mFormat &&
+                       physical.miWidth == attachment.miWidth &&
+                       physical.miHeight == attachment.miHeight &&
+                       physical.miLastUse < attachment.miFirstUse)
+                    {
+                        iPhysical = i;
+                        break;
+                    }
+                }
+            }
+            else
+            {
+                ++mStats.miNumPersistent;
+            }
+
+            if(iPhysical == UINT32_MAX)
+            {
+                iPhysical = (uint32_t)aPhysical.size();
+                aPhysical.push_back({attachment.mFormat, attachment.miWidth, attachment.miHeight, 0});
+                mStats.miBytesAfter += iSize;
+            }
+
+            // persistent textures are never handed on
+            aPhysical[iPhysical].miLastUse = attachment.mbPersistent ? UINT32_MAX : attachment.miLastUse;
+            attachment.miPhysical = iPhysical;
+        }
+        mStats.miNumPhysical = (uint32_t)aPhysical.size();
+
+        return mStats.miNumPhysical;
+    }
+
+    /*
+    **
+    */
+    void CAliasPlanner::printStats() const
+    {
+        printf("render target aliasing: %d attachments (%d persistent) in %d textures, %.2f MB -> %.2f MB\n",
+            mStats.miNumAttachments,
+            mStats.miNumPersistent,
+            mStats.miNumPhysical,
+            (double)mStats.miBytesBefore / (1024.0 * 1024.0),
+            (double)mStats.miBytesAfter / (1024.0 * 1024.0));
+    }
+
+}   // Render
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <webgpu/webgpu_cpp.h>
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace Render
+{
+    /*
+    ** assigns render job output textures to shared physical textures. each attachment is alive from
+    ** the job writing it to the last job reading it in the frame, attachments of the same format and
+    ** size whose lifetimes don't overlap go in the same texture. persistent ones, read the next frame
+    ** or outside the render jobs, keep their own
+    */
+    class CAliasPlanner
+    {
+    public:
+        struct Attachment
+        {
+            std::string             mJobName;
+            std::string             mName;
+            wgpu::TextureFormat     mFormat;
+            uint32_t                miWidth = 0;
+            uint32_t                miHeight = 0;
+            uint32_t                miFirstUse = 0;
+            uint32_t                miLastUse = 0;
+            bool                    mbPersistent = false;
+
+            // filled in by plan()
+            uint32_t                miPhysical = UINT32_MAX;
+        };
+
+        struct Stats
+        {
+            uint32_t                miNumAttachments = 0;
+            uint32_t                miNumPersistent = 0;
+            uint32_t                miNumPhysical = 0;
+            uint64_t                miBytesBefore = 0;
+            uint64_t                miBytesAfter = 0;
+        };
+
+    public:
+        CAliasPlanner() = default;
+        virtual ~CAliasPlanner() = default;
+
+        // first fit in the order the attachments are first used, returns the number of physical textures
+        uint32_t plan(std::vector<Attachment>& aAttachments);
+
+        inline Stats const& getStats() const
+        {
+            return mStats;
+        }
+
+        void printStats() const;
+
+    protected:
+        Stats                       mStats;
+    };
+
+}   // Render
@@ -0,0 +1,168 @@
+#include <render/format_policy.h>
+
+#include <stdio.h>
+
+namespace Render
+{
+    namespace FormatPolicy
+    {
+        struct FormatInfo
+        {
+            char const*             mszName;
+            wgpu::TextureFormat     mFormat;
+            uint32_t                miBytesPerPixel;
+            bool                    mbStorage;
+            wgpu::TextureSampleType mSampleType;
+        };
+
+        static FormatInfo const kaFormats[] =
+        {
+            {"rgba32float",     wgpu::TextureFormat::RGBA32Float,       16,     true,   wgpu::TextureSampleType::UnfilterableFloat},
+            {"rgba16float",     wgpu::TextureFormat::RGBA16Float,       8,      true,   wgpu::TextureSampleType::UnfilterableFloat},
+            {"rg32float",       wgpu::TextureFormat::RG32Float,         8,      true,   wgpu::TextureSampleType::UnfilterableFloat},
+            {"rg16float",       wgpu::TextureFormat::RG16Float,         4,      false,  wgpu::TextureSampleType::UnfilterableFloat},
+            {"r32float",        wgpu::TextureFormat::R32Float,          4,      true,   wgpu::TextureSampleType::UnfilterableFloat},
+            {"r16float",        wgpu::TextureFormat::R16Float,          2,      false,  wgpu::TextureSampleType::UnfilterableFloat},
+            {"rg11b10ufloat",   wgpu::TextureFormat::RG11B10Ufloat,     4,      false,  wgpu::TextureSampleType::UnfilterableFloat},
+            {"rgba8unorm",      wgpu::TextureFormat::RGBA8Unorm,        4,      true,   wgpu::TextureSampleType::UnfilterableFloat},
+            {"rgba8uint",       wgpu::TextureFormat::RGBA8Uint,         4,      true,   wgpu::TextureSampleType::Uint},
+            {"rgba16uint",      wgpu::TextureFormat::RGBA16Uint,        8,      true,   wgpu::TextureSampleType::Uint},
+            {"rgba32uint",      wgpu::TextureFormat::RGBA32Uint,        16,     true,   wgpu::TextureSampleType::Uint},
+            {"rg16uint",        wgpu::TextureFormat::RG16Uint,          4,      false,  wgpu::TextureSampleType::Uint},
+            {"rg32uint",        wgpu::TextureFormat::RG32Uint,          8,      true,   wgpu::TextureSampleType::Uint},
+            {"r16uint",         wgpu::TextureFormat::R16Uint,           2,      false,  wgpu::TextureSampleType::Uint},
+            {"r32uint",         wgpu::TextureFormat::R32Uint,           4,      true,   wgpu::TextureSampleType::Uint},
+        };
+
+        struct SemanticInfo
+        {
+            char const*             mszName;
+            wgpu::TextureFormat     maFormats[3];       // by quality
+        };
+
+        static SemanticInfo const kaSemantics[] =
+        {
+            {"radiance",        {wgpu::TextureFormat::RGBA16Float,      wgpu::TextureFormat::RGBA16Float,       wgpu::TextureFormat::RGBA32Float}},
+            {"radiance_rgb",    {wgpu::TextureFormat::RG11B10Ufloat,    wgpu::TextureFormat::RG11B10Ufloat,     wgpu::TextureFormat::RGBA16Float}},
+            {"normal",          {wgpu::TextureFormat::RGBA16Float,      wgpu::TextureFormat::RGBA16Float,       wgpu::TextureFormat::RGBA16Float}},
+            {"position",        {wgpu::TextureFormat::RGBA32Float,      wgpu::TextureFormat::RGBA32Float,       wgpu::TextureFormat::RGBA32Float}},
+            {"reservoir",       {wgpu::TextureFormat::RGBA16Float,      wgpu::TextureFormat::RGBA16Float,       wgpu::TextureFormat::RGBA32Float}},
+            {"moment",          {wgpu::TextureFormat::RGBA16Float,      wgpu::TextureFormat::RGBA16Float,       wgpu::TextureFormat::RGBA32Float}},
+            {"mask",            {wgpu::TextureFormat::RGBA8Unorm,       wgpu::TextureFormat::RGBA8Unorm,        wgpu::TextureFormat::RGBA16Float}},
+            {"scalar",          {wgpu::TextureFormat::R16Float,         wgpu::TextureFormat::R16Float,          wgpu::TextureFormat::R32Float}},
+        };
+
+        /*
+        **
+        */
+        static FormatInfo const* findFormat(wgpu::TextureFormat format)
+        {
+            for(auto const& formatInfo : kaFormats)
+            {
+                if(formatInfo.mFormat == format)
+                {
+                    return &formatInfo;
+                }
+            }
+
+            return nullptr;
+        }
+
+        /*
+        **
+        */
+        wgpu::TextureFormat parseFormat(std::string const& formatName)
+        {
+            for(auto const& formatInfo : kaFormats)
+            {
+                if(formatName == formatInfo.mszName)
+                {
+                    return formatInfo.mFormat;
+                }
+            }
+
+            return wgpu::TextureFormat::Undefined;
+        }
+
+        /*
+        **
+        */
+        char const* getFormatName(wgpu::TextureFormat format)
+        {
+            FormatInfo const* pFormatInfo = findFormat(format);
+            return (pFormatInfo != nullptr) ? pFormatInfo->mszName : "unknown";
+        }
+
+        /*
+        **
+        */
+        wgpu::TextureFormat resolve(
+            std::string const& semantic,
+            std::string const& declaredFormat,
+            Settings const& settings)
+        {
+            if(semantic.length() > 0)
+            {
+                for(auto const& semanticInfo : kaSemantics)
+                {
+                    if(semantic == semanticInfo.mszName)
+                    {
+                        wgpu::TextureFormat format = semanticInfo.maFormats[(uint32_t)settings.mQuality];
+                        if(format == wgpu::TextureFormat::RG11B10Ufloat && !settings.mbRG11B10UfloatRenderable)
+                        {
+                            format = wgpu::TextureFormat::RGBA16Float;
+                        }
+
+                        return format;
+                    }
+                }
+
+                printf("%s : %d unknown attachment semantic \"%s\", using the declared format\n",
+                    __FILE__,
+                    __LINE__,
+                    semantic.c_str());
+            }
+
+            wgpu::TextureFormat format = parseFormat(declaredFormat);
+            if(format == wgpu::TextureFormat::Undefined)
+            {
+                printf("%s : %d unknown attachment format \"%s\", using rgba32float\n",
+                    __FILE__,
+                    __LINE__,
+                    declaredFormat.c_str());
+                format = wgpu::TextureFormat::RGBA32Float;
+            }
+
+            return format;
+        }
+
+        /*
+        **
+        */
+        uint32_t getBytesPerPixel(wgpu::TextureFormat format)
+        {
+            FormatInfo const* pFormatInfo = findFormat(format);
+            return (pFormatInfo != nullptr) ? pFormatInfo->miBytesPerPixel : 16;
+        }
+
+        /*
+        **
+        */
+        bool supportsStorage(wgpu::TextureFormat format)
+        {
+            FormatInfo const* pFormatInfo = findFormat(format);
+            return (pFormatInfo != nullptr) ? pFormatInfo->mbStorage : false;
+        }
+
+        /*
+        **
+        */
+        wgpu::TextureSampleType getSampleType(wgpu::TextureFormat format)
+        {
+            FormatInfo const* pFormatInfo = findFormat(format);
+            return (pFormatInfo != nullptr) ? pFormatInfo->mSampleType : wgpu::TextureSampleType::UnfilterableFloat;
+        }
+
+    }   // FormatPolicy
+
+}   // Render
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <webgpu/webgpu_cpp.h>
+
+#include <string>
+
+#include <stdint.h>
+
+namespace Render
+{
+    /*
+    ** render target formats. an attachment either names its format or declares what it holds with
+    ** "Semantic" and gets the cheapest format that keeps that data at the global quality setting
+    **
+    **  semantic        low             medium          high
+    **  radiance        rgba16float     rgba16float     rgba32float     hdr, alpha carries data
+    **  radiance_rgb    rg11b10ufloat   rg11b10ufloat   rgba16float     positive hdr, no alpha
+    **  normal          rgba16float     rgba16float     rgba16float
+    **  position        rgba32float     rgba32float     rgba32float
+    **  reservoir       rgba16float     rgba16float     rgba32float
+    **  moment          rgba16float     rgba16float     rgba32float
+    **  mask            rgba8unorm      rgba8unorm      rgba16float     0 to 1
+    **  scalar          r16float        r16float        r32float
+    **
+    ** rg11b10ufloat falls back to rgba16float without the RG11B10UfloatRenderable feature
+    */
+    namespace FormatPolicy
+    {
+        enum class Quality
+        {
+            Low = 0,
+            Medium,
+            High,
+        };
+
+        struct Settings
+        {
+            Quality         mQuality = Quality::Medium;
+            bool            mbRG11B10UfloatRenderable = false;
+        };
+
+        // Undefined for names it doesn't know
+        wgpu::TextureFormat parseFormat(std::string const& formatName);
+        char const* getFormatName(wgpu::TextureFormat format);
+
+        // semantic if there is one, otherwise the declared format, RGBA32Float with a warning if neither is known
+        wgpu::TextureFormat resolve(
+            std::string const& semantic,
+            std::string const& declaredFormat,
+            Settings const& settings);
+
+        uint32_t getBytesPerPixel(wgpu::TextureFormat format);
+        bool supportsStorage(wgpu::TextureFormat format);
+        wgpu::TextureSampleType getSampleType(wgpu::TextureFormat format);
+
+    }   // FormatPolicy
+
+}   // Render
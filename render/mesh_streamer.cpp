@@ -0,0 +1,250 @@
+#include <render/mesh_streamer.h>
+
+#include <loader/loader.h>
+
+#include <algorithm>
+
+#include <assert.h>
+#include <stdio.h>
+
+#define MAX_CHUNK_LOAD_ATTEMPTS     3
+
+namespace Render
+{
+    /*
+    **
+    */
+    CMeshStreamer::~CMeshStreamer()
+    {
+        // loader threads still hold on to this streamer through their callbacks
+        std::unique_lock<std::mutex> lock(mReadyMutex);
+        mAllLoaded.wait(lock, [&]
+        {
+            return miNumOutstandingLoads == 0;
+        });
+    }
+
+    /*
+    **
+    */
+    void CMeshStreamer::setup(
+        CreateDescriptor const& desc,
+        std::vector<Range> const& aVertexRanges,
+        std::vector<Range> const& aTriangleRanges,
+        std::vector<Extent> const& aExtents)
+    {
+        assert(aVertexRanges.size() == aTriangleRanges.size());
+        assert(aExtents.size() >= aTriangleRanges.size());
+
+        mDesc = desc;
+        maVertexRanges = aVertexRanges;
+        maTriangleRanges = aTriangleRanges;
+        maExtents = aExtents;
+
+        uint32_t iNumMeshes = (uint32_t)maTriangleRanges.size();
+        maChunkStates.assign(iNumMeshes, ChunkState::NotLoaded);
+        maiResidency.assign(iNumMeshes, 0);
+        maiNumAttempts.assign(iNumMeshes, 0);
+        miNumResidentMeshes = 0;
+        miNumFailedMeshes = 0;
+        miNumRequestsInFlight = 0;
+    }
+
+    /*
+    **
+    */
+    bool CMeshStreamer::update(
+        float3 const& cameraPosition,
+        float3 const& cameraLookAt)
+    {
+        bool bResidencyChanged = false;
+
+        // upload the chunks that arrived since the last frame
+        std::vector<std::shared_ptr<LoadedChunk>> apUploadChunks;
+        {
+            std::lock_guard<std::mutex> lock(mReadyMutex);
+            while(maReadyChunks.size() > 0 && (uint32_t)apUploadChunks.size() < mDesc.miMaxUploadsPerFrame)
+            {
+                apUploadChunks.push_back(maReadyChunks.front());
+                maReadyChunks.pop_front();
+            }
+        }
+
+        for(auto const& pChunk : apUploadChunks)
+        {
+            uint32_t iMesh = pChunk->miMesh;
+            --miNumRequestsInFlight;
+
+            if(!pChunk->mbSucceeded)
+            {
+                maChunkStates[iMesh] = (maiNumAttempts[iMesh] >= MAX_CHUNK_LOAD_ATTEMPTS) ? ChunkState::Failed : ChunkState::NotLoaded;
+                if(maChunkStates[iMesh] == ChunkState::Failed)
+                {
+                    ++miNumFailedMeshes;
+                    printf("%s : %d failed to stream mesh %d from \"%s\"\n",
+                        __FILE__,
+                        __LINE__,
+                        iMesh,
+                        mDesc.mFilePath.c_str());
+                }
+                continue;
+            }
+
+            // indices are global, the data goes to the same place as a full load would put it
+            if(pChunk->macVertexData.size() > 0)
+            {
+                mDesc.mpDevice->GetQueue().WriteBuffer(
+                    mDesc.mVertexBuffer,
+                    (uint64_t)maVertexRanges[iMesh].miStart * mDesc.miVertexSize,
+                    pChunk->macVertexData.data(),
+                    pChunk->macVertexData.size());
+            }
+            if(pChunk->macIndexData.size() > 0)
+            {
+                mDesc.mpDevice->GetQueue().WriteBuffer(
+                    mDesc.mIndexBuffer,
+                    (uint64_t)maTriangleRanges[iMesh].miStart * sizeof(uint32_t),
+                    pChunk->macIndexData.data(),
+                    pChunk->macIndexData.size());
+            }
+
+            maChunkStates[iMesh] = ChunkState::Resident;
+            maiResidency[iMesh] = 1;
+            ++miNumResidentMeshes;
+            bResidencyChanged = true;
+        }
+
+        if(miNumRequestsInFlight >= mDesc.miMaxRequestsInFlight || isComplete())
+        {
+            return bResidencyChanged;
+        }
+
+        // projected size of the mesh bounds, meshes in front of the camera go first
+        float3 viewDirection = cameraLookAt - cameraPosition;
+        float fViewLength = length(viewDirection);
+        viewDirection = (fViewLength > 1.0e-5f) ? viewDirection / fViewLength : float3(0.0f, 0.0f, 1.0f);
+
+        std::vector<std::pair<float, uint32_t>> aPriorities;
+        aPriorities.reserve(maChunkStates.size());
+        for(uint32_t iMesh = 0; iMesh < (uint32_t)maChunkStates.size(); iMesh++)
+        {
+            if(maChunkStates[iMesh] != ChunkState::NotLoaded)
+            {
+                continue;
+            }
+
+            float3 minPosition = float3(maExtents[iMesh].mMinPosition);
+            float3 maxPosition = float3(maExtents[iMesh].mMaxPosition);
+            float3 center = (minPosition + maxPosition) * 0.5f;
+            float fRadius = length(maxPosition - minPosition) * 0.5f;
+
+            float3 toCenter = center - cameraPosition;
+            float fDistance = length(toCenter);
+            float fProjectedSize = fRadius / std::max(fDistance, 1.0e-3f);
+
+            // camera inside the bounds, load right away
+            float fFacing = 1.0f;
+            if(fDistance > fRadius)
+            {
+                fFacing = dot(toCenter / fDistance, viewDirection);
+                fFacing = (fFacing > 0.0f) ? 1.0f + fFacing : 0.25f;
+            }
+            else
+            {
+                fProjectedSize = 1.0e10f;
+            }
+
+            aPriorities.push_back(std::make_pair(fProjectedSize * fFacing, iMesh));
+        }
+
+        uint32_t iNumRequests = std::min(
+            mDesc.miMaxRequestsInFlight - miNumRequestsInFlight,
+            (uint32_t)aPriorities.size());
+        std::partial_sort(
+            aPriorities.begin(),
+            aPriorities.begin() + iNumRequests,
+            aPriorities.end(),
+            [](std::pair<float, uint32_t> const& left, std::pair<float, uint32_t> const& right)
+            {
+                return left.first > right.first;
+            });
+
+        for(uint32_t i = 0; i < iNumRequests; i++)
+        {
+            requestChunk(aPriorities[i].second);
+        }
+
+        return bResidencyChanged;
+    }
+
+    /*
+    **
+    */
+    void CMeshStreamer::requestChunk(uint32_t iMesh)
+    {
+        maChunkStates[iMesh] = ChunkState::Requested;
+        ++maiNumAttempts[iMesh];
+        ++miNumRequestsInFlight;
+
+        std::shared_ptr<LoadedChunk> pChunk = std::make_shared<LoadedChunk>();
+        pChunk->miMesh = iMesh;
+
+        uint64_t iVertexOffset = mDesc.miVertexDataOffset + (uint64_t)maVertexRanges[iMesh].miStart * mDesc.miVertexSize;
+        uint64_t iVertexSize = (uint64_t)(maVertexRanges[iMesh].miEnd - maVertexRanges[iMesh].miStart) * mDesc.miVertexSize;
+        uint64_t iIndexOffset = mDesc.miIndexDataOffset + (uint64_t)maTriangleRanges[iMesh].miStart * sizeof(uint32_t);
+        uint64_t iIndexSize = (uint64_t)(maTriangleRanges[iMesh].miEnd - maTriangleRanges[iMesh].miStart) * sizeof(uint32_t);
+
+        {
+            std::lock_guard<std::mutex> lock(mReadyMutex);
+            miNumOutstandingLoads += 2;
+        }
+
+        // empty parts complete right away
+        if(iVertexSize > 0)
+        {
+            Loader::requestFileRange(mDesc.mFilePath, iVertexOffset, iVertexSize, [this, pChunk](std::vector<char>& acData, bool bSucceeded)
+            {
+                pChunk->macVertexData.swap(acData);
+                chunkPartLoaded(pChunk, bSucceeded);
+            });
+        }
+        else
+        {
+            chunkPartLoaded(pChunk, true);
+        }
+
+        if(iIndexSize > 0)
+        {
+            Loader::requestFileRange(mDesc.mFilePath, iIndexOffset, iIndexSize, [this, pChunk](std::vector<char>& acData, bool bSucceeded)
+            {
+                pChunk->macIndexData.swap(acData);
+                chunkPartLoaded(pChunk, bSucceeded);
+            });
+        }
+        else
+        {
+            chunkPartLoaded(pChunk, true);
+        }
+    }
+
+    /*
+    **
+    */
+    void CMeshStreamer::chunkPartLoaded(
+        std::shared_ptr<LoadedChunk> const& pChunk,
+        bool bSucceeded)
+    {
+        std::lock_guard<std::mutex> lock(mReadyMutex);
+        pChunk->mbSucceeded = pChunk->mbSucceeded && bSucceeded;
+        if(--pChunk->miNumPartsLeft == 0)
+        {
+            maReadyChunks.push_back(pChunk);
+        }
+
+        if(--miNumOutstandingLoads == 0)
+        {
+            mAllLoaded.notify_all();
+        }
+    }
+
+}   // Render
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <webgpu/webgpu_cpp.h>
+#include <math/vec.h>
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace Render
+{
+    /*
+    ** streams the vertices and triangle indices of each mesh from the raw -triangles.bin
+    ** in priority order, uploads them into the full size buffers as they arrive and keeps
+    ** track of which meshes are resident
+    */
+    class CMeshStreamer
+    {
+    public:
+        struct Range
+        {
+            uint32_t        miStart;
+            uint32_t        miEnd;
+        };
+
+        struct Extent
+        {
+            float4          mMinPosition;
+            float4          mMaxPosition;
+        };
+
+        struct CreateDescriptor
+        {
+            wgpu::Device*   mpDevice;
+            wgpu::Buffer    mVertexBuffer;
+            wgpu::Buffer    mIndexBuffer;
+            std::string     mFilePath;
+            uint64_t        miVertexDataOffset;
+            uint64_t        miIndexDataOffset;
+            uint32_t        miVertexSize;
+            uint32_t        miMaxRequestsInFlight = 16;
+            uint32_t        miMaxUploadsPerFrame = 8;
+        };
+
+        enum class ChunkState
+        {
+            NotLoaded = 0,
+            Requested,
+            Resident,
+            Failed,
+        };
+
+    public:
+        CMeshStreamer() = default;
+        virtual ~CMeshStreamer();
+
+        void setup(
+            CreateDescriptor const& desc,
+            std::vector<Range> const& aVertexRanges,
+            std::vector<Range> const& aTriangleRanges,
+            std::vector<Extent> const& aExtents);
+
+        // issues new requests and uploads finished ones, returns true if any mesh became resident
+        bool update(
+            float3 const& cameraPosition,
+            float3 const& cameraLookAt);
+
+        inline bool isResident(uint32_t iMesh) const
+        {
+            return maiResidency.size() == 0 || maiResidency[iMesh] != 0;
+        }
+
+        inline std::vector<uint32_t> const& getResidency() const
+        {
+            return maiResidency;
+        }
+
+        inline bool isComplete() const
+        {
+            return miNumResidentMeshes + miNumFailedMeshes == (uint32_t)maChunkStates.size();
+        }
+
+    protected:
+        struct LoadedChunk
+        {
+            uint32_t            miMesh;
+            uint32_t            miNumPartsLeft = 2;
+            bool                mbSucceeded = true;
+            std::vector<char>   macVertexData;
+            std::vector<char>   macIndexData;
+        };
+
+        void requestChunk(uint32_t iMesh);
+        void chunkPartLoaded(std::shared_ptr<LoadedChunk> const& pChunk, bool bSucceeded);
+
+    protected:
+        CreateDescriptor                        mDesc;
+
+        std::vector<Range>                      maVertexRanges;
+        std::vector<Range>                      maTriangleRanges;
+        std::vector<Extent>                     maExtents;
+
+        std::vector<ChunkState>                 maChunkStates;
+        std::vector<uint32_t>                   maiResidency;
+        std::vector<uint32_t>                   maiNumAttempts;
+        uint32_t                                miNumResidentMeshes = 0;
+        uint32_t                                miNumFailedMeshes = 0;
+        uint32_t                                miNumRequestsInFlight = 0;
+
+        // filled from the loader threads, drained on the render thread
+        std::deque<std::shared_ptr<LoadedChunk>>    maReadyChunks;
+        std::mutex                              mReadyMutex;
+        std::condition_variable                 mAllLoaded;
+        uint32_t                                miNumOutstandingLoads = 0;
+    };
+
+}   // Render
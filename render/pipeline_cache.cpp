@@ -0,0 +1,226 @@
+#include <render/pipeline_cache.h>
+
+#include <filesystem>
+
+#include <stdio.h>
+#include <string.h>
+
+namespace Render
+{
+    /*
+    **
+    */
+    void CPipelineCache::setup(CreateDescriptor const& desc)
+    {
+        mDesc = desc;
+
+        std::error_code error;
+        std::filesystem::create_directories(mDesc.mDirectory, error);
+        if(error)
+        {
+            printf("%s : %d can\'t create pipeline cache directory \"%s\"\n",
+                __FILE__,
+                __LINE__,
+                mDesc.mDirectory.c_str());
+        }
+    }
+
+#if !defined(__EMSCRIPTEN__)
+    /*
+    **
+    */
+    void CPipelineCache::fillDeviceDescriptor(wgpu::DawnCacheDeviceDescriptor& cacheDesc)
+    {
+        cacheDesc.isolationKey = mDesc.mAdapterKey.c_str();
+        cacheDesc.loadDataFunction = &CPipelineCache::loadData;
+        cacheDesc.storeDataFunction = &CPipelineCache::storeData;
+        cacheDesc.functionUserdata = this;
+    }
+#endif // !__EMSCRIPTEN__
+
+    /*
+    **
+    */
+    CPipelineCache::Stats CPipelineCache::getStats() const
+    {
+        Stats stats;
+        stats.miNumHits = miNumHits.load();
+        stats.miNumMisses = miNumMisses.load();
+        stats.miNumStores = miNumStores.load();
+        stats.miLoadedBytes = miLoadedBytes.load();
+        stats.miStoredBytes = miStoredBytes.load();
+
+        return stats;
+    }
+
+    /*
+    **
+    */
+    void CPipelineCache::printStats() const
+    {
+        Stats stats = getStats();
+        printf("pipeline cache: %d hits %.2f MB, %d misses, %d stored %.2f MB\n",
+            stats.miNumHits,
+            (double)stats.miLoadedBytes / (1024.0 * 1024.0),
+            stats.miNumMisses,
+            stats.miNumStores,
+            (double)stats.miStoredBytes / (1024.0 * 1024.0));
+    }
+
+    /*
+    **
+    */
+    size_t CPipelineCache::loadData(
+        void const* pKey,
+        size_t iKeySize,
+        void* pValue,
+        size_t iValueSize,
+        void* pUserData)
+    {
+        CPipelineCache* pCache = (CPipelineCache*)pUserData;
+        std::string key((char const*)pKey, iKeySize);
+
+        // second call for the blob sized on the first
+        if(pValue != nullptr)
+        {
+            std::vector<char> acValue;
+            {
+                std::lock_guard<std::mutex> lock(pCache->mMutex);
+                auto iter = pCache->maPendingLoads.find(key);
+                if(iter == pCache->maPendingLoads.end())
+                {
+                    return 0;
+                }
+                acValue = std::move(iter->second);
+                pCache->maPendingLoads.erase(iter);
+            }
+
+            if(acValue.size() > iValueSize)
+            {
+                return 0;
+            }
+            memcpy(pValue, acValue.data(), acValue.size());
+
+            ++pCache->miNumHits;
+            pCache->miLoadedBytes += acValue.size();
+
+            return acValue.size();
+        }
+
+        std::string filePath = pCache->getFilePath(pKey, iKeySize);
+        FILE* fp = fopen(filePath.c_str(), "rb");
+        if(fp == nullptr)
+        {
+            ++pCache->miNumMisses;
+            return 0;
+        }
+
+        fseek(fp, 0, SEEK_END);
+        size_t iFileSize = (size_t)ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+
+        // key size, key, blob
+        uint32_t iStoredKeySize = 0;
+        bool bValid = (iFileSize > sizeof(uint32_t));
+        if(bValid)
+        {
+            fread(&iStoredKeySize, sizeof(uint32_t), 1, fp);
+            bValid = (iStoredKeySize == iKeySize && iFileSize > sizeof(uint32_t) + iKeySize);
+        }
+
+        if(bValid)
+        {
+            std::vector<char> acStoredKey(iKeySize);
+            fread(acStoredKey.data(), sizeof(char), iKeySize, fp);
+            bValid = (memcmp(acStoredKey.data(), pKey, iKeySize) == 0);
+        }
+
+        std::vector<char> acValue;
+        if(bValid)
+        {
+            acValue.resize(iFileSize - sizeof(uint32_t) - iKeySize);
+            bValid = (fread(acValue.data(), sizeof(char), acValue.size(), fp) == acValue.size());
+        }
+        fclose(fp);
+
+        if(!bValid)
+        {
+            ++pCache->miNumMisses;
+            return 0;
+        }
+
+        size_t iSize = acValue.size();
+        {
+            std::lock_guard<std::mutex> lock(pCache->mMutex);
+            pCache->maPendingLoads[key] = std::move(acValue);
+        }
+
+        return iSize;
+    }
+
+    /*
+    **
+    */
+    void CPipelineCache::storeData(
+        void const* pKey,
+        size_t iKeySize,
+        void const* pValue,
+        size_t iValueSize,
+        void* pUserData)
+    {
+        CPipelineCache* pCache = (CPipelineCache*)pUserData;
+        std::string filePath = pCache->getFilePath(pKey, iKeySize);
+
+        // written aside and renamed so a crash can't leave a partial blob under the real name
+        std::string tempFilePath = filePath + ".tmp";
+        FILE* fp = fopen(tempFilePath.c_str(), "wb");
+        if(fp == nullptr)
+        {
+            printf("%s : %d can\'t write pipeline cache entry \"%s\"\n",
+                __FILE__,
+                __LINE__,
+                tempFilePath.c_str());
+            return;
+        }
+
+        uint32_t iStoredKeySize = (uint32_t)iKeySize;
+        fwrite(&iStoredKeySize, sizeof(uint32_t), 1, fp);
+        fwrite(pKey, sizeof(char), iKeySize, fp);
+        fwrite(pValue, sizeof(char), iValueSize, fp);
+        fclose(fp);
+
+        std::error_code error;
+        std::filesystem::rename(tempFilePath, filePath, error);
+        if(error)
+        {
+            std::filesystem::remove(tempFilePath, error);
+            return;
+        }
+
+        ++pCache->miNumStores;
+        pCache->miStoredBytes += iValueSize;
+    }
+
+    /*
+    **
+    */
+    std::string CPipelineCache::getFilePath(
+        void const* pKey,
+        size_t iKeySize) const
+    {
+        // fnv-1a
+        uint64_t iHash = 14695981039346656037ull;
+        uint8_t const* piKey = (uint8_t const*)pKey;
+        for(size_t i = 0; i < iKeySize; i++)
+        {
+            iHash ^= piKey[i];
+            iHash *= 1099511628211ull;
+        }
+
+        char szFileName[32];
+        snprintf(szFileName, sizeof(szFileName), "%016llx.bin", (unsigned long long)iHash);
+
+        return mDesc.mDirectory + "/" + szFileName;
+    }
+
+}   // Render
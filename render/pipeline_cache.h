@@ -0,0 +1,88 @@
+#pragma once
+
+#include <webgpu/webgpu_cpp.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace Render
+{
+    /*
+    ** persistent backing for Dawn's blob cache. Dawn builds the keys itself from the adapter, the
+    ** device toggles and features, the shader source and the pipeline descriptor, and asks for the
+    ** compiled blobs through the load/store callbacks. each blob goes in its own file in the cache
+    ** directory named by a hash of its key, with the key kept in the file to catch collisions. the
+    ** browser keeps its own cache on the web so this is desktop only
+    */
+    class CPipelineCache
+    {
+    public:
+        struct CreateDescriptor
+        {
+            std::string     mDirectory = "pipeline-cache";
+            std::string     mAdapterKey;
+        };
+
+        struct Stats
+        {
+            uint32_t        miNumHits = 0;
+            uint32_t        miNumMisses = 0;
+            uint32_t        miNumStores = 0;
+            uint64_t        miLoadedBytes = 0;
+            uint64_t        miStoredBytes = 0;
+        };
+
+    public:
+        CPipelineCache() = default;
+        virtual ~CPipelineCache() = default;
+
+        void setup(CreateDescriptor const& desc);
+
+#if !defined(__EMSCRIPTEN__)
+        // chain into the device descriptor before RequestDevice, the cache has to outlive the device
+        void fillDeviceDescriptor(wgpu::DawnCacheDeviceDescriptor& cacheDesc);
+#endif // !__EMSCRIPTEN__
+
+        Stats getStats() const;
+        void printStats() const;
+
+    protected:
+        static size_t loadData(
+            void const* pKey,
+            size_t iKeySize,
+            void* pValue,
+            size_t iValueSize,
+            void* pUserData);
+
+        static void storeData(
+            void const* pKey,
+            size_t iKeySize,
+            void const* pValue,
+            size_t iValueSize,
+            void* pUserData);
+
+        std::string getFilePath(
+            void const* pKey,
+            size_t iKeySize) const;
+
+    protected:
+        CreateDescriptor                mDesc;
+
+        // Dawn asks for the size first then for the data, blobs read on the first call are kept
+        // by key until the second, pipelines can be compiling on several threads
+        std::mutex                                      mMutex;
+        std::map<std::string, std::vector<char>>        maPendingLoads;
+
+        std::atomic<uint32_t>           miNumHits{0};
+        std::atomic<uint32_t>           miNumMisses{0};
+        std::atomic<uint32_t>           miNumStores{0};
+        std::atomic<uint64_t>           miLoadedBytes{0};
+        std::atomic<uint64_t>           miStoredBytes{0};
+    };
+
+}   // Render
@@ -0,0 +1,171 @@
+#include <render/render_graph.h>
+
+#include <algorithm>
+
+#include <stdio.h>
+
+namespace Render
+{
+    /*
+    **
+    */
+    void CRenderGraph::addJob(std::string const& name)
+    {
+        Node node;
+        node.mName = name;
+        node.miOrder = (uint32_t)maNodes.size();
+        maNodeIndices[name] = node.miOrder;
+        maNodes.push_back(node);
+    }
+
+    /*
+    **
+    */
+    void CRenderGraph::addLink(
+        std::string const& childName,
+        std::string const& parentName)
+    {
+        maLinks.push_back(std::make_pair(childName, parentName));
+    }
+
+    /*
+    **
+    */
+    bool CRenderGraph::validate(std::vector<std::string> const& aExternalParents)
+    {
+        for(auto& node : maNodes)
+        {
+            node.maiParents.clear();
+            node.maiHistoryParents.clear();
+        }
+
+        bool bValid = true;
+        uint32_t iNumLinks = 0, iNumHistoryLinks = 0;
+        for(auto const& link : maLinks)
+        {
+            auto childIter = maNodeIndices.find(link.first);
+            auto parentIter = maNodeIndices.find(link.second);
+            if(parentIter == maNodeIndices.end())
+            {
+                if(std::find(aExternalParents.begin(), aExternalParents.end(), link.second) == aExternalParents.end())
+                {
+                    printf("%s : %d render job \"%s\" reads from unknown job \"%s\"\n",
+                        __FILE__,
+                        __LINE__,
+                        link.first.c_str(),
+                        link.second.c_str());
+                    bValid = false;
+                }
+                continue;
+            }
+            if(childIter == maNodeIndices.end() || childIter->second == parentIter->second)
+            {
+                continue;
+            }
+
+            // a parent at or after the child in the execution order was last written the frame before
+            Node& child = maNodes[childIter->second];
+            std::vector<uint32_t>& aiParents = (parentIter->second < childIter->second) ? child.maiParents : child.maiHistoryParents;
+            if(std::find(aiParents.begin(), aiParents.end(), parentIter->second) == aiParents.end())
+            {
+                aiParents.push_back(parentIter->second);
+                if(parentIter->second < childIter->second)
+                {
+                    ++iNumLinks;
+                }
+                else
+                {
+                    ++iNumHistoryLinks;
+                }
+            }
+        }
+
+        printf("render graph: %d jobs, %d links, %d previous frame links\n",
+            (uint32_t)maNodes.size(),
+            iNumLinks,
+            iNumHistoryLinks);
+
+        return bValid;
+    }
+
+    /*
+    **
+    */
+    void CRenderGraph::setJobEnabled(
+        std::string const& name,
+        bool bEnabled)
+    {
+        auto iter = maNodeIndices.find(name);
+        if(iter != maNodeIndices.end())
+        {
+            maNodes[iter->second].mbEnabled = bEnabled;
+        }
+    }
+
+    /*
+    **
+    */
+    std::vector<std::string> CRenderGraph::compile(std::string const& outputJobName) const
+    {
+        std::vector<std::string> aRet;
+        auto outputIter = maNodeIndices.find(outputJobName);
+        if(outputIter == maNodeIndices.end())
+        {
+            printf("%s : %d output render job \"%s\" doesn\'t exist, nothing culled\n",
+                __FILE__,
+                __LINE__,
+                outputJobName.c_str());
+            for(auto const& node : maNodes)
+            {
+                aRet.push_back(node.mName);
+            }
+
+            return aRet;
+        }
+
+        // a job feeding last frame's result forward has to run this frame for the next one
+        std::vector<bool> abLive(maNodes.size(), false);
+        std::vector<uint32_t> aiStack = {outputIter->second};
+        abLive[outputIter->second] = true;
+        while(!aiStack.empty())
+        {
+            uint32_t iNode = aiStack.back();
+            aiStack.pop_back();
+
+            for(auto const* paiParents : {&maNodes[iNode].maiParents, &maNodes[iNode].maiHistoryParents})
+            {
+                for(uint32_t iParent : *paiParents)
+                {
+                    if(!abLive[iParent] && maNodes[iParent].mbEnabled)
+                    {
+                        abLive[iParent] = true;
+                        aiStack.push_back(iParent);
+                    }
+                }
+            }
+        }
+
+        for(uint32_t iNode = 0; iNode < (uint32_t)maNodes.size(); iNode++)
+        {
+            if(abLive[iNode])
+            {
+                aRet.push_back(maNodes[iNode].mName);
+            }
+            else if(!maNodes[iNode].mbEnabled)
+            {
+                printf("render graph: \"%s\" is turned off\n", maNodes[iNode].mName.c_str());
+            }
+            else
+            {
+                printf("render graph: culled \"%s\"\n", maNodes[iNode].mName.c_str());
+            }
+        }
+        printf("render graph: %d of %d jobs run for \"%s\"\n",
+            (uint32_t)aRet.size(),
+            (uint32_t)maNodes.size(),
+            outputJobName.c_str());
+
+        return aRet;
+    }
+
+}   // Render
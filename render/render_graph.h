@@ -0,0 +1,60 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace Render
+{
+    /*
+    ** dependencies between render jobs from their attachments' ParentJobName links, the jobs run in
+    ** render-jobs.json order so a link to a job listed later reads what that job wrote last frame.
+    ** compile() keeps the jobs the requested output depends on through links of either kind and culls
+    ** the rest
+    */
+    class CRenderGraph
+    {
+    public:
+        struct Node
+        {
+            std::string                 mName;
+            uint32_t                    miOrder = 0;
+            std::vector<uint32_t>       maiParents;
+            std::vector<uint32_t>       maiHistoryParents;
+            bool                        mbEnabled = true;
+        };
+
+    public:
+        CRenderGraph() = default;
+        virtual ~CRenderGraph() = default;
+
+        // in execution order
+        void addJob(std::string const& name);
+
+        // child reads parent's output, parents that aren't jobs are ignored
+        void addLink(
+            std::string const& childName,
+            std::string const& parentName);
+
+        // sorts the links into same frame and previous frame ones, false if a link names a job that
+        // doesn't exist
+        bool validate(std::vector<std::string> const& aExternalParents);
+
+        // a disabled job is culled along with the parents only it needs, jobs reading its outputs
+        // still run and see whatever the output last held
+        void setJobEnabled(
+            std::string const& name,
+            bool bEnabled);
+
+        // jobs the output job needs, in execution order
+        std::vector<std::string> compile(std::string const& outputJobName) const;
+
+    protected:
+        std::vector<Node>                                           maNodes;
+        std::map<std::string, uint32_t>                             maNodeIndices;
+        std::vector<std::pair<std::string, std::string>>            maLinks;
+    };
+
+}   // Render
@@ -3,6 +3,7 @@
 #include <loader/loader.h>
 #include <utils/LogPrint.h>
 
+#include <algorithm>
 #include <sstream>
 
 namespace Render
@@ -46,6 +47,7 @@ namespace Render
 
         std::vector< wgpu::ColorTargetState> aTargetStates;
         uint32_t iNumOutputAttachments = 0;
+        uint32_t iBytesPerPixel = 0;
         auto const& attachments = doc["Attachments"].GetArray();
         for(auto const& attachment : attachments)
         {
@@ -54,23 +56,61 @@ namespace Render
             
             std::vector<wgpu::TextureFormat> aViewFormats;
             wgpu::ColorTargetState colorTargetState = {};
-            if(attachmentType == "TextureOutput")
+
+            // parent texture read by this job, copy jobs name the texture they copy from on their outputs
+            if(attachment.HasMember("ParentJobName") && attachmentType != "BufferInput" && attachmentType != "BufferInputOutput")
             {
-                std::string attachmentFormat = attachment["Format"].GetString();
+                std::string parentName = attachmentName;
+                if(attachment.HasMember("ParentName"))
+                {
+                    parentName = attachment["ParentName"].GetString();
+                }
+                maInputTextureLinks.push_back(std::make_pair(std::string(attachment["ParentJobName"].GetString()), parentName));
+            }
 
-                wgpu::TextureFormat format = wgpu::TextureFormat::RGBA32Float;
-                if(attachmentFormat == "rgba16float")
+            if(attachmentType == "TextureOutput")
+            {
+                std::string attachmentFormat = "";
+                if(attachment.HasMember("Format"))
                 {
-                    format = wgpu::TextureFormat::RGBA16Float;
+                    attachmentFormat = attachment["Format"].GetString();
                 }
-                else if(attachmentFormat == "rg16float")
+
+                std::string attachmentSemantic = "";
+                if(attachment.HasMember("Semantic"))
                 {
-                    format = wgpu::TextureFormat::RG16Float;
+                    attachmentSemantic = attachment["Semantic"].GetString();
                 }
-                else if(attachmentFormat == "r32float")
+
+                wgpu::TextureFormat format = FormatPolicy::resolve(attachmentSemantic, attachmentFormat, createInfo.mFormatSettings);
+
+                // texture to texture copies need matching formats, take whatever the parent ended up with
+                if(mType == Render::JobType::Copy && attachment.HasMember("ParentJobName"))
                 {
-                    format = wgpu::TextureFormat::R32Float;
+                    std::string parentJobName = attachment["ParentJobName"].GetString();
+                    std::string parentAttachmentName = attachmentName;
+                    if(attachment.HasMember("ParentName"))
+                    {
+                        parentAttachmentName = attachment["ParentName"].GetString();
+                    }
+
+                    for(auto const* pRenderJob : *createInfo.mpaRenderJobs)
+                    {
+                        if(pRenderJob->mName != parentJobName)
+                        {
+                            continue;
+                        }
+
+                        auto parentIter = pRenderJob->mOutputImageAttachments.find(parentAttachmentName);
+                        if(parentIter != pRenderJob->mOutputImageAttachments.end())
+                        {
+                            format = parentIter->second.GetFormat();
+                        }
+                        break;
+                    }
                 }
+                attachmentFormat = FormatPolicy::getFormatName(format);
+                iBytesPerPixel += FormatPolicy::getBytesPerPixel(format);
                 aViewFormats.push_back(format);
 
                 float fScaleX = 1.0f, fScaleY = 1.0f;
@@ -97,8 +137,11 @@ namespace Render
                 textureDescriptor.viewFormats = aViewFormats.data();
                 textureDescriptor.usage = wgpu::TextureUsage::RenderAttachment | 
                     wgpu::TextureUsage::TextureBinding | 
-                    wgpu::TextureUsage::CopySrc |
-                    wgpu::TextureUsage::StorageBinding;
+                    wgpu::TextureUsage::CopySrc;
+                if(FormatPolicy::supportsStorage(format))
+                {
+                    textureDescriptor.usage |= wgpu::TextureUsage::StorageBinding;
+                }
                 textureDescriptor.viewFormatCount = 1;
 
                 if(mType == Render::JobType::Copy)
@@ -110,6 +153,15 @@ namespace Render
 
                 mOutputImageAttachments[attachmentName].SetLabel(std::string(mName + "-" + attachmentName).c_str());
 
+                // ping-pong with a second texture, readers of the history name get the other one
+                if(attachment.HasMember("History"))
+                {
+                    std::string historyName = attachment["History"].GetString();
+                    mHistoryImageAttachments[historyName] = createInfo.mpDevice->CreateTexture(&textureDescriptor);
+                    mHistoryImageAttachments[historyName].SetLabel(std::string(mName + "-" + historyName).c_str());
+                    maHistoryNames[attachmentName] = historyName;
+                }
+
                 // save format
                 wgpu::ColorTargetState targetState = {};
                 targetState.format = format;
@@ -135,7 +187,17 @@ namespace Render
             else if(attachmentType == "BufferOutput")
             {
                 std::string usage = "";
-                uint32_t iSize = attachment["Size"].GetUint();
+                uint32_t iSize = 0;
+                if(attachment.HasMember("SizeOf"))
+                {
+                    // as big as one of the renderer's buffers, sizes of the mesh data aren't known up front
+                    createInfo.mpfnGetBuffer(iSize, attachment["SizeOf"].GetString(), createInfo.mpUserData);
+                }
+                else
+                {
+                    iSize = attachment["Size"].GetUint();
+                }
+
                 if(attachment.HasMember("Usage"))
                 {
                     usage = attachment["Usage"].GetString();
@@ -148,6 +210,10 @@ namespace Render
                 {
                     bufferDesc.usage |= wgpu::BufferUsage::Indirect;
                 }
+                else if(usage == "Index")
+                {
+                    bufferDesc.usage |= wgpu::BufferUsage::Index;
+                }
 
                 mOutputBufferAttachments[attachmentName] = createInfo.mpDevice->CreateBuffer(&bufferDesc);
                 mAttachmentOrder.push_back(std::make_pair(attachmentName, std::make_pair(attachmentType, "r32float")));
@@ -155,14 +221,27 @@ namespace Render
             }
             else if(attachmentType == "TextureInput")
             {
+                // mesh passes use the parent's depth as their depth attachment, it isn't bound
+                if(attachmentName == "Depth Output" && isMeshPass(mPassType))
+                {
+                    continue;
+                }
+
                 mAttachmentOrder.push_back(std::make_pair(attachmentName, std::make_pair(attachmentType, "parentFormat")));
             }
-            else if(attachmentType == "BufferInput")
+            else if(attachmentType == "BufferInput" || attachmentType == "BufferInputOutput")
             {
                 mAttachmentOrder.push_back(std::make_pair(attachmentName, std::make_pair(attachmentType, "parentFormat")));
             }
         }
 
+        if(iBytesPerPixel > 0)
+        {
+            printf("render job \"%s\" output attachments: %d bytes per pixel\n",
+                mName.c_str(),
+                iBytesPerPixel);
+        }
+
         if(mType == Render::JobType::Copy)
         {
             return;
@@ -218,6 +297,9 @@ namespace Render
                     {
                         uint32_t iBufferSize = 0;
                         mUniformBuffers[uniformInfo["name"]] = createInfo.mpfnGetBuffer(iBufferSize, uniformInfo["name"], createInfo.mpUserData);
+
+                        bool bWrite = (uniformInfo["usage"] == "read_write_storage" || uniformInfo["usage"] == "write_only_storage");
+                        (bWrite ? maExternalWrites : maExternalReads).push_back(uniformInfo["name"]);
                     }
                 }
                 else if(uniformInfo["type"] == "texture")
@@ -227,6 +309,9 @@ namespace Render
                     if(shaderResource.HasMember("external"))
                     {
                         mUniformTextures[uniformInfo["name"]] = createInfo.mpfnGetTexture(uniformInfo["name"], createInfo.mpUserData);
+
+                        bool bWrite = (uniformInfo["usage"] == "read_write_storage" || uniformInfo["usage"] == "write_only_storage");
+                        (bWrite ? maExternalWrites : maExternalReads).push_back(uniformInfo["name"]);
                     }
                 }
 
@@ -336,6 +421,86 @@ namespace Render
         }
     }
 
+    /*
+    **
+    */
+    void CRenderJob::aliasOutputAttachment(
+        std::string const& attachmentName,
+        wgpu::Texture const& texture)
+    {
+        // color attachments are in the order of the texture outputs
+        uint32_t iColorAttachment = 0;
+        for(auto const& attachmentInfo : mAttachmentOrder)
+        {
+            if(attachmentInfo.second.first != "TextureOutput")
+            {
+                continue;
+            }
+
+            if(attachmentInfo.first == attachmentName)
+            {
+                break;
+            }
+            ++iColorAttachment;
+        }
+        assert(iColorAttachment < (uint32_t)maOutputAttachments.size());
+
+        mOutputImageAttachments[attachmentName].Destroy();
+        mOutputImageAttachments[attachmentName] = texture;
+
+        wgpu::TextureViewDescriptor viewDesc = {};
+        viewDesc.format = mOutputImageFormats[iColorAttachment];
+        viewDesc.dimension = wgpu::TextureViewDimension::e2D;
+        viewDesc.mipLevelCount = 1;
+        viewDesc.arrayLayerCount = 1;
+        maOutputAttachments[iColorAttachment].view = texture.CreateView(&viewDesc);
+    }
+
+    /*
+    **
+    */
+    wgpu::Texture* CRenderJob::getOutputTexture(
+        std::string const& attachmentName,
+        uint32_t iFrame)
+    {
+        bool bOddFrame = ((iFrame & 1) == 1);
+
+        auto historyIter = mHistoryImageAttachments.find(attachmentName);
+        if(historyIter != mHistoryImageAttachments.end())
+        {
+            for(auto const& keyValue : maHistoryNames)
+            {
+                if(keyValue.second == attachmentName)
+                {
+                    return bOddFrame ? &mOutputImageAttachments[keyValue.first] : &historyIter->second;
+                }
+            }
+        }
+
+        auto outputIter = mOutputImageAttachments.find(attachmentName);
+        if(outputIter == mOutputImageAttachments.end())
+        {
+            return nullptr;
+        }
+
+        auto historyNameIter = maHistoryNames.find(attachmentName);
+        if(bOddFrame && historyNameIter != maHistoryNames.end())
+        {
+            return &mHistoryImageAttachments[historyNameIter->second];
+        }
+
+        return &outputIter->second;
+    }
+
+    /*
+    **
+    */
+    bool CRenderJob::isPingPong(std::string const& attachmentName) const
+    {
+        return (maHistoryNames.find(attachmentName) != maHistoryNames.end() ||
+                mHistoryImageAttachments.find(attachmentName) != mHistoryImageAttachments.end());
+    }
+
     /*
     **
     */
@@ -381,6 +546,7 @@ namespace Render
             {
                 std::string parentJobName = attachment["ParentJobName"].GetString();
                 std::string parentName = attachment["ParentName"].GetString();
+                maParentJobNames.push_back(parentJobName);
 
                 // get parent render job
                 auto iter = std::find_if(
@@ -399,6 +565,9 @@ namespace Render
                 mInputImageAttachments[attachmentName] = &parentOutputAttachment->second;
             }
         }
+
+        // no pipeline to wait for
+        mPipelineState = PipelineState::Ready;
     }
 
     /*
@@ -444,13 +613,17 @@ namespace Render
         // shader code
         wgpu::ShaderModuleWGSLDescriptor wgslDesc = {};
         std::string shaderPath = std::string("shaders/") + doc["Shader"].GetString();
-#if defined(__EMSCRIPTEN__)
+#if defined(__EMSCRIPTEN__) || !defined(_MSC_VER)
+        // builds without multi-draw record the mesh passes into render bundles, reading one draw
+        // call per mesh
         if(doc.HasMember("Emscripten Shader"))
         {
             shaderPath = std::string("shaders/") + doc["Emscripten Shader"].GetString();
             printf("!!! USE EMSCRIPTEN SHADER !!!\n");
         }
+#endif // __EMSCRIPTEN__
 
+#if defined(__EMSCRIPTEN__)
         char* acShaderFileContent = nullptr;
         Loader::loadFile(
             &acShaderFileContent,
@@ -485,33 +658,12 @@ namespace Render
         // fill out input attachments 
         std::vector< wgpu::ColorTargetState> aTargetStates;
         uint32_t iNumOutputAttachments = 0;
+        uint32_t iJobOrder = (uint32_t)(std::find(createInfo.mpaRenderJobs->begin(), createInfo.mpaRenderJobs->end(), this) - createInfo.mpaRenderJobs->begin());
         auto const& attachments = doc["Attachments"].GetArray();
         for(auto const& attachment : attachments)
         {
             std::string attachmentType = attachment["Type"].GetString();
             
-            if(mType == Render::JobType::Graphics)
-            {
-                std::string attachmentFormat = ""; 
-                if(attachment.HasMember("Format"))
-                {
-                    attachmentFormat = attachment["Format"].GetString();
-                }
-
-                wgpu::TextureFormat format = wgpu::TextureFormat::RGBA32Float;
-                if(attachmentFormat == "rgba16float")
-                {
-                    format = wgpu::TextureFormat::RGBA16Float;
-                }
-                else if(attachmentFormat == "rg16float")
-                {
-                    format = wgpu::TextureFormat::RG16Float;
-                }
-
-                std::vector<wgpu::TextureFormat> aViewFormats;
-                aViewFormats.push_back(format);
-            }
-
             std::vector<CRenderJob*>& aRenderJobs = *createInfo.mpaRenderJobs;
 
             // parent render job output attachment to this render job input attachment
@@ -526,20 +678,29 @@ namespace Render
                 }
 
                 std::string attachmentParentJobName = attachment["ParentJobName"].GetString();
+                maParentJobNames.push_back(attachmentParentJobName);
 
                 bool bFound = false;
-                for(auto const& renderJob : aRenderJobs)
+                for(uint32_t iParentOrder = 0; iParentOrder < (uint32_t)aRenderJobs.size(); iParentOrder++)
                 {
+                    CRenderJob* renderJob = aRenderJobs[iParentOrder];
                     if(attachmentParentJobName == renderJob->mName)
                     {
                         bFound = true;
-                        if(renderJob->mOutputImageAttachments.find(parentAttachmentName) != renderJob->mOutputImageAttachments.end())
+                        if(renderJob->getOutputTexture(parentAttachmentName, 0) != nullptr)
                         {
-                            if(attachmentName == "Depth Output" && mPassType == PassType::DrawMeshes)
+                            if(attachmentName == "Depth Output" && isMeshPass(mPassType))
                             {
                                 mDepthStencilTexture = renderJob->mDepthStencilTexture;
                                 mDepthStencilAttachment = renderJob->mDepthStencilAttachment;
                             }
+                            else if(renderJob->isPingPong(parentAttachmentName))
+                            {
+                                // a ping-pong output read before its job runs still holds last frame's, that's the other texture
+                                uint32_t iLag = (iParentOrder > iJobOrder && renderJob->maHistoryNames.count(parentAttachmentName) > 0) ? 1 : 0;
+                                mInputImageAttachments[attachmentName] = renderJob->getOutputTexture(parentAttachmentName, iLag);
+                                mOddFrameInputImageAttachments[attachmentName] = renderJob->getOutputTexture(parentAttachmentName, iLag + 1);
+                            }
                             else
                             {
                                 mInputImageAttachments[attachmentName] = &renderJob->mOutputImageAttachments[parentAttachmentName];
@@ -574,6 +735,7 @@ namespace Render
                 }
 
                 std::string attachmentParentJobName = attachment["ParentJobName"].GetString();
+                maParentJobNames.push_back(attachmentParentJobName);
 
                 bool bFound = false;
                 for(auto const& renderJob : aRenderJobs)
@@ -587,6 +749,13 @@ namespace Render
                             
                             break;
                         }
+                        else if(renderJob->mInputBufferAttachments.find(parentAttachmentName) != renderJob->mInputBufferAttachments.end())
+                        {
+                            // the parent updates its own parent's buffer in place, read the same buffer
+                            mInputBufferAttachments[attachmentName] = renderJob->mInputBufferAttachments[parentAttachmentName];
+
+                            break;
+                        }
                         else
                         {
                             assert(!"Can\'t find input attachment");
@@ -659,8 +828,14 @@ namespace Render
             attrib.shaderLocation = 2;
             aVertexAttributes.push_back(attrib);
 
+            // depth prepasses only read the positions, the other attributes stay in the stride
+            if(mPassType == PassType::DepthPrepass)
+            {
+                aVertexAttributes.resize(1);
+            }
+
             // vertex layout
-            vertexBufferLayout.attributeCount = 3;
+            vertexBufferLayout.attributeCount = (uint32_t)aVertexAttributes.size();
             vertexBufferLayout.arrayStride = sizeof(float4) * 3;
             vertexBufferLayout.attributes = aVertexAttributes.data();
             vertexBufferLayout.stepMode = wgpu::VertexStepMode::Vertex;
@@ -686,6 +861,10 @@ namespace Render
         
         std::vector<std::vector<wgpu::BindGroupEntry>> aaBindingGroupEntries(2);
 
+        // group 0 again with the ping-pong textures swapped, only made if the job touches any
+        std::vector<wgpu::BindGroupEntry> aOddFrameBindGroupEntries;
+        bool bPingPong = false;
+
         DEBUG_PRINTF("Render Job: \"%s\"\n", mName.c_str());
 
         // in/out attachments in group 0
@@ -705,12 +884,13 @@ namespace Render
 
             wgpu::BindGroupEntry bindGroupEntry = {};
             wgpu::BindGroupLayoutEntry bindingLayout = {};
+            wgpu::TextureView oddFrameTextureView = nullptr;
             bindingLayout.binding = iIndex;
             bindGroupEntry.binding = iIndex;
             if(attachmentType == "TextureInput")
             {
                 bindingLayout.texture.multisampled = false;
-                bindingLayout.texture.sampleType = wgpu::TextureSampleType::UnfilterableFloat;
+                bindingLayout.texture.sampleType = FormatPolicy::getSampleType(mInputImageAttachments[attachmentName]->GetFormat());
                 bindingLayout.texture.viewDimension = wgpu::TextureViewDimension::e2D;
                 bindingLayout.visibility = wgpu::ShaderStage::Fragment;
                 if(mType == Render::JobType::Compute)
@@ -720,6 +900,12 @@ namespace Render
 
                 wgpu::TextureView textureView = mInputImageAttachments[attachmentName]->CreateView();
                 bindGroupEntry.textureView = textureView;
+
+                if(mOddFrameInputImageAttachments.find(attachmentName) != mOddFrameInputImageAttachments.end())
+                {
+                    oddFrameTextureView = mOddFrameInputImageAttachments[attachmentName]->CreateView();
+                    bPingPong = true;
+                }
                 
                 DEBUG_PRINTF("\tgroup 0 binding %d read texture \"%s\"\n",
                     (uint32_t)aaBindGroupLayoutEntries[0].size(),
@@ -734,6 +920,12 @@ namespace Render
                 wgpu::TextureView textureView = mOutputImageAttachments[attachmentName].CreateView();
                 bindGroupEntry.textureView = textureView;
 
+                if(maHistoryNames.find(attachmentName) != maHistoryNames.end())
+                {
+                    oddFrameTextureView = getOutputTexture(attachmentName, 1)->CreateView();
+                    bPingPong = true;
+                }
+
                 DEBUG_PRINTF("\tgroup 0 binding %d write texture \"%s\"\n",
                     (uint32_t)aaBindGroupLayoutEntries[0].size(),
                     attachmentName.c_str());
@@ -753,6 +945,21 @@ namespace Render
                     (uint32_t)aaBindGroupLayoutEntries[0].size(),
                     attachmentName.c_str());
             }
+            else if(attachmentType == "BufferInputOutput")
+            {
+                bindingLayout.buffer.type = wgpu::BufferBindingType::Storage;
+                bindingLayout.buffer.minBindingSize = 0;
+                bindingLayout.visibility = wgpu::ShaderStage::Vertex | wgpu::ShaderStage::Fragment;
+                if(mType == Render::JobType::Compute)
+                {
+                    bindingLayout.visibility = wgpu::ShaderStage::Compute;
+                }
+                bindGroupEntry.buffer = *mInputBufferAttachments[attachmentName];
+
+                DEBUG_PRINTF("\tgroup 0 binding %d read write buffer \"%s\"\n",
+                    (uint32_t)aaBindGroupLayoutEntries[0].size(),
+                    attachmentName.c_str());
+            }
             else if(attachmentType == "BufferOutput")
             {
                 bindingLayout.buffer.type = wgpu::BufferBindingType::Storage;
@@ -772,8 +979,15 @@ namespace Render
             
             ++iIndex;
 
+            wgpu::BindGroupEntry oddFrameBindGroupEntry = bindGroupEntry;
+            if(oddFrameTextureView)
+            {
+                oddFrameBindGroupEntry.textureView = oddFrameTextureView;
+            }
+
             aaBindGroupLayoutEntries[0].push_back(bindingLayout);
             aaBindingGroupEntries[0].push_back(bindGroupEntry);
+            aOddFrameBindGroupEntries.push_back(oddFrameBindGroupEntry);
         }
 
         // shader resouces in group 1
@@ -809,7 +1023,19 @@ namespace Render
                     }
                 }
 
-                bindGroupEntry.textureView = mUniformTextures[uniformName].CreateView();
+                // the default view of a single layer texture is 2d, array textures ask for the array view
+                if(uniformUsage == "texture_array")
+                {
+                    bindingLayout.texture.viewDimension = wgpu::TextureViewDimension::e2DArray;
+
+                    wgpu::TextureViewDescriptor viewDesc = {};
+                    viewDesc.dimension = wgpu::TextureViewDimension::e2DArray;
+                    bindGroupEntry.textureView = mUniformTextures[uniformName].CreateView(&viewDesc);
+                }
+                else
+                {
+                    bindGroupEntry.textureView = mUniformTextures[uniformName].CreateView();
+                }
                 
                 DEBUG_PRINTF("\tgroup 1 binding %d texture \"%s\"\n",
                     (uint32_t)aaBindGroupLayoutEntries[1].size(),
@@ -937,6 +1163,45 @@ namespace Render
             maBindGroups[iGroup].SetLabel(oss.str().c_str());
         }
 
+        // odd frames bind the other half of each ping-pong pair, group 1 doesn't change
+        if(bPingPong)
+        {
+            wgpu::BindGroupDescriptor groupDesc = {};
+            groupDesc.layout = aBindGroupLayout[0];
+            groupDesc.entries = aOddFrameBindGroupEntries.data();
+            groupDesc.entryCount = (uint32_t)aOddFrameBindGroupEntries.size();
+
+            maOddFrameBindGroups = {createInfo.mpDevice->CreateBindGroup(&groupDesc), maBindGroups[1]};
+            maOddFrameBindGroups[0].SetLabel(std::string(mName + " Odd Frame Bind Group 0").c_str());
+        }
+
+        // odd frames render to the other texture of each ping-pong output, made here to pick up any
+        // aliased views
+        if(!maHistoryNames.empty())
+        {
+            maOddFrameOutputAttachments = maOutputAttachments;
+
+            uint32_t iColorAttachment = 0;
+            for(auto const& attachmentInfo : mAttachmentOrder)
+            {
+                if(attachmentInfo.second.first != "TextureOutput")
+                {
+                    continue;
+                }
+
+                if(maHistoryNames.find(attachmentInfo.first) != maHistoryNames.end())
+                {
+                    wgpu::TextureViewDescriptor viewDesc = {};
+                    viewDesc.format = mOutputImageFormats[iColorAttachment];
+                    viewDesc.dimension = wgpu::TextureViewDimension::e2D;
+                    viewDesc.mipLevelCount = 1;
+                    viewDesc.arrayLayerCount = 1;
+                    maOddFrameOutputAttachments[iColorAttachment].view = getOutputTexture(attachmentInfo.first, 1)->CreateView(&viewDesc);
+                }
+                ++iColorAttachment;
+            }
+        }
+
         // pipeline layout
         wgpu::PipelineLayoutDescriptor layoutDesc = {};
         layoutDesc.bindGroupLayoutCount = (uint32_t)aBindGroupLayout.size();
@@ -958,8 +1223,7 @@ namespace Render
             pipelineDescriptor.depthStencil = &mDepthStencilState;
             pipelineDescriptor.layout = pipelineLayout;
             mDepthStencilState.format = wgpu::TextureFormat::Depth32Float;
-            mRenderPipeline = createInfo.mpDevice->CreateRenderPipeline(&pipelineDescriptor);
-            mRenderPipeline.SetLabel(pipelineDescriptor.label);
+            createRenderPipelineAsync(createInfo, pipelineDescriptor);
 
             // depth texture
             if(mDepthStencilTexture == nullptr)
@@ -970,8 +1234,14 @@ namespace Render
                 depthStencilDesc.usage = wgpu::TextureUsage::RenderAttachment | wgpu::TextureUsage::TextureBinding;
                 depthStencilDesc.format = wgpu::TextureFormat::Depth32Float;
                 depthStencilDesc.viewFormats = &mDepthStencilViewFormat;
-                depthStencilDesc.size.width = mOutputImageAttachments.begin()->second.GetWidth();
-                depthStencilDesc.size.height = mOutputImageAttachments.begin()->second.GetHeight();
+                // depth only jobs have no outputs to match, they're screen sized
+                depthStencilDesc.size.width = createInfo.miScreenWidth;
+                depthStencilDesc.size.height = createInfo.miScreenHeight;
+                if(mOutputImageAttachments.size() > 0)
+                {
+                    depthStencilDesc.size.width = mOutputImageAttachments.begin()->second.GetWidth();
+                    depthStencilDesc.size.height = mOutputImageAttachments.begin()->second.GetHeight();
+                }
                 depthStencilDesc.size.depthOrArrayLayers = 1;
                 mDepthStencilTexture = createInfo.mpDevice->CreateTexture(&depthStencilDesc);
                 mOutputImageAttachments["Depth Output"] = mDepthStencilTexture;
@@ -992,6 +1262,9 @@ namespace Render
                 mDepthStencilAttachment.depthClearValue = 1.0f;
                 mDepthStencilAttachment.depthStoreOp = wgpu::StoreOp::Store;
                 mDepthStencilAttachment.depthLoadOp = wgpu::LoadOp::Load;
+
+                // the shared depth reads as this job's too
+                mOutputImageAttachments["Depth Output"] = mDepthStencilTexture;
             }
             
             // render pass descriptor
@@ -999,7 +1272,7 @@ namespace Render
             mRenderPassDesc.colorAttachments = maOutputAttachments.data();
             mRenderPassDesc.depthStencilAttachment = &mDepthStencilAttachment;
 
-            printf("create pipeline: \"%s\"\n", pipelineName.c_str());
+            printf("issued pipeline: \"%s\"\n", pipelineName.c_str());
         }
         else if(mType == JobType::Compute)
         {
@@ -1017,14 +1290,14 @@ namespace Render
             computeDesc.constantCount = 0;
 #endif // __EMSCRIPTEN__
 
+            std::string pipelineName = mName + " Compute Pipeline";
             wgpu::ComputePipelineDescriptor pipelineDescriptor = {};
+            pipelineDescriptor.label = pipelineName.c_str();
             pipelineDescriptor.compute = computeDesc;
             pipelineDescriptor.layout = pipelineLayout;
-            mComputePipeline = createInfo.mpDevice->CreateComputePipeline(&pipelineDescriptor);
-            std::string pipelineName = mName + " Compute Pipeline";
-            mComputePipeline.SetLabel(pipelineName.c_str());
+            createComputePipelineAsync(createInfo, pipelineDescriptor);
             
-            printf("create pipeline: \"%s\"\n", pipelineName.c_str());
+            printf("issued pipeline: \"%s\"\n", pipelineName.c_str());
         }
         else
         {
@@ -1032,4 +1305,151 @@ namespace Render
         }
     }
 
+    /*
+    **
+    */
+    void CRenderJob::createRenderPipelineAsync(
+        CreateInfo& createInfo,
+        wgpu::RenderPipelineDescriptor const& pipelineDescriptor)
+    {
+        beginPipelineCreate(createInfo);
+
+#if defined(__EMSCRIPTEN__)
+        createInfo.mpDevice->CreateRenderPipelineAsync(
+            &pipelineDescriptor,
+            [](WGPUCreatePipelineAsyncStatus status,
+                WGPURenderPipeline cPipeline,
+                char const* message,
+                void* pUserData)
+            {
+                CRenderJob* pRenderJob = (CRenderJob*)pUserData;
+                if(status != WGPUCreatePipelineAsyncStatus_Success)
+                {
+                    printf("!!! error %d creating pipeline for \"%s\" -- message: \"%s\"\n",
+                        (uint32_t)status,
+                        pRenderJob->mName.c_str(),
+                        message);
+                    pRenderJob->mPipelineState = PipelineState::Failed;
+                    return;
+                }
+
+                pRenderJob->mRenderPipeline = wgpu::RenderPipeline::Acquire(cPipeline);
+                pRenderJob->onPipelineCreated();
+            },
+            this);
+#else
+        // picked up by the instance's ProcessEvents() in the frame loop
+        createInfo.mpDevice->CreateRenderPipelineAsync(
+            &pipelineDescriptor,
+            wgpu::CallbackMode::AllowProcessEvents,
+            [this](wgpu::CreatePipelineAsyncStatus status,
+                wgpu::RenderPipeline pipeline,
+                wgpu::StringView message)
+            {
+                if(status != wgpu::CreatePipelineAsyncStatus::Success)
+                {
+                    printf("!!! error %d creating pipeline for \"%s\" -- message: \"%s\"\n",
+                        (uint32_t)status,
+                        mName.c_str(),
+                        message.data);
+                    mPipelineState = PipelineState::Failed;
+                    return;
+                }
+
+                mRenderPipeline = std::move(pipeline);
+                onPipelineCreated();
+            });
+#endif // __EMSCRIPTEN__
+    }
+
+    /*
+    **
+    */
+    void CRenderJob::createComputePipelineAsync(
+        CreateInfo& createInfo,
+        wgpu::ComputePipelineDescriptor const& pipelineDescriptor)
+    {
+        beginPipelineCreate(createInfo);
+
+#if defined(__EMSCRIPTEN__)
+        createInfo.mpDevice->CreateComputePipelineAsync(
+            &pipelineDescriptor,
+            [](WGPUCreatePipelineAsyncStatus status,
+                WGPUComputePipeline cPipeline,
+                char const* message,
+                void* pUserData)
+            {
+                CRenderJob* pRenderJob = (CRenderJob*)pUserData;
+                if(status != WGPUCreatePipelineAsyncStatus_Success)
+                {
+                    printf("!!! error %d creating pipeline for \"%s\" -- message: \"%s\"\n",
+                        (uint32_t)status,
+                        pRenderJob->mName.c_str(),
+                        message);
+                    pRenderJob->mPipelineState = PipelineState::Failed;
+                    return;
+                }
+
+                pRenderJob->mComputePipeline = wgpu::ComputePipeline::Acquire(cPipeline);
+                pRenderJob->onPipelineCreated();
+            },
+            this);
+#else
+        createInfo.mpDevice->CreateComputePipelineAsync(
+            &pipelineDescriptor,
+            wgpu::CallbackMode::AllowProcessEvents,
+            [this](wgpu::CreatePipelineAsyncStatus status,
+                wgpu::ComputePipeline pipeline,
+                wgpu::StringView message)
+            {
+                if(status != wgpu::CreatePipelineAsyncStatus::Success)
+                {
+                    printf("!!! error %d creating pipeline for \"%s\" -- message: \"%s\"\n",
+                        (uint32_t)status,
+                        mName.c_str(),
+                        message.data);
+                    mPipelineState = PipelineState::Failed;
+                    return;
+                }
+
+                mComputePipeline = std::move(pipeline);
+                onPipelineCreated();
+            });
+#endif // __EMSCRIPTEN__
+    }
+
+    /*
+    **
+    */
+    void CRenderJob::beginPipelineCreate(CreateInfo& createInfo)
+    {
+        mPipelineIssueTime = std::chrono::high_resolution_clock::now();
+
+        mpfnGetPipelineCacheCounts = createInfo.mpfnGetPipelineCacheCounts;
+        mpPipelineCacheUserData = createInfo.mpUserData;
+        if(mpfnGetPipelineCacheCounts != nullptr)
+        {
+            mpfnGetPipelineCacheCounts(miPipelineCacheHits, miPipelineCacheMisses, mpPipelineCacheUserData);
+        }
+    }
+
+    /*
+    **
+    */
+    void CRenderJob::onPipelineCreated()
+    {
+        mfPipelineCreateTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - mPipelineIssueTime).count();
+
+        // counts at issue to the ones since
+        if(mpfnGetPipelineCacheCounts != nullptr)
+        {
+            uint32_t iNumHits = 0, iNumMisses = 0;
+            mpfnGetPipelineCacheCounts(iNumHits, iNumMisses, mpPipelineCacheUserData);
+            miPipelineCacheHits = iNumHits - miPipelineCacheHits;
+            miPipelineCacheMisses = iNumMisses - miPipelineCacheMisses;
+        }
+
+        mPipelineState = PipelineState::Ready;
+    }
+
 }   // Render
\ No newline at end of file
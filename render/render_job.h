@@ -3,7 +3,9 @@
 #include <webgpu/webgpu_cpp.h>
 #include <math/vec.h>
 #include <render/render_utils.h>
+#include <render/format_policy.h>
 
+#include <chrono>
 #include <map>
 #include <string>
 
@@ -25,6 +27,8 @@ namespace Render
 
 			std::vector<CRenderJob*>*							mpaRenderJobs;
 
+			FormatPolicy::Settings								mFormatSettings;
+
 			wgpu::Buffer* mpDefaultUniformBuffer;
 			uint3												mDispatchSize;
 
@@ -38,6 +42,7 @@ namespace Render
 
 			wgpu::Buffer(*mpfnGetBuffer)(uint32_t& iBufferSize, std::string const& bufferName, void* pUserData);
 			wgpu::Texture(*mpfnGetTexture)(std::string const& textureName, void* pUserData);
+			void(*mpfnGetPipelineCacheCounts)(uint32_t& iNumHits, uint32_t& iNumMisses, void* pUserData) = nullptr;
 			void* mpUserData = nullptr;
 
 			wgpu::TextureView*									mpTotalDiffuseTextureView = nullptr;
@@ -51,12 +56,67 @@ namespace Render
 		void createWithInputAttachmentsAndPipeline(CreateInfo& createInfo);
 		void setCopyAttachments(CreateInfo& createInfo);
 
+		// shares another attachment's texture, before createWithInputAttachmentsAndPipeline() makes
+		// the bind groups
+		void aliasOutputAttachment(
+			std::string const& attachmentName,
+			wgpu::Texture const& texture);
+
+		// pipelines are created asynchronously, the job is skipped until its pipeline is ready
+		enum class PipelineState
+		{
+			Pending = 0,
+			Ready,
+			Failed,
+		};
+
+		inline bool isReady() const
+		{
+			return mPipelineState == PipelineState::Ready;
+		}
+
+		// texture behind an output, or the history of one, on frames of the given parity. outputs with
+		// a "History" name ping-pong between two textures, the history name reads the one written the
+		// frame before. nullptr if the job has no such attachment
+		wgpu::Texture* getOutputTexture(
+			std::string const& attachmentName,
+			uint32_t iFrame);
+		bool isPingPong(std::string const& attachmentName) const;
+
+		inline std::vector<wgpu::BindGroup> const& getBindGroups(uint32_t iFrame) const
+		{
+			return ((iFrame & 1) && !maOddFrameBindGroups.empty()) ? maOddFrameBindGroups : maBindGroups;
+		}
+
+		inline std::vector<wgpu::RenderPassColorAttachment> const& getOutputAttachments(uint32_t iFrame) const
+		{
+			return ((iFrame & 1) && !maOddFrameOutputAttachments.empty()) ? maOddFrameOutputAttachments : maOutputAttachments;
+		}
+
+	protected:
+		void createRenderPipelineAsync(
+			CreateInfo& createInfo,
+			wgpu::RenderPipelineDescriptor const& pipelineDescriptor);
+		void createComputePipelineAsync(
+			CreateInfo& createInfo,
+			wgpu::ComputePipelineDescriptor const& pipelineDescriptor);
+		void beginPipelineCreate(CreateInfo& createInfo);
+		void onPipelineCreated();
+
 	protected:
 		wgpu::SurfaceTexture* mpSwapChain;
 		uint3													mDispatchSize = uint3(1, 1, 1);
 
 		std::map<std::string, wgpu::Texture>					mOutputImageAttachments;
 		std::map<std::string, wgpu::Texture*>					mInputImageAttachments;
+
+		// second texture of each ping-pong output by history name, written on odd frames, and the
+		// output name to history name
+		std::map<std::string, wgpu::Texture>					mHistoryImageAttachments;
+		std::map<std::string, std::string>						maHistoryNames;
+
+		// odd frame textures of the inputs reading ping-pong outputs
+		std::map<std::string, wgpu::Texture*>					mOddFrameInputImageAttachments;
 		std::map<std::string, wgpu::Buffer>						mOutputBufferAttachments;
 		std::map<std::string, wgpu::Buffer*>					mInputBufferAttachments;
 		std::map<std::string, wgpu::Buffer>						mUniformBuffers;
@@ -71,6 +131,7 @@ namespace Render
 		std::vector<std::map<std::string, std::string>>									mUniformOrder;
 
 		std::vector<wgpu::RenderPassColorAttachment>									maOutputAttachments;
+		std::vector<wgpu::RenderPassColorAttachment>									maOddFrameOutputAttachments;
 
 		std::string												mName;
 		Render::JobType											mType;
@@ -87,11 +148,39 @@ namespace Render
 		wgpu::DepthStencilState									mDepthStencilState;
 		
 		std::vector<wgpu::BindGroup>							maBindGroups;
+		std::vector<wgpu::BindGroup>							maOddFrameBindGroups;
 		
 		wgpu::RenderPassDepthStencilAttachment					mDepthStencilAttachment;
 
 		wgpu::LoadOp											mLoadOp = wgpu::LoadOp::Clear;
 		wgpu::StoreOp											mStoreOp = wgpu::StoreOp::Store;
+
+		// jobs named by the attachments' ParentJobName, and the renderer's resources read and written,
+		// for building the render graph
+		std::vector<std::string>								maParentJobNames;
+		std::vector<std::string>								maExternalReads;
+		std::vector<std::string>								maExternalWrites;
+
+		// (job, attachment) of each parent texture, known after createWithOnlyOutputAttachments() for
+		// planning which outputs can share a texture
+		std::vector<std::pair<std::string, std::string>>		maInputTextureLinks;
+
+		// mesh passes draw from the sort job's draw calls, or the compaction job's index list, set from
+		// the job's "MeshDrawCalls" and "MeshCompaction" in render-jobs.json
+		std::string												mMeshDrawCallJobName = "Mesh Draw Sort Compute";
+		std::string												mMeshCompactionJobName = "Mesh Index Compaction Compute";
+
+		// set from the creation callback, on the thread calling ProcessEvents()
+		PipelineState											mPipelineState = PipelineState::Pending;
+		std::chrono::high_resolution_clock::time_point			mPipelineIssueTime;
+		double													mfPipelineCreateTime = 0.0;
+
+		// pipeline cache hits and misses while the pipeline compiled, pipelines compiling at the same
+		// time count each other's too
+		void(*mpfnGetPipelineCacheCounts)(uint32_t& iNumHits, uint32_t& iNumMisses, void* pUserData) = nullptr;
+		void*													mpPipelineCacheUserData = nullptr;
+		uint32_t												miPipelineCacheHits = 0;
+		uint32_t												miPipelineCacheMisses = 0;
 	};
 
 }	// Render
\ No newline at end of file
@@ -19,4 +19,10 @@ namespace Render
 		DepthPrepass,
 	};
 
+	// passes drawing the meshes from a culling job's draw calls, depth prepasses only have positions
+	inline bool isMeshPass(PassType passType)
+	{
+		return (passType == PassType::DrawMeshes || passType == PassType::DepthPrepass);
+	}
+
 }   // Render
\ No newline at end of file
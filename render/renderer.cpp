@@ -6,10 +6,17 @@
 #include <math/vec.h>
 #include <math/mat4.h>
 #include <loader/loader.h>
+#include <loader/asset_pack.h>
+#include <loader/loader_metrics.h>
+#include <loader/mesh_codec.h>
+#include <utils/task_graph.h>
+#include <utils/rect_packer.h>
 #include <assert.h>
 
+#include <algorithm>
 #include <iostream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #if defined(__EMSCRIPTEN__)
@@ -29,12 +36,20 @@
 #undef max
 #endif //__EMSCRIPTEN__
 
+// decoded diffuse texture bytes held at once while the atlas is filled
+#define TEXTURE_DECODE_MEMORY_BUDGET    (256ull << 20)
+
+// diffuse atlas pages, textures are padded and aligned to the block the last mip level reduces to a texel
+#define DIFFUSE_ATLAS_MAX_PAGE_SIZE     8192
+#define DIFFUSE_ATLAS_MIP_LEVELS        4
+
 struct Vertex
 {
     vec4        mPosition;
     vec4        mUV;
     vec4        mNormal;
 };
+static_assert(sizeof(Vertex) == sizeof(Loader::MeshCodec::Vertex));
 
 struct DefaultUniformData
 {
@@ -102,6 +117,34 @@ void streamBinary(
 
 namespace Render
 {
+    /*
+    **
+    */
+    // whole file into a vector on every platform, the setup stages hand their data across threads
+    static void loadFileToVector(
+        std::vector<char>& acData,
+        std::string const& filePath,
+        bool bTextFile = false)
+    {
+#if defined(__EMSCRIPTEN__)
+        char* acFileData = nullptr;
+        uint32_t iSize = Loader::loadFile(&acFileData, filePath, bTextFile);
+        acData.clear();
+        if(acFileData != nullptr)
+        {
+            acData.assign(acFileData, acFileData + iSize);
+            Loader::loadFileFree(acFileData);
+        }
+#else
+        Loader::loadFile(acData, filePath, bTextFile);
+#endif // __EMSCRIPTEN__
+
+        if(bTextFile && (acData.size() == 0 || acData.back() != '\0'))
+        {
+            acData.push_back('\0');
+        }
+    }
+
     /*
     **
     */
@@ -114,21 +157,82 @@ namespace Render
 
         mpSampler = desc.mpSampler;
 
-        createMiscBuffers();
+        mUploadManager.setup(mpDevice);
 
-        loadMeshes();
-        loadTexturesIntoAtlas();
-        loadFont();
-        loadBVH();
-        loadExternalData();
+        // scene asset pack, entries found here are extracted from the pack instead of being loaded individually
+        Loader::mountAssetPack(std::string("assets/") + mCreateDesc.mMeshFilePath + ".pak");
 
-        createRenderJobs(desc);
+        // overlap downloading and inflating the scene files with the setup work below
+        std::string meshBaseName = mCreateDesc.mMeshFilePath.substr(0, mCreateDesc.mMeshFilePath.rfind("."));
+        std::vector<std::string> aPrefetchFilePaths = {
+            mCreateDesc.mMeshFilePath + ".mid",
+            mCreateDesc.mMeshFilePath + ".mat",
+            mCreateDesc.mMeshFilePath + "-texture-names.tex",
+            meshBaseName + "-triangles.bvh",
+            "font-atlas.png",
+            "glyph_info.bin",
+        };
+        if(!mCreateDesc.mbProgressiveMeshLoading)
+        {
+            // streamed geometry is fetched in ranges after setup
+            aPrefetchFilePaths.push_back(mCreateDesc.mMeshFilePath + "-triangles.bin");
+        }
+        Loader::prefetchFiles(aPrefetchFilePaths);
+
+        // file loading and decoding runs on the setup workers, everything touching the device stays on this thread
+        typedef Utils::CTaskGraph::Affinity Affinity;
+        Utils::CTaskGraph setupGraph;
+
+        uint32_t iMiscBuffers = setupGraph.addTask("create misc buffers", Affinity::MainThread, {}, [&] { createMiscBuffers(); });
+        uint32_t iFetchMeshes = setupGraph.addTask("fetch meshes", Affinity::Worker, {}, [&] { fetchMeshes(); });
+        uint32_t iFetchTextures = setupGraph.addTask("fetch textures", Affinity::Worker, {}, [&] { fetchTextures(); });
+        uint32_t iFetchFont = setupGraph.addTask("fetch font", Affinity::Worker, {}, [&] { fetchFont(); });
+        uint32_t iFetchBVH = setupGraph.addTask("fetch bvh", Affinity::Worker, {}, [&] { fetchBVH(); });
+        uint32_t iFetchExternalData = setupGraph.addTask("fetch external data", Affinity::Worker, {}, [&] { fetchExternalData(); });
+        uint32_t iFetchRenderJobs = setupGraph.addTask("fetch render jobs", Affinity::Worker, {}, [&]
+        {
+            loadFileToVector(mSetupData.macRenderJobs, "render-jobs/" + desc.mRenderJobPipelineFilePath, true);
+        });
+
+        // geometry is decoded on a worker straight into the mapped vertex and index buffers
+        uint32_t iAllocateMeshes = setupGraph.addTask("allocate mesh buffers", Affinity::MainThread, {iFetchMeshes}, [&] { allocateMeshBuffers(); });
+        uint32_t iDecodeMeshes = setupGraph.addTask("decode meshes", Affinity::Worker, {iAllocateMeshes}, [&] { decodeMeshes(); });
+        uint32_t iUploadMeshes = setupGraph.addTask("upload meshes", Affinity::MainThread, {iDecodeMeshes}, [&] { uploadMeshes(); });
+        uint32_t iUploadTextures = setupGraph.addTask("upload texture atlas", Affinity::MainThread, {iFetchTextures}, [&] { uploadTextureAtlas(); });
+        uint32_t iUploadVirtualTexture = setupGraph.addTask("upload virtual texture", Affinity::MainThread, {iFetchTextures}, [&] { uploadVirtualTexture(); });
+        uint32_t iUploadFont = setupGraph.addTask("upload font", Affinity::MainThread, {iFetchFont}, [&] { uploadFont(); });
+        uint32_t iUploadBVH = setupGraph.addTask("upload bvh", Affinity::MainThread, {iFetchBVH}, [&] { uploadBVH(); });
+        uint32_t iUploadExternalData = setupGraph.addTask("upload external data", Affinity::MainThread, {iFetchExternalData}, [&] { uploadExternalData(); });
+
+        // render jobs look up every buffer and texture created above
+        uint32_t iCreateRenderJobs = setupGraph.addTask(
+            "create render jobs",
+            Affinity::MainThread,
+            {iMiscBuffers, iUploadMeshes, iUploadTextures, iUploadVirtualTexture, iUploadFont, iUploadBVH, iUploadExternalData, iFetchRenderJobs},
+            [&] { createRenderJobs(desc); });
+        setupGraph.addTask("setup uniform buffers", Affinity::MainThread, {iCreateRenderJobs}, [&] { setupUniformAndMiscBuffers(); });
+
+        {
+            Utils::CThreadPool setupThreadPool;
+            setupThreadPool.start(Utils::getDefaultNumWorkerThreads(), "Setup");
+            setupGraph.run(setupThreadPool);
+        }
+        setupGraph.printReport();
+        mUploadManager.printStats();
+
+        if(desc.mbWaitForPipelines)
+        {
+            waitForPipelines();
+        }
 
-        setupUniformAndMiscBuffers();
+        releaseSetupData();
 
         mLastTimeStart = std::chrono::high_resolution_clock::now();
 
         mpInstance = desc.mpInstance;
+
+        // per file load timings for tuning the loading pipeline
+        Loader::dumpMetrics("loader-metrics.json");
     }
 
     /*
@@ -167,24 +271,31 @@ namespace Render
 #endif // #if 0
 
         // clear number of draw calls
-        char acClearData[] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-        mpDevice->GetQueue().WriteBuffer(
-            maRenderJobs["Mesh Culling Compute"]->mOutputBufferAttachments["Num Draw Calls"],
-            0,
-            acClearData,
-            sizeof(acClearData)
-        );
-        mpDevice->GetQueue().WriteBuffer(
-            maBuffers["irradianceCacheQueueCounter"],
-            0,
-            acClearData,
-            sizeof(acClearData)
-        );
+        static char const acClearData[1024] = {};
+        for(CounterBuffer const& counterBuffer : maCounterBuffers)
+        {
+            mpDevice->GetQueue().WriteBuffer(
+                *counterBuffer.mpBuffer,
+                0,
+                acClearData,
+                counterBuffer.miClearSize
+            );
+        }
 
-        for(auto queuedData : maQueueData)
+        for(auto const& queuedData : maQueueData)
         {
+            uint32_t iBuffer = queuedData.miBufferHandle;
+            if(iBuffer == UINT32_MAX)
+            {
+                iBuffer = getUniformBufferHandle(queuedData.mJobName, queuedData.mShaderResourceName);
+                if(iBuffer == UINT32_MAX)
+                {
+                    continue;
+                }
+            }
+
             mpDevice->GetQueue().WriteBuffer(
-                maRenderJobs[queuedData.mJobName]->mUniformBuffers[queuedData.mShaderResourceName],
+                *mapUniformBuffers[iBuffer],
                 queuedData.miStart,
                 queuedData.mpData,
                 queuedData.miSize
@@ -193,6 +304,35 @@ namespace Render
 
         maQueueData.clear();
 
+        // upload streamed meshes and turn them on
+        if(mpMeshStreamer)
+        {
+            float3 cameraPosition = desc.mpCameraPosition ? *desc.mpCameraPosition : mCameraPosition;
+            float3 cameraLookAt = desc.mpCameraLookAt ? *desc.mpCameraLookAt : mCameraLookAt;
+            if(mpMeshStreamer->update(cameraPosition, cameraLookAt))
+            {
+                writeVisibilityFlags(
+                    maiVisibilityFlags,
+                    0,
+                    (uint32_t)maMeshTriangleRanges.size() * sizeof(uint32_t));
+            }
+
+            if(mpMeshStreamer->isComplete())
+            {
+                printf("all %d meshes streamed in at frame %d\n",
+                    (uint32_t)maMeshTriangleRanges.size(),
+                    miFrame);
+                mpMeshStreamer.reset();
+                setRayTracedJobsEnabled(true);
+            }
+        }
+
+        // tiles the deferred pass asked for a few frames ago
+        if(mpVirtualTextureStreamer)
+        {
+            mpVirtualTextureStreamer->update();
+        }
+
         struct MeshSelectionUniformData
         {
             int32_t miSelectedMesh;
@@ -317,13 +457,16 @@ namespace Render
             uniformBuffer.miPadding = 0;
 
             printf("uniform selected mesh = %d\n", uniformBuffer.miSelectedMesh);
-            mpDevice->GetQueue().WriteBuffer(
-                maRenderJobs["Mesh Selection Graphics"]->mUniformBuffers["uniformBuffer"],
-                0,
-                &uniformBuffer,
-                sizeof(MeshSelectionUniformData)
-            );
-            printf("updated mesh selection uniform\n");
+            if(mpMeshSelectionUniformBuffer != nullptr)
+            {
+                mpDevice->GetQueue().WriteBuffer(
+                    *mpMeshSelectionUniformBuffer,
+                    0,
+                    &uniformBuffer,
+                    sizeof(MeshSelectionUniformData)
+                );
+                printf("updated mesh selection uniform\n");
+            }
 
         }
 
@@ -335,9 +478,13 @@ namespace Render
         std::ostringstream oss;
         oss << iFPS << " fps";
 
-        std::vector<wgpu::CommandBuffer> aCommandBuffer;
+        // the whole frame is recorded into one encoder and goes out in one submit
+        wgpu::CommandEncoderDescriptor commandEncoderDesc = {};
+        commandEncoderDesc.label = "Frame Command Encoder";
+        wgpu::CommandEncoder commandEncoder = mpDevice->CreateCommandEncoder(&commandEncoderDesc);
+
         drawText(
-            aCommandBuffer,
+            commandEncoder,
             oss.str(),
             100,
             20,
@@ -345,42 +492,64 @@ namespace Render
             float3(1.0f, 0.5f, 0.2f)
         );
 
-        // add commands from the render jobs
-        for(auto const& renderJobName : maOrderedRenderJobs)
+        if(mbRenderGraphDirty)
         {
-            Render::CRenderJob* pRenderJob = maRenderJobs[renderJobName].get();
+            maiScheduledRenderJobs.clear();
+            for(auto const& renderJobName : mRenderGraph.compile(mSwapChainRenderJobName))
+            {
+                maiScheduledRenderJobs.push_back(getRenderJobHandle(renderJobName));
+            }
+            mbRenderGraphDirty = false;
+
+            if(std::find(maAliasedAttachments.begin(), maAliasedAttachments.end(), std::make_pair(mSwapChainRenderJobName, mSwapChainAttachmentName)) != maAliasedAttachments.end())
+            {
+                printf("!!! swap chain output \"%s\" of \"%s\" shares its texture with later passes, turn off CreateDescriptor::mbAliasTransientAttachments to view it !!!\n",
+                    mSwapChainAttachmentName.c_str(),
+                    mSwapChainRenderJobName.c_str());
+            }
+        }
+
+        // add commands from the render jobs, ones still waiting on their pipelines sit the frame out
+        updatePipelineStatus();
+        for(uint32_t iRenderJob : maiScheduledRenderJobs)
+        {
+            Render::CRenderJob* pRenderJob = mapRenderJobs[iRenderJob];
+            if(!pRenderJob->isReady())
+            {
+                continue;
+            }
 
-            wgpu::CommandEncoderDescriptor commandEncoderDesc = {};
-            wgpu::CommandEncoder commandEncoder = mpDevice->CreateCommandEncoder(&commandEncoderDesc);
             if(pRenderJob->mType == Render::JobType::Graphics)
             {
                 uint32_t iOutputAttachmentWidth = pRenderJob->mOutputImageAttachments.begin()->second.GetWidth();
                 uint32_t iOutputAttachmentHeight = pRenderJob->mOutputImageAttachments.begin()->second.GetHeight();
 
                 wgpu::RenderPassDescriptor renderPassDesc = {};
-                renderPassDesc.colorAttachmentCount = pRenderJob->maOutputAttachments.size();
-                renderPassDesc.colorAttachments = pRenderJob->maOutputAttachments.data();
+                std::vector<wgpu::RenderPassColorAttachment> const& aOutputAttachments = pRenderJob->getOutputAttachments(miFrame);
+                renderPassDesc.colorAttachmentCount = aOutputAttachments.size();
+                renderPassDesc.colorAttachments = aOutputAttachments.data();
                 renderPassDesc.depthStencilAttachment = &pRenderJob->mDepthStencilAttachment;
                 wgpu::RenderPassEncoder renderPassEncoder = commandEncoder.BeginRenderPass(&renderPassDesc);
 
                 renderPassEncoder.PushDebugGroup(pRenderJob->mName.c_str());
 
                 // bind broup, pipeline, index buffer, vertex buffer, scissor rect, viewport, and draw
-                for(uint32_t iGroup = 0; iGroup < (uint32_t)pRenderJob->maBindGroups.size(); iGroup++)
+                std::vector<wgpu::BindGroup> const& aBindGroups = pRenderJob->getBindGroups(miFrame);
+                for(uint32_t iGroup = 0; iGroup < (uint32_t)aBindGroups.size(); iGroup++)
                 {
                     renderPassEncoder.SetBindGroup(
                         iGroup,
-                        pRenderJob->maBindGroups[iGroup]);
+                        aBindGroups[iGroup]);
                 }
 
                 renderPassEncoder.SetPipeline(pRenderJob->mRenderPipeline);
                 renderPassEncoder.SetIndexBuffer(
-                    maBuffers["train-index-buffer"],
+                    *getFrameBuffer(FrameBuffer::TrainIndex),
                     wgpu::IndexFormat::Uint32
                 );
                 renderPassEncoder.SetVertexBuffer(
                     0,
-                    maBuffers["train-vertex-buffer"]
+                    *getFrameBuffer(FrameBuffer::TrainVertex)
                 );
                 renderPassEncoder.SetScissorRect(
                     0,
@@ -395,32 +564,34 @@ namespace Render
                     0.0f,
                     1.0f);
                 
-                if(pRenderJob->mPassType == Render::PassType::DrawMeshes)
+                if(Render::isMeshPass(pRenderJob->mPassType))
                 {
+                    MeshDrawBuffers const& drawBuffers = maMeshDrawBuffers[iRenderJob];
 #if defined(__EMSCRIPTEN__) || !defined(_MSC_VER)
-                    for(uint32_t iMesh = 0; iMesh < (uint32_t)maMeshTriangleRanges.size(); iMesh++)
+                    if(drawBuffers.mpCompactedIndices != nullptr)
                     {
-                        if(maiVisibilityFlags[iMesh] >= 1)
-                        {
-                            uint32_t iNumIndices = maMeshTriangleRanges[iMesh].miEnd - maMeshTriangleRanges[iMesh].miStart;
-                            uint32_t iIndexOffset = maMeshTriangleRanges[iMesh].miStart;
-                            //renderPassEncoder.DrawIndexed(iNumIndices, 1, iIndexOffset, 0, 0);
-                            renderPassEncoder.DrawIndexedIndirect(
-                                maRenderJobs["Mesh Culling Compute"]->mOutputBufferAttachments["Draw Calls"],
-                                iMesh * 5 * sizeof(uint32_t)
-                            );
-                        }
-                        //else
-                        //{
-                        //    printf("mesh %d not visible\n", iMesh);
-                        //}
+                        // every visible triangle in one list, the mesh id comes with the vertices
+                        renderPassEncoder.SetIndexBuffer(
+                            *drawBuffers.mpCompactedIndices,
+                            wgpu::IndexFormat::Uint32
+                        );
+                        renderPassEncoder.DrawIndexedIndirect(
+                            *drawBuffers.mpCompactedDrawCall,
+                            0
+                        );
+                    }
+                    else
+                    {
+                        // one indirect draw per visible mesh, recorded when the visibility flags change
+                        wgpu::RenderBundle const& renderBundle = getMeshRenderBundle(iRenderJob);
+                        renderPassEncoder.ExecuteBundles(1, &renderBundle);
                     }
 #else
                     renderPassEncoder.MultiDrawIndexedIndirect(
-                        maRenderJobs["Mesh Culling Compute"]->mOutputBufferAttachments["Draw Calls"],
+                        *drawBuffers.mpDrawCalls,
                         0,
                         (uint32_t)maMeshTriangleRanges.size(), //65536 * 2,
-                        maRenderJobs["Mesh Culling Compute"]->mOutputBufferAttachments["Num Draw Calls"],
+                        *drawBuffers.mpNumDrawCalls,
                         0
                     );
 #endif // __EMSCRIPTEN__
@@ -442,11 +613,12 @@ namespace Render
                 computePassEncoder.PushDebugGroup(pRenderJob->mName.c_str());
 
                 // bind broup, pipeline, index buffer, vertex buffer, scissor rect, viewport, and draw
-                for(uint32_t iGroup = 0; iGroup < (uint32_t)pRenderJob->maBindGroups.size(); iGroup++)
+                std::vector<wgpu::BindGroup> const& aBindGroups = pRenderJob->getBindGroups(miFrame);
+                for(uint32_t iGroup = 0; iGroup < (uint32_t)aBindGroups.size(); iGroup++)
                 {
                     computePassEncoder.SetBindGroup(
                         iGroup,
-                        pRenderJob->maBindGroups[iGroup]);
+                        aBindGroups[iGroup]);
                 }
                 computePassEncoder.SetPipeline(pRenderJob->mComputePipeline);
                 computePassEncoder.DispatchWorkgroups(
@@ -506,38 +678,40 @@ namespace Render
                 commandEncoder.PopDebugGroup();
             }
 
-            wgpu::CommandBuffer commandBuffer = commandEncoder.Finish();
-            aCommandBuffer.push_back(commandBuffer);
-
         }   // for all render jobs
 
+        if(mpVirtualTextureStreamer)
+        {
+            mpVirtualTextureStreamer->addFeedbackCommands(commandEncoder);
+        }
+
 #if 0
         // get selection info from shader via read back buffer
-        if(mbWaitingForMeshSelection)
+        if(mbWaitingForMeshSelection && mpCaptureUniformBuffer != nullptr)
         {
-            wgpu::CommandEncoderDescriptor commandEncoderDesc = {};
-            wgpu::CommandEncoder commandEncoder = mpDevice->CreateCommandEncoder(&commandEncoderDesc);
-
             commandEncoder.CopyBufferToBuffer(
-                maRenderJobs[mCaptureImageJobName]->mUniformBuffers[mCaptureUniformBufferName],
+                *mpCaptureUniformBuffer,
                 0,
                 mOutputImageBuffer,
                 0,
                 64
             );
 
-            wgpu::CommandBuffer commandBuffer = commandEncoder.Finish();
-            aCommandBuffer.push_back(commandBuffer);
-
             printf("copy selection buffer\n");
             mbSelectedBufferCopied = true;
         }
 #endif // #if 0
 
         // submit all the job commands
+        wgpu::CommandBuffer commandBuffer = commandEncoder.Finish();
         mpDevice->GetQueue().Submit(
-            (uint32_t)aCommandBuffer.size(), 
-            aCommandBuffer.data());
+            1, 
+            &commandBuffer);
+
+        if(mpVirtualTextureStreamer)
+        {
+            mpVirtualTextureStreamer->readBackFeedback();
+        }
 
 
         // test test test
@@ -576,21 +750,8 @@ namespace Render
     */
     void CRenderer::createRenderJobs(CreateDescriptor& desc)
     {
-#if defined(__EMSCRIPTEN__)
-        char* acFileContentBuffer = nullptr;
-        Loader::loadFile(
-            &acFileContentBuffer,
-            "render-jobs/" + desc.mRenderJobPipelineFilePath,
-            true
-        );
-#else 
-        std::vector<char> acFileContentBuffer;
-        Loader::loadFile(
-            acFileContentBuffer,
-            "render-jobs/" + desc.mRenderJobPipelineFilePath,
-            true
-        );
-#endif //__EMSCRIPTEN__
+        // loaded by the setup workers
+        std::vector<char>& acFileContentBuffer = mSetupData.macRenderJobs;
 
         Render::CRenderJob::CreateInfo createInfo = {};
         createInfo.miScreenWidth = desc.miScreenWidth;
@@ -613,19 +774,27 @@ namespace Render
             return pRenderer->maTextures[textureName];
         };
 
-        rapidjson::Document doc;
+        createInfo.mpfnGetPipelineCacheCounts = [](uint32_t& iNumHits, uint32_t& iNumMisses, void* pUserData)
         {
-#if defined(__EMSCRIPTEN__)
-            doc.Parse(acFileContentBuffer);
-            Loader::loadFileFree(acFileContentBuffer);
-#else 
-            doc.Parse(acFileContentBuffer.data());
-#endif //__EMSCRIPTEN__
-        }
+            CPipelineCache::Stats stats = ((Render::CRenderer*)pUserData)->getPipelineCacheStats();
+            iNumHits = stats.miNumHits;
+            iNumMisses = stats.miNumMisses;
+        };
+
+        rapidjson::Document doc;
+        doc.Parse(acFileContentBuffer.data());
 
         std::vector<std::string> aRenderJobNames;
         std::vector<std::string> aShaderModuleFilePath;
 
+        // copy jobs look up the format of the attachment they copy from, earlier jobs are in here by then
+        mapRenderJobs.clear();
+        maiRenderJobHandles.clear();
+        createInfo.mpaRenderJobs = &mapRenderJobs;
+
+        createInfo.mFormatSettings.mQuality = desc.mAttachmentQuality;
+        createInfo.mFormatSettings.mbRG11B10UfloatRenderable = mpDevice->HasFeature(wgpu::FeatureName::RG11B10UfloatRenderable);
+
         auto const& jobs = doc["Jobs"].GetArray();
         for(auto const& job : jobs)
         {
@@ -688,6 +857,8 @@ namespace Render
             // create output attachments first
             maRenderJobs[createInfo.mName] = std::make_unique<Render::CRenderJob>();
             maRenderJobs[createInfo.mName]->createWithOnlyOutputAttachments(createInfo);
+            maiRenderJobHandles[createInfo.mName] = (uint32_t)mapRenderJobs.size();
+            mapRenderJobs.push_back(maRenderJobs[createInfo.mName].get());
 
             if(jobType == "Compute")
             {
@@ -699,20 +870,30 @@ namespace Render
                     maRenderJobs[createInfo.mName]->mDispatchSize.z = dispatchArray[2].GetUint();
                 }
             }
+            else if(Render::isMeshPass(createInfo.mPassType))
+            {
+                if(job.HasMember("MeshDrawCalls"))
+                {
+                    maRenderJobs[createInfo.mName]->mMeshDrawCallJobName = job["MeshDrawCalls"].GetString();
+                }
+                if(job.HasMember("MeshCompaction"))
+                {
+                    maRenderJobs[createInfo.mName]->mMeshCompactionJobName = job["MeshCompaction"].GetString();
+                }
+            }
 
             aRenderJobNames.push_back(createInfo.mName);
         }
 
-        std::vector<Render::CRenderJob*> apRenderJobs;
-        for(auto const& renderJobName : aRenderJobNames)
+        if(desc.mbAliasTransientAttachments)
         {
-            apRenderJobs.push_back(maRenderJobs[renderJobName].get());
+            aliasTransientAttachments();
         }
 
         // attach input attachments to output attachments from above, also set default uniform buffer
         createInfo.mpDrawTextOutputAttachment = &mFontOutputAttachment;
         createInfo.mpDefaultUniformBuffer = &maBuffers["default-uniform-buffer"];
-        createInfo.mpaRenderJobs = &apRenderJobs;
+        auto createStartTime = std::chrono::high_resolution_clock::now();
         uint32_t iIndex = 0;
         for(auto const& renderJobName : aRenderJobNames)
         {
@@ -728,10 +909,26 @@ namespace Render
             else
             {
                 maRenderJobs[renderJobName]->createWithInputAttachmentsAndPipeline(createInfo);
+                maiPendingPipelineJobs.push_back(getRenderJobHandle(renderJobName));
             }
             ++iIndex;
         }
 
+#if defined(__EMSCRIPTEN__) || !defined(_MSC_VER)
+        mbCompactedMeshDraw = desc.mbCompactMeshIndices;
+        printf("mesh passes draw %s\n", mbCompactedMeshDraw ? "the compacted index list in one draw" : "one indirect draw per mesh");
+#endif // __EMSCRIPTEN__
+
+        // the mesh passes' links in the render graph depend on what they draw from
+        resolveFrameResources();
+        buildRenderGraph();
+
+        // every pipeline is issued above, they compile in parallel
+        mPipelineIssueTime = std::chrono::high_resolution_clock::now();
+        printf("issued %d render job pipelines in %.2f ms\n",
+            (uint32_t)maiPendingPipelineJobs.size(),
+            std::chrono::duration<double, std::milli>(mPipelineIssueTime - createStartTime).count());
+
         for(auto const& job : jobs)
         {
             if(job.HasMember("UniformData"))
@@ -775,13 +972,175 @@ namespace Render
                 
             }
         }
+    }
+
+    /*
+    **
+    */
+    void CRenderer::resolveFrameResources()
+    {
+        auto findBuffer = [](std::map<std::string, wgpu::Buffer>& aBuffers, std::string const& bufferName) -> wgpu::Buffer*
+        {
+            auto iter = aBuffers.find(bufferName);
+            if(iter == aBuffers.end())
+            {
+                printf("%s : %d can't find buffer \"%s\"\n",
+                    __FILE__,
+                    __LINE__,
+                    bufferName.c_str());
+                return nullptr;
+            }
+
+            return &iter->second;
+        };
+
+        mapFrameBuffers[(uint32_t)FrameBuffer::TrainIndex] = findBuffer(maBuffers, "train-index-buffer");
+        mapFrameBuffers[(uint32_t)FrameBuffer::TrainVertex] = findBuffer(maBuffers, "train-vertex-buffer");
+        mapFrameBuffers[(uint32_t)FrameBuffer::IrradianceCacheQueueCounter] = findBuffer(maBuffers, "irradianceCacheQueueCounter");
+
+        // the selection job is optional
+        mpMeshSelectionUniformBuffer = nullptr;
+        auto selectionIter = maiRenderJobHandles.find("Mesh Selection Graphics");
+        if(selectionIter != maiRenderJobHandles.end())
+        {
+            mpMeshSelectionUniformBuffer = findBuffer(mapRenderJobs[selectionIter->second]->mUniformBuffers, "uniformBuffer");
+        }
+
+        if(mSwapChainRenderJobName.length() > 0)
+        {
+            miSwapChainRenderJob = getRenderJobHandle(mSwapChainRenderJobName);
+        }
+
+        maCounterBuffers.clear();
+        if(getFrameBuffer(FrameBuffer::IrradianceCacheQueueCounter) != nullptr)
+        {
+            maCounterBuffers.push_back({getFrameBuffer(FrameBuffer::IrradianceCacheQueueCounter), 16});
+        }
+
+        // each mesh pass's sort job, and compaction job if the index list is compacted
+        maMeshDrawBuffers.assign(mapRenderJobs.size(), MeshDrawBuffers());
+        for(uint32_t iRenderJob = 0; iRenderJob < (uint32_t)mapRenderJobs.size(); iRenderJob++)
+        {
+            Render::CRenderJob* pRenderJob = mapRenderJobs[iRenderJob];
+            if(!Render::isMeshPass(pRenderJob->mPassType))
+            {
+                continue;
+            }
+
+            MeshDrawBuffers& drawBuffers = maMeshDrawBuffers[iRenderJob];
+            uint32_t iDrawCallJob = getRenderJobHandle(pRenderJob->mMeshDrawCallJobName);
+            if(iDrawCallJob != UINT32_MAX)
+            {
+                // the count comes from the culling job before it
+                Render::CRenderJob* pDrawCallJob = mapRenderJobs[iDrawCallJob];
+                drawBuffers.mpDrawCalls = findBuffer(pDrawCallJob->mOutputBufferAttachments, "Draw Calls");
+                auto countIter = pDrawCallJob->mInputBufferAttachments.find("Num Draw Calls");
+                if(countIter != pDrawCallJob->mInputBufferAttachments.end())
+                {
+                    drawBuffers.mpNumDrawCalls = countIter->second;
+                }
+                else
+                {
+                    drawBuffers.mpNumDrawCalls = findBuffer(pDrawCallJob->mOutputBufferAttachments, "Num Draw Calls");
+                }
+
+                // per bucket counts follow the totals
+                if(drawBuffers.mpNumDrawCalls != nullptr &&
+                   std::find_if(maCounterBuffers.begin(), maCounterBuffers.end(), [&](CounterBuffer const& counterBuffer) { return counterBuffer.mpBuffer == drawBuffers.mpNumDrawCalls; }) == maCounterBuffers.end())
+                {
+                    maCounterBuffers.push_back({drawBuffers.mpNumDrawCalls, (uint32_t)std::min<uint64_t>(drawBuffers.mpNumDrawCalls->GetSize(), 1024)});
+                }
+            }
+
+            // the mesh passes can't draw without these
+            assert(drawBuffers.mpDrawCalls != nullptr);
+            assert(drawBuffers.mpNumDrawCalls != nullptr);
+
+            if(mbCompactedMeshDraw)
+            {
+                uint32_t iCompactionJob = getRenderJobHandle(pRenderJob->mMeshCompactionJobName);
+                if(iCompactionJob != UINT32_MAX)
+                {
+                    std::map<std::string, wgpu::Buffer>& aCompactionBuffers = mapRenderJobs[iCompactionJob]->mOutputBufferAttachments;
+                    drawBuffers.mpCompactedIndices = findBuffer(aCompactionBuffers, "Compacted Indices");
+                    drawBuffers.mpCompactedDrawCall = findBuffer(aCompactionBuffers, "Compacted Draw Call");
+                }
+
+                if(drawBuffers.mpCompactedIndices == nullptr || drawBuffers.mpCompactedDrawCall == nullptr)
+                {
+                    printf("\"%s\" has no compacted index list, drawing one mesh at a time\n", pRenderJob->mName.c_str());
+                    drawBuffers.mpCompactedIndices = drawBuffers.mpCompactedDrawCall = nullptr;
+                }
+            }
+        }
+
+        assert(getFrameBuffer(FrameBuffer::TrainIndex) != nullptr);
+        assert(getFrameBuffer(FrameBuffer::TrainVertex) != nullptr);
+
+        invalidateMeshRenderBundles();
+    }
+
+    /*
+    **
+    */
+    uint32_t CRenderer::getRenderJobHandle(std::string const& jobName) const
+    {
+        auto iter = maiRenderJobHandles.find(jobName);
+        if(iter == maiRenderJobHandles.end())
+        {
+            printf("%s : %d can't find render job \"%s\"\n",
+                __FILE__,
+                __LINE__,
+                jobName.c_str());
+            return UINT32_MAX;
+        }
+
+        return iter->second;
+    }
+
+    /*
+    **
+    */
+    uint32_t CRenderer::getUniformBufferHandle(
+        std::string const& jobName,
+        std::string const& shaderResourceName)
+    {
+        std::string key = jobName + "/" + shaderResourceName;
+        auto iter = maiUniformBufferHandles.find(key);
+        if(iter != maiUniformBufferHandles.end())
+        {
+            return iter->second;
+        }
+
+        uint32_t iRenderJob = getRenderJobHandle(jobName);
+        if(iRenderJob == UINT32_MAX)
+        {
+            return UINT32_MAX;
+        }
+
+        std::map<std::string, wgpu::Buffer>& aUniformBuffers = mapRenderJobs[iRenderJob]->mUniformBuffers;
+        auto bufferIter = aUniformBuffers.find(shaderResourceName);
+        if(bufferIter == aUniformBuffers.end())
+        {
+            printf("%s : %d render job \"%s\" has no uniform buffer \"%s\"\n",
+                __FILE__,
+                __LINE__,
+                jobName.c_str(),
+                shaderResourceName.c_str());
+            return UINT32_MAX;
+        }
+
+        uint32_t iBuffer = (uint32_t)mapUniformBuffers.size();
+        mapUniformBuffers.push_back(&bufferIter->second);
+        maiUniformBufferHandles[key] = iBuffer;
 
+        return iBuffer;
     }
 
     /*
     **
     */
-    wgpu::Texture& CRenderer::getSwapChainTexture()
+    wgpu::Texture& CRenderer::getSwapChainTexture(uint32_t iFrame)
     {
         //wgpu::Texture& swapChainTexture = maRenderJobs["Outline Graphics"]->mOutputImageAttachments["Line Output"];
         //wgpu::Texture& swapChainTexture = maRenderJobs["Ambient Occlusion Graphics"]->mOutputImageAttachments["Indirect Lighting Output"];
@@ -791,7 +1150,8 @@ namespace Render
         //wgpu::Texture& swapChainTexture = maRenderJobs["Ambient Occlusion Graphics"]->mOutputImageAttachments["Ambient Occlusion Output"];
         //wgpu::Texture& swapChainTexture = maRenderJobs["TAA Graphics"]->mOutputImageAttachments["TAA Output"];
         //wgpu::Texture& swapChainTexture = maRenderJobs["Mesh Selection Graphics"]->mOutputImageAttachments["Selection Output"];
-        wgpu::Texture& swapChainTexture = maRenderJobs[mSwapChainRenderJobName]->mOutputImageAttachments[mSwapChainAttachmentName];
+        assert(miSwapChainRenderJob != UINT32_MAX);
+        wgpu::Texture& swapChainTexture = *mapRenderJobs[miSwapChainRenderJob]->getOutputTexture(mSwapChainAttachmentName, iFrame);
         //wgpu::Texture& swapChainTexture = maRenderJobs["Diffuse Temporal Restir Graphics"]->mOutputImageAttachments["Radiance Output"];
         //wgpu::Texture& swapChainTexture = maRenderJobs["Diffuse Temporal Restir Graphics"]->mOutputImageAttachments["Sample Ray Direction Output"];
         //wgpu::Texture& swapChainTexture = maRenderJobs["Spherical Harmonics Diffuse Graphics"]->mOutputImageAttachments["Inverse Spherical Harmonics Output"];
@@ -808,6 +1168,24 @@ namespace Render
         return swapChainTexture;
     }
 
+    /*
+    **
+    */
+    void CRenderer::setSwapChainOutput(
+        char const* szRenderJobName,
+        char const* szOutputAttachmentName)
+    {
+        mSwapChainRenderJobName = szRenderJobName;
+        mSwapChainAttachmentName = szOutputAttachmentName;
+
+        // before the render jobs exist resolveFrameResources() picks it up
+        if(mapRenderJobs.size() > 0)
+        {
+            miSwapChainRenderJob = getRenderJobHandle(mSwapChainRenderJobName);
+        }
+        mbRenderGraphDirty = true;
+    }
+
     /*
     **
     */
@@ -849,6 +1227,17 @@ namespace Render
     {
         bool bRet = true;
 
+        if(bufferName == "visibilityFlags")
+        {
+            invalidateMeshRenderBundles();
+        }
+
+        if(bufferName == "visibilityFlags" && mpMeshStreamer)
+        {
+            writeVisibilityFlags((uint32_t const*)pData, iOffset, iDataSize);
+            return bRet;
+        }
+
         assert(maBuffers.find(bufferName) != maBuffers.end());
         mpDevice->GetQueue().WriteBuffer(
             maBuffers[bufferName],
@@ -863,28 +1252,402 @@ namespace Render
     /*
     **
     */
-    void CRenderer::highLightSelectedMesh(int32_t iX, int32_t iY)
+    void CRenderer::writeVisibilityFlags(
+        uint32_t const* aiVisibilityFlags,
+        uint32_t iOffset,
+        uint32_t iDataSize)
     {
-        mCaptureImageName = "Selection Output";
-        mCaptureImageJobName = "Mesh Selection Graphics";
-        mCaptureUniformBufferName = "selectedMesh";
+        // the flags passed in are the caller's, meshes still streaming in stay hidden
+        uint32_t iStartMesh = iOffset / sizeof(uint32_t);
+        uint32_t iNumFlags = iDataSize / sizeof(uint32_t);
+        maiResidentVisibilityFlags.resize(iNumFlags);
+        for(uint32_t i = 0; i < iNumFlags; i++)
+        {
+            uint32_t iFlag = aiVisibilityFlags ? aiVisibilityFlags[i] : 1;
+            maiResidentVisibilityFlags[i] = mpMeshStreamer->isResident(iStartMesh + i) ? iFlag : 0;
+        }
 
-        mSelectedCoord = int2(iX, iY);
-        mSelectMeshInfo.miMeshID = 0;
+        mpDevice->GetQueue().WriteBuffer(
+            maBuffers["visibilityFlags"],
+            iOffset,
+            maiResidentVisibilityFlags.data(),
+            iNumFlags * sizeof(uint32_t)
+        );
+
+        invalidateMeshRenderBundles();
     }
 
     /*
     **
     */
-    CRenderer::SelectMeshInfo const& CRenderer::getSelectionInfo()
+    wgpu::RenderBundle const& CRenderer::getMeshRenderBundle(uint32_t iRenderJob)
     {
-        return mSelectMeshInfo;
+        std::vector<wgpu::RenderBundle>& aRenderBundles = maaMeshRenderBundles[miFrame & 1];
+        if(aRenderBundles.size() != mapRenderJobs.size())
+        {
+            aRenderBundles.resize(mapRenderJobs.size());
+        }
+
+        if(aRenderBundles[iRenderJob])
+        {
+            return aRenderBundles[iRenderJob];
+        }
+
+        Render::CRenderJob* pRenderJob = mapRenderJobs[iRenderJob];
+
+        auto startTime = std::chrono::high_resolution_clock::now();
+
+        std::string label = pRenderJob->mName + " Mesh Render Bundle";
+        wgpu::RenderBundleEncoderDescriptor bundleEncoderDesc = {};
+        bundleEncoderDesc.label = label.c_str();
+        bundleEncoderDesc.colorFormatCount = pRenderJob->mOutputImageFormats.size();
+        bundleEncoderDesc.colorFormats = pRenderJob->mOutputImageFormats.data();
+        bundleEncoderDesc.depthStencilFormat = wgpu::TextureFormat::Depth32Float;
+        bundleEncoderDesc.sampleCount = 1;
+        wgpu::RenderBundleEncoder bundleEncoder = mpDevice->CreateRenderBundleEncoder(&bundleEncoderDesc);
+
+        // bundles don't inherit the pass state
+        std::vector<wgpu::BindGroup> const& aBindGroups = pRenderJob->getBindGroups(miFrame);
+        for(uint32_t iGroup = 0; iGroup < (uint32_t)aBindGroups.size(); iGroup++)
+        {
+            bundleEncoder.SetBindGroup(
+                iGroup,
+                aBindGroups[iGroup]);
+        }
+        bundleEncoder.SetPipeline(pRenderJob->mRenderPipeline);
+        bundleEncoder.SetIndexBuffer(
+            *getFrameBuffer(FrameBuffer::TrainIndex),
+            wgpu::IndexFormat::Uint32
+        );
+        bundleEncoder.SetVertexBuffer(
+            0,
+            *getFrameBuffer(FrameBuffer::TrainVertex)
+        );
+
+        uint32_t iNumDraws = 0;
+        wgpu::Buffer& drawCallBuffer = *maMeshDrawBuffers[iRenderJob].mpDrawCalls;
+        for(uint32_t iMesh = 0; iMesh < (uint32_t)maMeshTriangleRanges.size(); iMesh++)
+        {
+            if(maiVisibilityFlags[iMesh] >= 1 && (!mpMeshStreamer || mpMeshStreamer->isResident(iMesh)))
+            {
+                bundleEncoder.DrawIndexedIndirect(
+                    drawCallBuffer,
+                    iMesh * 5 * sizeof(uint32_t)
+                );
+                ++iNumDraws;
+            }
+        }
+
+        aRenderBundles[iRenderJob] = bundleEncoder.Finish();
+
+        uint64_t iElapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - startTime).count();
+        DEBUG_PRINTF("recorded \"%s\" render bundle, %d of %d meshes in %.2f ms\n",
+            pRenderJob->mName.c_str(),
+            iNumDraws,
+            (uint32_t)maMeshTriangleRanges.size(),
+            (float)iElapsed / 1000.0f);
+
+        return aRenderBundles[iRenderJob];
     }
 
     /*
     **
     */
-    void CRenderer::setupFontPipeline()
+    void CRenderer::highLightSelectedMesh(int32_t iX, int32_t iY)
+    {
+        mCaptureImageName = "Selection Output";
+        mCaptureImageJobName = "Mesh Selection Graphics";
+        mCaptureUniformBufferName = "selectedMesh";
+
+        mpCaptureUniformBuffer = nullptr;
+        auto captureIter = maiRenderJobHandles.find(mCaptureImageJobName);
+        if(captureIter != maiRenderJobHandles.end())
+        {
+            auto bufferIter = mapRenderJobs[captureIter->second]->mUniformBuffers.find(mCaptureUniformBufferName);
+            if(bufferIter != mapRenderJobs[captureIter->second]->mUniformBuffers.end())
+            {
+                mpCaptureUniformBuffer = &bufferIter->second;
+            }
+        }
+
+        mSelectedCoord = int2(iX, iY);
+        mSelectMeshInfo.miMeshID = 0;
+    }
+
+    /*
+    **
+    */
+    CRenderer::SelectMeshInfo const& CRenderer::getSelectionInfo()
+    {
+        return mSelectMeshInfo;
+    }
+
+    /*
+    **
+    */
+    void CRenderer::printPipelineCreateTime(
+        std::string const& name,
+        std::chrono::high_resolution_clock::time_point const& startTime,
+        CPipelineCache::Stats const& startStats)
+    {
+        double fElapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+        mfTotalPipelineCreateTime += fElapsed;
+
+        CPipelineCache::Stats stats = getPipelineCacheStats();
+        printf("pipeline \"%s\" %.2f ms, %d cache hits, %d misses\n",
+            name.c_str(),
+            fElapsed,
+            stats.miNumHits - startStats.miNumHits,
+            stats.miNumMisses - startStats.miNumMisses);
+    }
+
+    /*
+    **
+    */
+    void CRenderer::buildRenderGraph()
+    {
+        for(auto const& renderJobName : maOrderedRenderJobs)
+        {
+            mRenderGraph.addJob(renderJobName);
+        }
+
+        for(auto const& renderJobName : maOrderedRenderJobs)
+        {
+            Render::CRenderJob* pRenderJob = maRenderJobs[renderJobName].get();
+            for(auto const& parentJobName : pRenderJob->maParentJobNames)
+            {
+                mRenderGraph.addLink(renderJobName, parentJobName);
+            }
+
+            // mesh draws are indirect from the sort job's draw calls, or the compacted indices
+            if(Render::isMeshPass(pRenderJob->mPassType))
+            {
+                bool bCompacted = (maMeshDrawBuffers[getRenderJobHandle(renderJobName)].mpCompactedIndices != nullptr);
+                mRenderGraph.addLink(renderJobName, bCompacted ? pRenderJob->mMeshCompactionJobName : pRenderJob->mMeshDrawCallJobName);
+            }
+
+            // the renderer's buffers and textures written by one job and read by another
+            for(auto const& resourceName : pRenderJob->maExternalReads)
+            {
+                for(auto const& writerJobName : maOrderedRenderJobs)
+                {
+                    auto const& aWrites = maRenderJobs[writerJobName]->maExternalWrites;
+                    if(writerJobName != renderJobName && std::find(aWrites.begin(), aWrites.end(), resourceName) != aWrites.end())
+                    {
+                        mRenderGraph.addLink(renderJobName, writerJobName);
+                    }
+                }
+            }
+        }
+
+        // draw text isn't a render job, its output comes from drawText()
+        bool bValid = mRenderGraph.validate({"Draw Text Graphics"});
+        assert(bValid);
+
+        // meshes not streamed in yet are zeroed triangles in the buffers the bvh points into, ray traced
+        // jobs stay off until the streamer is done
+        if(mpMeshStreamer)
+        {
+            setRayTracedJobsEnabled(false);
+        }
+        mbRenderGraphDirty = true;
+    }
+
+    /*
+    **
+    */
+    void CRenderer::setRayTracedJobsEnabled(bool bEnabled)
+    {
+        for(auto const& renderJobName : maOrderedRenderJobs)
+        {
+            auto const& aReads = maRenderJobs[renderJobName]->maExternalReads;
+            if(std::find(aReads.begin(), aReads.end(), "bvhNodes") != aReads.end())
+            {
+                mRenderGraph.setJobEnabled(renderJobName, bEnabled);
+            }
+        }
+        mbRenderGraphDirty = true;
+    }
+
+    /*
+    **
+    */
+    void CRenderer::aliasTransientAttachments()
+    {
+        std::map<std::string, uint32_t> aiJobOrder;
+        for(uint32_t iJob = 0; iJob < (uint32_t)maOrderedRenderJobs.size(); iJob++)
+        {
+            aiJobOrder[maOrderedRenderJobs[iJob]] = iJob;
+        }
+
+        // every job's texture outputs, copy job and ping-pong outputs hold last frame's results and jobs
+        // that load their attachments build on last frame's contents
+        std::vector<CAliasPlanner::Attachment> aAttachments;
+        std::map<std::pair<std::string, std::string>, uint32_t> aiAttachmentIndices;
+        std::vector<bool> abRead;
+        for(uint32_t iJob = 0; iJob < (uint32_t)maOrderedRenderJobs.size(); iJob++)
+        {
+            Render::CRenderJob* pRenderJob = maRenderJobs[maOrderedRenderJobs[iJob]].get();
+
+            // ray traced jobs are off while meshes stream in, their readers see the cleared outputs rather
+            // than another job's
+            auto const& aReads = pRenderJob->maExternalReads;
+            bool bTurnedOff = (mpMeshStreamer && std::find(aReads.begin(), aReads.end(), "bvhNodes") != aReads.end());
+
+            for(auto const& keyValue : pRenderJob->mOutputImageAttachments)
+            {
+                CAliasPlanner::Attachment attachment;
+                attachment.mJobName = pRenderJob->mName;
+                attachment.mName = keyValue.first;
+                attachment.mFormat = keyValue.second.GetFormat();
+                attachment.miWidth = keyValue.second.GetWidth();
+                attachment.miHeight = keyValue.second.GetHeight();
+                attachment.miFirstUse = attachment.miLastUse = iJob;
+                attachment.mbPersistent = (pRenderJob->mType == Render::JobType::Copy || pRenderJob->mLoadOp == wgpu::LoadOp::Load || pRenderJob->isPingPong(keyValue.first) || bTurnedOff);
+
+                aiAttachmentIndices[std::make_pair(attachment.mJobName, attachment.mName)] = (uint32_t)aAttachments.size();
+                aAttachments.push_back(attachment);
+                abRead.push_back(false);
+            }
+        }
+
+        // extend to the last reader, a reader at or before the writer gets last frame's contents
+        for(uint32_t iJob = 0; iJob < (uint32_t)maOrderedRenderJobs.size(); iJob++)
+        {
+            Render::CRenderJob* pRenderJob = maRenderJobs[maOrderedRenderJobs[iJob]].get();
+            for(auto const& link : pRenderJob->maInputTextureLinks)
+            {
+                auto iter = aiAttachmentIndices.find(link);
+                if(iter == aiAttachmentIndices.end())
+                {
+                    continue;
+                }
+
+                CAliasPlanner::Attachment& attachment = aAttachments[iter->second];
+                abRead[iter->second] = true;
+                if(attachment.miFirstUse >= iJob)
+                {
+                    attachment.mbPersistent = true;
+                }
+                attachment.miLastUse = std::max(attachment.miLastUse, iJob);
+            }
+        }
+
+        // outputs no job reads are for the swap chain or debug views, they have to last past the frame
+        for(uint32_t i = 0; i < (uint32_t)aAttachments.size(); i++)
+        {
+            if(!abRead[i])
+            {
+                aAttachments[i].mbPersistent = true;
+            }
+        }
+
+        CAliasPlanner planner;
+        uint32_t iNumPhysical = planner.plan(aAttachments);
+
+        // first attachment in each physical texture keeps its texture, the rest take it over
+        std::vector<wgpu::Texture> aPhysicalTextures(iNumPhysical);
+        std::vector<uint32_t> aiSortedAttachments(aAttachments.size());
+        for(uint32_t i = 0; i < (uint32_t)aAttachments.size(); i++)
+        {
+            aiSortedAttachments[i] = i;
+        }
+        std::stable_sort(
+            aiSortedAttachments.begin(),
+            aiSortedAttachments.end(),
+            [&](uint32_t iLeft, uint32_t iRight)
+            {
+                return aAttachments[iLeft].miFirstUse < aAttachments[iRight].miFirstUse;
+            });
+        for(uint32_t iAttachment : aiSortedAttachments)
+        {
+            CAliasPlanner::Attachment const& attachment = aAttachments[iAttachment];
+            Render::CRenderJob* pRenderJob = maRenderJobs[attachment.mJobName].get();
+            wgpu::Texture& physicalTexture = aPhysicalTextures[attachment.miPhysical];
+            if(physicalTexture == nullptr)
+            {
+                physicalTexture = pRenderJob->mOutputImageAttachments[attachment.mName];
+                continue;
+            }
+
+            pRenderJob->aliasOutputAttachment(attachment.mName, physicalTexture);
+            maAliasedAttachments.push_back(std::make_pair(attachment.mJobName, attachment.mName));
+        }
+
+        planner.printStats();
+    }
+
+    /*
+    **
+    */
+    bool CRenderer::updatePipelineStatus()
+    {
+        if(maiPendingPipelineJobs.empty())
+        {
+            return true;
+        }
+
+        for(auto iter = maiPendingPipelineJobs.begin(); iter != maiPendingPipelineJobs.end();)
+        {
+            Render::CRenderJob* pRenderJob = mapRenderJobs[*iter];
+            if(pRenderJob->mPipelineState == Render::CRenderJob::PipelineState::Pending)
+            {
+                ++iter;
+                continue;
+            }
+
+            if(pRenderJob->isReady())
+            {
+                printf("pipeline \"%s\" ready in %.2f ms, %d cache hits, %d misses\n",
+                    pRenderJob->mName.c_str(),
+                    pRenderJob->mfPipelineCreateTime,
+                    pRenderJob->miPipelineCacheHits,
+                    pRenderJob->miPipelineCacheMisses);
+            }
+            iter = maiPendingPipelineJobs.erase(iter);
+        }
+
+        if(maiPendingPipelineJobs.empty())
+        {
+            double fElapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - mPipelineIssueTime).count();
+            printf("all render job pipelines ready %.2f ms after issue\n", fElapsed);
+            if(mCreateDesc.mpPipelineCache != nullptr)
+            {
+                mCreateDesc.mpPipelineCache->printStats();
+            }
+        }
+
+        return maiPendingPipelineJobs.empty();
+    }
+
+    /*
+    **
+    */
+    void CRenderer::waitForPipelines()
+    {
+        while(!updatePipelineStatus())
+        {
+#if defined(__EMSCRIPTEN__)
+            emscripten_sleep(1);
+#else
+            mCreateDesc.mpInstance->ProcessEvents();
+            std::this_thread::yield();
+#endif // __EMSCRIPTEN__
+        }
+    }
+
+    /*
+    **
+    */
+    CPipelineCache::Stats CRenderer::getPipelineCacheStats() const
+    {
+        return (mCreateDesc.mpPipelineCache != nullptr) ? mCreateDesc.mpPipelineCache->getStats() : CPipelineCache::Stats();
+    }
+
+    /*
+    **
+    */
+    void CRenderer::setupFontPipeline()
     {
         // output texture for draw text
         wgpu::TextureFormat aViewFormats[] = {wgpu::TextureFormat::RGBA8Unorm};
@@ -1110,7 +1873,7 @@ namespace Render
     **
     */
     void CRenderer::drawText(
-        std::vector<wgpu::CommandBuffer>& aCommandBuffers,
+        wgpu::CommandEncoder& commandEncoder,
         std::string const& text, 
         uint32_t iX, 
         uint32_t iY, 
@@ -1175,9 +1938,6 @@ namespace Render
             sizeof(UniformData)
         );
 
-        wgpu::CommandEncoderDescriptor commandEncoderDesc = {};
-        wgpu::CommandEncoder commandEncoder = mpDevice->CreateCommandEncoder(&commandEncoderDesc);
-
         wgpu::RenderPassColorAttachment attachment
         {
             .view = mFontOutputAttachment.CreateView(),
@@ -1222,157 +1982,513 @@ namespace Render
          
         renderPassEncoder.PopDebugGroup();
         renderPassEncoder.End();
+    }
 
-        wgpu::CommandBuffer commandBuffer = commandEncoder.Finish();
-        aCommandBuffers.push_back(commandBuffer);
+    /*
+    **
+    */
+    void CRenderer::decodeImage(
+        DecodedImage& image,
+        std::string const& filePath)
+    {
+        image.mFilePath = filePath;
 
+        // pre-decoded by obj_2_binary --cache-textures/--cache-image, nothing left to do but read it
+        Loader::TextureCache::Header header;
+        loadFileToVector(image.macCacheData, Loader::TextureCache::getCachePath(filePath));
+        if(Loader::TextureCache::parse(header, image.maCacheLevels, image.macCacheData.data(), image.macCacheData.size()) &&
+           header.miFormat == Loader::TextureCache::Format::RGBA8Unorm)
+        {
+            image.mpImageData = (uint8_t*)image.macCacheData.data() + image.maCacheLevels[0].miOffset;
+            image.miWidth = (int32_t)header.miWidth;
+            image.miHeight = (int32_t)header.miHeight;
+            return;
+        }
+        image.macCacheData = std::vector<char>();
+        image.maCacheLevels.clear();
+
+        std::vector<char> acImageData;
+        loadFileToVector(acImageData, filePath);
+
+        int32_t iImageComp = 0;
+        image.mpImageData = stbi_load_from_memory(
+            (stbi_uc const*)acImageData.data(),
+            (int32_t)acImageData.size(),
+            &image.miWidth,
+            &image.miHeight,
+            &iImageComp,
+            4
+        );
     }
 
     /*
     **
     */
-    void CRenderer::loadMeshes()
+    void CRenderer::freeImage(DecodedImage& image)
     {
-#if defined(__EMSCRIPTEN__)
-        char* acTriangleBuffer = nullptr;
-        uint64_t iSize = Loader::loadFile(&acTriangleBuffer, mCreateDesc.mMeshFilePath + "-triangles.bin");
-        printf("acTriangleBuffer = 0x%X size: %lld\n", (uint32_t)acTriangleBuffer, iSize);
-        uint32_t const* piData = (uint32_t const*)acTriangleBuffer;
-#else 
-        std::vector<char> acTriangleBuffer;
-        Loader::loadFile(acTriangleBuffer, mCreateDesc.mMeshFilePath + "-triangles.bin");
-        uint32_t const* piData = (uint32_t const*)acTriangleBuffer.data();
-#endif // __EMSCRIPTEN__
+        if(image.macCacheData.size() == 0)
+        {
+            stbi_image_free(image.mpImageData);
+        }
+        image.mpImageData = nullptr;
+        image.macCacheData = std::vector<char>();
+        image.maCacheLevels.clear();
+        image.miFormat = Loader::TextureCache::Format::RGBA8Unorm;
+    }
 
-        uint32_t iNumMeshes = *piData++;
-        uint32_t iNumTotalVertices = *piData++;
-        uint32_t iNumTotalTriangles = *piData++;
-        uint32_t iVertexSize = *piData++;
-        uint32_t iTriangleStartOffset = *piData++;
+    /*
+    **
+    */
+    uint32_t CRenderer::getNumMipLevels(DecodedImage const& image)
+    {
+        return std::max((uint32_t)image.maCacheLevels.size(), 1u);
+    }
 
-        printf("num meshes: %d\n", iNumMeshes);
-        printf("num total vertices: %d\n", iNumTotalVertices);
+    /*
+    **
+    */
+    // level 0 and any cached levels below it
+    void CRenderer::writeImage(
+        wgpu::Texture const& texture,
+        DecodedImage const& image,
+        uint32_t iArrayLayer)
+    {
+        if(image.maCacheLevels.size() == 0)
+        {
+            mUploadManager.writeTexture(texture, 0, 0, image.miWidth, image.miHeight, 4, image.mpImageData, 0, iArrayLayer);
+            return;
+        }
 
-        // triangle ranges for all the meshes
-        maMeshTriangleRanges.resize(iNumMeshes);
-        memcpy(maMeshTriangleRanges.data(), piData, sizeof(MeshTriangleRange) * iNumMeshes);
-        piData += (2 * iNumMeshes);
+        uint32_t iBytesPerBlock = Loader::TextureCache::getBytesPerBlock(image.miFormat);
+        for(uint32_t iMip = 0; iMip < (uint32_t)image.maCacheLevels.size(); iMip++)
+        {
+            Loader::TextureCache::Level const& level = image.maCacheLevels[iMip];
+            if(iBytesPerBlock > 0)
+            {
+                mUploadManager.writeCompressedTexture(
+                    texture,
+                    0,
+                    0,
+                    level.miWidth,
+                    level.miHeight,
+                    iBytesPerBlock,
+                    image.macCacheData.data() + level.miOffset,
+                    iMip,
+                    iArrayLayer);
+                continue;
+            }
 
-        // the total mesh extent is at the very end of the list
-        MeshExtent const* pMeshExtent = (MeshExtent const*)piData;
-        maMeshExtents.resize(iNumMeshes + 1);
-        memcpy(maMeshExtents.data(), pMeshExtent, sizeof(MeshExtent) * (iNumMeshes + 1));
-        pMeshExtent += (iNumMeshes + 1);
-        mTotalMeshExtent = maMeshExtents.back();
+            mUploadManager.writeTexture(
+                texture,
+                0,
+                0,
+                level.miWidth,
+                level.miHeight,
+                4,
+                image.macCacheData.data() + level.miOffset,
+                iMip,
+                iArrayLayer);
+        }
+    }
+
+    /*
+    **
+    */
+    // whole triangle file and its counts, the geometry is decoded once the mapped buffers exist
+    void CRenderer::fetchMeshes()
+    {
+        if(mCreateDesc.mbProgressiveMeshLoading && fetchMeshStreamingHeaders())
+        {
+            mSetupData.mbStreamMeshes = true;
+        }
+        else
+        {
+            std::vector<char>& acTriangleBuffer = mSetupData.macTriangleFile;
+            loadFileToVector(acTriangleBuffer, mCreateDesc.mMeshFilePath + "-triangles.bin");
+            uint32_t const* piData = (uint32_t const*)acTriangleBuffer.data();
+            uint64_t iSize = acTriangleBuffer.size();
+
+            uint32_t iNumMeshes = 0;
+            uint32_t iNumTotalVertices = 0;
+            uint32_t iNumTotalTriangles = 0;
+            if(Loader::MeshCodec::isEncoded(piData, iSize))
+            {
+                // ranges and extents come out of the decode
+                bool bValid = Loader::MeshCodec::getDecodedCounts(
+                    iNumMeshes,
+                    iNumTotalVertices,
+                    iNumTotalTriangles,
+                    piData,
+                    iSize);
+                assert(bValid);
+                mSetupData.mbEncodedMeshes = true;
+            }
+            else
+            {
+                iNumMeshes = *piData++;
+                iNumTotalVertices = *piData++;
+                iNumTotalTriangles = *piData++;
+                uint32_t iVertexSize = *piData++;
+                uint32_t iTriangleStartOffset = *piData++;
+
+                // triangle ranges for all the meshes
+                maMeshTriangleRanges.resize(iNumMeshes);
+                memcpy(maMeshTriangleRanges.data(), piData, sizeof(MeshTriangleRange) * iNumMeshes);
+                piData += (2 * iNumMeshes);
+
+                // the total mesh extent is at the very end of the list
+                MeshExtent const* pMeshExtent = (MeshExtent const*)piData;
+                maMeshExtents.resize(iNumMeshes + 1);
+                memcpy(maMeshExtents.data(), pMeshExtent, sizeof(MeshExtent) * (iNumMeshes + 1));
+                pMeshExtent += (iNumMeshes + 1);
+                mTotalMeshExtent = maMeshExtents.back();
+
+                // vertices followed by the triangle indices
+                mSetupData.miMeshVertexDataOffset = (uint64_t)((char const*)pMeshExtent - acTriangleBuffer.data());
+            }
 
-        // all the mesh vertices
-        std::vector<Vertex> aTotalMeshVertices(iNumTotalVertices);
-        Vertex const* pVertices = (Vertex const*)pMeshExtent;
-        memcpy(aTotalMeshVertices.data(), pVertices, iNumTotalVertices * sizeof(Vertex));
-        pVertices += iNumTotalVertices;
+            mSetupData.miNumMeshVertices = iNumTotalVertices;
+            mSetupData.miNumMeshTriangles = iNumTotalTriangles;
 
-        // all the triangle indices
-        std::vector<uint32_t> aiTotalMeshTriangleIndices(iNumTotalTriangles * 3);
-        piData = (uint32_t const*)pVertices;
-        memcpy(aiTotalMeshTriangleIndices.data(), piData, iNumTotalTriangles * 3 * sizeof(uint32_t));
+            printf("num meshes: %d\n", iNumMeshes);
+            printf("num total vertices: %d\n", iNumTotalVertices);
+        }
 
-#if defined(__EMSCRIPTEN__)
-        Loader::loadFileFree(acTriangleBuffer);
-#endif // __EMSCRIPTEN__
+        loadFileToVector(mSetupData.macMaterialIDs, mCreateDesc.mMeshFilePath + ".mid");
+        loadFileToVector(mSetupData.macMaterials, mCreateDesc.mMeshFilePath + ".mat");
+        printf("mesh material size: %d\n", (uint32_t)mSetupData.macMaterials.size());
+    }
+
+    /*
+    **
+    */
+    // vertex and index buffers are created mapped so the geometry is decoded straight into them
+    void CRenderer::allocateMeshBuffers()
+    {
+        if(mSetupData.mbStreamMeshes)
+        {
+            return;
+        }
 
         wgpu::BufferDescriptor bufferDesc = {};
 
-        bufferDesc.size = iNumTotalVertices * sizeof(Vertex);
+        bufferDesc.size = (uint64_t)mSetupData.miNumMeshVertices * sizeof(Vertex);
         bufferDesc.usage = wgpu::BufferUsage::Vertex | wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst;
-        maBuffers["train-vertex-buffer"] = mpDevice->CreateBuffer(&bufferDesc);
+        mSetupData.mpMappedVertices = mUploadManager.createMappedBuffer(maBuffers["train-vertex-buffer"], bufferDesc);
         maBuffers["train-vertex-buffer"].SetLabel("Train Vertex Buffer");
         maBufferSizes["train-vertex-buffer"] = (uint32_t)bufferDesc.size;
 
-        bufferDesc.size = aiTotalMeshTriangleIndices.size() * sizeof(uint32_t);
+        bufferDesc.size = (uint64_t)mSetupData.miNumMeshTriangles * 3 * sizeof(uint32_t);
         bufferDesc.usage = wgpu::BufferUsage::Index | wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst;
-        maBuffers["train-index-buffer"] = mpDevice->CreateBuffer(&bufferDesc);
+        mSetupData.mpMappedTriangleIndices = mUploadManager.createMappedBuffer(maBuffers["train-index-buffer"], bufferDesc);
         maBuffers["train-index-buffer"].SetLabel("Train Index Buffer");
         maBufferSizes["train-index-buffer"] = (uint32_t)bufferDesc.size;
+    }
 
-        bufferDesc.size = iNumTotalVertices * sizeof(Vertex);
-        bufferDesc.usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst;
-        maBuffers["meshTriangleIndexRanges"] = mpDevice->CreateBuffer(&bufferDesc);
-        maBuffers["meshTriangleIndexRanges"].SetLabel("Mesh Triangle Ranges");
-        maBufferSizes["meshTriangleIndexRanges"] = (uint32_t)bufferDesc.size;
-
-        bufferDesc.size = (iNumMeshes + 1) * sizeof(MeshExtent);
-        bufferDesc.usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst;
-        maBuffers["meshExtents"] = mpDevice->CreateBuffer(&bufferDesc);
-        maBuffers["meshExtents"].SetLabel("Train Mesh Extents");
-        maBufferSizes["meshExtents"] = (uint32_t)bufferDesc.size;
+    /*
+    **
+    */
+    // worker stage, only touches the mapped memory, the buffers themselves stay with the main thread
+    void CRenderer::decodeMeshes()
+    {
+        if(mSetupData.mbStreamMeshes)
+        {
+            return;
+        }
 
-        mpDevice->GetQueue().WriteBuffer(maBuffers["train-vertex-buffer"], 0, aTotalMeshVertices.data(), iNumTotalVertices * sizeof(Vertex));
-        mpDevice->GetQueue().WriteBuffer(maBuffers["train-index-buffer"], 0, aiTotalMeshTriangleIndices.data(), aiTotalMeshTriangleIndices.size() * sizeof(uint32_t));
-        mpDevice->GetQueue().WriteBuffer(maBuffers["meshTriangleIndexRanges"], 0, maMeshTriangleRanges.data(), maMeshTriangleRanges.size() * sizeof(MeshTriangleRange));
-        mpDevice->GetQueue().WriteBuffer(maBuffers["meshExtents"], 0, maMeshExtents.data(), maMeshExtents.size() * sizeof(MeshExtent));
+        std::vector<char>& acTriangleBuffer = mSetupData.macTriangleFile;
+        uint32_t iNumMeshes = 0;
+        if(mSetupData.mbEncodedMeshes)
+        {
+            // quantized and delta coded geometry, decodes into the same layout as the raw file
+            std::vector<Loader::MeshCodec::Range> aRanges;
+            std::vector<Loader::MeshCodec::Extent> aExtents;
+            bool bDecoded = Loader::MeshCodec::decode(
+                aRanges,
+                aExtents,
+                (Loader::MeshCodec::Vertex*)mSetupData.mpMappedVertices,
+                (uint32_t*)mSetupData.mpMappedTriangleIndices,
+                acTriangleBuffer.data(),
+                acTriangleBuffer.size());
+            assert(bDecoded);
+
+            iNumMeshes = (uint32_t)aRanges.size();
+            maMeshTriangleRanges.resize(iNumMeshes);
+            for(uint32_t iMesh = 0; iMesh < iNumMeshes; iMesh++)
+            {
+                maMeshTriangleRanges[iMesh].miStart = aRanges[iMesh].miStart;
+                maMeshTriangleRanges[iMesh].miEnd = aRanges[iMesh].miEnd;
+            }
 
+            // the last extent is the total
+            maMeshExtents.resize(iNumMeshes + 1);
+            for(uint32_t iMesh = 0; iMesh <= iNumMeshes; iMesh++)
+            {
+                maMeshExtents[iMesh].mMinPosition = aExtents[iMesh].mMinPosition;
+                maMeshExtents[iMesh].mMaxPosition = aExtents[iMesh].mMaxPosition;
+            }
+            mTotalMeshExtent = maMeshExtents.back();
+        }
+        else
         {
-#if defined(__EMSCRIPTEN__)
-            char* acMaterialID = nullptr;
-            bufferDesc.size = Loader::loadFile(&acMaterialID, mCreateDesc.mMeshFilePath + ".mid");
-#else 
+            uint64_t iVertexDataSize = (uint64_t)mSetupData.miNumMeshVertices * sizeof(Vertex);
+            uint64_t iIndexDataSize = (uint64_t)mSetupData.miNumMeshTriangles * 3 * sizeof(uint32_t);
+            char const* pcVertexData = acTriangleBuffer.data() + mSetupData.miMeshVertexDataOffset;
+            assert(mSetupData.miMeshVertexDataOffset + iVertexDataSize + iIndexDataSize <= acTriangleBuffer.size());
 
-            std::vector<char> acMaterialID;
-            Loader::loadFile(acMaterialID, mCreateDesc.mMeshFilePath + ".mid");
-            bufferDesc.size = acMaterialID.size();
-#endif // __EMSCRIPTEN__
+            memcpy(mSetupData.mpMappedVertices, pcVertexData, iVertexDataSize);
+            memcpy(mSetupData.mpMappedTriangleIndices, pcVertexData + iVertexDataSize, iIndexDataSize);
+        }
 
-            bufferDesc.usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst;
-            maBuffers["meshMaterialIDs"] = mpDevice->CreateBuffer(&bufferDesc);
-            maBuffers["meshMaterialIDs"].SetLabel("Mesh Material IDs");
-            maBufferSizes["meshEmeshMaterialIDsxtents"] = (uint32_t)bufferDesc.size;
+        acTriangleBuffer = std::vector<char>();
+    }
+
+    /*
+    **
+    */
+    void CRenderer::uploadMeshes()
+    {
+        if(mSetupData.mbStreamMeshes)
+        {
+            createMeshStreamer();
+        }
+        else
+        {
+            maBuffers["train-vertex-buffer"].Unmap();
+            maBuffers["train-index-buffer"].Unmap();
+            mSetupData.mpMappedVertices = nullptr;
+            mSetupData.mpMappedTriangleIndices = nullptr;
+
+            uint32_t iNumMeshes = (uint32_t)maMeshTriangleRanges.size();
+
+            wgpu::BufferDescriptor bufferDesc = {};
+
+            bufferDesc.size = iNumMeshes * sizeof(MeshTriangleRange);
+            bufferDesc.usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst;
+            mUploadManager.createBufferWithData(
+                maBuffers["meshTriangleIndexRanges"],
+                bufferDesc,
+                maMeshTriangleRanges.data(),
+                maMeshTriangleRanges.size() * sizeof(MeshTriangleRange));
+            maBuffers["meshTriangleIndexRanges"].SetLabel("Mesh Triangle Ranges");
+            maBufferSizes["meshTriangleIndexRanges"] = (uint32_t)bufferDesc.size;
+
+            bufferDesc.size = (iNumMeshes + 1) * sizeof(MeshExtent);
+            bufferDesc.usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst;
+            mUploadManager.createBufferWithData(
+                maBuffers["meshExtents"],
+                bufferDesc,
+                maMeshExtents.data(),
+                maMeshExtents.size() * sizeof(MeshExtent));
+            maBuffers["meshExtents"].SetLabel("Train Mesh Extents");
+            maBufferSizes["meshExtents"] = (uint32_t)bufferDesc.size;
+        }
+
+        uploadMeshMaterials();
+    }
+
+    /*
+    **
+    */
+    // mesh header, ranges and extents up front, vertices and indices are streamed in per mesh in draw()
+    bool CRenderer::fetchMeshStreamingHeaders()
+    {
+        std::string triangleFilePath = mCreateDesc.mMeshFilePath + "-triangles.bin";
+
+        // packed files can't be read in ranges
+        Loader::CAssetPack* pAssetPack = nullptr;
+        if(Loader::findInMountedAssetPacks(&pAssetPack, triangleFilePath) != nullptr)
+        {
+            return false;
+        }
+
+        // per mesh vertex spans written by obj_2_binary next to raw triangle files
+        struct ChunkFileHeader
+        {
+            char        macSignature[4];
+            uint32_t    miNumMeshes;
+            uint32_t    miNumVertices;
+            uint32_t    miNumTriangles;
+        };
+        std::string chunkFilePath = mCreateDesc.mMeshFilePath + "-mesh-chunks.bin";
+        std::vector<char> acChunkHeader;
+        if(!Loader::loadFileRange(acChunkHeader, chunkFilePath, 0, sizeof(ChunkFileHeader)))
+        {
+            printf("no mesh chunk file \"%s\", loading all the geometry up front\n", chunkFilePath.c_str());
+            return false;
+        }
+        ChunkFileHeader chunkHeader;
+        memcpy(&chunkHeader, acChunkHeader.data(), sizeof(ChunkFileHeader));
+        if(memcmp(chunkHeader.macSignature, "MCHK", 4) != 0)
+        {
+            return false;
+        }
+
+        // header of the raw triangle file, an encoded file won't match the chunk file's counts
+        std::vector<char> acTriangleHeader;
+        if(!Loader::loadFileRange(acTriangleHeader, triangleFilePath, 0, sizeof(uint32_t) * 5))
+        {
+            return false;
+        }
+        uint32_t aiTriangleHeader[5];
+        memcpy(aiTriangleHeader, acTriangleHeader.data(), sizeof(aiTriangleHeader));
+        uint32_t iNumMeshes = aiTriangleHeader[0];
+        uint32_t iNumTotalVertices = aiTriangleHeader[1];
+        uint32_t iNumTotalTriangles = aiTriangleHeader[2];
+        uint32_t iVertexSize = aiTriangleHeader[3];
+        if(iNumMeshes != chunkHeader.miNumMeshes ||
+           iNumTotalVertices != chunkHeader.miNumVertices ||
+           iNumTotalTriangles != chunkHeader.miNumTriangles ||
+           iVertexSize != sizeof(Vertex))
+        {
+            printf("%s : %d mesh chunk file doesn\'t match \"%s\", loading all the geometry up front\n",
+                __FILE__,
+                __LINE__,
+                triangleFilePath.c_str());
+            return false;
+        }
+
+        std::vector<char> acVertexRanges;
+        if(!Loader::loadFileRange(acVertexRanges, chunkFilePath, sizeof(ChunkFileHeader), iNumMeshes * sizeof(CMeshStreamer::Range)))
+        {
+            return false;
+        }
+
+        uint64_t iRangeOffset = sizeof(uint32_t) * 5;
+        uint64_t iRangeSize = iNumMeshes * sizeof(MeshTriangleRange);
+        uint64_t iExtentSize = (iNumMeshes + 1) * sizeof(MeshExtent);
+        std::vector<char> acRangesAndExtents;
+        if(!Loader::loadFileRange(acRangesAndExtents, triangleFilePath, iRangeOffset, iRangeSize + iExtentSize))
+        {
+            return false;
+        }
 
+        maMeshTriangleRanges.resize(iNumMeshes);
+        memcpy(maMeshTriangleRanges.data(), acRangesAndExtents.data(), iRangeSize);
+        maMeshExtents.resize(iNumMeshes + 1);
+        memcpy(maMeshExtents.data(), acRangesAndExtents.data() + iRangeSize, iExtentSize);
+        mTotalMeshExtent = maMeshExtents.back();
+
+        mSetupData.maStreamedVertexRanges.resize(iNumMeshes);
+        memcpy(mSetupData.maStreamedVertexRanges.data(), acVertexRanges.data(), iNumMeshes * sizeof(CMeshStreamer::Range));
+        mSetupData.miNumStreamedVertices = iNumTotalVertices;
+        mSetupData.miNumStreamedTriangles = iNumTotalTriangles;
+        mSetupData.miStreamedVertexDataOffset = iRangeOffset + iRangeSize + iExtentSize;
+
+        printf("num meshes: %d\n", iNumMeshes);
+        printf("num total vertices: %d (streamed)\n", iNumTotalVertices);
+
+        return true;
+    }
+
+    /*
+    **
+    */
+    void CRenderer::createMeshStreamer()
+    {
+        uint32_t iNumMeshes = (uint32_t)maMeshTriangleRanges.size();
+        uint32_t iNumTotalVertices = mSetupData.miNumStreamedVertices;
+        uint32_t iNumTotalTriangles = mSetupData.miNumStreamedTriangles;
+
+        // full size buffers, streamed meshes are written in place
+        wgpu::BufferDescriptor bufferDesc = {};
+
+        bufferDesc.size = iNumTotalVertices * sizeof(Vertex);
+        bufferDesc.usage = wgpu::BufferUsage::Vertex | wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst;
+        maBuffers["train-vertex-buffer"] = mpDevice->CreateBuffer(&bufferDesc);
+        maBuffers["train-vertex-buffer"].SetLabel("Train Vertex Buffer");
+        maBufferSizes["train-vertex-buffer"] = (uint32_t)bufferDesc.size;
+
+        bufferDesc.size = iNumTotalTriangles * 3 * sizeof(uint32_t);
+        bufferDesc.usage = wgpu::BufferUsage::Index | wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst;
+        maBuffers["train-index-buffer"] = mpDevice->CreateBuffer(&bufferDesc);
+        maBuffers["train-index-buffer"].SetLabel("Train Index Buffer");
+        maBufferSizes["train-index-buffer"] = (uint32_t)bufferDesc.size;
+
+        bufferDesc.size = iNumMeshes * sizeof(MeshTriangleRange);
+        bufferDesc.usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst;
+        mUploadManager.createBufferWithData(
+            maBuffers["meshTriangleIndexRanges"],
+            bufferDesc,
+            maMeshTriangleRanges.data(),
+            maMeshTriangleRanges.size() * sizeof(MeshTriangleRange));
+        maBuffers["meshTriangleIndexRanges"].SetLabel("Mesh Triangle Ranges");
+        maBufferSizes["meshTriangleIndexRanges"] = (uint32_t)bufferDesc.size;
+
+        bufferDesc.size = (iNumMeshes + 1) * sizeof(MeshExtent);
+        bufferDesc.usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst;
+        mUploadManager.createBufferWithData(
+            maBuffers["meshExtents"],
+            bufferDesc,
+            maMeshExtents.data(),
+            maMeshExtents.size() * sizeof(MeshExtent));
+        maBuffers["meshExtents"].SetLabel("Train Mesh Extents");
+        maBufferSizes["meshExtents"] = (uint32_t)bufferDesc.size;
+
+        std::vector<CMeshStreamer::Range> aTriangleRanges(iNumMeshes);
+        for(uint32_t iMesh = 0; iMesh < iNumMeshes; iMesh++)
+        {
+            aTriangleRanges[iMesh].miStart = maMeshTriangleRanges[iMesh].miStart;
+            aTriangleRanges[iMesh].miEnd = maMeshTriangleRanges[iMesh].miEnd;
+        }
+        std::vector<CMeshStreamer::Extent> aExtents(iNumMeshes + 1);
+        for(uint32_t iMesh = 0; iMesh <= iNumMeshes; iMesh++)
+        {
+            aExtents[iMesh].mMinPosition = maMeshExtents[iMesh].mMinPosition;
+            aExtents[iMesh].mMaxPosition = maMeshExtents[iMesh].mMaxPosition;
+        }
+
+        CMeshStreamer::CreateDescriptor streamerDesc = {};
+        streamerDesc.mpDevice = mpDevice;
+        streamerDesc.mVertexBuffer = maBuffers["train-vertex-buffer"];
+        streamerDesc.mIndexBuffer = maBuffers["train-index-buffer"];
+        streamerDesc.mFilePath = mCreateDesc.mMeshFilePath + "-triangles.bin";
+        streamerDesc.miVertexDataOffset = mSetupData.miStreamedVertexDataOffset;
+        streamerDesc.miIndexDataOffset = streamerDesc.miVertexDataOffset + (uint64_t)iNumTotalVertices * sizeof(Vertex);
+        streamerDesc.miVertexSize = sizeof(Vertex);
+        streamerDesc.miMaxUploadsPerFrame = std::max(mCreateDesc.miNumStreamedMeshesPerFrame, 1u);
 #if defined(__EMSCRIPTEN__)
-            mpDevice->GetQueue().WriteBuffer(
-                maBuffers["meshMaterialIDs"],
-                0,
-                acMaterialID,
-                bufferDesc.size);
-            Loader::loadFileFree(acMaterialID);
+        // range requests complete in place on web, don't stall the frame on more than one frame's worth
+        streamerDesc.miMaxRequestsInFlight = streamerDesc.miMaxUploadsPerFrame;
 #else
-            mpDevice->GetQueue().WriteBuffer(
+        streamerDesc.miMaxRequestsInFlight = streamerDesc.miMaxUploadsPerFrame * 2;
+#endif // __EMSCRIPTEN__
+        mpMeshStreamer = std::make_unique<CMeshStreamer>();
+        mpMeshStreamer->setup(streamerDesc, mSetupData.maStreamedVertexRanges, aTriangleRanges, aExtents);
+    }
+
+    /*
+    **
+    */
+    void CRenderer::uploadMeshMaterials()
+    {
+        uint32_t iNumMeshes = (uint32_t)maMeshTriangleRanges.size();
+        wgpu::BufferDescriptor bufferDesc = {};
+
+        {
+            std::vector<char> const& acMaterialID = mSetupData.macMaterialIDs;
+            bufferDesc.size = acMaterialID.size();
+            bufferDesc.usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst;
+            mUploadManager.createBufferWithData(
                 maBuffers["meshMaterialIDs"],
-                0,
+                bufferDesc,
                 acMaterialID.data(),
                 acMaterialID.size());
-#endif // __EMSCRIPTEN__
+            maBuffers["meshMaterialIDs"].SetLabel("Mesh Material IDs");
+            maBufferSizes["meshEmeshMaterialIDsxtents"] = (uint32_t)bufferDesc.size;
         }
 
         {
-#if defined(__EMSCRIPTEN__)
-            char* acMaterials = nullptr;
-            bufferDesc.size = Loader::loadFile(&acMaterials, mCreateDesc.mMeshFilePath + ".mat");
-            printf("mesh material size: %d\n", (uint32_t)bufferDesc.size);
-#else
-            std::vector<char> acMaterials;
-            Loader::loadFile(acMaterials, mCreateDesc.mMeshFilePath + ".mat");
-
+            std::vector<char> const& acMaterials = mSetupData.macMaterials;
             bufferDesc.size = acMaterials.size();
-#endif // __EMSCRIPTEN__
             bufferDesc.usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst;
-            maBuffers["meshMaterials"] = mpDevice->CreateBuffer(&bufferDesc);
-            maBuffers["meshMaterials"].SetLabel("Mesh Materials");
-            maBufferSizes["meshMaterials"] = (uint32_t)bufferDesc.size;
-
-#if defined(__EMSCRIPTEN__)
-            mpDevice->GetQueue().WriteBuffer(
-                maBuffers["meshMaterials"],
-                0,
-                acMaterials,
-                bufferDesc.size);
-            Loader::loadFileFree(acMaterials);
-#else 
-            mpDevice->GetQueue().WriteBuffer(
+            mUploadManager.createBufferWithData(
                 maBuffers["meshMaterials"],
-                0,
+                bufferDesc,
                 acMaterials.data(),
                 acMaterials.size());
-#endif // __EMSCRIPTEN__
+            maBuffers["meshMaterials"].SetLabel("Mesh Materials");
+            maBufferSizes["meshMaterials"] = (uint32_t)bufferDesc.size;
         }
 
         bufferDesc.size = iNumMeshes * sizeof(uint32_t);
@@ -1380,40 +2496,45 @@ namespace Render
         maBuffers["visibilityFlags"] = mpDevice->CreateBuffer(&bufferDesc);
         maBuffers["visibilityFlags"].SetLabel("Mesh Visibility Flags");
         maBufferSizes["visibilityFlags"] = (uint32_t)bufferDesc.size;
+
+        if(mpMeshStreamer)
+        {
+            // nothing is resident yet
+            writeVisibilityFlags(nullptr, 0, iNumMeshes * sizeof(uint32_t));
+        }
     }
 
     /*
     **
     */
-    // external data from external-data.json
-    void CRenderer::loadExternalData()
+    // external data from external-data.json, texture files are decoded here
+    void CRenderer::fetchExternalData()
     {
-        rapidjson::Document doc;
+        loadFileToVector(mSetupData.macExternalData, "render-jobs/external-data.json", true);
 
-#if defined(__EMSCRIPTEN__)
-        char* acFileContentBuffer = nullptr;
-        uint32_t iFileSize = Loader::loadFile(
-            &acFileContentBuffer,
-            "render-jobs/external-data.json",
-            true
-        );
-        assert(acFileContentBuffer);
-
-        DEBUG_PRINTF("loaded \"%s\" file size = %d\n", mCreateDesc.mRenderJobPipelineFilePath.c_str(), iFileSize);
+        rapidjson::Document doc;
+        doc.Parse(mSetupData.macExternalData.data());
 
-        doc.Parse(acFileContentBuffer);
-        DEBUG_PRINTF("%s : %d parsed\n", __FILE__, __LINE__);
-        Loader::loadFileFree(acFileContentBuffer);
-#else 
-        std::vector<char> acFileContentBuffer;
-        Loader::loadFile(
-            acFileContentBuffer,
-            "render-jobs/external-data.json",
-            true
-        );
+        auto externalDataEntries = doc["External Data"].GetArray();
+        for(auto& externalDataEntry : externalDataEntries)
+        {
+            std::string type = externalDataEntry["Type"].GetString();
+            if(type == "Texture")
+            {
+                std::string name = externalDataEntry["Name"].GetString();
+                std::string fileName = externalDataEntry["File"].GetString();
+                decodeImage(mSetupData.maExternalTextures[name], fileName);
+            }
+        }
+    }
 
-        doc.Parse(acFileContentBuffer.data());
-#endif //__EMSCRIPTEN__
+    /*
+    **
+    */
+    void CRenderer::uploadExternalData()
+    {
+        rapidjson::Document doc;
+        doc.Parse(mSetupData.macExternalData.data());
 
         auto externalDataEntries = doc["External Data"].GetArray();
         for(auto& externalDataEntry : externalDataEntries)
@@ -1437,27 +2558,15 @@ namespace Render
             }
             else if(type == "Texture")
             {
-                std::string fileName = externalDataEntry["File"].GetString();
-
-#if defined(__EMSCRIPTEN__)
-                char* acImageData = nullptr;
-                uint32_t iFileSize = Loader::loadFile(&acImageData, fileName);
-#else
-                std::vector<char> acBlueNoiseImageDataV;
-                Loader::loadFile(acBlueNoiseImageDataV, fileName);
-                char* acImageData = acBlueNoiseImageDataV.data();
-                uint32_t iFileSize = (uint32_t)acBlueNoiseImageDataV.size();
-#endif // __EMSCRIPTEN__
-
-                int32_t iImageWidth = 0, iImageHeight = 0, iNumComp = 0;
-                stbi_uc* pImageData = stbi_load_from_memory((stbi_uc const*)acImageData, iFileSize, &iImageWidth, &iImageHeight, &iNumComp, 4);
+                DecodedImage& image = mSetupData.maExternalTextures[name];
+                int32_t iImageWidth = image.miWidth, iImageHeight = image.miHeight;
 
                 wgpu::TextureFormat aViewFormats[] = {wgpu::TextureFormat::RGBA8Unorm};
                 wgpu::TextureDescriptor textureDesc = {};
                 textureDesc.usage = wgpu::TextureUsage::CopyDst | wgpu::TextureUsage::TextureBinding;
                 textureDesc.dimension = wgpu::TextureDimension::e2D;
                 textureDesc.format = wgpu::TextureFormat::RGBA8Unorm;
-                textureDesc.mipLevelCount = 1;
+                textureDesc.mipLevelCount = getNumMipLevels(image);
                 textureDesc.sampleCount = 1;
                 textureDesc.size.depthOrArrayLayers = 1;
                 textureDesc.size.width = iImageWidth;
@@ -1467,71 +2576,19 @@ namespace Render
                 maTextures[name] = mpDevice->CreateTexture(&textureDesc);
                 maTextures[name].SetLabel(name.c_str());
 
-#if defined(__EMSCRIPTEN__)
-                wgpu::TextureDataLayout layout = {};
-#else
-                wgpu::TexelCopyBufferLayout layout = {};
-#endif // __EMSCRIPTEN__
-                layout.bytesPerRow = iImageWidth * 4 * sizeof(char);
-                layout.offset = 0;
-                layout.rowsPerImage = iImageHeight;
-                wgpu::Extent3D extent = {};
-                extent.depthOrArrayLayers = 1;
-                extent.width = iImageWidth;
-                extent.height = iImageHeight;
-
-#if defined(__EMSCRIPTEN__)
-                wgpu::ImageCopyTexture destination = {};
-#else 
-                wgpu::TexelCopyTextureInfo destination = {};
-#endif // __EMSCRIPTEN__
-                destination.aspect = wgpu::TextureAspect::All;
-                destination.mipLevel = 0;
-                destination.origin = {.x = 0, .y = 0, .z = 0};
-                destination.texture = maTextures[name];
-                mpDevice->GetQueue().WriteTexture(
-                    &destination,
-                    pImageData,
-                    iImageWidth * iImageHeight * 4,
-                    &layout,
-                    &extent);
-
-                mpDevice->GetQueue().WriteTexture(
-                    &destination,
-                    pImageData,
-                    iImageWidth * iImageHeight * 4,
-                    &layout,
-                    &extent);
-
-#if defined(__EMSCRIPTEN__)
-                free(acImageData);
-#endif // __EMSCRIPTEN__
+                writeImage(maTextures[name], image);
+                freeImage(image);
             }
             else if(type == "Render Target")
             {
+                // shaders bind these as storage textures of the declared format, so no semantic downgrade here
                 wgpu::TextureDescriptor textureDesc = {};
-                textureDesc.format = wgpu::TextureFormat::RGBA32Float;
-
                 std::string format = externalDataEntry["Format"].GetString();
-                if(format == "rgba32float")
-                {
-                    textureDesc.format = wgpu::TextureFormat::RGBA32Float;
-                }
-                else if(format == "rgba16float")
-                {
-                    textureDesc.format = wgpu::TextureFormat::RGBA16Float;
-                }
-                else if(format == "rg32float")
-                {
-                    textureDesc.format = wgpu::TextureFormat::RG32Float;
-                }
-                else if(format == "r32float")
-                {
-                    textureDesc.format = wgpu::TextureFormat::R32Float;
-                }
-                else
+                textureDesc.format = FormatPolicy::parseFormat(format);
+                if(textureDesc.format == wgpu::TextureFormat::Undefined)
                 {
                     assert(!"not handled");
+                    textureDesc.format = wgpu::TextureFormat::RGBA32Float;
                 }
 
                 uint32_t iWidth = mCreateDesc.miScreenWidth;
@@ -1564,73 +2621,64 @@ namespace Render
                 maTextures[name].SetLabel(name.c_str());
             }
         }
+
+        mUploadManager.flush();
     }
 
     /*
     **
     */
-    void CRenderer::loadBVH()
+    void CRenderer::fetchBVH()
     {
         auto fileExtensionStart = mCreateDesc.mMeshFilePath.rfind(".");
         std::string baseName = mCreateDesc.mMeshFilePath.substr(0, fileExtensionStart);
         std::string bvhName = baseName + "-triangles.bvh";
 
-#if defined(__EMSCRIPTEN__)
-        char* acBVHData = nullptr;
-        uint32_t iFileSize = Loader::loadFile(&acBVHData, bvhName.c_str());
-#else
-        std::vector<char> acBVHDataVector;
-        Loader::loadFile(acBVHDataVector, bvhName);
-        char* acBVHData = acBVHDataVector.data();
-        uint32_t iFileSize = (uint32_t)acBVHDataVector.size();
-#endif // __EMSCRIPTEN__
+        loadFileToVector(mSetupData.macBVH, bvhName);
+    }
+
+    /*
+    **
+    */
+    void CRenderer::uploadBVH()
+    {
+        char const* acBVHData = mSetupData.macBVH.data();
+        uint32_t iFileSize = (uint32_t)mSetupData.macBVH.size();
 
         wgpu::BufferDescriptor bufferDesc = {};
         bufferDesc.size = iFileSize;
         bufferDesc.usage = wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::Storage;
-        maBuffers["bvhNodes"] = mpDevice->CreateBuffer(&bufferDesc);
+        mUploadManager.createBufferWithData(maBuffers["bvhNodes"], bufferDesc, acBVHData, iFileSize);
         maBuffers["bvhNodes"].SetLabel("BVH Buffer");
-        mpDevice->GetQueue().WriteBuffer(maBuffers["bvhNodes"], 0, acBVHData, iFileSize);
 
-#if defined(__EMSCRIPTEN__)
-        free(acBVHData);
-#endif // __EMSCRIPTEN__
-        
+        mSetupData.macBVH = std::vector<char>();
     }
 
     /*
     **
     */
-    void CRenderer::loadFont()
+    void CRenderer::fetchFont()
     {
-        // font atlas
-        
-#if defined(__EMSCRIPTEN__)
-        char* acAtlasImageData = nullptr;
-        uint32_t iFileSize = Loader::loadFile(&acAtlasImageData, "font-atlas.png");
-#else 
-        std::vector<char> acAtlasImageDataV;
-        Loader::loadFile(acAtlasImageDataV, "font-atlas.png");
-        char* acAtlasImageData = acAtlasImageDataV.data();
-        uint32_t iFileSize = (uint32_t)acAtlasImageDataV.size();
-#endif // __EMSCRIPTEN__
+        decodeImage(mSetupData.mFontAtlas, "font-atlas.png");
+        loadFileToVector(mSetupData.macGlyphInfo, "glyph_info.bin");
+    }
 
-        int32_t iImageWidth = 0, iImageHeight = 0, iNumComp = 0;
-        stbi_uc* pImageData = stbi_load_from_memory(
-            (stbi_uc const*)acAtlasImageData,
-            (int32_t)iFileSize,
-            &iImageWidth,
-            &iImageHeight,
-            &iNumComp,
-            4
-        );
+    /*
+    **
+    */
+    void CRenderer::uploadFont()
+    {
+        // font atlas
+        DecodedImage& fontAtlas = mSetupData.mFontAtlas;
+        int32_t iImageWidth = fontAtlas.miWidth, iImageHeight = fontAtlas.miHeight;
+        uint32_t iNumMipLevels = getNumMipLevels(fontAtlas);
 
         wgpu::TextureFormat aViewFormats[] = {wgpu::TextureFormat::RGBA8Unorm};
         wgpu::TextureDescriptor textureDesc = {};
         textureDesc.usage = wgpu::TextureUsage::CopyDst | wgpu::TextureUsage::TextureBinding;
         textureDesc.dimension = wgpu::TextureDimension::e2D;
         textureDesc.format = wgpu::TextureFormat::RGBA8Unorm;
-        textureDesc.mipLevelCount = 1;
+        textureDesc.mipLevelCount = iNumMipLevels;
         textureDesc.sampleCount = 1;
         textureDesc.size.depthOrArrayLayers = 1;
         textureDesc.size.width = iImageWidth;
@@ -1640,35 +2688,9 @@ namespace Render
         maTextures["font-atlas-image"] = mpDevice->CreateTexture(&textureDesc);
         maTextures["font-atlas-image"].SetLabel("Font Atlas");
 
-#if defined(__EMSCRIPTEN__)
-        wgpu::TextureDataLayout layout = {};
-#else
-        wgpu::TexelCopyBufferLayout layout = {};
-#endif // __EMSCRIPTEN__
-        layout.bytesPerRow = iImageWidth * 4 * sizeof(char);
-        layout.offset = 0;
-        layout.rowsPerImage = iImageHeight;
-        wgpu::Extent3D extent = {};
-        extent.depthOrArrayLayers = 1;
-        extent.width = iImageWidth;
-        extent.height = iImageHeight;
-
-#if defined(__EMSCRIPTEN__)
-        wgpu::ImageCopyTexture destination = {};
-#else 
-        wgpu::TexelCopyTextureInfo destination = {};
-#endif // __EMSCRIPTEN__
-        destination.aspect = wgpu::TextureAspect::All;
-        destination.mipLevel = 0;
-        destination.origin = {.x = 0, .y = 0, .z = 0, };
-        destination.texture = maTextures["font-atlas-image"];
-        mpDevice->GetQueue().WriteTexture(
-            &destination,
-            pImageData,
-            iImageWidth * iImageHeight * 4,
-            &layout,
-            &extent);
-        stbi_image_free(pImageData);
+        writeImage(maTextures["font-atlas-image"], fontAtlas);
+        mUploadManager.flush();
+        freeImage(fontAtlas);
 
         wgpu::TextureViewDescriptor viewDesc = {};
         viewDesc.arrayLayerCount = 1;
@@ -1678,41 +2700,25 @@ namespace Render
         viewDesc.dimension = wgpu::TextureViewDimension::e2D;
         viewDesc.format = wgpu::TextureFormat::RGBA8Unorm;
         viewDesc.label = "Font Texture Atlas";
-        viewDesc.mipLevelCount = 1;
+        viewDesc.mipLevelCount = iNumMipLevels;
 #if !defined(__EMSCRIPTEN__)
         viewDesc.usage = wgpu::TextureUsage::CopyDst | wgpu::TextureUsage::TextureBinding;
 #endif // __EMSCRIPTEN__
         maTextureViews["font-atlas-image"] = maTextures["font-atlas-image"].CreateView(&viewDesc);
 
-#if defined(__EMSCRIPTEN__)
-        free(acAtlasImageData);
-#endif // __EMSCRIPTEN__
-
-#if defined(__EMSCRIPTEN__)
-        char* acFontInfoData = nullptr;
-        iFileSize = Loader::loadFile(&acFontInfoData, "glyph_info.bin");
-#else 
-        std::vector<char> acFontInfoDataV;
-        Loader::loadFile(acFontInfoDataV, "glyph_info.bin");
-        char* acFontInfoData = acFontInfoDataV.data();
-        iFileSize = (uint32_t)acFontInfoDataV.size();
-#endif // __EMSCRIPTEN__
+        char const* acFontInfoData = mSetupData.macGlyphInfo.data();
+        uint32_t iFileSize = (uint32_t)mSetupData.macGlyphInfo.size();
 
         wgpu::BufferDescriptor bufferDesc = {};
         bufferDesc.size = iFileSize;
         bufferDesc.usage = (wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::Storage);
-        maBuffers["font-info"] = mpDevice->CreateBuffer(&bufferDesc);
+        mUploadManager.createBufferWithData(maBuffers["font-info"], bufferDesc, acFontInfoData, iFileSize);
         maBuffers["font-info"].SetLabel("Font Info Buffer");
-        mpDevice->GetQueue().WriteBuffer(maBuffers["font-info"], 0, acFontInfoData, iFileSize);
 
         uint32_t iNumFontInfo = iFileSize / sizeof(OutputGlyphInfo);
         maFontInfo.resize(iNumFontInfo);
         memcpy(maFontInfo.data(), acFontInfoData, iFileSize);
 
-#if defined(__EMSCRIPTEN__)
-        free(acFontInfoData);
-#endif // __EMSCRIPTEN__
-
         bufferDesc.size = sizeof(Vertex) * 4;
         bufferDesc.usage = wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::Vertex;
         maBuffers["quad-vertex-buffer"] = mpDevice->CreateBuffer(&bufferDesc);
@@ -1751,281 +2757,549 @@ namespace Render
         maBuffers["draw-text-uniform"] = mpDevice->CreateBuffer(&bufferDesc);
         maBuffers["draw-text-uniform"].SetLabel("Draw Text Uniform Buffer");
 
+        auto startTime = std::chrono::high_resolution_clock::now();
+        CPipelineCache::Stats startStats = getPipelineCacheStats();
         setupFontPipeline();
-        
+        printPipelineCreateTime("Draw Text", startTime, startStats);
+
     }
 
     /*
     **
     */
-    void CRenderer::loadTexturesIntoAtlas()
+    // texture name file, the diffuse textures it lists are handed to the decode queue
+    void CRenderer::fetchTextures()
     {
-        struct TextureAtlasInfo
-        {
-            uint2               miTextureCoord;
-            float2              mUV;
-            uint32_t            miTextureID;
-            uint32_t            miImageWidth;
-            uint32_t            miImageHeight;
-            uint32_t            miPadding0;
-        };
+        // tiles are streamed in after setup, the atlas is left empty
+        if(mCreateDesc.mbVirtualTexturing && fetchVirtualTexture())
+        {
+            return;
+        }
 
-        std::vector<TextureAtlasInfo> aTextureAtlasInfo;
-        std::vector<std::string> aDiffuseTextureNames;
+        // atlas baked by obj_2_binary --bake-atlas, one image per page instead of every texture
+        if(fetchBakedTextureAtlas())
+        {
+            return;
+        }
+
+        std::vector<std::string>& aDiffuseTextureNames = mSetupData.maDiffuseTextureNames;
         std::vector<std::string> aEmissiveTextureNames;
         std::vector<std::string> aSpecularTextureNames;
         std::vector<std::string> aNormalTextureNames;
+
+        std::vector<char> acTextureNames;
+        loadFileToVector(acTextureNames, mCreateDesc.mMeshFilePath + "-texture-names.tex");
+        if(acTextureNames.size() > 0)
         {
-            // diffuse texture atlas
-            int32_t iAtlasImageWidth = 8192;
-            int32_t iAtlasImageHeight = 8192;
-            wgpu::TextureFormat aViewFormats[] = {wgpu::TextureFormat::RGBA8Unorm};
+            uint32_t iDiffuseSignature = ('D') | ('F' << 8) | ('S' << 16) | ('E' << 24);
+            uint32_t iEmissiveSignature = ('E') | ('M' << 8) | ('S' << 16) | ('V' << 24);
+            uint32_t iSpecularSignature = ('S') | ('P' << 8) | ('C' << 16) | ('L' << 24);
+            uint32_t iNormalSignature = ('N') | ('R' << 8) | ('M' << 16) | ('L' << 24);
+
+            uint32_t const* piData = (uint32_t const*)acTextureNames.data();
+            char const* pcEnd = ((char const*)piData) + acTextureNames.size();
+            for(uint32_t iType = 0; iType < 4; iType++)
+            {
+                uint32_t iSignature = *piData++;
+                uint32_t iNumTextures = *piData++;
+                char const* pcChar = (char const*)piData;
+                for(uint32_t i = 0; i < iNumTextures; i++)
+                {
+                    std::vector<char> acName;
+                    while(*pcChar != '\0')
+                    {
+                        acName.push_back(*pcChar++);
+                    }
+                    acName.push_back(*pcChar++);
+
+                    std::string convertedName = std::string(acName.data());
+                    auto iter = convertedName.rfind("/");
+                    if(iter == std::string::npos)
+                    {
+                        iter = convertedName.rfind("\\");
+                    }
+
+                    std::string baseName = convertedName;
+                    if(iter != std::string::npos)
+                    {
+                        baseName = convertedName.substr(iter);
+                    }
+                    iter = baseName.rfind(".");
+                    std::string noExtension = baseName.substr(0, iter);
+                    std::string oldFileExtension = baseName.substr(iter);
+
+                    if(oldFileExtension != ".jpeg" && oldFileExtension != ".png" && oldFileExtension != ".jpg")
+                    {
+                        noExtension += ".png";
+                    }
+                    else
+                    {
+                        noExtension += oldFileExtension;
+                    }
+
+                    if(iSignature == iDiffuseSignature)
+                    {
+                        aDiffuseTextureNames.push_back(noExtension);
+                    }
+                    else if(iSignature == iEmissiveSignature)
+                    {
+                        aEmissiveTextureNames.push_back(noExtension);
+                    }
+                    else if(iSignature == iSpecularSignature)
+                    {
+                        aSpecularTextureNames.push_back(noExtension);
+                    }
+                    else if(iSignature == iNormalSignature)
+                    {
+                        aNormalTextureNames.push_back(noExtension);
+                    }
+                }
+                piData = (uint32_t const*)pcChar;
+                if(pcChar == pcEnd)
+                {
+                    break;
+                }
+
+            }   // for texture type
+
+            std::vector<std::string> aTexturePaths;
+            for(auto const& diffuseTextureName : aDiffuseTextureNames)
+            {
+                aTexturePaths.push_back(std::string("textures/") + diffuseTextureName);
+            }
+
+            // decoded on the queue's workers, the atlas upload takes them in list order
+            mSetupData.mpDiffuseTextureQueue = std::make_unique<CTextureDecodeQueue>();
+            mSetupData.mpDiffuseTextureQueue->start(
+                aTexturePaths,
+                Utils::getDefaultNumWorkerThreads(),
+                TEXTURE_DECODE_MEMORY_BUDGET);
+        }
+    }
+
+    /*
+    **
+    */
+    bool CRenderer::fetchBakedTextureAtlas()
+    {
+        struct AtlasFileHeader
+        {
+            char        macSignature[4];
+            uint32_t    miPageWidth;
+            uint32_t    miPageHeight;
+            uint32_t    miNumTextures;
+            uint32_t    miNumPages;
+            uint32_t    miNumMipLevels;
+        };
+
+        std::vector<char> acAtlasInfo;
+        loadFileToVector(acAtlasInfo, mCreateDesc.mMeshFilePath + "-diffuse-atlas.bin");
+        if(acAtlasInfo.size() < sizeof(AtlasFileHeader) || memcmp(acAtlasInfo.data(), "ATLS", 4) != 0)
+        {
+            return false;
+        }
+
+        AtlasFileHeader header;
+        memcpy(&header, acAtlasInfo.data(), sizeof(AtlasFileHeader));
+        if(acAtlasInfo.size() < sizeof(AtlasFileHeader) + header.miNumTextures * sizeof(TextureAtlasInfo))
+        {
+            printf("%s : %d truncated texture atlas info\n", __FILE__, __LINE__);
+            return false;
+        }
+
+        std::vector<DecodedImage>& aPages = mSetupData.maBakedDiffuseAtlasPages;
+        aPages.resize(header.miNumPages);
+
+        // block compressed pages from obj_2_binary --compress, a quarter of the memory for BC7 and an
+        // eighth for BC1, only when the device can sample them and every page comes with its mips
+        bool bCompressed = (header.miNumPages > 0 && mpDevice->HasFeature(wgpu::FeatureName::TextureCompressionBC));
+        for(uint32_t iPage = 0; iPage < header.miNumPages && bCompressed; iPage++)
+        {
+            DecodedImage& page = aPages[iPage];
+            page.mFilePath = mCreateDesc.mMeshFilePath + "-diffuse-atlas-" + std::to_string(iPage) + "-bc.rtex";
+            loadFileToVector(page.macCacheData, page.mFilePath);
+
+            Loader::TextureCache::Header cacheHeader;
+            bCompressed = (Loader::TextureCache::parse(cacheHeader, page.maCacheLevels, page.macCacheData.data(), page.macCacheData.size()) &&
+                Loader::TextureCache::getBytesPerBlock(cacheHeader.miFormat) > 0 &&
+                cacheHeader.miFormat == ((iPage > 0) ? aPages[0].miFormat : cacheHeader.miFormat) &&
+                cacheHeader.miWidth == header.miPageWidth &&
+                cacheHeader.miHeight == header.miPageHeight &&
+                cacheHeader.miWidth % 4 == 0 &&
+                cacheHeader.miHeight % 4 == 0 &&
+                cacheHeader.miNumMipLevels == std::max(header.miNumMipLevels, 1u));
+            if(bCompressed)
+            {
+                page.mpImageData = (uint8_t*)page.macCacheData.data() + page.maCacheLevels[0].miOffset;
+                page.miWidth = (int32_t)cacheHeader.miWidth;
+                page.miHeight = (int32_t)cacheHeader.miHeight;
+                page.miFormat = cacheHeader.miFormat;
+            }
+        }
+
+        if(!bCompressed)
+        {
+            for(auto& page : aPages)
+            {
+                freeImage(page);
+                page = DecodedImage();
+            }
+        }
+
+        bool bValid = (header.miNumPages > 0);
+        for(uint32_t iPage = 0; iPage < header.miNumPages && bValid && !bCompressed; iPage++)
+        {
+            DecodedImage& page = aPages[iPage];
+            decodeImage(page, mCreateDesc.mMeshFilePath + "-diffuse-atlas-" + std::to_string(iPage) + ".png");
+            bValid = (page.mpImageData != nullptr &&
+                (uint32_t)page.miWidth == header.miPageWidth &&
+                (uint32_t)page.miHeight == header.miPageHeight);
+        }
+
+        if(!bValid)
+        {
+            printf("%s : %d baked texture atlas doesn\'t match its info, loading the textures individually\n", __FILE__, __LINE__);
+            for(auto& page : aPages)
+            {
+                freeImage(page);
+            }
+            aPages.clear();
+            return false;
+        }
+
+        mSetupData.miBakedAtlasMipLevels = std::max(header.miNumMipLevels, 1u);
+        mSetupData.maBakedTextureAtlasInfo.resize(header.miNumTextures);
+        memcpy(
+            mSetupData.maBakedTextureAtlasInfo.data(),
+            acAtlasInfo.data() + sizeof(AtlasFileHeader),
+            header.miNumTextures * sizeof(TextureAtlasInfo));
+
+        return true;
+    }
+
+    /*
+    **
+    */
+    void CRenderer::uploadTextureAtlas()
+    {
+        std::vector<DecodedImage>& aBakedPages = mSetupData.maBakedDiffuseAtlasPages;
+        bool bBakedAtlas = (aBakedPages.size() > 0);
+
+        CTextureDecodeQueue* pDecodeQueue = mSetupData.mpDiffuseTextureQueue.get();
+        uint32_t iNumDiffuseTextures = pDecodeQueue ? pDecodeQueue->getNumImages() : 0;
+
+        // texture rects padded by a gutter of repeated edge texels and aligned to the block the
+        // last mip level reduces to a texel, so no level mixes neighbouring textures
+        int32_t iAlignment = 1 << (DIFFUSE_ATLAS_MIP_LEVELS - 1);
+        int32_t iGutter = iAlignment;
+        auto alignSize = [iAlignment](int32_t iSize)
+        {
+            return (iSize + iAlignment - 1) & ~(iAlignment - 1);
+        };
+
+        // only the headers are needed to pack, the decodes carry on meanwhile
+        int32_t iPageWidth = 1, iPageHeight = 1;
+        uint32_t iNumPages = 1;
+        uint32_t iNumMipLevels = DIFFUSE_ATLAS_MIP_LEVELS;
+        std::vector<Utils::PackRect> aRects(iNumDiffuseTextures);
+        if(bBakedAtlas)
+        {
+            iPageWidth = aBakedPages[0].miWidth;
+            iPageHeight = aBakedPages[0].miHeight;
+            iNumPages = (uint32_t)aBakedPages.size();
+            iNumMipLevels = mSetupData.miBakedAtlasMipLevels;
+        }
+        else if(iNumDiffuseTextures > 0)
+        {
+            for(uint32_t iTexture = 0; iTexture < iNumDiffuseTextures; iTexture++)
+            {
+                int32_t iImageWidth = 0, iImageHeight = 0;
+                pDecodeQueue->waitForImageSize(iTexture, iImageWidth, iImageHeight);
+                if(iImageWidth > 0 && iImageHeight > 0)
+                {
+                    aRects[iTexture].miWidth = alignSize(iImageWidth + iGutter * 2);
+                    aRects[iTexture].miHeight = alignSize(iImageHeight + iGutter * 2);
+                }
+            }
+
+            iNumPages = std::max(Utils::packRectsIntoPages(aRects, DIFFUSE_ATLAS_MAX_PAGE_SIZE, iPageWidth, iPageHeight), 1u);
+        }
+
+        // mip chain stops at a 1 texel level
+        uint32_t iMaxMipLevels = 1;
+        while((1 << iMaxMipLevels) <= std::min(iPageWidth, iPageHeight))
+        {
+            ++iMaxMipLevels;
+        }
+        iNumMipLevels = std::min(iNumMipLevels, iMaxMipLevels);
+
+        // compressed pages can't be filtered down here, their levels all come from the baker
+        wgpu::TextureFormat atlasFormat = wgpu::TextureFormat::RGBA8Unorm;
+        bool bCompressedAtlas = (bBakedAtlas && Loader::TextureCache::getBytesPerBlock(aBakedPages[0].miFormat) > 0);
+        if(bCompressedAtlas)
+        {
+            atlasFormat = (aBakedPages[0].miFormat == Loader::TextureCache::Format::BC1RGBAUnorm) ?
+                wgpu::TextureFormat::BC1RGBAUnorm :
+                wgpu::TextureFormat::BC7RGBAUnorm;
+            iNumMipLevels = (uint32_t)aBakedPages[0].maCacheLevels.size();
+        }
+
+        std::vector<TextureAtlasInfo> aTextureAtlasInfo;
+        {
+            wgpu::TextureFormat aViewFormats[] = {atlasFormat};
             wgpu::TextureDescriptor textureDesc = {};
             textureDesc.usage = wgpu::TextureUsage::CopyDst | wgpu::TextureUsage::TextureBinding;
             textureDesc.dimension = wgpu::TextureDimension::e2D;
-            textureDesc.format = wgpu::TextureFormat::RGBA8Unorm;
-            textureDesc.mipLevelCount = 1;
+            textureDesc.format = atlasFormat;
+            textureDesc.mipLevelCount = iNumMipLevels;
             textureDesc.sampleCount = 1;
-            textureDesc.size.depthOrArrayLayers = 1;
-            textureDesc.size.width = iAtlasImageWidth;
-            textureDesc.size.height = iAtlasImageHeight;
+            textureDesc.size.depthOrArrayLayers = iNumPages;
+            textureDesc.size.width = iPageWidth;
+            textureDesc.size.height = iPageHeight;
             textureDesc.viewFormatCount = 1;
             textureDesc.viewFormats = aViewFormats;
 
             maTextures["totalDiffuseTextures"] = mpDevice->CreateTexture(&textureDesc);
             mDiffuseTextureAtlas = maTextures["totalDiffuseTextures"];
 
-
-#if defined(__EMSCRIPTEN__)
-            char* acTextureNames = nullptr;
-            uint32_t iSize = Loader::loadFile(&acTextureNames, mCreateDesc.mMeshFilePath + "-texture-names.tex");
-            if(iSize > 0)
-#else 
-            std::vector<char> acTextureNames;
-            Loader::loadFile(acTextureNames, mCreateDesc.mMeshFilePath + "-texture-names.tex");
-            if(acTextureNames.size() > 0)
-#endif // __EMSCRIPTEN__
-            {
-                uint32_t iDiffuseSignature = ('D') | ('F' << 8) | ('S' << 16) | ('E' << 24);
-                uint32_t iEmissiveSignature = ('E') | ('M' << 8) | ('S' << 16) | ('V' << 24);
-                uint32_t iSpecularSignature = ('S') | ('P' << 8) | ('C' << 16) | ('L' << 24);
-                uint32_t iNormalSignature = ('N') | ('R' << 8) | ('M' << 16) | ('L' << 24);
-
-#if defined(__EMSCRIPTEN__)
-                uint32_t const* piData = (uint32_t const*)acTextureNames;
-                char const* pcEnd = ((char const*)piData) + iSize;
-#else 
-                uint32_t const* piData = (uint32_t const*)acTextureNames.data();
-                char const* pcEnd = ((char const*)piData) + acTextureNames.size();
-#endif // __EMSCRIPTEN__
-                for(uint32_t iType = 0; iType < 4; iType++)
+            // writes the region and its box filtered levels, the region's corner and size are
+            // multiples of the alignment so every level lines up
+            std::vector<uint8_t> aiMipData[2];
+            auto writeWithMips = [&](
+                uint32_t iX,
+                uint32_t iY,
+                uint32_t iWidth,
+                uint32_t iHeight,
+                uint8_t const* pImageData,
+                uint32_t iPage)
                 {
-                    uint32_t iSignature = *piData++;
-                    uint32_t iNumTextures = *piData++;
-                    char const* pcChar = (char const*)piData;
-                    for(uint32_t i = 0; i < iNumTextures; i++)
-                    {
-                        std::vector<char> acName;
-                        while(*pcChar != '\0')
-                        {
-                            acName.push_back(*pcChar++);
-                        }
-                        acName.push_back(*pcChar++);
+                    mUploadManager.writeTexture(mDiffuseTextureAtlas, iX, iY, iWidth, iHeight, 4, pImageData, 0, iPage);
 
-                        std::string convertedName = std::string(acName.data());
-                        auto iter = convertedName.rfind("/");
-                        if(iter == std::string::npos)
-                        {
-                            iter = convertedName.rfind("\\");
-                        }
-
-                        std::string baseName = convertedName;
-                        if(iter != std::string::npos)
-                        {
-                            baseName = convertedName.substr(iter);
-                        }
-                        iter = baseName.rfind(".");
-                        std::string noExtension = baseName.substr(0, iter);
-                        std::string oldFileExtension = baseName.substr(iter);
+                    uint8_t const* pSrc = pImageData;
+                    for(uint32_t iMip = 1; iMip < iNumMipLevels; iMip++)
+                    {
+                        uint32_t iSrcWidth = iWidth >> (iMip - 1), iSrcHeight = iHeight >> (iMip - 1);
+                        uint32_t iMipWidth = std::max(iSrcWidth >> 1, 1u), iMipHeight = std::max(iSrcHeight >> 1, 1u);
+                        std::vector<uint8_t>& aiDest = aiMipData[iMip & 1];
+                        Loader::TextureCache::halveImage(aiDest, pSrc, iSrcWidth, iSrcHeight);
 
-                        if(oldFileExtension != ".jpeg" && oldFileExtension != ".png" && oldFileExtension != ".jpg")
-                        {
-                            noExtension += ".png";
-                        }
-                        else
-                        {
-                            noExtension += oldFileExtension;
-                        }
+                        mUploadManager.writeTexture(mDiffuseTextureAtlas, iX >> iMip, iY >> iMip, iMipWidth, iMipHeight, 4, aiDest.data(), iMip, iPage);
+                        pSrc = aiDest.data();
+                    }
+                };
 
-                        if(iSignature == iDiffuseSignature)
-                        {
-                            aDiffuseTextureNames.push_back(noExtension);
-                        }
-                        else if(iSignature == iEmissiveSignature)
-                        {
-                            aEmissiveTextureNames.push_back(noExtension);
-                        }
-                        else if(iSignature == iSpecularSignature)
-                        {
-                            aSpecularTextureNames.push_back(noExtension);
-                        }
-                        else if(iSignature == iNormalSignature)
-                        {
-                            aNormalTextureNames.push_back(noExtension);
-                        }
+            if(bBakedAtlas)
+            {
+                // cached pages come with their mip chain
+                for(uint32_t iPage = 0; iPage < iNumPages; iPage++)
+                {
+                    DecodedImage& page = aBakedPages[iPage];
+                    if(bCompressedAtlas || page.maCacheLevels.size() == iNumMipLevels)
+                    {
+                        writeImage(mDiffuseTextureAtlas, page, iPage);
                     }
-                    piData = (uint32_t const*)pcChar;
-                    if(pcChar == pcEnd)
+                    else
                     {
-                        break;
+                        writeWithMips(0, 0, iPageWidth, iPageHeight, page.mpImageData, iPage);
                     }
+                    freeImage(page);
+                }
+                aTextureAtlasInfo = mSetupData.maBakedTextureAtlasInfo;
 
-                }   // for texture type
+                printf("loaded %d %d x %d %s atlas pages\n",
+                    iNumPages,
+                    iPageWidth,
+                    iPageHeight,
+                    (atlasFormat == wgpu::TextureFormat::BC1RGBAUnorm) ? "BC1" : ((atlasFormat == wgpu::TextureFormat::BC7RGBAUnorm) ? "BC7" : "RGBA8"));
+            }
 
-#if defined(__EMSCRIPTEN__)
-                free(acTextureNames);
-#endif // __EMSCRIPTEN__
+            // placed in list order whatever order the decodes finish in, the pixels are released
+            // once they're in the staging block so the next decodes can start
+            std::vector<uint8_t> aiPaddedImage;
+            for(uint32_t iTexture = 0; iTexture < iNumDiffuseTextures; iTexture++)
+            {
+                CTextureDecodeQueue::Image const& image = pDecodeQueue->waitForImage(iTexture);
+                Utils::PackRect const& rect = aRects[iTexture];
 
-                int32_t iAtlasIndex = 0;
-                int32_t iX = 0, iY = 0;
-                int32_t iLargestHeight = 0;
-
-                auto copyToAtlas = [&](
-                    int32_t& iX,
-                    int32_t& iY,
-                    int32_t iAtlasImageWidth,
-                    int32_t iAtlasImageHeight,
-                    std::string const& textureName,
-                    wgpu::Texture& textureAtlas,
-                    int32_t& iLargestHeight)
+                // failed textures keep their entry so the ids still index the list
+                TextureAtlasInfo info = {};
+                info.miTextureID = iTexture;
+                if(image.mpImageData == nullptr || rect.miPage >= iNumPages)
+                {
+                    DEBUG_PRINTF("!!! Can\'t load \"%s\" into the atlas\n", image.mFilePath.c_str());
+                }
+                else
+                {
+                    // edge texels repeated into the gutter
+                    aiPaddedImage.resize((size_t)rect.miWidth * rect.miHeight * 4);
+                    for(int32_t iY = 0; iY < rect.miHeight; iY++)
                     {
-                        std::string parsedTextureName = std::string("textures/") + textureName;
-
-#if defined(__EMSCRIPTEN__)
-                        char* acTextureImageData = nullptr;
-                        uint32_t iSize = Loader::loadFile(&acTextureImageData, parsedTextureName);
-                        int32_t iImageWidth = 0, iImageHeight = 0, iImageComp = 0;
-                        stbi_uc* pImageData = stbi_load_from_memory(
-                            (stbi_uc const*)acTextureImageData,
-                            (int32_t)iSize,
-                            &iImageWidth,
-                            &iImageHeight,
-                            &iImageComp,
-                            4
-                        );
-#else
-                        std::vector<char> acTextureImageData;
-                        Loader::loadFile(acTextureImageData, parsedTextureName);
-                        int32_t iImageWidth = 0, iImageHeight = 0, iImageComp = 0;
-                        stbi_uc* pImageData = stbi_load_from_memory(
-                            (stbi_uc const*)acTextureImageData.data(),
-                            (int32_t)acTextureImageData.size(),
-                            &iImageWidth,
-                            &iImageHeight,
-                            &iImageComp,
-                            4
-                        );
-#endif // __EMSCRIPTEN__
-
-                        if(pImageData)
+                        int32_t iSrcY = std::clamp(iY - iGutter, 0, image.miHeight - 1);
+                        for(int32_t iX = 0; iX < rect.miWidth; iX++)
                         {
-                            iLargestHeight = std::max(iLargestHeight, iImageHeight);
-                            if(iX + iImageWidth >= iAtlasImageWidth)
-                            {
-                                iX = 0;
-                                iY += iLargestHeight;
-                                iLargestHeight = 0;
-                            }
-
-#if defined(__EMSCRIPTEN__)
-                            wgpu::TextureDataLayout layout = {};
-#else
-                            wgpu::TexelCopyBufferLayout layout = {};
-#endif // __EMSCRIPTEN__
-                            layout.bytesPerRow = iImageWidth * 4 * sizeof(char);
-                            layout.offset = 0;
-                            layout.rowsPerImage = iImageHeight;
-                            wgpu::Extent3D extent = {};
-                            extent.depthOrArrayLayers = 1;
-                            extent.width = iImageWidth;
-                            extent.height = iImageHeight;
-
-#if defined(__EMSCRIPTEN__)
-                            wgpu::ImageCopyTexture destination = {};
-#else 
-                            wgpu::TexelCopyTextureInfo destination = {};
-#endif // __EMSCRIPTEN__
-                            destination.aspect = wgpu::TextureAspect::All;
-                            destination.mipLevel = 0;
-                            destination.origin = {.x = (uint32_t)iX, .y = (uint32_t)iY, .z = 0};
-                            destination.texture = textureAtlas;
-                            mpDevice->GetQueue().WriteTexture(
-                                &destination,
-                                pImageData,
-                                iImageWidth * iImageHeight * 4,
-                                &layout,
-                                &extent);
-
-                            TextureAtlasInfo info = {};
-                            info.miTextureCoord = uint2(iX, iY);
-                            info.miTextureID = iAtlasIndex;
-                            info.mUV = float2(float(iX) / float(iAtlasImageWidth), float(iY) / float(iAtlasImageHeight));
-                            info.miImageWidth = iImageWidth;
-                            info.miImageHeight = iImageHeight;
-                            aTextureAtlasInfo.push_back(info);
-
-                            iX += iImageWidth;
-
-                            stbi_image_free(pImageData);
-
-#if defined(__EMSCRIPTEN__)
-                            free(acTextureImageData);
-#endif // __EMSCRIPTEN__
+                            int32_t iSrcX = std::clamp(iX - iGutter, 0, image.miWidth - 1);
+                            memcpy(
+                                &aiPaddedImage[((size_t)iY * rect.miWidth + iX) * 4],
+                                &image.mpImageData[((size_t)iSrcY * image.miWidth + iSrcX) * 4],
+                                4);
                         }
-                        else
-                        {
-                            DEBUG_PRINTF("!!! Can\'t load \"%s\"\n", parsedTextureName.c_str());
-                        }
-                    };
-
-
-                for(auto const& diffuseTextureName : aDiffuseTextureNames)
-                {
-                    copyToAtlas(iX, iY, iAtlasImageWidth, iAtlasImageHeight, diffuseTextureName, mDiffuseTextureAtlas, iLargestHeight);
+                    }
+                    writeWithMips(rect.miX, rect.miY, rect.miWidth, rect.miHeight, aiPaddedImage.data(), rect.miPage);
 
-                    ++iAtlasIndex;
+                    info.miTextureCoord = uint2(rect.miX + iGutter, rect.miY + iGutter);
+                    info.mUV = float2(float(rect.miX + iGutter) / float(iPageWidth), float(rect.miY + iGutter) / float(iPageHeight));
+                    info.miImageWidth = image.miWidth;
+                    info.miImageHeight = image.miHeight;
+                    info.miPage = rect.miPage;
                 }
+                aTextureAtlasInfo.push_back(info);
 
+                pDecodeQueue->releaseImage(iTexture);
+            }
+
+            if(pDecodeQueue)
+            {
+                printf("decoded %d diffuse textures into %d %d x %d atlas pages, peak decoded memory %.2f MB\n",
+                    iNumDiffuseTextures,
+                    iNumPages,
+                    iPageWidth,
+                    iPageHeight,
+                    (double)pDecodeQueue->getPeakDecodedBytes() / (1024.0 * 1024.0));
             }
 
         }   // textures
 
         wgpu::TextureViewDescriptor viewDesc = {};
-        viewDesc.arrayLayerCount = 1;
+        viewDesc.arrayLayerCount = iNumPages;
         viewDesc.aspect = wgpu::TextureAspect::All;
         viewDesc.baseArrayLayer = 0;
         viewDesc.baseMipLevel = 0;
-        viewDesc.dimension = wgpu::TextureViewDimension::e2D;
-        viewDesc.format = wgpu::TextureFormat::RGBA8Unorm;
+        viewDesc.dimension = wgpu::TextureViewDimension::e2DArray;
+        viewDesc.format = atlasFormat;
         viewDesc.label = "Diffuse Texture Atlas";
-        viewDesc.mipLevelCount = 1;
+        viewDesc.mipLevelCount = iNumMipLevels;
 #if !defined(__EMSCRIPTEN__)
         viewDesc.usage = wgpu::TextureUsage::CopyDst | wgpu::TextureUsage::TextureBinding;
 #endif // __EMSCRIPTEN__
         mDiffuseTextureAtlasView = mDiffuseTextureAtlas.CreateView(&viewDesc);
 
         wgpu::BufferDescriptor bufferDesc = {};
-        bufferDesc.mappedAtCreation = false;
         bufferDesc.usage = wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::Storage;
         bufferDesc.size = std::max((uint32_t)sizeof(TextureAtlasInfo) * (uint32_t)aTextureAtlasInfo.size(), 64u);
-        maBuffers["diffuseTextureAtlasInfoBuffer"] = mpDevice->CreateBuffer(&bufferDesc);
-        maBuffers["diffuseTextureAtlasInfoBuffer"].SetLabel("Diffuse Texture Atlas Info Buffer");
-        mpDevice->GetQueue().WriteBuffer(
+        mUploadManager.createBufferWithData(
             maBuffers["diffuseTextureAtlasInfoBuffer"],
-            0,
+            bufferDesc,
             aTextureAtlasInfo.data(),
-            sizeof(TextureAtlasInfo) * (uint32_t)aTextureAtlasInfo.size()
-        );
+            sizeof(TextureAtlasInfo) * (uint32_t)aTextureAtlasInfo.size());
+        maBuffers["diffuseTextureAtlasInfoBuffer"].SetLabel("Diffuse Texture Atlas Info Buffer");
+
+        mUploadManager.flush();
+    }
+
+    /*
+    **
+    */
+    // header and texture entries only, the tiles are read in ranges as they're asked for
+    bool CRenderer::fetchVirtualTexture()
+    {
+        std::string filePath = mCreateDesc.mMeshFilePath + "-virtual-texture.bin";
+
+        CVirtualTextureStreamer::FileHeader header;
+        std::vector<char>& acHeaderData = mSetupData.macVirtualTextureHeader;
+        if(!Loader::loadFileRange(acHeaderData, filePath, 0, sizeof(header)) ||
+           acHeaderData.size() < sizeof(header) ||
+           memcmp(acHeaderData.data(), "VTEX", 4) != 0)
+        {
+            printf("%s : %d no virtual texture in \"%s\", loading the atlas\n", __FILE__, __LINE__, filePath.c_str());
+            acHeaderData.clear();
+            return false;
+        }
+        memcpy(&header, acHeaderData.data(), sizeof(header));
+
+        uint64_t iHeaderSize = sizeof(header) + sizeof(CVirtualTextureStreamer::TextureInfo) * header.miNumTextures;
+        if(!Loader::loadFileRange(acHeaderData, filePath, 0, iHeaderSize) || acHeaderData.size() < iHeaderSize)
+        {
+            printf("%s : %d truncated virtual texture \"%s\", loading the atlas\n", __FILE__, __LINE__, filePath.c_str());
+            acHeaderData.clear();
+            return false;
+        }
+
+        return true;
+    }
+
+    /*
+    **
+    */
+    // the deferred pass binds the virtual texture either way, without one it gets empty stand-ins
+    // and samples the atlas
+    void CRenderer::uploadVirtualTexture()
+    {
+        if(mSetupData.macVirtualTextureHeader.size() > 0)
+        {
+            CVirtualTextureStreamer::CreateDescriptor streamerDesc = {};
+            streamerDesc.mpDevice = mpDevice;
+            streamerDesc.mFilePath = mCreateDesc.mMeshFilePath + "-virtual-texture.bin";
+            streamerDesc.miCacheSize = mCreateDesc.miVirtualTextureCacheSize;
+
+            mpVirtualTextureStreamer = std::make_unique<CVirtualTextureStreamer>();
+            if(!mpVirtualTextureStreamer->setup(streamerDesc, mSetupData.macVirtualTextureHeader))
+            {
+                mpVirtualTextureStreamer.reset();
+            }
+        }
+
+        if(mpVirtualTextureStreamer)
+        {
+            maBuffers["virtualTextureInfoBuffer"] = mpVirtualTextureStreamer->getTextureInfoBuffer();
+            maBuffers["virtualTexturePageTable"] = mpVirtualTextureStreamer->getPageTableBuffer();
+            maBuffers["virtualTextureFeedback"] = mpVirtualTextureStreamer->getFeedbackBuffer();
+            maTextures["virtualTextureCache"] = mpVirtualTextureStreamer->getCacheTexture();
+            return;
+        }
+
+        // zero texture infos have no mip levels, which sends the shader to the atlas
+        wgpu::BufferDescriptor bufferDesc = {};
+        bufferDesc.usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst;
+        bufferDesc.size = 64;
+        char const* aszBufferNames[] = {"virtualTextureInfoBuffer", "virtualTexturePageTable", "virtualTextureFeedback"};
+        for(char const* szBufferName : aszBufferNames)
+        {
+            mUploadManager.createBufferWithData(maBuffers[szBufferName], bufferDesc, nullptr, 0);
+            maBuffers[szBufferName].SetLabel(szBufferName);
+        }
+
+        wgpu::TextureDescriptor textureDesc = {};
+        textureDesc.usage = wgpu::TextureUsage::CopyDst | wgpu::TextureUsage::TextureBinding;
+        textureDesc.dimension = wgpu::TextureDimension::e2D;
+        textureDesc.format = wgpu::TextureFormat::RGBA8Unorm;
+        textureDesc.mipLevelCount = 1;
+        textureDesc.sampleCount = 1;
+        textureDesc.size.width = 1;
+        textureDesc.size.height = 1;
+        textureDesc.size.depthOrArrayLayers = 1;
+        maTextures["virtualTextureCache"] = mpDevice->CreateTexture(&textureDesc);
+        maTextures["virtualTextureCache"].SetLabel("Virtual Texture Cache");
+    }
+
+    /*
+    **
+    */
+    void CRenderer::releaseSetupData()
+    {
+        freeImage(mSetupData.mFontAtlas);
+        for(auto& page : mSetupData.maBakedDiffuseAtlasPages)
+        {
+            freeImage(page);
+        }
+        for(auto& keyValue : mSetupData.maExternalTextures)
+        {
+            freeImage(keyValue.second);
+        }
+
+        mSetupData = SetupData();
+
+        // scene files prefetched but never loaded, e.g. images with a .rtex cache
+        Loader::clearPrefetchedFiles();
     }
 
     /*
@@ -2042,11 +3316,18 @@ namespace Render
         UniformData uniformData;
         uniformData.miNumMeshes = (uint32_t)maMeshExtents.size();
         uniformData.mfExplodeMultipler = 1.0f;
-        mpDevice->GetQueue().WriteBuffer(
-            maRenderJobs["Mesh Culling Compute"]->mUniformBuffers["uniformBuffer"],
-            0,
-            &uniformData,
-            sizeof(UniformData));
+        for(char const* szCullingJob : {"Mesh Culling Compute", "Mesh Occlusion Culling Compute"})
+        {
+            auto iter = maRenderJobs.find(szCullingJob);
+            if(iter != maRenderJobs.end())
+            {
+                mpDevice->GetQueue().WriteBuffer(
+                    iter->second->mUniformBuffers["uniformBuffer"],
+                    0,
+                    &uniformData,
+                    sizeof(UniformData));
+            }
+        }
 
         wgpu::BufferDescriptor bufferDesc = {};
         bufferDesc.mappedAtCreation = false;
@@ -1,7 +1,17 @@
 #pragma once
 
 #include <render/render_job.h>
+#include <render/render_graph.h>
+#include <render/alias_planner.h>
+#include <render/mesh_streamer.h>
+#include <render/virtual_texture_streamer.h>
+#include <render/pipeline_cache.h>
+#include <render/upload_manager.h>
+#include <render/texture_decode_queue.h>
+#include <loader/mesh_codec.h>
+#include <loader/texture_cache.h>
 #include <webgpu/webgpu_cpp.h>
+#include <array>
 #include <string>
 #include <map>
 #include <chrono>
@@ -22,6 +32,34 @@ namespace Render
             std::string mMeshFilePath;
             std::string mRenderJobPipelineFilePath;
             wgpu::Sampler* mpSampler;
+
+            // stream the geometry in after setup instead of loading all of it up front, the bvh is built
+            // for the whole scene so the ray traced jobs (lighting, shadows, irradiance cache) are turned
+            // off until every mesh is resident
+            bool mbProgressiveMeshLoading = false;
+            uint32_t miNumStreamedMeshesPerFrame = 8;
+
+            // stream the diffuse textures' tiles in as the deferred pass asks for them instead of
+            // loading the whole atlas, needs -virtual-texture.bin from obj_2_binary --bake-virtual-texture
+            bool mbVirtualTexturing = false;
+            uint32_t miVirtualTextureCacheSize = 4096;
+
+            // device's blob cache backing, only for reporting cache hits and misses
+            CPipelineCache* mpPipelineCache = nullptr;
+
+            // render job pipelines are created asynchronously and frames draw the jobs that are
+            // ready, block at the end of setup until all of them are instead
+            bool mbWaitForPipelines = false;
+
+            // render job outputs only alive for part of the frame share textures with others
+            bool mbAliasTransientAttachments = true;
+
+            // formats picked for render job outputs that declare a "Semantic", see format_policy.h
+            FormatPolicy::Quality mAttachmentQuality = FormatPolicy::Quality::Medium;
+
+            // where there's no MultiDrawIndexedIndirect, the visible meshes' triangles are compacted into
+            // one index list and drawn with a single indirect draw instead of an indirect draw per mesh
+            bool mbCompactMeshIndices = true;
         };
 
         struct DrawUpdateDescriptor
@@ -52,7 +90,8 @@ namespace Render
         void setup(CreateDescriptor& desc);
         void draw(DrawUpdateDescriptor& desc);
 
-        wgpu::Texture& getSwapChainTexture();
+        // texture shown on frames of iFrame's parity, the same for both unless the output ping-pongs
+        wgpu::Texture& getSwapChainTexture(uint32_t iFrame = 0);
 
         bool setBufferData(
             std::string const& jobName,
@@ -79,6 +118,7 @@ namespace Render
         inline void setVisibilityFlags(uint32_t* piVisibilityFlags)
         {
             maiVisibilityFlags = piVisibilityFlags;
+            invalidateMeshRenderBundles();
         }
 
         inline uint32_t getFrameIndex()
@@ -111,6 +151,9 @@ namespace Render
             void* mpData;
             uint32_t            miStart;
             uint32_t            miSize;
+
+            // from getUniformBufferHandle(), the names are looked up each time without it
+            uint32_t            miBufferHandle = UINT32_MAX;
         };
 
         std::vector<QueueData>                  maQueueData;
@@ -120,12 +163,21 @@ namespace Render
             maQueueData.push_back(data);
         }
 
+        // handle of a render job's uniform buffer for QueueData, UINT32_MAX if there is no such buffer
+        uint32_t getUniformBufferHandle(
+            std::string const& jobName,
+            std::string const& shaderResourceName);
+
         float  mfCrossSectionPlaneD = 1000000.0f;
         float3                                  mCameraPosition;
         float3                                  mCameraLookAt;
 
     protected:
         void createRenderJobs(CreateDescriptor& desc);
+        void buildRenderGraph();
+        void setRayTracedJobsEnabled(bool bEnabled);
+        void aliasTransientAttachments();
+        void resolveFrameResources();
 
     protected:
         CreateDescriptor                        mCreateDesc;
@@ -138,8 +190,63 @@ namespace Render
         std::map<std::string, std::unique_ptr<Render::CRenderJob>>   maRenderJobs;
         std::vector<std::string> maOrderedRenderJobs;
 
+        // the names are for the json and debugging, the frame loop goes through handles, indices of
+        // the jobs in execution order, found once when the jobs are created
+        std::vector<Render::CRenderJob*>        mapRenderJobs;
+        std::map<std::string, uint32_t>         maiRenderJobHandles;
+        uint32_t getRenderJobHandle(std::string const& jobName) const;
+
+        // buffers used every frame, looked up in createRenderJobs()
+        enum class FrameBuffer : uint32_t
+        {
+            TrainIndex = 0,
+            TrainVertex,
+            IrradianceCacheQueueCounter,
+
+            Count,
+        };
+        std::array<wgpu::Buffer*, (uint32_t)FrameBuffer::Count>     mapFrameBuffers = {};
+        inline wgpu::Buffer* getFrameBuffer(FrameBuffer buffer)
+        {
+            return mapFrameBuffers[(uint32_t)buffer];
+        }
+
+        // what each mesh pass draws from, by job handle. the compacted ones are null without
+        // the compacted index list
+        struct MeshDrawBuffers
+        {
+            wgpu::Buffer*                       mpDrawCalls = nullptr;
+            wgpu::Buffer*                       mpNumDrawCalls = nullptr;
+            wgpu::Buffer*                       mpCompactedIndices = nullptr;
+            wgpu::Buffer*                       mpCompactedDrawCall = nullptr;
+        };
+        std::vector<MeshDrawBuffers>            maMeshDrawBuffers;
+
+        // counters zeroed at the start of every frame, and how many bytes of each
+        struct CounterBuffer
+        {
+            wgpu::Buffer*                       mpBuffer = nullptr;
+            uint32_t                            miClearSize = 0;
+        };
+        std::vector<CounterBuffer>              maCounterBuffers;
+
+        // render job uniform buffers written through QueueData, keyed by "job/resource"
+        std::vector<wgpu::Buffer*>              mapUniformBuffers;
+        std::map<std::string, uint32_t>         maiUniformBufferHandles;
+
+        // jobs that contribute to the swap chain output, recompiled when the output changes
+        CRenderGraph                            mRenderGraph;
+        std::vector<uint32_t>                   maiScheduledRenderJobs;
+        bool                                    mbRenderGraphDirty = true;
+
+        // job and attachment names of outputs sharing a texture with an earlier one
+        std::vector<std::pair<std::string, std::string>>    maAliasedAttachments;
+
         uint32_t                                miFrame = 0;
 
+        // mesh passes draw the compacted index list, see CreateDescriptor::mbCompactMeshIndices
+        bool                                    mbCompactedMeshDraw = false;
+
         struct MeshTriangleRange
         {
             uint32_t miStart;
@@ -160,6 +267,10 @@ namespace Render
         std::string                             mCaptureImageName = "";
         std::string                             mCaptureImageJobName = "";
         std::string                             mCaptureUniformBufferName = "";
+        wgpu::Buffer*                           mpCaptureUniformBuffer = nullptr;
+
+        // selected mesh goes in the "Mesh Selection Graphics" uniforms, nullptr without the job
+        wgpu::Buffer*                           mpMeshSelectionUniformBuffer = nullptr;
         int2                                    mSelectedCoord = int2(-1, -1);
         wgpu::Buffer                            mOutputImageBuffer;
         
@@ -175,6 +286,29 @@ namespace Render
 
         uint32_t*                               maiVisibilityFlags = nullptr;
 
+        // progressive mesh loading, meshes that aren't resident are masked out of visibilityFlags
+        std::unique_ptr<CMeshStreamer>          mpMeshStreamer;
+        std::vector<uint32_t>                   maiResidentVisibilityFlags;
+
+        bool fetchMeshStreamingHeaders();
+        void createMeshStreamer();
+        void writeVisibilityFlags(
+            uint32_t const* aiVisibilityFlags,
+            uint32_t iOffset,
+            uint32_t iDataSize);
+
+        // per-mesh indirect draws of a DrawMeshes job recorded once for each frame parity, thrown
+        // away when the visibility flags or the resident meshes change. indexed by job handle
+        std::vector<wgpu::RenderBundle>         maaMeshRenderBundles[2];
+        wgpu::RenderBundle const& getMeshRenderBundle(uint32_t iRenderJob);
+        inline void invalidateMeshRenderBundles()
+        {
+            maaMeshRenderBundles[0].assign(mapRenderJobs.size(), wgpu::RenderBundle());
+            maaMeshRenderBundles[1].assign(mapRenderJobs.size(), wgpu::RenderBundle());
+        }
+
+        std::unique_ptr<CVirtualTextureStreamer>    mpVirtualTextureStreamer;
+
         wgpu::Texture                           mDiffuseTextureAtlas;
         wgpu::TextureView                       mDiffuseTextureAtlasView;
 
@@ -204,7 +338,7 @@ namespace Render
 
         void setupFontPipeline();
         void drawText(
-            std::vector<wgpu::CommandBuffer>& aCommandBuffers,
+            wgpu::CommandEncoder& commandEncoder,
             std::string const& text,
             uint32_t iX,
             uint32_t iY,
@@ -214,24 +348,126 @@ namespace Render
         std::string     mFPSOutput;
         std::chrono::high_resolution_clock::time_point mLastTimeStart;
 
+        // startup cost of each pipeline, cache hits and misses from the device's blob cache
+        void printPipelineCreateTime(
+            std::string const& name,
+            std::chrono::high_resolution_clock::time_point const& startTime,
+            CPipelineCache::Stats const& startStats);
+        CPipelineCache::Stats getPipelineCacheStats() const;
+        double mfTotalPipelineCreateTime = 0.0;
+
+        // reports the render jobs whose pipelines came in since the last call, true once all are in
+        bool updatePipelineStatus();
+        void waitForPipelines();
+        std::vector<uint32_t> maiPendingPipelineJobs;
+        std::chrono::high_resolution_clock::time_point mPipelineIssueTime;
+
+    public:
+        struct DecodedImage
+        {
+            std::string             mFilePath;
+            uint8_t*                mpImageData = nullptr;
+            int32_t                 miWidth = 0;
+            int32_t                 miHeight = 0;
+
+            // loaded from the pre-decoded .rtex, mpImageData and the levels point into the file data
+            std::vector<char>                           macCacheData;
+            std::vector<Loader::TextureCache::Level>    maCacheLevels;
+            uint32_t                                    miFormat = Loader::TextureCache::Format::RGBA8Unorm;
+        };
+
+        // entry per diffuse texture, same layout as TextureAtlasInfo in the shaders
+        struct TextureAtlasInfo
+        {
+            uint2                   miTextureCoord;
+            float2                  mUV;
+            uint32_t                miTextureID;
+            uint32_t                miImageWidth;
+            uint32_t                miImageHeight;
+            uint32_t                miPage;
+        };
+
+    protected:
+        // handed from the setup fetch stages to the upload stages, released at the end of setup
+        struct SetupData
+        {
+            std::vector<char>                           macTriangleFile;
+            bool                                        mbEncodedMeshes = false;
+            uint32_t                                    miNumMeshVertices = 0;
+            uint32_t                                    miNumMeshTriangles = 0;
+            uint64_t                                    miMeshVertexDataOffset = 0;
+            void*                                       mpMappedVertices = nullptr;
+            void*                                       mpMappedTriangleIndices = nullptr;
+
+            std::vector<char>                           macMaterialIDs;
+            std::vector<char>                           macMaterials;
+
+            bool                                        mbStreamMeshes = false;
+            std::vector<CMeshStreamer::Range>           maStreamedVertexRanges;
+            uint32_t                                    miNumStreamedVertices = 0;
+            uint32_t                                    miNumStreamedTriangles = 0;
+            uint64_t                                    miStreamedVertexDataOffset = 0;
+
+            std::vector<std::string>                    maDiffuseTextureNames;
+            std::unique_ptr<CTextureDecodeQueue>        mpDiffuseTextureQueue;
+            std::vector<DecodedImage>                   maBakedDiffuseAtlasPages;
+            uint32_t                                    miBakedAtlasMipLevels = 1;
+            std::vector<TextureAtlasInfo>               maBakedTextureAtlasInfo;
+            std::vector<char>                           macVirtualTextureHeader;
+
+            DecodedImage                                mFontAtlas;
+            std::vector<char>                           macGlyphInfo;
+
+            std::vector<char>                           macBVH;
+
+            std::vector<char>                           macExternalData;
+            std::map<std::string, DecodedImage>         maExternalTextures;
+
+            std::vector<char>                           macRenderJobs;
+        };
+
+        SetupData                               mSetupData;
+        CUploadManager                          mUploadManager;
+
+        static void decodeImage(
+            DecodedImage& image,
+            std::string const& filePath);
+        static void freeImage(DecodedImage& image);
+        static uint32_t getNumMipLevels(DecodedImage const& image);
+        void writeImage(
+            wgpu::Texture const& texture,
+            DecodedImage const& image,
+            uint32_t iArrayLayer = 0);
+        void releaseSetupData();
+
     protected:
         std::string mSwapChainRenderJobName;
         std::string mSwapChainAttachmentName;
+        uint32_t miSwapChainRenderJob = UINT32_MAX;
 
     public:
-        inline void setSwapChainOutput(
+        // resolved to a handle here, and again when the render jobs are created
+        void setSwapChainOutput(
             char const* szRenderJobName,
-            char const* szOutputAttachmentName)
-        {
-            mSwapChainRenderJobName = szRenderJobName;
-            mSwapChainAttachmentName = szOutputAttachmentName;
-        }
-
-        void loadMeshes();
-        void loadExternalData();
-        void loadBVH();
-        void loadFont();
-        void loadTexturesIntoAtlas();
+            char const* szOutputAttachmentName);
+
+        // setup stages, fetch runs on a worker and fills mSetupData, upload runs on the main thread
+        void fetchMeshes();
+        void allocateMeshBuffers();
+        void decodeMeshes();
+        void uploadMeshes();
+        void uploadMeshMaterials();
+        void fetchExternalData();
+        void uploadExternalData();
+        void fetchBVH();
+        void uploadBVH();
+        void fetchFont();
+        void uploadFont();
+        void fetchTextures();
+        bool fetchBakedTextureAtlas();
+        void uploadTextureAtlas();
+        bool fetchVirtualTexture();
+        void uploadVirtualTexture();
         void setupUniformAndMiscBuffers();
         void createMiscBuffers();
     };
@@ -0,0 +1,335 @@
+#include <render/texture_decode_queue.h>
+
+#include <loader/loader.h>
+#include <loader/texture_cache.h>
+#include <external/stb_image/stb_image.h>
+
+#include <algorithm>
+
+#include <assert.h>
+#include <stdio.h>
+
+#define IMAGE_HEADER_READ_SIZE      (64u << 10)
+
+namespace Render
+{
+    /*
+    **
+    */
+    static void loadWholeFile(
+        std::vector<char>& acFileData,
+        std::string const& filePath)
+    {
+#if defined(__EMSCRIPTEN__)
+        char* acData = nullptr;
+        uint32_t iFileSize = Loader::loadFile(&acData, filePath, false);
+        acFileData.clear();
+        if(acData != nullptr)
+        {
+            acFileData.assign(acData, acData + iFileSize);
+            Loader::loadFileFree(acData);
+        }
+#else
+        Loader::loadFile(acFileData, filePath);
+#endif // __EMSCRIPTEN__
+    }
+
+    /*
+    **
+    */
+    CTextureDecodeQueue::~CTextureDecodeQueue()
+    {
+        // workers still waiting on the budget bail out
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mbCancelled = true;
+        }
+        mBudgetAvailable.notify_all();
+        mThreadPool.stop();
+
+        for(uint32_t iImage = 0; iImage < (uint32_t)maImages.size(); iImage++)
+        {
+            freeImageData(iImage);
+        }
+    }
+
+    /*
+    **
+    */
+    void CTextureDecodeQueue::start(
+        std::vector<std::string> const& aFilePaths,
+        uint32_t iNumThreads,
+        uint64_t iMemoryBudget)
+    {
+        uint32_t iNumImages = (uint32_t)aFilePaths.size();
+        maImages.resize(iNumImages);
+        maacFileData.resize(iNumImages);
+        maiImageBytes.assign(iNumImages, 0);
+        maiFromCache.assign(iNumImages, 0);
+        maiHeaderReady.assign(iNumImages, 0);
+        maiImageReady.assign(iNumImages, 0);
+        for(uint32_t iImage = 0; iImage < iNumImages; iImage++)
+        {
+            maImages[iImage].mFilePath = aFilePaths[iImage];
+        }
+
+        miMemoryBudget = iMemoryBudget;
+        miDecodedBytes = 0;
+        miPeakDecodedBytes = 0;
+        miNextBudgetImage = 0;
+
+        mThreadPool.start(std::min(iNumThreads, std::max(iNumImages, 1u)), "Texture Decode");
+
+        // without workers the images are read and decoded one at a time as they're waited on,
+        // otherwise every header job is queued ahead of the decodes so workers blocked on the
+        // budget can't hold up the sizes
+        if(mThreadPool.getNumThreads() > 0)
+        {
+            for(uint32_t iImage = 0; iImage < iNumImages; iImage++)
+            {
+                mThreadPool.submit([this, iImage]
+                {
+                    readHeader(iImage);
+                });
+            }
+            for(uint32_t iImage = 0; iImage < iNumImages; iImage++)
+            {
+                mThreadPool.submit([this, iImage]
+                {
+                    decode(iImage);
+                });
+            }
+        }
+    }
+
+    /*
+    **
+    */
+    void CTextureDecodeQueue::waitForImageSize(
+        uint32_t iImage,
+        int32_t& iWidth,
+        int32_t& iHeight)
+    {
+        assert(iImage < (uint32_t)maImages.size());
+        if(mThreadPool.getNumThreads() == 0 && maiHeaderReady[iImage] == 0)
+        {
+            readHeader(iImage);
+        }
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        mHeaderReady.wait(lock, [&]
+        {
+            return maiHeaderReady[iImage] != 0;
+        });
+
+        iWidth = maImages[iImage].miWidth;
+        iHeight = maImages[iImage].miHeight;
+    }
+
+    /*
+    **
+    */
+    CTextureDecodeQueue::Image const& CTextureDecodeQueue::waitForImage(uint32_t iImage)
+    {
+        assert(iImage < (uint32_t)maImages.size());
+        if(mThreadPool.getNumThreads() == 0 && maiImageReady[iImage] == 0)
+        {
+            decode(iImage);
+        }
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        mImageReady.wait(lock, [&]
+        {
+            return maiImageReady[iImage] != 0;
+        });
+
+        return maImages[iImage];
+    }
+
+    /*
+    **
+    */
+    void CTextureDecodeQueue::releaseImage(uint32_t iImage)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            freeImageData(iImage);
+            miDecodedBytes -= maiImageBytes[iImage];
+            maiImageBytes[iImage] = 0;
+        }
+        mBudgetAvailable.notify_all();
+    }
+
+    /*
+    **
+    */
+    void CTextureDecodeQueue::freeImageData(uint32_t iImage)
+    {
+        // cached images point into their file data
+        if(maiFromCache[iImage])
+        {
+            maacFileData[iImage] = std::vector<char>();
+        }
+        else
+        {
+            stbi_image_free(maImages[iImage].mpImageData);
+        }
+        maImages[iImage].mpImageData = nullptr;
+    }
+
+    /*
+    **
+    */
+    void CTextureDecodeQueue::readHeader(uint32_t iImage)
+    {
+        Image& image = maImages[iImage];
+
+        // a pre-decoded cache file holds the decoded bytes already, only its header is read here and
+        // the rest once the budget is granted
+        std::vector<char> acCacheHeader;
+        Loader::TextureCache::Header cacheHeader;
+        if(Loader::loadFileRange(acCacheHeader, Loader::TextureCache::getCachePath(image.mFilePath), 0, sizeof(cacheHeader)) &&
+           Loader::TextureCache::parseHeader(cacheHeader, acCacheHeader.data(), acCacheHeader.size()) &&
+           cacheHeader.miFormat == Loader::TextureCache::Format::RGBA8Unorm)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                image.miWidth = (int32_t)cacheHeader.miWidth;
+                image.miHeight = (int32_t)cacheHeader.miHeight;
+                maiImageBytes[iImage] = Loader::TextureCache::getFileSize(cacheHeader);
+                maiFromCache[iImage] = 1;
+                maiHeaderReady[iImage] = 1;
+            }
+            mHeaderReady.notify_all();
+            return;
+        }
+
+        // decoded size from the start of the file, the whole file is only read once the budget is granted
+        std::vector<char> acHeaderData;
+        int32_t iWidth = 0, iHeight = 0, iComp = 0;
+        bool bValid = (Loader::loadFileRange(acHeaderData, image.mFilePath, 0, IMAGE_HEADER_READ_SIZE) &&
+            stbi_info_from_memory((stbi_uc const*)acHeaderData.data(), (int32_t)acHeaderData.size(), &iWidth, &iHeight, &iComp));
+        if(!bValid)
+        {
+            // shorter than the range, packed, or the size comes after the metadata
+            loadWholeFile(acHeaderData, image.mFilePath);
+            if(!stbi_info_from_memory((stbi_uc const*)acHeaderData.data(), (int32_t)acHeaderData.size(), &iWidth, &iHeight, &iComp))
+            {
+                iWidth = iHeight = 0;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            image.miWidth = iWidth;
+            image.miHeight = iHeight;
+            maiImageBytes[iImage] = (uint64_t)iWidth * (uint64_t)iHeight * 4;
+            maiHeaderReady[iImage] = 1;
+        }
+        mHeaderReady.notify_all();
+    }
+
+    /*
+    **
+    */
+    void CTextureDecodeQueue::decode(uint32_t iImage)
+    {
+        Image& image = maImages[iImage];
+
+        // the header job was queued first but may still be running on another worker
+        if(mThreadPool.getNumThreads() == 0 && maiHeaderReady[iImage] == 0)
+        {
+            readHeader(iImage);
+        }
+
+        uint64_t iImageBytes = 0;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mHeaderReady.wait(lock, [&]
+            {
+                return maiHeaderReady[iImage] != 0;
+            });
+            iImageBytes = maiImageBytes[iImage];
+        }
+        std::vector<char>& acImageData = maacFileData[iImage];
+
+        bool bCancelled = false;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            if(mThreadPool.getNumThreads() > 0)
+            {
+                // an image larger than the whole budget still goes through once nothing else is held
+                mBudgetAvailable.wait(lock, [&]
+                {
+                    return mbCancelled ||
+                        (miNextBudgetImage == iImage && (miDecodedBytes == 0 || miDecodedBytes + iImageBytes <= miMemoryBudget));
+                });
+            }
+
+            bCancelled = mbCancelled;
+            miDecodedBytes += iImageBytes;
+            miPeakDecodedBytes = std::max(miPeakDecodedBytes, miDecodedBytes);
+            ++miNextBudgetImage;
+        }
+        mBudgetAvailable.notify_all();
+
+        uint8_t* pImageData = nullptr;
+        int32_t iWidth = 0, iHeight = 0, iComp = 0;
+        uint64_t iCompressedBytes = 0;
+        if(!bCancelled && iImageBytes > 0 && maiFromCache[iImage])
+        {
+            // level 0 is used in place, the file data is kept until the image is released
+            std::string cachePath = Loader::TextureCache::getCachePath(image.mFilePath);
+            loadWholeFile(acImageData, cachePath);
+
+            Loader::TextureCache::Header header;
+            std::vector<Loader::TextureCache::Level> aLevels;
+            if(Loader::TextureCache::parse(header, aLevels, acImageData.data(), acImageData.size()) &&
+               (int32_t)header.miWidth == image.miWidth &&
+               (int32_t)header.miHeight == image.miHeight)
+            {
+                pImageData = (uint8_t*)acImageData.data() + aLevels[0].miOffset;
+            }
+            else
+            {
+                printf("%s : %d invalid texture cache file \"%s\"\n", __FILE__, __LINE__, cachePath.c_str());
+            }
+        }
+        else if(!bCancelled && iImageBytes > 0)
+        {
+            // the compressed bytes count against the same budget until the pixels are decoded
+            loadWholeFile(acImageData, image.mFilePath);
+            iCompressedBytes = (uint64_t)acImageData.size();
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                miDecodedBytes += iCompressedBytes;
+                miPeakDecodedBytes = std::max(miPeakDecodedBytes, miDecodedBytes);
+            }
+
+            pImageData = stbi_load_from_memory(
+                (stbi_uc const*)acImageData.data(),
+                (int32_t)acImageData.size(),
+                &iWidth,
+                &iHeight,
+                &iComp,
+                4);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            image.mpImageData = pImageData;
+            if(!maiFromCache[iImage] || pImageData == nullptr)
+            {
+                maacFileData[iImage] = std::vector<char>();
+            }
+            miDecodedBytes -= iCompressedBytes;
+            maiImageReady[iImage] = 1;
+        }
+        mImageReady.notify_all();
+        if(iCompressedBytes > 0)
+        {
+            mBudgetAvailable.notify_all();
+        }
+    }
+
+}   // Render
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <utils/thread_pool.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace Render
+{
+    /*
+    ** decodes a list of images to RGBA8 on its own workers, images are handed out in list order
+    ** and the decoded bytes held at once stay under the memory budget, budget is granted in list
+    ** order so the image the consumer waits on is never starved by later ones
+    **
+    ** only the start of each file is read ahead of the decodes so the sizes of every image are
+    ** known before any pixels are, the whole file is read once its budget is granted and the
+    ** compressed bytes count against the budget until the image is decoded.
+    ** an image with a pre-decoded .rtex next to it is read from that instead, with no decode
+    */
+    class CTextureDecodeQueue
+    {
+    public:
+        struct Image
+        {
+            std::string             mFilePath;
+            uint8_t*                mpImageData = nullptr;
+            int32_t                 miWidth = 0;
+            int32_t                 miHeight = 0;
+        };
+
+    public:
+        CTextureDecodeQueue() = default;
+        virtual ~CTextureDecodeQueue();
+
+        void start(
+            std::vector<std::string> const& aFilePaths,
+            uint32_t iNumThreads,
+            uint64_t iMemoryBudget);
+
+        // blocks until the image's header is read, the size is 0 x 0 if the file is missing or not an image
+        void waitForImageSize(
+            uint32_t iImage,
+            int32_t& iWidth,
+            int32_t& iHeight);
+
+        // blocks until the image is decoded, mpImageData is null if it failed
+        Image const& waitForImage(uint32_t iImage);
+
+        // frees the pixels and gives the bytes back to the budget
+        void releaseImage(uint32_t iImage);
+
+        inline uint32_t getNumImages() const
+        {
+            return (uint32_t)maImages.size();
+        }
+
+        inline uint64_t getPeakDecodedBytes() const
+        {
+            return miPeakDecodedBytes;
+        }
+
+    protected:
+        void readHeader(uint32_t iImage);
+        void decode(uint32_t iImage);
+        void freeImageData(uint32_t iImage);
+
+    protected:
+        std::vector<Image>                  maImages;
+        std::vector<std::vector<char>>      maacFileData;
+        std::vector<uint64_t>               maiImageBytes;
+        std::vector<uint8_t>                maiFromCache;
+        std::vector<uint8_t>                maiHeaderReady;
+        std::vector<uint8_t>                maiImageReady;
+
+        Utils::CThreadPool                  mThreadPool;
+        std::mutex                          mMutex;
+        std::condition_variable             mHeaderReady;
+        std::condition_variable             mBudgetAvailable;
+        std::condition_variable             mImageReady;
+
+        uint64_t                            miMemoryBudget = 0;
+        uint64_t                            miDecodedBytes = 0;
+        uint64_t                            miPeakDecodedBytes = 0;
+        uint32_t                            miNextBudgetImage = 0;
+        bool                                mbCancelled = false;
+    };
+
+}   // Render
@@ -0,0 +1,290 @@
+#include <render/upload_manager.h>
+
+#include <algorithm>
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#define COPY_BYTES_PER_ROW_ALIGNMENT    256
+
+namespace Render
+{
+    /*
+    **
+    */
+    static uint64_t alignUp(uint64_t iValue, uint64_t iAlignment)
+    {
+        return (iValue + iAlignment - 1) & ~(iAlignment - 1);
+    }
+
+    /*
+    **
+    */
+    void CUploadManager::setup(
+        wgpu::Device* pDevice,
+        uint64_t iStagingBlockSize)
+    {
+        mpDevice = pDevice;
+        miStagingBlockSize = alignUp(iStagingBlockSize, COPY_BYTES_PER_ROW_ALIGNMENT);
+        maStagingBlocks.clear();
+        mbHasPendingCopies = false;
+        mStats = Stats();
+    }
+
+    /*
+    **
+    */
+    void* CUploadManager::createMappedBuffer(
+        wgpu::Buffer& buffer,
+        wgpu::BufferDescriptor const& desc)
+    {
+        // mapped at creation needs a multiple of 4 bytes
+        wgpu::BufferDescriptor mappedDesc = desc;
+        mappedDesc.size = std::max(alignUp(desc.size, 4), (uint64_t)4);
+        mappedDesc.mappedAtCreation = true;
+        buffer = mpDevice->CreateBuffer(&mappedDesc);
+
+        ++mStats.miNumBuffers;
+        mStats.miBufferBytes += mappedDesc.size;
+
+        void* pMappedData = buffer.GetMappedRange(0, mappedDesc.size);
+        assert(pMappedData);
+
+        return pMappedData;
+    }
+
+    /*
+    **
+    */
+    void CUploadManager::createBufferWithData(
+        wgpu::Buffer& buffer,
+        wgpu::BufferDescriptor const& desc,
+        void const* pData,
+        uint64_t iDataSize)
+    {
+        assert(iDataSize <= desc.size);
+
+        // new mappings are zeroed
+        void* pMappedData = createMappedBuffer(buffer, desc);
+        if(pMappedData && pData && iDataSize > 0)
+        {
+            memcpy(pMappedData, pData, iDataSize);
+        }
+        buffer.Unmap();
+    }
+
+    /*
+    **
+    */
+    void CUploadManager::writeTexture(
+        wgpu::Texture const& texture,
+        uint32_t iX,
+        uint32_t iY,
+        uint32_t iWidth,
+        uint32_t iHeight,
+        uint32_t iBytesPerPixel,
+        void const* pData,
+        uint32_t iMipLevel,
+        uint32_t iArrayLayer)
+    {
+        copyToTexture(
+            texture,
+            iX,
+            iY,
+            iWidth,
+            iHeight,
+            iHeight,
+            (uint64_t)iWidth * iBytesPerPixel,
+            pData,
+            iMipLevel,
+            iArrayLayer);
+    }
+
+    /*
+    **
+    */
+    void CUploadManager::writeCompressedTexture(
+        wgpu::Texture const& texture,
+        uint32_t iX,
+        uint32_t iY,
+        uint32_t iWidth,
+        uint32_t iHeight,
+        uint32_t iBytesPerBlock,
+        void const* pData,
+        uint32_t iMipLevel,
+        uint32_t iArrayLayer)
+    {
+        // the copy covers whole blocks, levels smaller than a block copy the block's physical size
+        uint32_t iNumBlocksX = (iWidth + 3) / 4;
+        uint32_t iNumBlocksY = (iHeight + 3) / 4;
+        copyToTexture(
+            texture,
+            iX,
+            iY,
+            iNumBlocksX * 4,
+            iNumBlocksY * 4,
+            iNumBlocksY,
+            (uint64_t)iNumBlocksX * iBytesPerBlock,
+            pData,
+            iMipLevel,
+            iArrayLayer);
+    }
+
+    /*
+    **
+    */
+    void CUploadManager::copyToTexture(
+        wgpu::Texture const& texture,
+        uint32_t iX,
+        uint32_t iY,
+        uint32_t iWidth,
+        uint32_t iHeight,
+        uint32_t iNumRows,
+        uint64_t iSrcBytesPerRow,
+        void const* pData,
+        uint32_t iMipLevel,
+        uint32_t iArrayLayer)
+    {
+        if(pData == nullptr || iWidth == 0 || iHeight == 0)
+        {
+            return;
+        }
+
+        uint64_t iDstBytesPerRow = alignUp(iSrcBytesPerRow, COPY_BYTES_PER_ROW_ALIGNMENT);
+        uint64_t iSize = iDstBytesPerRow * iNumRows;
+
+        StagingBlock& block = allocateStaging(iSize);
+        uint64_t iOffset = block.miOffset;
+        block.miOffset += iSize;
+
+        uint8_t const* pSrc = (uint8_t const*)pData;
+        uint8_t* pDst = block.mpData + iOffset;
+        for(uint32_t iRow = 0; iRow < iNumRows; iRow++)
+        {
+            memcpy(pDst, pSrc, iSrcBytesPerRow);
+            pSrc += iSrcBytesPerRow;
+            pDst += iDstBytesPerRow;
+        }
+
+        if(!mbHasPendingCopies)
+        {
+            wgpu::CommandEncoderDescriptor encoderDesc = {};
+            encoderDesc.label = "Upload Command Encoder";
+            mCommandEncoder = mpDevice->CreateCommandEncoder(&encoderDesc);
+            mbHasPendingCopies = true;
+        }
+
+#if defined(__EMSCRIPTEN__)
+        wgpu::ImageCopyBuffer source = {};
+#else
+        wgpu::TexelCopyBufferInfo source = {};
+#endif // __EMSCRIPTEN__
+        source.buffer = block.mBuffer;
+        source.layout.offset = iOffset;
+        source.layout.bytesPerRow = (uint32_t)iDstBytesPerRow;
+        source.layout.rowsPerImage = iNumRows;
+
+#if defined(__EMSCRIPTEN__)
+        wgpu::ImageCopyTexture destination = {};
+#else
+        wgpu::TexelCopyTextureInfo destination = {};
+#endif // __EMSCRIPTEN__
+        destination.aspect = wgpu::TextureAspect::All;
+        destination.mipLevel = iMipLevel;
+        destination.origin = {.x = iX, .y = iY, .z = iArrayLayer};
+        destination.texture = texture;
+
+        wgpu::Extent3D extent = {};
+        extent.width = iWidth;
+        extent.height = iHeight;
+        extent.depthOrArrayLayers = 1;
+
+        mCommandEncoder.CopyBufferToTexture(&source, &destination, &extent);
+
+        ++mStats.miNumTextureCopies;
+        mStats.miTextureBytes += iSrcBytesPerRow * iNumRows;
+    }
+
+    /*
+    **
+    */
+    CUploadManager::StagingBlock& CUploadManager::allocateStaging(uint64_t iSize)
+    {
+        // copy offsets keep the row alignment
+        if(maStagingBlocks.size() > 0)
+        {
+            StagingBlock& block = maStagingBlocks.back();
+            block.miOffset = alignUp(block.miOffset, COPY_BYTES_PER_ROW_ALIGNMENT);
+            if(block.miOffset + iSize <= block.miSize)
+            {
+                return block;
+            }
+        }
+
+        // images larger than a block get one of their own
+        StagingBlock block;
+        block.miSize = std::max(miStagingBlockSize, alignUp(iSize, COPY_BYTES_PER_ROW_ALIGNMENT));
+
+        wgpu::BufferDescriptor bufferDesc = {};
+        bufferDesc.size = block.miSize;
+        bufferDesc.usage = wgpu::BufferUsage::CopySrc;
+        bufferDesc.mappedAtCreation = true;
+        block.mBuffer = mpDevice->CreateBuffer(&bufferDesc);
+        block.mBuffer.SetLabel("Upload Staging Buffer");
+        block.mpData = (uint8_t*)block.mBuffer.GetMappedRange(0, block.miSize);
+        assert(block.mpData);
+
+        ++mStats.miNumStagingBlocks;
+        mStats.miStagingBytes += block.miSize;
+        maStagingBlocks.push_back(block);
+
+        uint64_t iPendingStagingBytes = 0;
+        for(auto const& stagingBlock : maStagingBlocks)
+        {
+            iPendingStagingBytes += stagingBlock.miSize;
+        }
+        mStats.miPeakStagingBytes = std::max(mStats.miPeakStagingBytes, iPendingStagingBytes);
+
+        return maStagingBlocks.back();
+    }
+
+    /*
+    **
+    */
+    void CUploadManager::flush()
+    {
+        // copies can't be submitted while the source is mapped
+        for(auto& block : maStagingBlocks)
+        {
+            block.mBuffer.Unmap();
+        }
+
+        if(mbHasPendingCopies)
+        {
+            wgpu::CommandBuffer commandBuffer = mCommandEncoder.Finish();
+            mpDevice->GetQueue().Submit(1, &commandBuffer);
+            mCommandEncoder = wgpu::CommandEncoder();
+            mbHasPendingCopies = false;
+        }
+
+        // the submitted copies keep the staging buffers alive until they're done
+        maStagingBlocks.clear();
+    }
+
+    /*
+    **
+    */
+    void CUploadManager::printStats() const
+    {
+        printf("upload: %d mapped buffers %.2f MB, %d texture copies %.2f MB through %d staging blocks %.2f MB (peak %.2f MB)\n",
+            mStats.miNumBuffers,
+            (double)mStats.miBufferBytes / (1024.0 * 1024.0),
+            mStats.miNumTextureCopies,
+            (double)mStats.miTextureBytes / (1024.0 * 1024.0),
+            mStats.miNumStagingBlocks,
+            (double)mStats.miStagingBytes / (1024.0 * 1024.0),
+            (double)mStats.miPeakStagingBytes / (1024.0 * 1024.0));
+    }
+
+}   // Render
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <webgpu/webgpu_cpp.h>
+
+#include <vector>
+
+#include <stdint.h>
+
+namespace Render
+{
+    /*
+    ** setup uploads without the extra copy through Queue::WriteBuffer/WriteTexture, buffers are
+    ** created mapped and filled in place, texture data goes into mapped staging blocks that are
+    ** copied over on flush()
+    */
+    class CUploadManager
+    {
+    public:
+        struct Stats
+        {
+            uint32_t        miNumBuffers = 0;
+            uint32_t        miNumTextureCopies = 0;
+            uint32_t        miNumStagingBlocks = 0;
+            uint64_t        miBufferBytes = 0;
+            uint64_t        miTextureBytes = 0;
+            uint64_t        miStagingBytes = 0;
+            uint64_t        miPeakStagingBytes = 0;
+        };
+
+    public:
+        CUploadManager() = default;
+        virtual ~CUploadManager() = default;
+
+        void setup(
+            wgpu::Device* pDevice,
+            uint64_t iStagingBlockSize = (1ull << 25));
+
+        // creates the buffer mapped, the caller fills the returned memory and calls Unmap() on the buffer
+        void* createMappedBuffer(
+            wgpu::Buffer& buffer,
+            wgpu::BufferDescriptor const& desc);
+
+        // mapped buffer filled with the data and unmapped, anything past iDataSize is zero
+        void createBufferWithData(
+            wgpu::Buffer& buffer,
+            wgpu::BufferDescriptor const& desc,
+            void const* pData,
+            uint64_t iDataSize);
+
+        // rows are copied into the staging block at the 256 byte row pitch the copy needs
+        void writeTexture(
+            wgpu::Texture const& texture,
+            uint32_t iX,
+            uint32_t iY,
+            uint32_t iWidth,
+            uint32_t iHeight,
+            uint32_t iBytesPerPixel,
+            void const* pData,
+            uint32_t iMipLevel = 0,
+            uint32_t iArrayLayer = 0);
+
+        // rows of 4 x 4 blocks, iWidth and iHeight are the level's size in texels
+        void writeCompressedTexture(
+            wgpu::Texture const& texture,
+            uint32_t iX,
+            uint32_t iY,
+            uint32_t iWidth,
+            uint32_t iHeight,
+            uint32_t iBytesPerBlock,
+            void const* pData,
+            uint32_t iMipLevel = 0,
+            uint32_t iArrayLayer = 0);
+
+        // unmaps the staging blocks and submits the pending texture copies
+        void flush();
+
+        void printStats() const;
+
+        inline Stats const& getStats() const
+        {
+            return mStats;
+        }
+
+    protected:
+        struct StagingBlock
+        {
+            wgpu::Buffer        mBuffer;
+            uint8_t*            mpData = nullptr;
+            uint64_t            miSize = 0;
+            uint64_t            miOffset = 0;
+        };
+
+        StagingBlock& allocateStaging(uint64_t iSize);
+
+        // iNumRows rows of iSrcBytesPerRow into staging, copied to the iWidth x iHeight region
+        void copyToTexture(
+            wgpu::Texture const& texture,
+            uint32_t iX,
+            uint32_t iY,
+            uint32_t iWidth,
+            uint32_t iHeight,
+            uint32_t iNumRows,
+            uint64_t iSrcBytesPerRow,
+            void const* pData,
+            uint32_t iMipLevel,
+            uint32_t iArrayLayer);
+
+    protected:
+        wgpu::Device*                       mpDevice = nullptr;
+        uint64_t                            miStagingBlockSize = 0;
+
+        std::vector<StagingBlock>           maStagingBlocks;
+        wgpu::CommandEncoder                mCommandEncoder;
+        bool                                mbHasPendingCopies = false;
+
+        Stats                               mStats;
+    };
+
+}   // Render
@@ -0,0 +1,498 @@
+#include <render/virtual_texture_streamer.h>
+
+#include <loader/loader.h>
+
+#include <algorithm>
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#define MAX_TILE_LOAD_ATTEMPTS          3
+
+// tiles asked for within this many frames aren't evicted, each pixel reports once every 16 frames
+#define MIN_EVICTION_AGE                32
+
+namespace Render
+{
+    /*
+    **
+    */
+    CVirtualTextureStreamer::~CVirtualTextureStreamer()
+    {
+        // a pending map calls back on destroy while this is still around
+        if(mFeedbackReadbackBuffer)
+        {
+            mFeedbackReadbackBuffer.Destroy();
+        }
+
+        // loader threads still hold on to this streamer through their callbacks
+        std::unique_lock<std::mutex> lock(mReadyMutex);
+        mAllLoaded.wait(lock, [&]
+        {
+            return miNumOutstandingLoads == 0;
+        });
+    }
+
+    /*
+    **
+    */
+    bool CVirtualTextureStreamer::setup(
+        CreateDescriptor const& desc,
+        std::vector<char> const& acHeaderData)
+    {
+        mDesc = desc;
+
+        if(acHeaderData.size() < sizeof(FileHeader) || memcmp(acHeaderData.data(), "VTEX", 4) != 0)
+        {
+            return false;
+        }
+        memcpy(&mHeader, acHeaderData.data(), sizeof(FileHeader));
+        if(mHeader.miTileSize == 0 ||
+           mHeader.miNumTiles == 0 ||
+           mDesc.miCacheSize < mHeader.miTileSize ||
+           acHeaderData.size() < sizeof(FileHeader) + sizeof(TextureInfo) * mHeader.miNumTextures)
+        {
+            printf("%s : %d invalid virtual texture header in \"%s\"\n", __FILE__, __LINE__, mDesc.mFilePath.c_str());
+            return false;
+        }
+
+        std::vector<TextureInfo> aTextureInfo(mHeader.miNumTextures);
+        memcpy(aTextureInfo.data(), acHeaderData.data() + sizeof(FileHeader), sizeof(TextureInfo) * mHeader.miNumTextures);
+        miTileDataOffset = sizeof(FileHeader) + sizeof(TextureInfo) * mHeader.miNumTextures;
+        miTileBytes = (uint64_t)mHeader.miTileSize * mHeader.miTileSize * 4;
+
+        // mip level of each tile and the tail tile of each texture to pin
+        maTiles.assign(mHeader.miNumTiles, Tile());
+        for(auto const& info : aTextureInfo)
+        {
+            uint32_t iTile = info.miTileBase;
+            for(uint32_t iMip = 0; iMip < info.miNumMipLevels; iMip++)
+            {
+                uint32_t iLevelWidth = std::max(info.miWidth >> iMip, 1u);
+                uint32_t iLevelHeight = std::max(info.miHeight >> iMip, 1u);
+                uint32_t iNumLevelTiles =
+                    ((iLevelWidth + mHeader.miTileSize - 1) / mHeader.miTileSize) *
+                    ((iLevelHeight + mHeader.miTileSize - 1) / mHeader.miTileSize);
+                if(iTile + iNumLevelTiles > mHeader.miNumTiles)
+                {
+                    printf("%s : %d virtual texture tiles out of range in \"%s\"\n", __FILE__, __LINE__, mDesc.mFilePath.c_str());
+                    return false;
+                }
+
+                for(uint32_t i = 0; i < iNumLevelTiles; i++)
+                {
+                    maTiles[iTile + i].miMipLevel = (uint8_t)iMip;
+                }
+                if(iMip + 1 == info.miNumMipLevels)
+                {
+                    maTiles[iTile].mbPinned = true;
+                    maiPendingPinnedTiles.push_back(iTile);
+                }
+                iTile += iNumLevelTiles;
+            }
+        }
+
+        miSlotsPerRow = mDesc.miCacheSize / mHeader.miTileSize;
+        uint32_t iNumSlots = miSlotsPerRow * miSlotsPerRow;
+        maiSlotTiles.assign(iNumSlots, UINT32_MAX);
+        maiSlotLastUsed.assign(iNumSlots, 0);
+        maiFreeSlots.resize(iNumSlots);
+        for(uint32_t iSlot = 0; iSlot < iNumSlots; iSlot++)
+        {
+            maiFreeSlots[iSlot] = iNumSlots - 1 - iSlot;
+        }
+
+        // pinned tails past half the cache would leave nothing to stream into
+        if((uint32_t)maiPendingPinnedTiles.size() > iNumSlots / 2)
+        {
+            printf("%s : %d %d texture tails don\'t fit in half of the %d slot cache, only the first %d stay resident\n",
+                __FILE__,
+                __LINE__,
+                (uint32_t)maiPendingPinnedTiles.size(),
+                iNumSlots,
+                iNumSlots / 2);
+            for(uint32_t i = iNumSlots / 2; i < (uint32_t)maiPendingPinnedTiles.size(); i++)
+            {
+                maTiles[maiPendingPinnedTiles[i]].mbPinned = false;
+            }
+            maiPendingPinnedTiles.resize(iNumSlots / 2);
+        }
+
+        wgpu::BufferDescriptor bufferDesc = {};
+        bufferDesc.usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst;
+        bufferDesc.size = std::max((uint64_t)sizeof(TextureInfo) * mHeader.miNumTextures, (uint64_t)64);
+        bufferDesc.label = "Virtual Texture Info Buffer";
+        mTextureInfoBuffer = mDesc.mpDevice->CreateBuffer(&bufferDesc);
+        if(mHeader.miNumTextures > 0)
+        {
+            mDesc.mpDevice->GetQueue().WriteBuffer(mTextureInfoBuffer, 0, aTextureInfo.data(), sizeof(TextureInfo) * mHeader.miNumTextures);
+        }
+
+        // slot + 1 per virtual tile, 0 is not resident so the buffer starts out empty
+        bufferDesc.size = std::max((uint64_t)sizeof(uint32_t) * mHeader.miNumTiles, (uint64_t)64);
+        bufferDesc.label = "Virtual Texture Page Table";
+        mPageTableBuffer = mDesc.mpDevice->CreateBuffer(&bufferDesc);
+
+        // a bit per virtual tile
+        miFeedbackSize = std::max((uint64_t)((mHeader.miNumTiles + 31) / 32) * sizeof(uint32_t), (uint64_t)64);
+        bufferDesc.usage = wgpu::BufferUsage::Storage | wgpu::BufferUsage::CopyDst | wgpu::BufferUsage::CopySrc;
+        bufferDesc.size = miFeedbackSize;
+        bufferDesc.label = "Virtual Texture Feedback";
+        mFeedbackBuffer = mDesc.mpDevice->CreateBuffer(&bufferDesc);
+
+        bufferDesc.usage = wgpu::BufferUsage::MapRead | wgpu::BufferUsage::CopyDst;
+        bufferDesc.label = "Virtual Texture Feedback Readback";
+        mFeedbackReadbackBuffer = mDesc.mpDevice->CreateBuffer(&bufferDesc);
+
+        wgpu::TextureDescriptor textureDesc = {};
+        textureDesc.usage = wgpu::TextureUsage::CopyDst | wgpu::TextureUsage::TextureBinding;
+        textureDesc.dimension = wgpu::TextureDimension::e2D;
+        textureDesc.format = wgpu::TextureFormat::RGBA8Unorm;
+        textureDesc.mipLevelCount = 1;
+        textureDesc.sampleCount = 1;
+        textureDesc.size.width = miSlotsPerRow * mHeader.miTileSize;
+        textureDesc.size.height = miSlotsPerRow * mHeader.miTileSize;
+        textureDesc.size.depthOrArrayLayers = 1;
+        textureDesc.label = "Virtual Texture Cache";
+        mCacheTexture = mDesc.mpDevice->CreateTexture(&textureDesc);
+
+        printf("virtual texture: %d textures, %d tiles, %d x %d cache with %d slots\n",
+            mHeader.miNumTextures,
+            mHeader.miNumTiles,
+            textureDesc.size.width,
+            textureDesc.size.height,
+            iNumSlots);
+
+        return true;
+    }
+
+    /*
+    **
+    */
+    void CVirtualTextureStreamer::update()
+    {
+        ++miFrame;
+
+        // tiles the last read back frame asked for
+        if(mReadbackState == ReadbackState::Mapped)
+        {
+            maiRequestedTiles.clear();
+            uint32_t const* aiFeedback = (uint32_t const*)mFeedbackReadbackBuffer.GetConstMappedRange(0, miFeedbackSize);
+            if(aiFeedback != nullptr)
+            {
+                uint32_t iNumWords = (mHeader.miNumTiles + 31) / 32;
+                for(uint32_t iWord = 0; iWord < iNumWords; iWord++)
+                {
+                    uint32_t iBits = aiFeedback[iWord];
+                    while(iBits != 0)
+                    {
+                        uint32_t iBit = 0;
+                        while(((iBits >> iBit) & 1) == 0)
+                        {
+                            ++iBit;
+                        }
+                        iBits &= ~(1u << iBit);
+
+                        uint32_t iTile = iWord * 32 + iBit;
+                        if(iTile < mHeader.miNumTiles)
+                        {
+                            maiRequestedTiles.push_back(iTile);
+                        }
+                    }
+                }
+            }
+            mFeedbackReadbackBuffer.Unmap();
+            mReadbackState = ReadbackState::Idle;
+
+            for(uint32_t iTile : maiRequestedTiles)
+            {
+                if(maTiles[iTile].mState == TileState::Resident)
+                {
+                    maiSlotLastUsed[maTiles[iTile].miSlot] = miFrame;
+                }
+            }
+
+            // coarse levels first, they stand in for the finer ones while those load
+            maiRequestedTiles.erase(
+                std::remove_if(
+                    maiRequestedTiles.begin(),
+                    maiRequestedTiles.end(),
+                    [&](uint32_t iTile)
+                    {
+                        return maTiles[iTile].mState != TileState::NotLoaded;
+                    }),
+                maiRequestedTiles.end());
+            std::stable_sort(
+                maiRequestedTiles.begin(),
+                maiRequestedTiles.end(),
+                [&](uint32_t iLeft, uint32_t iRight)
+                {
+                    return maTiles[iLeft].miMipLevel > maTiles[iRight].miMipLevel;
+                });
+        }
+
+        // upload the tiles that arrived since the last frame
+        std::vector<LoadedTile> aUploadTiles;
+        {
+            std::lock_guard<std::mutex> lock(mReadyMutex);
+            while(maReadyTiles.size() > 0 && (uint32_t)aUploadTiles.size() < mDesc.miMaxUploadsPerFrame)
+            {
+                aUploadTiles.push_back(std::move(maReadyTiles.front()));
+                maReadyTiles.pop_front();
+            }
+        }
+        for(auto const& loadedTile : aUploadTiles)
+        {
+            --miNumRequestsInFlight;
+            uploadTile(loadedTile);
+        }
+
+        // pinned tails go ahead of the feedback requests
+        while(miNumRequestsInFlight < mDesc.miMaxRequestsInFlight && maiPendingPinnedTiles.size() > 0)
+        {
+            requestTile(maiPendingPinnedTiles.back());
+            maiPendingPinnedTiles.pop_back();
+        }
+
+        uint32_t iNumRequests = 0;
+        for(uint32_t iTile : maiRequestedTiles)
+        {
+            if(miNumRequestsInFlight >= mDesc.miMaxRequestsInFlight)
+            {
+                break;
+            }
+            if(maTiles[iTile].mState == TileState::NotLoaded)
+            {
+                requestTile(iTile);
+            }
+            ++iNumRequests;
+        }
+        maiRequestedTiles.erase(maiRequestedTiles.begin(), maiRequestedTiles.begin() + iNumRequests);
+    }
+
+    /*
+    **
+    */
+    void CVirtualTextureStreamer::addFeedbackCommands(wgpu::CommandEncoder& commandEncoder)
+    {
+        // bits keep accumulating while the last copy is still being read back
+        if(mReadbackState != ReadbackState::Idle)
+        {
+            return;
+        }
+
+        commandEncoder.PushDebugGroup("Virtual Texture Feedback");
+        commandEncoder.CopyBufferToBuffer(mFeedbackBuffer, 0, mFeedbackReadbackBuffer, 0, miFeedbackSize);
+        commandEncoder.ClearBuffer(mFeedbackBuffer, 0, miFeedbackSize);
+        commandEncoder.PopDebugGroup();
+
+        mReadbackState = ReadbackState::Copied;
+    }
+
+    /*
+    **
+    */
+    void CVirtualTextureStreamer::readBackFeedback()
+    {
+        if(mReadbackState != ReadbackState::Copied)
+        {
+            return;
+        }
+        mReadbackState = ReadbackState::Mapping;
+
+#if defined(__EMSCRIPTEN__)
+        wgpu::BufferMapCallback callBack = [](WGPUBufferMapAsyncStatus status, void* pUserData)
+        {
+            CVirtualTextureStreamer* pStreamer = (CVirtualTextureStreamer*)pUserData;
+            pStreamer->mReadbackState = (status == WGPUBufferMapAsyncStatus_Success) ? ReadbackState::Mapped : ReadbackState::Idle;
+        };
+        mFeedbackReadbackBuffer.MapAsync(wgpu::MapMode::Read, 0, miFeedbackSize, callBack, this);
+#else
+        // picked up by the instance's ProcessEvents() in the frame loop
+        mFeedbackReadbackBuffer.MapAsync(
+            wgpu::MapMode::Read,
+            0,
+            miFeedbackSize,
+            wgpu::CallbackMode::AllowProcessEvents,
+            [this](wgpu::MapAsyncStatus status, const char* message)
+            {
+                if(status != wgpu::MapAsyncStatus::Success)
+                {
+                    printf("%s : %d can\'t map feedback readback buffer, status = %d -- message: \"%s\"\n",
+                        __FILE__,
+                        __LINE__,
+                        (uint32_t)status,
+                        (message != nullptr) ? message : "");
+                }
+
+                mReadbackState = (status == wgpu::MapAsyncStatus::Success) ? ReadbackState::Mapped : ReadbackState::Idle;
+            });
+#endif // __EMSCRIPTEN__
+    }
+
+    /*
+    **
+    */
+    void CVirtualTextureStreamer::requestTile(uint32_t iTile)
+    {
+        Tile& tile = maTiles[iTile];
+        tile.mState = TileState::Requested;
+        ++tile.miNumAttempts;
+        ++miNumRequestsInFlight;
+
+        {
+            std::lock_guard<std::mutex> lock(mReadyMutex);
+            ++miNumOutstandingLoads;
+        }
+
+        Loader::requestFileRange(
+            mDesc.mFilePath,
+            miTileDataOffset + (uint64_t)iTile * miTileBytes,
+            miTileBytes,
+            [this, iTile](std::vector<char>& acData, bool bSucceeded)
+            {
+                std::lock_guard<std::mutex> lock(mReadyMutex);
+                LoadedTile loadedTile;
+                loadedTile.miTile = iTile;
+                loadedTile.mbSucceeded = bSucceeded && acData.size() == miTileBytes;
+                loadedTile.macData.swap(acData);
+                maReadyTiles.push_back(std::move(loadedTile));
+
+                --miNumOutstandingLoads;
+                mAllLoaded.notify_all();
+            });
+    }
+
+    /*
+    **
+    */
+    void CVirtualTextureStreamer::uploadTile(LoadedTile const& loadedTile)
+    {
+        Tile& tile = maTiles[loadedTile.miTile];
+        if(!loadedTile.mbSucceeded)
+        {
+            tile.mState = (tile.miNumAttempts >= MAX_TILE_LOAD_ATTEMPTS) ? TileState::Failed : TileState::NotLoaded;
+            if(tile.mState == TileState::Failed)
+            {
+                printf("%s : %d failed to stream virtual texture tile %d from \"%s\"\n",
+                    __FILE__,
+                    __LINE__,
+                    loadedTile.miTile,
+                    mDesc.mFilePath.c_str());
+            }
+            else if(tile.mbPinned)
+            {
+                maiPendingPinnedTiles.push_back(loadedTile.miTile);
+            }
+            return;
+        }
+
+        uint32_t iSlot = allocateSlot();
+        if(iSlot == UINT32_MAX)
+        {
+            // every slot is in view, asked for again once something falls out of it
+            tile.mState = TileState::NotLoaded;
+            if(tile.mbPinned)
+            {
+                maiPendingPinnedTiles.push_back(loadedTile.miTile);
+            }
+            if(miNumCacheFullFrames++ == 0)
+            {
+                printf("%s : %d virtual texture cache is full, raise miVirtualTextureCacheSize\n", __FILE__, __LINE__);
+            }
+            return;
+        }
+
+        uint32_t iTileSize = mHeader.miTileSize;
+
+#if defined(__EMSCRIPTEN__)
+        wgpu::ImageCopyTexture destination = {};
+        wgpu::TextureDataLayout layout = {};
+#else
+        wgpu::TexelCopyTextureInfo destination = {};
+        wgpu::TexelCopyBufferLayout layout = {};
+#endif // __EMSCRIPTEN__
+        destination.texture = mCacheTexture;
+        destination.aspect = wgpu::TextureAspect::All;
+        destination.mipLevel = 0;
+        destination.origin = {.x = (iSlot % miSlotsPerRow) * iTileSize, .y = (iSlot / miSlotsPerRow) * iTileSize, .z = 0};
+        layout.offset = 0;
+        layout.bytesPerRow = iTileSize * 4;
+        layout.rowsPerImage = iTileSize;
+
+        wgpu::Extent3D extent = {};
+        extent.width = iTileSize;
+        extent.height = iTileSize;
+        extent.depthOrArrayLayers = 1;
+
+        mDesc.mpDevice->GetQueue().WriteTexture(
+            &destination,
+            loadedTile.macData.data(),
+            loadedTile.macData.size(),
+            &layout,
+            &extent);
+
+        uint32_t iPageTableEntry = iSlot + 1;
+        mDesc.mpDevice->GetQueue().WriteBuffer(
+            mPageTableBuffer,
+            (uint64_t)loadedTile.miTile * sizeof(uint32_t),
+            &iPageTableEntry,
+            sizeof(uint32_t));
+
+        tile.mState = TileState::Resident;
+        tile.miSlot = iSlot;
+        maiSlotTiles[iSlot] = loadedTile.miTile;
+        maiSlotLastUsed[iSlot] = miFrame;
+    }
+
+    /*
+    **
+    */
+    uint32_t CVirtualTextureStreamer::allocateSlot()
+    {
+        if(maiFreeSlots.size() > 0)
+        {
+            uint32_t iSlot = maiFreeSlots.back();
+            maiFreeSlots.pop_back();
+            return iSlot;
+        }
+
+        // least recently asked for tile that's out of view for a while
+        uint32_t iEvictSlot = UINT32_MAX;
+        uint32_t iOldestFrame = UINT32_MAX;
+        for(uint32_t iSlot = 0; iSlot < (uint32_t)maiSlotTiles.size(); iSlot++)
+        {
+            uint32_t iTile = maiSlotTiles[iSlot];
+            if(iTile == UINT32_MAX || maTiles[iTile].mbPinned)
+            {
+                continue;
+            }
+            if(maiSlotLastUsed[iSlot] < iOldestFrame)
+            {
+                iOldestFrame = maiSlotLastUsed[iSlot];
+                iEvictSlot = iSlot;
+            }
+        }
+        if(iEvictSlot == UINT32_MAX || miFrame - iOldestFrame < MIN_EVICTION_AGE)
+        {
+            return UINT32_MAX;
+        }
+
+        uint32_t iEvictTile = maiSlotTiles[iEvictSlot];
+        maTiles[iEvictTile].mState = TileState::NotLoaded;
+        maTiles[iEvictTile].miSlot = UINT32_MAX;
+        maTiles[iEvictTile].miNumAttempts = 0;
+        maiSlotTiles[iEvictSlot] = UINT32_MAX;
+
+        uint32_t iPageTableEntry = 0;
+        mDesc.mpDevice->GetQueue().WriteBuffer(
+            mPageTableBuffer,
+            (uint64_t)iEvictTile * sizeof(uint32_t),
+            &iPageTableEntry,
+            sizeof(uint32_t));
+
+        return iEvictSlot;
+    }
+
+}   // Render
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <webgpu/webgpu_cpp.h>
+
+#include <deque>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace Render
+{
+    /*
+    ** virtual texture from obj_2_binary --bake-virtual-texture, every diffuse texture's mip chain cut
+    ** into tiles. the deferred pass marks the tiles it wants in a feedback bitmask, that's read back,
+    ** the missing tiles are streamed from the file into slots of the physical cache texture and the
+    ** page table maps each virtual tile to its slot. least recently requested tiles are evicted, the
+    ** single tile last level of each texture stays resident as the fallback
+    */
+    class CVirtualTextureStreamer
+    {
+    public:
+        // header of -virtual-texture.bin
+        struct FileHeader
+        {
+            char            macSignature[4];
+            uint32_t        miTileSize;
+            uint32_t        miNumTextures;
+            uint32_t        miNumTiles;
+        };
+
+        // same layout as VirtualTextureInfo in deferred.shader
+        struct TextureInfo
+        {
+            uint32_t        miTileBase;
+            uint32_t        miWidth;
+            uint32_t        miHeight;
+            uint32_t        miNumMipLevels;
+        };
+
+        struct CreateDescriptor
+        {
+            wgpu::Device*   mpDevice;
+            std::string     mFilePath;
+            uint32_t        miCacheSize = 4096;
+            uint32_t        miMaxRequestsInFlight = 32;
+            uint32_t        miMaxUploadsPerFrame = 16;
+        };
+
+        enum class TileState
+        {
+            NotLoaded = 0,
+            Requested,
+            Resident,
+            Failed,
+        };
+
+    public:
+        CVirtualTextureStreamer() = default;
+        virtual ~CVirtualTextureStreamer();
+
+        // acHeaderData holds the header and texture entries, false if they don't describe a usable file
+        bool setup(
+            CreateDescriptor const& desc,
+            std::vector<char> const& acHeaderData);
+
+        // before the frame's commands, reads the last feedback, uploads tiles that arrived and asks for more
+        void update();
+
+        // after the frame's commands, copies the feedback out for reading back and clears it
+        void addFeedbackCommands(wgpu::CommandEncoder& commandEncoder);
+
+        // after the submit that copied the feedback
+        void readBackFeedback();
+
+        inline wgpu::Buffer const& getTextureInfoBuffer() const
+        {
+            return mTextureInfoBuffer;
+        }
+
+        inline wgpu::Buffer const& getPageTableBuffer() const
+        {
+            return mPageTableBuffer;
+        }
+
+        inline wgpu::Buffer const& getFeedbackBuffer() const
+        {
+            return mFeedbackBuffer;
+        }
+
+        inline wgpu::Texture const& getCacheTexture() const
+        {
+            return mCacheTexture;
+        }
+
+    protected:
+        struct Tile
+        {
+            TileState       mState = TileState::NotLoaded;
+            uint32_t        miSlot = UINT32_MAX;
+            uint8_t         miMipLevel = 0;
+            uint8_t         miNumAttempts = 0;
+            bool            mbPinned = false;
+        };
+
+        struct LoadedTile
+        {
+            uint32_t            miTile;
+            bool                mbSucceeded;
+            std::vector<char>   macData;
+        };
+
+        enum class ReadbackState
+        {
+            Idle = 0,
+            Copied,
+            Mapping,
+            Mapped,
+        };
+
+        void requestTile(uint32_t iTile);
+        void uploadTile(LoadedTile const& loadedTile);
+        uint32_t allocateSlot();
+
+    protected:
+        CreateDescriptor                        mDesc;
+        FileHeader                              mHeader;
+        uint64_t                                miTileDataOffset = 0;
+        uint64_t                                miTileBytes = 0;
+
+        std::vector<Tile>                       maTiles;
+        std::vector<uint32_t>                   maiPendingPinnedTiles;
+        uint32_t                                miNumRequestsInFlight = 0;
+
+        // cache slots, the tile in each and the frame it was last asked for
+        uint32_t                                miSlotsPerRow = 0;
+        std::vector<uint32_t>                   maiSlotTiles;
+        std::vector<uint32_t>                   maiSlotLastUsed;
+        std::vector<uint32_t>                   maiFreeSlots;
+        uint32_t                                miFrame = 0;
+        uint32_t                                miNumCacheFullFrames = 0;
+
+        wgpu::Buffer                            mTextureInfoBuffer;
+        wgpu::Buffer                            mPageTableBuffer;
+        wgpu::Buffer                            mFeedbackBuffer;
+        wgpu::Buffer                            mFeedbackReadbackBuffer;
+        wgpu::Texture                           mCacheTexture;
+        uint64_t                                miFeedbackSize = 0;
+        ReadbackState                           mReadbackState = ReadbackState::Idle;
+        std::vector<uint32_t>                   maiRequestedTiles;
+
+        // filled from the loader threads, drained on the render thread
+        std::deque<LoadedTile>                  maReadyTiles;
+        std::mutex                              mReadyMutex;
+        std::condition_variable                 mAllLoaded;
+        uint32_t                                miNumOutstandingLoads = 0;
+    };
+
+}   // Render
@@ -73,9 +73,19 @@ struct TextureAtlasInfo
     miTextureID: u32,
     miImageWidth: u32,
     miImageHeight: u32,
-    miPadding0: u32,
+    miPage: u32,
 };
 
+struct VirtualTextureInfo
+{
+    miTileBase: u32,
+    miWidth: u32,
+    miHeight: u32,
+    miNumMipLevels: u32,
+};
+
+const VIRTUAL_TEXTURE_TILE_SIZE: u32 = 128u;
+
 @group(1) @binding(0)
 var<uniform> uniformBuffer: UniformData;
 
@@ -95,12 +105,24 @@ var<storage, read> aMeshExtents: array<MeshExtent>;
 var<storage, read> diffuseTextureAtlasInfoBuffer: array<TextureAtlasInfo>;
 
 @group(1) @binding(6)
-var diffuseTextureAtlas: texture_2d<f32>;
+var diffuseTextureAtlas: texture_2d_array<f32>;
 
 @group(1) @binding(7)
-var<uniform> defaultUniformBuffer: DefaultUniformData;
+var<storage, read> aVirtualTextureInfo: array<VirtualTextureInfo>;
 
 @group(1) @binding(8)
+var<storage, read> aiVirtualTexturePageTable: array<u32>;
+
+@group(1) @binding(9)
+var<storage, read_write> aiVirtualTextureFeedback: array<atomic<u32>>;
+
+@group(1) @binding(10)
+var virtualTextureCache: texture_2d<f32>;
+
+@group(1) @binding(11)
+var<uniform> defaultUniformBuffer: DefaultUniformData;
+
+@group(1) @binding(12)
 var textureSampler: sampler;
 
 struct VertexInput 
@@ -111,7 +133,8 @@ struct VertexInput
 };
 struct VertexOutput 
 {
-    @builtin(position) pos: vec4<f32>,
+    // matches the depth prepass exactly
+    @invariant @builtin(position) pos: vec4<f32>,
     @location(0) worldPosition: vec4<f32>,
     @location(1) texCoord: vec4<f32>,
     @location(2) normal: vec4<f32>,
@@ -156,12 +179,70 @@ fn vs_main(in: VertexInput,
     return out;
 }
 
+/////
+// texel from the finest resident level at or above the footprint's, the wanted tile is flagged
+// for streaming from one pixel of each 4 x 4 block per frame
+fn sampleVirtualTexture(
+    iTextureID: u32,
+    uv: vec2f,
+    texCoordDX: vec2f,
+    texCoordDY: vec2f,
+    screenCoord: vec2u) -> vec4f
+{
+    let info: VirtualTextureInfo = aVirtualTextureInfo[iTextureID];
+    let imageSize: vec2f = vec2f(f32(info.miWidth), f32(info.miHeight));
+    let fFootprint: f32 = max(length(texCoordDX * imageSize), length(texCoordDY * imageSize));
+    let iWantedMipLevel: u32 = u32(clamp(i32(floor(log2(max(fFootprint, 1.0f)))), 0, i32(info.miNumMipLevels) - 1));
+
+    let iSlotsPerRow: u32 = textureDimensions(virtualTextureCache).x / VIRTUAL_TEXTURE_TILE_SIZE;
+    let bFeedback: bool = ((screenCoord.x & 3u) | ((screenCoord.y & 3u) << 2u)) == (u32(defaultUniformBuffer.miFrame) & 15u);
+
+    var ret: vec4f = vec4f(1.0f, 1.0f, 1.0f, 1.0f);
+    var iLevelTileBase: u32 = info.miTileBase;
+    for(var iMipLevel: u32 = 0u; iMipLevel < info.miNumMipLevels; iMipLevel++)
+    {
+        let levelSize: vec2u = max(vec2u(info.miWidth, info.miHeight) >> vec2u(iMipLevel), vec2u(1u, 1u));
+        let numTiles: vec2u = (levelSize + vec2u(VIRTUAL_TEXTURE_TILE_SIZE - 1u)) / VIRTUAL_TEXTURE_TILE_SIZE;
+        if(iMipLevel >= iWantedMipLevel)
+        {
+            let texel: vec2u = min(vec2u(uv * vec2f(levelSize)), levelSize - vec2u(1u, 1u));
+            let tile: vec2u = texel / VIRTUAL_TEXTURE_TILE_SIZE;
+            let iTile: u32 = iLevelTileBase + tile.y * numTiles.x + tile.x;
+            if(iMipLevel == iWantedMipLevel && bFeedback)
+            {
+                atomicOr(&aiVirtualTextureFeedback[iTile >> 5u], 1u << (iTile & 31u));
+            }
+
+            // page table holds the cache slot + 1
+            let iSlot: u32 = aiVirtualTexturePageTable[iTile];
+            if(iSlot > 0u)
+            {
+                let slotCoord: vec2u = vec2u((iSlot - 1u) % iSlotsPerRow, (iSlot - 1u) / iSlotsPerRow) * VIRTUAL_TEXTURE_TILE_SIZE;
+                ret = textureLoad(
+                    virtualTextureCache,
+                    slotCoord + texel % vec2u(VIRTUAL_TEXTURE_TILE_SIZE),
+                    0);
+                break;
+            }
+        }
+
+        iLevelTileBase += numTiles.x * numTiles.y;
+    }
+
+    return ret;
+}
+
 @fragment
 fn fs_main(in: VertexOutput) -> FragmentOutput 
 {
     var out: FragmentOutput;
     
     let diffuseAtlasTextureSize: vec2u = textureDimensions(diffuseTextureAtlas);
+    let iNumAtlasMipLevels: i32 = i32(textureNumLevels(diffuseTextureAtlas));
+
+    // uv derivatives taken here while control flow is still uniform
+    let texCoordDX: vec2f = dpdx(in.texCoord.xy);
+    let texCoordDY: vec2f = dpdy(in.texCoord.xy);
     
     var planeNormal: vec3f = vec3f(-1.0f, 0.0f, 0.0f);
     var fPlaneD: f32 = -uniformBuffer.mfCrossSectionPlaneD;
@@ -256,7 +337,17 @@ fn fs_main(in: VertexOutput) -> FragmentOutput
         var albedo: vec4<f32> = vec4f(1.0f, 1.0f, 1.0f, 1.0f);
         let iTextureID: u32 = aMaterials[iMesh].miAlbedoTextureID;
 
-        if(iTextureID <= 100000)
+        let bVirtualTexture: bool = (iTextureID < arrayLength(&aVirtualTextureInfo) && aVirtualTextureInfo[iTextureID].miNumMipLevels > 0u);
+        if(iTextureID <= 100000 && bVirtualTexture)
+        {
+            albedo = sampleVirtualTexture(
+                iTextureID,
+                vec2f(texCoord.x, 1.0f - texCoord.y),
+                texCoordDX,
+                texCoordDY,
+                vec2u(in.pos.xy));
+        }
+        else if(iTextureID <= 100000)
         {
             let textureAtlasInfo: TextureAtlasInfo = diffuseTextureAtlasInfoBuffer[iTextureID];
 
@@ -266,14 +357,20 @@ fn fs_main(in: VertexOutput) -> FragmentOutput
             );
             let textureUV: vec2f = textureAtlasInfo.mUV.xy + vec2f(texCoord.x, 1.0f - texCoord.y) * atlasPct.xy;
 
+            // mip level from the texel footprint in the texture, the gutters cover the levels' filter width
+            let imageSize: vec2f = vec2f(f32(textureAtlasInfo.miImageWidth), f32(textureAtlasInfo.miImageHeight));
+            let fFootprint: f32 = max(length(texCoordDX * imageSize), length(texCoordDY * imageSize));
+            let iMipLevel: i32 = clamp(i32(floor(log2(max(fFootprint, 1.0f)))), 0, iNumAtlasMipLevels - 1);
+
             let imageCoord: vec2i = vec2i(
-                i32(textureUV.x * 8192.0f),
-                i32(textureUV.y * 8192.0f)
-            );
+                i32(textureUV.x * f32(diffuseAtlasTextureSize.x)),
+                i32(textureUV.y * f32(diffuseAtlasTextureSize.y))
+            ) >> vec2u(u32(iMipLevel));
             albedo = textureLoad(
                 diffuseTextureAtlas,
                 imageCoord,
-                0
+                i32(textureAtlasInfo.miPage),
+                iMipLevel
             );
         }
 
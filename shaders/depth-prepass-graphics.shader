@@ -0,0 +1,96 @@
+struct UniformData
+{
+    mfExplodeMultiplier: f32,
+    mfCrossSectionPlaneD: f32
+};
+
+struct DefaultUniformData
+{
+    miScreenWidth: i32,
+    miScreenHeight: i32,
+    miFrame: i32,
+    miNumMeshes: u32,
+
+    mfRand0: f32,
+    mfRand1: f32,
+    mfRand2: f32,
+    mfRand3: f32,
+
+    mViewProjectionMatrix: mat4x4<f32>,
+    mPrevViewProjectionMatrix: mat4x4<f32>,
+    mViewMatrix: mat4x4<f32>,
+    mProjectionMatrix: mat4x4<f32>,
+
+    mJitteredViewProjectionMatrix: mat4x4<f32>,
+    mPrevJitteredViewProjectionMatrix: mat4x4<f32>,
+
+    mCameraPosition: vec4<f32>,
+    mCameraLookDir: vec4<f32>,
+
+    mLightRadiance: vec4<f32>,
+    mLightDirection: vec4<f32>,
+};
+
+struct MeshExtent
+{
+    mMinPosition: vec4<f32>,
+    mMaxPosition: vec4<f32>,
+};
+
+@group(1) @binding(0)
+var<uniform> uniformBuffer: UniformData;
+
+@group(1) @binding(1)
+var<storage, read> aMeshExtents: array<MeshExtent>;
+
+@group(1) @binding(2)
+var<uniform> defaultUniformBuffer: DefaultUniformData;
+
+struct VertexInput 
+{
+    @location(0) worldPosition : vec4<f32>,
+};
+struct VertexOutput 
+{
+    @invariant @builtin(position) pos: vec4<f32>,
+    @location(0) worldPosition: vec4<f32>,
+};
+
+/////
+// same positions as the deferred pass from the positions alone, the mesh index is in w
+@vertex
+fn vs_main(in: VertexInput) -> VertexOutput 
+{
+    var out: VertexOutput;
+    
+    let iMesh: u32 = u32(ceil(in.worldPosition.w - 0.5f));
+    let midPt: vec3f = (aMeshExtents[iMesh].mMaxPosition.xyz + aMeshExtents[iMesh].mMinPosition.xyz) * 0.5f;
+
+    // total mesh extent is at the very end of list
+    let totalMeshExtent: MeshExtent = aMeshExtents[defaultUniformBuffer.miNumMeshes];
+    let totalCenter: vec3f = (totalMeshExtent.mMaxPosition.xyz + totalMeshExtent.mMinPosition.xyz) * 0.5f;
+
+    let worldPosition: vec4<f32> = vec4<f32>(
+        in.worldPosition.x,
+        in.worldPosition.y,
+        in.worldPosition.z - (totalCenter.z - midPt.z) * max(uniformBuffer.mfExplodeMultiplier, 0.0f),
+        1.0f
+    );
+    out.pos = worldPosition * defaultUniformBuffer.mJitteredViewProjectionMatrix;
+    out.worldPosition = worldPosition;
+
+    return out;
+}
+
+/////
+// only depth is written, cut by the deferred pass's cross section plane
+@fragment
+fn fs_main(in: VertexOutput)
+{
+    let planeNormal: vec3f = vec3f(-1.0f, 0.0f, 0.0f);
+    let fDistanceToPlane: f32 = dot(planeNormal, in.worldPosition.xyz) - uniformBuffer.mfCrossSectionPlaneD;
+    if(fDistanceToPlane > 0.0f)
+    {
+        discard;
+    }
+}
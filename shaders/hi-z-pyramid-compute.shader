@@ -0,0 +1,155 @@
+struct DefaultUniformData
+{
+    miScreenWidth: i32,
+    miScreenHeight: i32,
+    miFrame: i32,
+    miNumMeshes: u32,
+
+    mfRand0: f32,
+    mfRand1: f32,
+    mfRand2: f32,
+    mfRand3: f32,
+
+    mViewProjectionMatrix: mat4x4<f32>,
+    mPrevViewProjectionMatrix: mat4x4<f32>,
+    mViewMatrix: mat4x4<f32>,
+    mProjectionMatrix: mat4x4<f32>,
+
+    mJitteredViewProjectionMatrix: mat4x4<f32>,
+    mPrevJitteredViewProjectionMatrix: mat4x4<f32>,
+
+    mCameraPosition: vec4<f32>,
+    mCameraLookDir: vec4<f32>,
+
+    mLightRadiance: vec4<f32>,
+    mLightDirection: vec4<f32>,
+};
+
+@group(0) @binding(0) var<storage, read_write> afHiZPyramid: array<f32>;
+@group(0) @binding(1) var depthTexture: texture_2d<f32>;
+
+@group(1) @binding(0) var<uniform> defaultUniformBuffer: DefaultUniformData;
+
+const iNumThreads = 256u;
+
+// depth pixels on a side of the tile each workgroup reduces to a single texel at level 5
+const iTileSize = 64u;
+
+var<workgroup> afTile0: array<f32, 1024>;
+var<workgroup> afTile1: array<f32, 256>;
+
+/////
+// level 0 is half the screen size, each level after is half of the one before, rounded up
+fn getHiZLevelSize(
+    iLevel: u32) -> vec2u
+{
+    let screenSize: vec2u = vec2u(u32(defaultUniformBuffer.miScreenWidth), u32(defaultUniformBuffer.miScreenHeight));
+    let iScale: u32 = 1u << (iLevel + 1u);
+    return (screenSize + vec2u(iScale - 1u, iScale - 1u)) / iScale;
+}
+
+/////
+fn getHiZLevelOffset(
+    iLevel: u32) -> u32
+{
+    var iOffset: u32 = 0u;
+    for(var i: u32 = 0u; i < iLevel; i++)
+    {
+        let levelSize: vec2u = getHiZLevelSize(i);
+        iOffset += levelSize.x * levelSize.y;
+    }
+
+    return iOffset;
+}
+
+/////
+// down to 1 x 1
+fn getNumHiZLevels() -> u32
+{
+    let iMaxSize: u32 = u32(max(max(defaultUniformBuffer.miScreenWidth, defaultUniformBuffer.miScreenHeight), 2));
+    return firstLeadingBit(iMaxSize - 1u) + 1u;
+}
+
+/////
+fn writeHiZ(
+    iLevel: u32,
+    coord: vec2u,
+    fDepth: f32)
+{
+    let levelSize: vec2u = getHiZLevelSize(iLevel);
+    if(coord.x < levelSize.x && coord.y < levelSize.y)
+    {
+        afHiZPyramid[getHiZLevelOffset(iLevel) + coord.y * levelSize.x + coord.x] = fDepth;
+    }
+}
+
+//////
+// farthest depth pyramid of the occluder depth, levels 0 to 5. each workgroup takes a 64 x 64 tile
+// of depth down to a single texel in shared memory, "Hi-Z Pyramid Mips Compute" takes level 5 down
+// to 1 x 1. the levels are packed one after the other, finest first
+@compute
+@workgroup_size(iNumThreads)
+fn cs_main(
+    @builtin(local_invocation_index) iLocalThreadIndex: u32,
+    @builtin(workgroup_id) workGroup: vec3<u32>)
+{
+    let screenSize: vec2u = vec2u(u32(defaultUniformBuffer.miScreenWidth), u32(defaultUniformBuffer.miScreenHeight));
+    let numTiles: vec2u = (screenSize + vec2u(iTileSize - 1u, iTileSize - 1u)) / iTileSize;
+    if(workGroup.x >= numTiles.x || workGroup.y >= numTiles.y)
+    {
+        return;
+    }
+
+    let iNumLevels: u32 = getNumHiZLevels();
+
+    // level 0, pixels past the edge of the screen take the edge's
+    let maxPixel: vec2u = screenSize - vec2u(1u, 1u);
+    for(var i: u32 = 0u; i < 4u; i++)
+    {
+        let iTexel: u32 = iLocalThreadIndex + i * iNumThreads;
+        let coord: vec2u = workGroup.xy * 32u + vec2u(iTexel % 32u, iTexel / 32u);
+        let pixel: vec2u = coord * 2u;
+
+        let fDepth: f32 = max(
+            max(textureLoad(depthTexture, min(pixel, maxPixel), 0).x, textureLoad(depthTexture, min(pixel + vec2u(1u, 0u), maxPixel), 0).x),
+            max(textureLoad(depthTexture, min(pixel + vec2u(0u, 1u), maxPixel), 0).x, textureLoad(depthTexture, min(pixel + vec2u(1u, 1u), maxPixel), 0).x));
+
+        afTile0[iTexel] = fDepth;
+        writeHiZ(0u, coord, fDepth);
+    }
+    workgroupBarrier();
+
+    // levels 1 to 5, alternating between the shared arrays
+    for(var iLevel: u32 = 1u; iLevel < 6u; iLevel++)
+    {
+        let iWidth: u32 = 32u >> iLevel;
+        if(iLocalThreadIndex < iWidth * iWidth)
+        {
+            let tileCoord: vec2u = vec2u(iLocalThreadIndex % iWidth, iLocalThreadIndex / iWidth);
+            let iSrcWidth: u32 = iWidth * 2u;
+            let iSrc: u32 = tileCoord.y * 2u * iSrcWidth + tileCoord.x * 2u;
+
+            var fDepth: f32 = 0.0f;
+            if((iLevel & 1u) == 1u)
+            {
+                fDepth = max(
+                    max(afTile0[iSrc], afTile0[iSrc + 1u]),
+                    max(afTile0[iSrc + iSrcWidth], afTile0[iSrc + iSrcWidth + 1u]));
+                afTile1[iLocalThreadIndex] = fDepth;
+            }
+            else
+            {
+                fDepth = max(
+                    max(afTile1[iSrc], afTile1[iSrc + 1u]),
+                    max(afTile1[iSrc + iSrcWidth], afTile1[iSrc + iSrcWidth + 1u]));
+                afTile0[iLocalThreadIndex] = fDepth;
+            }
+
+            if(iLevel < iNumLevels)
+            {
+                writeHiZ(iLevel, workGroup.xy * iWidth + tileCoord, fDepth);
+            }
+        }
+        workgroupBarrier();
+    }
+}
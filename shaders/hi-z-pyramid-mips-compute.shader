@@ -0,0 +1,108 @@
+struct DefaultUniformData
+{
+    miScreenWidth: i32,
+    miScreenHeight: i32,
+    miFrame: i32,
+    miNumMeshes: u32,
+
+    mfRand0: f32,
+    mfRand1: f32,
+    mfRand2: f32,
+    mfRand3: f32,
+
+    mViewProjectionMatrix: mat4x4<f32>,
+    mPrevViewProjectionMatrix: mat4x4<f32>,
+    mViewMatrix: mat4x4<f32>,
+    mProjectionMatrix: mat4x4<f32>,
+
+    mJitteredViewProjectionMatrix: mat4x4<f32>,
+    mPrevJitteredViewProjectionMatrix: mat4x4<f32>,
+
+    mCameraPosition: vec4<f32>,
+    mCameraLookDir: vec4<f32>,
+
+    mLightRadiance: vec4<f32>,
+    mLightDirection: vec4<f32>,
+};
+
+@group(0) @binding(0) var<storage, read_write> afHiZPyramid: array<f32>;
+
+@group(1) @binding(0) var<uniform> defaultUniformBuffer: DefaultUniformData;
+
+const iNumThreads = 256u;
+
+/////
+// level 0 is half the screen size, each level after is half of the one before, rounded up
+fn getHiZLevelSize(
+    iLevel: u32) -> vec2u
+{
+    let screenSize: vec2u = vec2u(u32(defaultUniformBuffer.miScreenWidth), u32(defaultUniformBuffer.miScreenHeight));
+    let iScale: u32 = 1u << (iLevel + 1u);
+    return (screenSize + vec2u(iScale - 1u, iScale - 1u)) / iScale;
+}
+
+/////
+fn getHiZLevelOffset(
+    iLevel: u32) -> u32
+{
+    var iOffset: u32 = 0u;
+    for(var i: u32 = 0u; i < iLevel; i++)
+    {
+        let levelSize: vec2u = getHiZLevelSize(i);
+        iOffset += levelSize.x * levelSize.y;
+    }
+
+    return iOffset;
+}
+
+/////
+// down to 1 x 1
+fn getNumHiZLevels() -> u32
+{
+    let iMaxSize: u32 = u32(max(max(defaultUniformBuffer.miScreenWidth, defaultUniformBuffer.miScreenHeight), 2));
+    return firstLeadingBit(iMaxSize - 1u) + 1u;
+}
+
+/////
+fn writeHiZ(
+    iLevel: u32,
+    coord: vec2u,
+    fDepth: f32)
+{
+    let levelSize: vec2u = getHiZLevelSize(iLevel);
+    if(coord.x < levelSize.x && coord.y < levelSize.y)
+    {
+        afHiZPyramid[getHiZLevelOffset(iLevel) + coord.y * levelSize.x + coord.x] = fDepth;
+    }
+}
+
+//////
+// the rest of the farthest depth pyramid after "Hi-Z Pyramid Compute", level 6 down to 1 x 1, each
+// from the one before in the buffer. a single workgroup, the storage barrier between levels covers
+// all the threads reading the level before
+@compute
+@workgroup_size(iNumThreads)
+fn cs_main(
+    @builtin(local_invocation_index) iLocalThreadIndex: u32)
+{
+    let iNumLevels: u32 = getNumHiZLevels();
+    for(var iLevel: u32 = 6u; iLevel < iNumLevels; iLevel++)
+    {
+        let levelSize: vec2u = getHiZLevelSize(iLevel);
+        let prevLevelSize: vec2u = getHiZLevelSize(iLevel - 1u);
+        let iPrevLevelOffset: u32 = getHiZLevelOffset(iLevel - 1u);
+        let maxPrevCoord: vec2u = prevLevelSize - vec2u(1u, 1u);
+        for(var iTexel: u32 = iLocalThreadIndex; iTexel < levelSize.x * levelSize.y; iTexel += iNumThreads)
+        {
+            let coord: vec2u = vec2u(iTexel % levelSize.x, iTexel / levelSize.x);
+            let src0: vec2u = min(coord * 2u, maxPrevCoord);
+            let src1: vec2u = min(coord * 2u + vec2u(1u, 1u), maxPrevCoord);
+
+            let fDepth: f32 = max(
+                max(afHiZPyramid[iPrevLevelOffset + src0.y * prevLevelSize.x + src0.x], afHiZPyramid[iPrevLevelOffset + src0.y * prevLevelSize.x + src1.x]),
+                max(afHiZPyramid[iPrevLevelOffset + src1.y * prevLevelSize.x + src0.x], afHiZPyramid[iPrevLevelOffset + src1.y * prevLevelSize.x + src1.x]));
+            writeHiZ(iLevel, coord, fDepth);
+        }
+        storageBarrier();
+    }
+}
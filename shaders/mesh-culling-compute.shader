@@ -1,10 +1,9 @@
-struct DrawIndexParam
+struct MeshDrawSlot
 {
-    miIndexCount: u32,
-    miInstanceCount: u32,
-    miFirstIndex: u32,
-    miBaseVertex: i32,
-    miFirstInstance: u32,
+    miBucket: u32,
+    miDrawSlot: u32,
+    miIndexSlot: u32,
+    miPadding: u32,
 };
 
 struct MeshExtent
@@ -52,17 +51,11 @@ struct UniformData
     mfExplodeMultiplier: f32,
 };
 
-@group(0) @binding(0) var<storage, read_write> aDrawCalls: array<DrawIndexParam>;
-@group(0) @binding(1) var<storage, read_write> aNumDrawCalls: array<atomic<u32>>;
-@group(0) @binding(2) var<storage, read_write> aiVisibleMeshID: array<u32>;
-//@group(0) @binding(3) depthTexture0: texture_2d<f32>;
-//@group(0) @binding(4) depthTexture1: texture_2d<f32>;
-//@group(0) @binding(5) depthTexture2: texture_2d<f32>;
-//@group(0) @binding(6) depthTexture3: texture_2d<f32>;
-//@group(0) @binding(7) depthTexture4: texture_2d<f32>;
-//@group(0) @binding(8) depthTexture5: texture_2d<f32>;
-//@group(0) @binding(9) depthTexture6: texture_2d<f32>;
-//@group(0) @binding(10) depthTexture7: texture_2d<f32>;
+@group(0) @binding(0) var<storage, read_write> aNumDrawCalls: array<atomic<u32>>;
+@group(0) @binding(1) var<storage, read_write> aMeshDrawSlots: array<MeshDrawSlot>;
+
+// meshes the occlusion culling pass found visible last frame, drawn first as occluders
+@group(0) @binding(2) var<storage, read> aiMeshVisibilityHistory: array<u32>;
 
 @group(1) @binding(0) var<uniform> uniformBuffer: UniformData;
 @group(1) @binding(1) var<storage, read> aMeshTriangleIndexRanges: array<Range>;
@@ -72,6 +65,12 @@ struct UniformData
 
 const iNumThreads = 256u;
 
+// draws go front to back by depth bucket, aNumDrawCalls holds the draws and indices of each
+// bucket after the totals, "Mesh Draw Sort Compute" lays the buckets out one after the other
+const iNumDepthBuckets = 64u;
+const iBucketDrawCountOffset = 64u;
+const iBucketIndexCountOffset = 128u;
+
 @compute
 @workgroup_size(iNumThreads)
 fn cs_main(
@@ -85,6 +84,9 @@ fn cs_main(
         return;
     }
 
+    // bucket of the mesh's draw, all ones if it isn't drawn
+    aMeshDrawSlots[iMesh].miBucket = 0xffffffffu;
+
     if(aiVisibleFlags[iMesh] <= 0)
     {
         return;
@@ -105,12 +107,9 @@ fn cs_main(
     minPos.z -= fOffsetZ;
     maxPos.z -= fOffsetZ;
 
-    // check bbox against the depth pyramid
-    let bOccluded: bool = cullBBoxDepth(
-        minPos,
-        maxPos,
-        iMesh
-    );
+    // only last frame's visible set is drawn here, the rest are tested against the depth pyramid
+    // built from these in "Mesh Occlusion Culling Compute"
+    let bOccluded: bool = (aiMeshVisibilityHistory[iMesh] == 0u);
 
     var bInside: bool = cullBBox(
         minPos,
@@ -133,23 +132,21 @@ fn cs_main(
 
 //bInside = true;
 
-    aiVisibleMeshID[iMesh] = 0u;
-
     let iNumIndices: u32 = aMeshTriangleIndexRanges[iMesh].miEnd - aMeshTriangleIndexRanges[iMesh].miStart;
-    let iIndexAddressOffset: u32 = aMeshTriangleIndexRanges[iMesh].miStart;
-    //var iDrawCommandIndex: u32 = 0u;
     if(bInside && !bOccluded)
     {
-        let iDrawCommandIndex: u32 = atomicAdd(&aNumDrawCalls[0], 1u);
-
-        aDrawCalls[iDrawCommandIndex].miIndexCount = iNumIndices;
-        aDrawCalls[iDrawCommandIndex].miInstanceCount = 1u;
-        aDrawCalls[iDrawCommandIndex].miFirstIndex = iIndexAddressOffset;
-        aDrawCalls[iDrawCommandIndex].miBaseVertex = 0;
-        aDrawCalls[iDrawCommandIndex].miFirstInstance = 0u;
-
-        // mark as visible
-        aiVisibleMeshID[iMesh] = 1u;
+        let iBucket: u32 = getDepthBucket(
+            minPos,
+            maxPos,
+            totalMeshExtent);
+
+        atomicAdd(&aNumDrawCalls[0], 1u);
+        aMeshDrawSlots[iMesh].miBucket = iBucket;
+        aMeshDrawSlots[iMesh].miDrawSlot = atomicAdd(&aNumDrawCalls[iBucketDrawCountOffset + iBucket], 1u);
+        aMeshDrawSlots[iMesh].miIndexSlot = atomicAdd(&aNumDrawCalls[iBucketIndexCountOffset + iBucket], iNumIndices);
+
+        // aNumDrawCalls[2] is the total number of compacted indices
+        atomicAdd(&aNumDrawCalls[2], iNumIndices);
     }
 
     atomicAdd(&aNumDrawCalls[1], 1u);  
@@ -253,129 +250,22 @@ fn cullBBox(
     return (fCount0 >= -8.0f && fCount1 >= -8.0f && fCount2 >= -8.0f && fCount3 >= -8.0f && fCount4 >= -8.0f);  
 }
 
-
-//////
-fn cullBBoxDepth(
+/////
+// nearest distance from the camera to the bbox, in equal steps over the distances the whole scene spans
+fn getDepthBucket(
     minPosition: vec3f,
     maxPosition: vec3f,
-    iMesh: u32) -> bool
+    totalMeshExtent: MeshExtent) -> u32
 {
-    return false;
-
-    // NOTE: z pyramid textures didn't all in account of all pixels, just the 4 adjacent ones when down scaling
-    // scale to pow(2) size to fix this?
-
-    //let v0: vec3f = vec3f(minPosition.x, minPosition.y, minPosition.z);
-    //let v1: vec3f = vec3f(maxPosition.x, minPosition.y, minPosition.z);
-    //let v2: vec3f = vec3f(minPosition.x, minPosition.y, maxPosition.z);
-    //let v3: vec3f = vec3f(maxPosition.x, minPosition.y, maxPosition.z);
-//
-    //let v4: vec3f = vec3f(minPosition.x, maxPosition.y, minPosition.z);
-    //let v5: vec3f = vec3f(maxPosition.x, maxPosition.y, minPosition.z);
-    //let v6: vec3f = vec3f(minPosition.x, maxPosition.y, maxPosition.z);
-    //let v7: vec3f = vec3f(maxPosition.x, maxPosition.y, maxPosition.z);
-//
-    //let xform0: vec4f = vec4f(v0.xyz, 1.0f) * defaultUniformBuffer.mJitteredViewProjectionMatrix;
-    //let xform1: vec4f = vec4f(v1.xyz, 1.0f) * defaultUniformBuffer.mJitteredViewProjectionMatrix;
-    //let xform2: vec4f = vec4f(v2.xyz, 1.0f) * defaultUniformBuffer.mJitteredViewProjectionMatrix;
-    //let xform3: vec4f = vec4f(v3.xyz, 1.0f) * defaultUniformBuffer.mJitteredViewProjectionMatrix;
-//
-    //let xform4: vec4f = vec4f(v4.xyz, 1.0f) * defaultUniformBuffer.mJitteredViewProjectionMatrix;
-    //let xform5: vec4f = vec4f(v5.xyz, 1.0f) * defaultUniformBuffer.mJitteredViewProjectionMatrix;
-    //let xform6: vec4f = vec4f(v6.xyz, 1.0f) * defaultUniformBuffer.mJitteredViewProjectionMatrix;
-    //let xform7: vec4f = vec4f(v7.xyz, 1.0f) * defaultUniformBuffer.mJitteredViewProjectionMatrix;
-//
-    //let xyz0:vec3f  = xform0.xyz / xform0.w;
-    //let xyz1:vec3f  = xform1.xyz / xform1.w;
-    //let xyz2:vec3f  = xform2.xyz / xform2.w;
-    //let xyz3:vec3f  = xform3.xyz / xform3.w;
-//
-    //let xyz4:vec3f  = xform4.xyz / xform4.w;
-    //let xyz5:vec3f  = xform5.xyz / xform5.w;
-    //let xyz6:vec3f  = xform6.xyz / xform6.w;
-    //let xyz7:vec3f  = xform7.xyz / xform7.w;
-//
-    //var minXYZ: vec3f = min(min(min(min(min(min(min(xyz0, xyz1), xyz2), xyz3), xyz4), xyz5), xyz6), xyz7);
-    //var maxXYZ: vec3f = max(max(max(max(max(max(max(xyz0, xyz1), xyz2), xyz3), xyz4), xyz5), xyz6), xyz7);
-    //minXYZ = vec3f(minXYZ.x * 0.5f + 0.5f, minXYZ.y * 0.5f + 0.5f, minXYZ.z);
-    //maxXYZ = vec3f(maxXYZ.x * 0.5f + 0.5f, maxXYZ.y * 0.5f + 0.5f, maxXYZ.z);
-//
-    //minXYZ.x = clamp(minXYZ.x, 0.0f, 1.0f);
-    //minXYZ.y = clamp(minXYZ.y, 0.0f, 1.0f);
-    //maxXYZ.x = clamp(maxXYZ.x, 0.0f, 1.0f);
-    //maxXYZ.y = clamp(maxXYZ.y, 0.0f, 1.0f);
-//
-    //if (maxXYZ.z > 1.0f)
-    //{
-    //    minXYZ.z = 0.0f;
-    //}
-//
-    //let fMinDepth: f32 = minXYZ.z;
-    //let fAspectRatio: f32 = f32(defaultUniformBuffer.miScreenHeight) / f32(defaultUniformBuffer.miScreenWidth);
-    //let diffXY: vec2f = abs(maxXYZ.xy - minXYZ.xy);
-    //let fMaxComp: f32 = max(diffXY.x, diffXY.y * fAspectRatio) * 512.0f; // compute LOD from 1 to 8
-    //let iLOD: u32 = min(u32(log2(fMaxComp)), 8u);
-    //var uv: vec2f = vec2f(maxXYZ.xy + minXYZ.xy) * 0.5f;
-    //uv.y = 1.0f - uv.y;
-    //uv = clamp(uv, vec2f(0.0f, 0.0f), vec2f(1.0f, 1.0f));
-    //var fSampleDepth: f32 = 0.0f;
-//
-    //if (iLOD == 0u)
-    //{
-    //    var textureSize: uint2;
-    //    depthTexture0.GetDimensions(textureSize.x, textureSize.y);
-    //    let screenCoord: uint2 = uint2(u32(uv.x * f32(textureSize.x)), u32(uv.y * f32(textureSize.y)));
-    //    fSampleDepth = depthTexture0[screenCoord].x;
-    //}
-    //else if (iLOD == 1u)
-    //{
-    //    var textureSize: uint2;
-    //    depthTexture1.GetDimensions(textureSize.x, textureSize.y);
-    //    let screenCoord: uint2 = uint2(u32(uv.x * f32(textureSize.x)), u32(uv.y * f32(textureSize.y)));
-    //    fSampleDepth = depthTexture1[screenCoord].x;
-    //}
-    //else if (iLOD == 2u)
-    //{
-    //    var textureSize: uint2;
-    //    depthTexture2.GetDimensions(textureSize.x, textureSize.y);
-    //    let screenCoord: uint2 = uint2(u32(uv.x * f32(textureSize.x)), u32(uv.y * f32(textureSize.y)));
-    //    fSampleDepth = depthTexture2[screenCoord].x;
-    //}
-    //else if (iLOD == 3u)
-    //{
-    //    var textureSize: uint2;
-    //    depthTexture3.GetDimensions(textureSize.x, textureSize.y);
-    //    let screenCoord: uint2 = uint2(u32(uv.x * f32(textureSize.x)), u32(uv.y * f32(textureSize.y)));
-    //    fSampleDepth = depthTexture3[screenCoord].x;
-    //}
-    //else if (iLOD == 4u)
-    //{
-    //    var textureSize: uint2;
-    //    depthTexture4.GetDimensions(textureSize.x, textureSize.y);
-    //    let screenCoord: uint2 = uint2(u32(uv.x * f32(textureSize.x)), u32(uv.y * f32(textureSize.y)));
-    //    fSampleDepth = depthTexture4[screenCoord].x;
-    //}
-    //else if (iLOD == 5u)
-    //{
-    //    var textureSize: uint2;
-    //    depthTexture5.GetDimensions(textureSize.x, textureSize.y);
-    //    let screenCoord: uint2 = uint2(u32(uv.x * f32(textureSize.x)), u32(uv.y * f32(textureSize.y)));
-    //    fSampleDepth = depthTexture5[screenCoord].x;
-    //}
-    //else if (iLOD == 6u)
-    //{
-    //    var textureSize: uint2;
-    //    depthTexture6.GetDimensions(textureSize.x, textureSize.y);
-    //    let screenCoord: uint2 = uint2(u32(uv.x * f32(textureSize.x)), u32(uv.y * f32(textureSize.y)));
-    //    fSampleDepth = depthTexture6[screenCoord].x;
-    //}
-    //else
-    //{
-    //    var textureSize: uint2;
-    //    depthTexture7.GetDimensions(textureSize.x, textureSize.y);
-    //    let screenCoord: uint2 = uint2(u32(uv.x * f32(textureSize.x)), u32(uv.y * f32(textureSize.y)));
-    //    fSampleDepth = depthTexture7[screenCoord].x;
-    //}
+    let cameraPosition: vec3f = defaultUniformBuffer.mCameraPosition.xyz;
+    let fDistance: f32 = length(max(max(minPosition - cameraPosition, cameraPosition - maxPosition), vec3f(0.0f, 0.0f, 0.0f)));
+
+    let totalCenter: vec3f = (totalMeshExtent.mMaxPosition.xyz + totalMeshExtent.mMinPosition.xyz) * 0.5f;
+    let fTotalRadius: f32 = length(totalMeshExtent.mMaxPosition.xyz - totalMeshExtent.mMinPosition.xyz) * 0.5f;
+    let fSceneDistance: f32 = length(totalCenter - cameraPosition);
+    let fNearest: f32 = max(fSceneDistance - fTotalRadius, 0.0f);
+    let fFarthest: f32 = fSceneDistance + fTotalRadius;
 
-    //return (fMinDepth > fSampleDepth);
-}
\ No newline at end of file
+    let fPct: f32 = clamp((fDistance - fNearest) / max(fFarthest - fNearest, 0.0001f), 0.0f, 1.0f);
+    return min(u32(fPct * f32(iNumDepthBuckets)), iNumDepthBuckets - 1u);
+}
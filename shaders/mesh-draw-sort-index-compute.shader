@@ -0,0 +1,121 @@
+struct DrawIndexParam
+{
+    miIndexCount: u32,
+    miInstanceCount: u32,
+    miFirstIndex: u32,
+    miBaseVertex: i32,
+    miFirstInstance: u32,
+};
+
+struct MeshDrawSlot
+{
+    miBucket: u32,
+    miDrawSlot: u32,
+    miIndexSlot: u32,
+    miPadding: u32,
+};
+
+struct Range
+{
+    miStart: u32,
+    miEnd: u32,
+};
+
+struct DefaultUniformData
+{
+    miScreenWidth: i32,
+    miScreenHeight: i32,
+    miFrame: i32,
+    miNumMeshes: u32,
+
+    mfRand0: f32,
+    mfRand1: f32,
+    mfRand2: f32,
+    mfRand3: f32,
+
+    mViewProjectionMatrix: mat4x4<f32>,
+    mPrevViewProjectionMatrix: mat4x4<f32>,
+    mViewMatrix: mat4x4<f32>,
+    mProjectionMatrix: mat4x4<f32>,
+
+    mJitteredViewProjectionMatrix: mat4x4<f32>,
+    mPrevJitteredViewProjectionMatrix: mat4x4<f32>,
+
+    mCameraPosition: vec4<f32>,
+    mCameraLookDir: vec4<f32>,
+
+    mLightRadiance: vec4<f32>,
+    mLightDirection: vec4<f32>,
+};
+
+@group(0) @binding(0) var<storage, read_write> aDrawCalls: array<DrawIndexParam>;
+@group(0) @binding(1) var<storage, read_write> aiCompactedIndexOffsets: array<u32>;
+@group(0) @binding(2) var<storage, read> aMeshDrawSlots: array<MeshDrawSlot>;
+@group(0) @binding(3) var<storage, read> aiNumDrawCalls: array<u32>;
+
+@group(1) @binding(0) var<storage, read> aMeshTriangleIndexRanges: array<Range>;
+@group(1) @binding(1) var<uniform> defaultUniformBuffer: DefaultUniformData;
+
+const iNumThreads = 256u;
+
+// same as the culling jobs'
+const iNumDepthBuckets = 64u;
+const iBucketDrawCountOffset = 64u;
+const iBucketIndexCountOffset = 128u;
+
+var<workgroup> aiBucketDrawStart: array<u32, iNumDepthBuckets>;
+var<workgroup> aiBucketIndexStart: array<u32, iNumDepthBuckets>;
+
+//////
+// draw calls stay one per mesh for the render bundles, the compacted index list still goes front
+// to back by depth bucket. every workgroup lays out the buckets itself, there are only a few
+@compute
+@workgroup_size(iNumThreads)
+fn cs_main(
+    @builtin(local_invocation_index) iLocalThreadIndex: u32,
+    @builtin(workgroup_id) workGroup: vec3<u32>)
+{
+    if(iLocalThreadIndex == 0u)
+    {
+        var iDrawStart: u32 = 0u;
+        var iIndexStart: u32 = 0u;
+        for(var iBucket: u32 = 0u; iBucket < iNumDepthBuckets; iBucket++)
+        {
+            aiBucketDrawStart[iBucket] = iDrawStart;
+            aiBucketIndexStart[iBucket] = iIndexStart;
+            iDrawStart += aiNumDrawCalls[iBucketDrawCountOffset + iBucket];
+            iIndexStart += aiNumDrawCalls[iBucketIndexCountOffset + iBucket];
+        }
+    }
+    workgroupBarrier();
+
+    let iMesh: u32 = iLocalThreadIndex + workGroup.x * iNumThreads;
+    if(iMesh >= defaultUniformBuffer.miNumMeshes)
+    {
+        return;
+    }
+
+    let drawSlot: MeshDrawSlot = aMeshDrawSlots[iMesh];
+    if(drawSlot.miBucket == 0xffffffffu)
+    {
+        // where the mesh's indices start in the compacted index list, all ones if it isn't drawn
+        aiCompactedIndexOffsets[iMesh] = 0xffffffffu;
+
+        aDrawCalls[iMesh].miIndexCount = 0u;
+        aDrawCalls[iMesh].miInstanceCount = 0u;
+        aDrawCalls[iMesh].miFirstIndex = 0u;
+        aDrawCalls[iMesh].miBaseVertex = 0;
+        aDrawCalls[iMesh].miFirstInstance = 0u;
+
+        return;
+    }
+
+    let iDrawCommandIndex: u32 = iMesh;
+    aDrawCalls[iDrawCommandIndex].miIndexCount = aMeshTriangleIndexRanges[iMesh].miEnd - aMeshTriangleIndexRanges[iMesh].miStart;
+    aDrawCalls[iDrawCommandIndex].miInstanceCount = 1u;
+    aDrawCalls[iDrawCommandIndex].miFirstIndex = aMeshTriangleIndexRanges[iMesh].miStart;
+    aDrawCalls[iDrawCommandIndex].miBaseVertex = 0;
+    aDrawCalls[iDrawCommandIndex].miFirstInstance = 0u;
+
+    aiCompactedIndexOffsets[iMesh] = aiBucketIndexStart[drawSlot.miBucket] + drawSlot.miIndexSlot;
+}
@@ -0,0 +1,120 @@
+struct DrawIndexParam
+{
+    miIndexCount: u32,
+    miInstanceCount: u32,
+    miFirstIndex: u32,
+    miBaseVertex: i32,
+    miFirstInstance: u32,
+};
+
+struct Range
+{
+    miStart: u32,
+    miEnd: u32,
+};
+
+struct DefaultUniformData
+{
+    miScreenWidth: i32,
+    miScreenHeight: i32,
+    miFrame: i32,
+    miNumMeshes: u32,
+
+    mfRand0: f32,
+    mfRand1: f32,
+    mfRand2: f32,
+    mfRand3: f32,
+
+    mViewProjectionMatrix: mat4x4<f32>,
+    mPrevViewProjectionMatrix: mat4x4<f32>,
+    mViewMatrix: mat4x4<f32>,
+    mProjectionMatrix: mat4x4<f32>,
+
+    mJitteredViewProjectionMatrix: mat4x4<f32>,
+    mPrevJitteredViewProjectionMatrix: mat4x4<f32>,
+
+    mCameraPosition: vec4<f32>,
+    mCameraLookDir: vec4<f32>,
+
+    mLightRadiance: vec4<f32>,
+    mLightDirection: vec4<f32>,
+};
+
+@group(0) @binding(0) var<storage, read_write> aiCompactedIndices: array<u32>;
+@group(0) @binding(1) var<storage, read_write> aCompactedDrawCall: array<DrawIndexParam>;
+@group(0) @binding(2) var<storage, read> aiCompactedIndexOffsets: array<u32>;
+@group(0) @binding(3) var<storage, read> aiNumDrawCalls: array<u32>;
+
+@group(1) @binding(0) var<storage, read> aiTrainIndices: array<u32>;
+@group(1) @binding(1) var<storage, read> aMeshTriangleIndexRanges: array<Range>;
+@group(1) @binding(2) var<uniform> defaultUniformBuffer: DefaultUniformData;
+
+const iNumThreads = 256u;
+
+/////
+fn findMesh(
+    iIndex: u32,
+    iNumMeshes: u32) -> u32
+{
+    // last mesh starting at or before the index, the ranges are in index buffer order
+    var iLow: u32 = 0u;
+    var iHigh: u32 = iNumMeshes;
+    while(iHigh - iLow > 1u)
+    {
+        let iMid: u32 = (iLow + iHigh) / 2u;
+        if(aMeshTriangleIndexRanges[iMid].miStart <= iIndex)
+        {
+            iLow = iMid;
+        }
+        else
+        {
+            iHigh = iMid;
+        }
+    }
+
+    return iLow;
+}
+
+//////
+// copies the triangles of the meshes the culling pass kept into one index list, drawn with a
+// single indirect draw. the culling pass gave each visible mesh its offset in the list
+@compute
+@workgroup_size(iNumThreads)
+fn cs_main(
+    @builtin(num_workgroups) numWorkGroups: vec3<u32>,
+    @builtin(global_invocation_id) globalThreadID: vec3<u32>)
+{
+    let iNumMeshes: u32 = defaultUniformBuffer.miNumMeshes;
+    if(globalThreadID.x == 0u)
+    {
+        aCompactedDrawCall[0].miIndexCount = aiNumDrawCalls[2];
+        aCompactedDrawCall[0].miInstanceCount = 1u;
+        aCompactedDrawCall[0].miFirstIndex = 0u;
+        aCompactedDrawCall[0].miBaseVertex = 0;
+        aCompactedDrawCall[0].miFirstInstance = 0u;
+    }
+
+    if(iNumMeshes == 0u)
+    {
+        return;
+    }
+
+    // fixed dispatch, each thread strides over the triangles
+    let iNumTriangles: u32 = aMeshTriangleIndexRanges[iNumMeshes - 1u].miEnd / 3u;
+    let iTotalThreads: u32 = numWorkGroups.x * iNumThreads;
+    for(var iTriangle: u32 = globalThreadID.x; iTriangle < iNumTriangles; iTriangle += iTotalThreads)
+    {
+        let iIndex: u32 = iTriangle * 3u;
+        let iMesh: u32 = findMesh(iIndex, iNumMeshes);
+        let iOffset: u32 = aiCompactedIndexOffsets[iMesh];
+        if(iOffset == 0xffffffffu || iIndex >= aMeshTriangleIndexRanges[iMesh].miEnd)
+        {
+            continue;
+        }
+
+        let iDest: u32 = iOffset + (iIndex - aMeshTriangleIndexRanges[iMesh].miStart);
+        aiCompactedIndices[iDest] = aiTrainIndices[iIndex];
+        aiCompactedIndices[iDest + 1u] = aiTrainIndices[iIndex + 1u];
+        aiCompactedIndices[iDest + 2u] = aiTrainIndices[iIndex + 2u];
+    }
+}
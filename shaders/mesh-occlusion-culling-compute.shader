@@ -0,0 +1,367 @@
+struct MeshDrawSlot
+{
+    miBucket: u32,
+    miDrawSlot: u32,
+    miIndexSlot: u32,
+    miPadding: u32,
+};
+
+struct MeshExtent
+{
+    mMinPosition: vec4<f32>,
+    mMaxPosition: vec4<f32>,
+};
+
+struct Range
+{
+    miStart: u32,
+    miEnd: u32,
+};
+
+struct DefaultUniformData
+{
+    miScreenWidth: i32,
+    miScreenHeight: i32,
+    miFrame: i32,
+    miNumMeshes: u32,
+
+    mfRand0: f32,
+    mfRand1: f32,
+    mfRand2: f32,
+    mfRand3: f32,
+
+    mViewProjectionMatrix: mat4x4<f32>,
+    mPrevViewProjectionMatrix: mat4x4<f32>,
+    mViewMatrix: mat4x4<f32>,
+    mProjectionMatrix: mat4x4<f32>,
+
+    mJitteredViewProjectionMatrix: mat4x4<f32>,
+    mPrevJitteredViewProjectionMatrix: mat4x4<f32>,
+
+    mCameraPosition: vec4<f32>,
+    mCameraLookDir: vec4<f32>,
+
+    mLightRadiance: vec4<f32>,
+    mLightDirection: vec4<f32>,
+};
+
+struct UniformData
+{
+    miNumMeshes: u32,
+    mfExplodeMultiplier: f32,
+};
+
+@group(0) @binding(0) var<storage, read_write> aNumDrawCalls: array<atomic<u32>>;
+@group(0) @binding(1) var<storage, read_write> aMeshDrawSlots: array<MeshDrawSlot>;
+@group(0) @binding(2) var<storage, read_write> aiMeshVisibilityHistory: array<u32>;
+@group(0) @binding(3) var<storage, read> afHiZPyramid: array<f32>;
+
+@group(1) @binding(0) var<uniform> uniformBuffer: UniformData;
+@group(1) @binding(1) var<storage, read> aMeshTriangleIndexRanges: array<Range>;
+@group(1) @binding(2) var<storage, read> aMeshExtents: array<MeshExtent>;
+@group(1) @binding(3) var<storage, read> aiVisibleFlags: array<u32>;
+@group(1) @binding(4) var<uniform> defaultUniformBuffer: DefaultUniformData;
+
+const iNumThreads = 256u;
+
+// draws go front to back by depth bucket, aNumDrawCalls holds the draws and indices of each
+// bucket after the totals, "Mesh Draw Sort Compute" lays the buckets out one after the other
+const iNumDepthBuckets = 64u;
+const iBucketDrawCountOffset = 64u;
+const iBucketIndexCountOffset = 128u;
+
+// largest screen "Hi-Z Pyramid Compute" covers
+const iMaxHiZSize = 4096u;
+
+//////
+// second culling phase, after last frame's visible set is drawn into "Mesh Occluder Depth Graphics"
+// and reduced to the depth pyramid. the meshes left in the frustum and not behind the pyramid are
+// this frame's visible set, drawn by the mesh passes and drawn first again next frame
+@compute
+@workgroup_size(iNumThreads)
+fn cs_main(
+    @builtin(num_workgroups) numWorkGroups: vec3<u32>,
+    @builtin(local_invocation_index) iLocalThreadIndex: u32,
+    @builtin(workgroup_id) workGroup: vec3<u32>)
+{
+    let iMesh: u32 = iLocalThreadIndex + workGroup.x * iNumThreads;
+    if(iMesh >= uniformBuffer.miNumMeshes)
+    {
+        return;
+    }
+
+    // bucket of the mesh's draw, all ones if it isn't drawn
+    aMeshDrawSlots[iMesh].miBucket = 0xffffffffu;
+    aiMeshVisibilityHistory[iMesh] = 0u;
+
+    if(aiVisibleFlags[iMesh] <= 0)
+    {
+        return;
+    }
+
+    // total mesh extent is at the very end of list
+    let totalMeshExtent: MeshExtent = aMeshExtents[defaultUniformBuffer.miNumMeshes];
+    let totalCenter: vec3f = (totalMeshExtent.mMaxPosition.xyz + totalMeshExtent.mMinPosition.xyz) * 0.5f;
+
+    var minPos: vec3f = aMeshExtents[iMesh].mMinPosition.xyz;
+    var maxPos: vec3f = aMeshExtents[iMesh].mMaxPosition.xyz;
+    let meshCenter = (maxPos + minPos) * 0.5f;
+
+    let fOffsetZ: f32 = (totalCenter.z - meshCenter.z) * max(uniformBuffer.mfExplodeMultiplier, 0.0f);
+
+    minPos.z -= fOffsetZ;
+    maxPos.z -= fOffsetZ;
+
+    let bInside: bool = cullBBox(
+        minPos,
+        maxPos,
+        iMesh);
+
+    var bOccluded: bool = false;
+    if(bInside)
+    {
+        bOccluded = cullBBoxHiZ(
+            minPos,
+            maxPos);
+    }
+
+    let iNumIndices: u32 = aMeshTriangleIndexRanges[iMesh].miEnd - aMeshTriangleIndexRanges[iMesh].miStart;
+    if(bInside && !bOccluded)
+    {
+        let iBucket: u32 = getDepthBucket(
+            minPos,
+            maxPos,
+            totalMeshExtent);
+
+        atomicAdd(&aNumDrawCalls[0], 1u);
+        aMeshDrawSlots[iMesh].miBucket = iBucket;
+        aMeshDrawSlots[iMesh].miDrawSlot = atomicAdd(&aNumDrawCalls[iBucketDrawCountOffset + iBucket], 1u);
+        aMeshDrawSlots[iMesh].miIndexSlot = atomicAdd(&aNumDrawCalls[iBucketIndexCountOffset + iBucket], iNumIndices);
+
+        aiMeshVisibilityHistory[iMesh] = 1u;
+
+        // aNumDrawCalls[2] is the total number of compacted indices
+        atomicAdd(&aNumDrawCalls[2], iNumIndices);
+    }
+
+    atomicAdd(&aNumDrawCalls[1], 1u);
+}
+
+/////
+fn getFrustumPlane(
+    iColumn: u32,
+    fMult: f32) -> vec4f
+{
+    var plane: vec3f = vec3f(
+        defaultUniformBuffer.mViewProjectionMatrix[iColumn][0] * fMult + defaultUniformBuffer.mViewProjectionMatrix[3][0],
+        defaultUniformBuffer.mViewProjectionMatrix[iColumn][1] * fMult + defaultUniformBuffer.mViewProjectionMatrix[3][1],
+        defaultUniformBuffer.mViewProjectionMatrix[iColumn][2] * fMult + defaultUniformBuffer.mViewProjectionMatrix[3][2]);
+    let fPlaneW: f32 = defaultUniformBuffer.mViewProjectionMatrix[iColumn][3] * fMult + defaultUniformBuffer.mViewProjectionMatrix[3][3];
+    let fLength: f32 = length(plane);
+    plane = normalize(plane);
+    
+    let ret: vec4f = vec4f(
+        plane.xyz,
+        fPlaneW / (fLength + 0.00001f)
+    );
+    
+    return ret;
+}
+
+//////
+fn cullBBox(
+    minPosition: vec3f,
+    maxPosition: vec3f,
+    iMesh: u32) -> bool
+{
+    // frustum planes
+    let leftPlane: vec4f = getFrustumPlane(0u, 1.0f);
+    let rightPlane: vec4f = getFrustumPlane(0u, -1.0f);
+    let bottomPlane: vec4f = getFrustumPlane(1u, 1.0f);
+    let upperPlane: vec4f = getFrustumPlane(1u, -1.0f);
+    let nearPlane: vec4f = getFrustumPlane(2u, 1.0f);
+    let farPlane: vec4f = getFrustumPlane(2u, -1.0f);
+
+    let v0: vec3f = vec3f(minPosition.x, minPosition.y, minPosition.z);
+    let v1: vec3f = vec3f(maxPosition.x, minPosition.y, minPosition.z);
+    let v2: vec3f = vec3f(minPosition.x, minPosition.y, maxPosition.z);
+    let v3: vec3f = vec3f(maxPosition.x, minPosition.y, maxPosition.z);
+
+    let v4: vec3f = vec3f(minPosition.x, maxPosition.y, minPosition.z);
+    let v5: vec3f = vec3f(maxPosition.x, maxPosition.y, minPosition.z);
+    let v6: vec3f = vec3f(minPosition.x, maxPosition.y, maxPosition.z);
+    let v7: vec3f = vec3f(maxPosition.x, maxPosition.y, maxPosition.z);
+
+    var fCount0: f32 = 0.0f;
+    fCount0 += sign(dot(leftPlane.xyz, v0) + leftPlane.w);
+    fCount0 += sign(dot(leftPlane.xyz, v1) + leftPlane.w);
+    fCount0 += sign(dot(leftPlane.xyz, v2) + leftPlane.w);
+    fCount0 += sign(dot(leftPlane.xyz, v3) + leftPlane.w);
+    fCount0 += sign(dot(leftPlane.xyz, v4) + leftPlane.w);
+    fCount0 += sign(dot(leftPlane.xyz, v5) + leftPlane.w);
+    fCount0 += sign(dot(leftPlane.xyz, v6) + leftPlane.w);
+    fCount0 += sign(dot(leftPlane.xyz, v7) + leftPlane.w);
+
+    var fCount1: f32 = 0.0f;
+    fCount1 += sign(dot(rightPlane.xyz, v0) + rightPlane.w);
+    fCount1 += sign(dot(rightPlane.xyz, v1) + rightPlane.w);
+    fCount1 += sign(dot(rightPlane.xyz, v2) + rightPlane.w);
+    fCount1 += sign(dot(rightPlane.xyz, v3) + rightPlane.w);
+    fCount1 += sign(dot(rightPlane.xyz, v4) + rightPlane.w);
+    fCount1 += sign(dot(rightPlane.xyz, v5) + rightPlane.w);
+    fCount1 += sign(dot(rightPlane.xyz, v6) + rightPlane.w);
+    fCount1 += sign(dot(rightPlane.xyz, v7) + rightPlane.w);
+
+    var fCount2: f32 = 0.0f;
+    fCount2 += sign(dot(upperPlane.xyz, v0) + upperPlane.w);
+    fCount2 += sign(dot(upperPlane.xyz, v1) + upperPlane.w);
+    fCount2 += sign(dot(upperPlane.xyz, v2) + upperPlane.w);
+    fCount2 += sign(dot(upperPlane.xyz, v3) + upperPlane.w);
+    fCount2 += sign(dot(upperPlane.xyz, v4) + upperPlane.w);
+    fCount2 += sign(dot(upperPlane.xyz, v5) + upperPlane.w);
+    fCount2 += sign(dot(upperPlane.xyz, v6) + upperPlane.w);
+    fCount2 += sign(dot(upperPlane.xyz, v7) + upperPlane.w);
+
+    var fCount3: f32 = 0.0f;
+    fCount3 += sign(dot(bottomPlane.xyz, v0) + bottomPlane.w);
+    fCount3 += sign(dot(bottomPlane.xyz, v1) + bottomPlane.w);
+    fCount3 += sign(dot(bottomPlane.xyz, v2) + bottomPlane.w);
+    fCount3 += sign(dot(bottomPlane.xyz, v3) + bottomPlane.w);
+    fCount3 += sign(dot(bottomPlane.xyz, v4) + bottomPlane.w);
+    fCount3 += sign(dot(bottomPlane.xyz, v5) + bottomPlane.w);
+    fCount3 += sign(dot(bottomPlane.xyz, v6) + bottomPlane.w);
+    fCount3 += sign(dot(bottomPlane.xyz, v7) + bottomPlane.w);
+
+    var fCount4: f32 = 0.0f;
+    fCount4 += sign(dot(nearPlane.xyz, v0) + nearPlane.w);
+    fCount4 += sign(dot(nearPlane.xyz, v1) + nearPlane.w);
+    fCount4 += sign(dot(nearPlane.xyz, v2) + nearPlane.w);
+    fCount4 += sign(dot(nearPlane.xyz, v3) + nearPlane.w);
+    fCount4 += sign(dot(nearPlane.xyz, v4) + nearPlane.w);
+    fCount4 += sign(dot(nearPlane.xyz, v5) + nearPlane.w);
+    fCount4 += sign(dot(nearPlane.xyz, v6) + nearPlane.w);
+    fCount4 += sign(dot(nearPlane.xyz, v7) + nearPlane.w);
+
+    return (fCount0 >= -8.0f && fCount1 >= -8.0f && fCount2 >= -8.0f && fCount3 >= -8.0f && fCount4 >= -8.0f);  
+}
+
+/////
+// level 0 is half the screen size, each level after is half of the one before, rounded up
+fn getHiZLevelSize(
+    iLevel: u32) -> vec2u
+{
+    let screenSize: vec2u = vec2u(u32(defaultUniformBuffer.miScreenWidth), u32(defaultUniformBuffer.miScreenHeight));
+    let iScale: u32 = 1u << (iLevel + 1u);
+    return (screenSize + vec2u(iScale - 1u, iScale - 1u)) / iScale;
+}
+
+/////
+fn getHiZLevelOffset(
+    iLevel: u32) -> u32
+{
+    var iOffset: u32 = 0u;
+    for(var i: u32 = 0u; i < iLevel; i++)
+    {
+        let levelSize: vec2u = getHiZLevelSize(i);
+        iOffset += levelSize.x * levelSize.y;
+    }
+
+    return iOffset;
+}
+
+/////
+fn getNumHiZLevels() -> u32
+{
+    let iMaxSize: u32 = u32(max(max(defaultUniformBuffer.miScreenWidth, defaultUniformBuffer.miScreenHeight), 2));
+    return firstLeadingBit(iMaxSize - 1u) + 1u;
+}
+
+/////
+fn loadHiZ(
+    iLevelOffset: u32,
+    levelSize: vec2u,
+    coord: vec2u) -> f32
+{
+    return afHiZPyramid[iLevelOffset + coord.y * levelSize.x + coord.x];
+}
+
+//////
+// the bbox's screen rectangle is at most 2 x 2 texels at the level picked, it's occluded if its
+// nearest depth is behind the farthest depth of all 4
+fn cullBBoxHiZ(
+    minPosition: vec3f,
+    maxPosition: vec3f) -> bool
+{
+    let iScreenWidth: u32 = u32(defaultUniformBuffer.miScreenWidth);
+    let iScreenHeight: u32 = u32(defaultUniformBuffer.miScreenHeight);
+    if(iScreenWidth > iMaxHiZSize || iScreenHeight > iMaxHiZSize)
+    {
+        return false;
+    }
+
+    let screenSize: vec2f = vec2f(f32(iScreenWidth), f32(iScreenHeight));
+    var minScreenCoord: vec2f = screenSize;
+    var maxScreenCoord: vec2f = vec2f(0.0f, 0.0f);
+    var fMinDepth: f32 = 1.0f;
+    for(var iCorner: u32 = 0u; iCorner < 8u; iCorner++)
+    {
+        let corner: vec3f = select(
+            minPosition,
+            maxPosition,
+            vec3<bool>((iCorner & 1u) != 0u, (iCorner & 2u) != 0u, (iCorner & 4u) != 0u));
+        let xform: vec4f = vec4f(corner, 1.0f) * defaultUniformBuffer.mJitteredViewProjectionMatrix;
+
+        // crossing the camera plane, can't be behind anything
+        if(xform.w <= 0.0f)
+        {
+            return false;
+        }
+
+        let xyz: vec3f = xform.xyz / xform.w;
+        let screenCoord: vec2f = vec2f(xyz.x * 0.5f + 0.5f, 0.5f - xyz.y * 0.5f) * screenSize;
+        minScreenCoord = min(minScreenCoord, screenCoord);
+        maxScreenCoord = max(maxScreenCoord, screenCoord);
+        fMinDepth = min(fMinDepth, xyz.z);
+    }
+
+    let maxScreenPixel: vec2f = screenSize - vec2f(1.0f, 1.0f);
+    let minPixel: vec2u = vec2u(clamp(minScreenCoord, vec2f(0.0f, 0.0f), maxScreenPixel));
+    let maxPixel: vec2u = vec2u(clamp(maxScreenCoord, vec2f(0.0f, 0.0f), maxScreenPixel));
+
+    // texels at level L are 2^(L + 1) pixels across
+    let pixelExtent: vec2u = maxPixel - minPixel + vec2u(1u, 1u);
+    let iExtent: u32 = max(pixelExtent.x, pixelExtent.y);
+    let iLevel: u32 = min(select(0u, firstLeadingBit(iExtent - 1u), iExtent > 1u), getNumHiZLevels() - 1u);
+
+    let levelSize: vec2u = getHiZLevelSize(iLevel);
+    let iLevelOffset: u32 = getHiZLevelOffset(iLevel);
+    let maxTexel: vec2u = levelSize - vec2u(1u, 1u);
+    let texel0: vec2u = min(minPixel >> vec2u(iLevel + 1u), maxTexel);
+    let texel1: vec2u = min(maxPixel >> vec2u(iLevel + 1u), maxTexel);
+
+    let fMaxDepth: f32 = max(
+        max(loadHiZ(iLevelOffset, levelSize, texel0), loadHiZ(iLevelOffset, levelSize, vec2u(texel1.x, texel0.y))),
+        max(loadHiZ(iLevelOffset, levelSize, vec2u(texel0.x, texel1.y)), loadHiZ(iLevelOffset, levelSize, texel1)));
+
+    return (fMinDepth > fMaxDepth);
+}
+
+/////
+// nearest distance from the camera to the bbox, in equal steps over the distances the whole scene spans
+fn getDepthBucket(
+    minPosition: vec3f,
+    maxPosition: vec3f,
+    totalMeshExtent: MeshExtent) -> u32
+{
+    let cameraPosition: vec3f = defaultUniformBuffer.mCameraPosition.xyz;
+    let fDistance: f32 = length(max(max(minPosition - cameraPosition, cameraPosition - maxPosition), vec3f(0.0f, 0.0f, 0.0f)));
+
+    let totalCenter: vec3f = (totalMeshExtent.mMaxPosition.xyz + totalMeshExtent.mMinPosition.xyz) * 0.5f;
+    let fTotalRadius: f32 = length(totalMeshExtent.mMaxPosition.xyz - totalMeshExtent.mMinPosition.xyz) * 0.5f;
+    let fSceneDistance: f32 = length(totalCenter - cameraPosition);
+    let fNearest: f32 = max(fSceneDistance - fTotalRadius, 0.0f);
+    let fFarthest: f32 = fSceneDistance + fTotalRadius;
+
+    let fPct: f32 = clamp((fDistance - fNearest) / max(fFarthest - fNearest, 0.0001f), 0.0f, 1.0f);
+    return min(u32(fPct * f32(iNumDepthBuckets)), iNumDepthBuckets - 1u);
+}
@@ -0,0 +1,596 @@
+#include "bc_encoder.h"
+
+#include <utils/thread_pool.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <assert.h>
+#include <string.h>
+
+namespace BCEncoder
+{
+    // bc7 4 bit index interpolation weights out of 64
+    static uint32_t const kaiBC7Weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    /*
+    **
+    */
+    // bits written from the lowest bit of the block up
+    struct BitWriter
+    {
+        uint8_t*        mpBlock = nullptr;
+        uint32_t        miBit = 0;
+
+        void write(uint32_t iValue, uint32_t iNumBits)
+        {
+            for(uint32_t i = 0; i < iNumBits; i++, miBit++)
+            {
+                if((iValue >> i) & 1)
+                {
+                    mpBlock[miBit >> 3] |= (uint8_t)(1 << (miBit & 7));
+                }
+            }
+        }
+    };
+
+    /*
+    **
+    */
+    // mean and principal axis of the texels through power iteration on the covariance
+    static void computePrincipalAxis(
+        float* afMean,
+        float* afAxis,
+        float const (*aafTexels)[4],
+        uint32_t iNumChannels)
+    {
+        for(uint32_t iChannel = 0; iChannel < 4; iChannel++)
+        {
+            afMean[iChannel] = 0.0f;
+            afAxis[iChannel] = 0.0f;
+        }
+        for(uint32_t iTexel = 0; iTexel < 16; iTexel++)
+        {
+            for(uint32_t iChannel = 0; iChannel < iNumChannels; iChannel++)
+            {
+                afMean[iChannel] += aafTexels[iTexel][iChannel] / 16.0f;
+            }
+        }
+
+        float aafCovariance[4][4] = {};
+        for(uint32_t iTexel = 0; iTexel < 16; iTexel++)
+        {
+            for(uint32_t iRow = 0; iRow < iNumChannels; iRow++)
+            {
+                for(uint32_t iColumn = 0; iColumn < iNumChannels; iColumn++)
+                {
+                    aafCovariance[iRow][iColumn] +=
+                        (aafTexels[iTexel][iRow] - afMean[iRow]) * (aafTexels[iTexel][iColumn] - afMean[iColumn]);
+                }
+            }
+        }
+
+        float afVector[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+        for(uint32_t iIteration = 0; iIteration < 8; iIteration++)
+        {
+            float afResult[4] = {};
+            float fLargest = 0.0f;
+            for(uint32_t iRow = 0; iRow < iNumChannels; iRow++)
+            {
+                for(uint32_t iColumn = 0; iColumn < iNumChannels; iColumn++)
+                {
+                    afResult[iRow] += aafCovariance[iRow][iColumn] * afVector[iColumn];
+                }
+                fLargest = std::max(fLargest, fabsf(afResult[iRow]));
+            }
+            if(fLargest <= 1.0e-6f)
+            {
+                // flat block
+                return;
+            }
+            for(uint32_t iChannel = 0; iChannel < iNumChannels; iChannel++)
+            {
+                afVector[iChannel] = afResult[iChannel] / fLargest;
+            }
+        }
+
+        for(uint32_t iChannel = 0; iChannel < iNumChannels; iChannel++)
+        {
+            afAxis[iChannel] = afVector[iChannel];
+        }
+    }
+
+    /*
+    **
+    */
+    // initial endpoints, the texels' bounding box or their extent along the principal axis
+    static void computeEndpoints(
+        float* afEndpoint0,
+        float* afEndpoint1,
+        float const (*aafTexels)[4],
+        uint32_t iNumChannels,
+        Quality quality)
+    {
+        if(quality == Quality::Fast)
+        {
+            for(uint32_t iChannel = 0; iChannel < iNumChannels; iChannel++)
+            {
+                afEndpoint0[iChannel] = 255.0f;
+                afEndpoint1[iChannel] = 0.0f;
+                for(uint32_t iTexel = 0; iTexel < 16; iTexel++)
+                {
+                    afEndpoint0[iChannel] = std::min(afEndpoint0[iChannel], aafTexels[iTexel][iChannel]);
+                    afEndpoint1[iChannel] = std::max(afEndpoint1[iChannel], aafTexels[iTexel][iChannel]);
+                }
+            }
+            return;
+        }
+
+        float afMean[4], afAxis[4];
+        computePrincipalAxis(afMean, afAxis, aafTexels, iNumChannels);
+
+        float fMinT = 0.0f, fMaxT = 0.0f;
+        for(uint32_t iTexel = 0; iTexel < 16; iTexel++)
+        {
+            float fT = 0.0f;
+            for(uint32_t iChannel = 0; iChannel < iNumChannels; iChannel++)
+            {
+                fT += (aafTexels[iTexel][iChannel] - afMean[iChannel]) * afAxis[iChannel];
+            }
+            fMinT = std::min(fMinT, fT);
+            fMaxT = std::max(fMaxT, fT);
+        }
+
+        float fAxisLengthSquared = 0.0f;
+        for(uint32_t iChannel = 0; iChannel < iNumChannels; iChannel++)
+        {
+            fAxisLengthSquared += afAxis[iChannel] * afAxis[iChannel];
+        }
+        fAxisLengthSquared = std::max(fAxisLengthSquared, 1.0e-6f);
+
+        for(uint32_t iChannel = 0; iChannel < iNumChannels; iChannel++)
+        {
+            afEndpoint0[iChannel] = std::clamp(afMean[iChannel] + afAxis[iChannel] * fMinT / fAxisLengthSquared, 0.0f, 255.0f);
+            afEndpoint1[iChannel] = std::clamp(afMean[iChannel] + afAxis[iChannel] * fMaxT / fAxisLengthSquared, 0.0f, 255.0f);
+        }
+    }
+
+    /*
+    **
+    */
+    // endpoints that best fit the texels for the given per texel weights, false if the system is singular
+    static bool refitEndpoints(
+        float* afEndpoint0,
+        float* afEndpoint1,
+        float const (*aafTexels)[4],
+        float const* afWeights,
+        uint32_t iNumChannels)
+    {
+        float fA00 = 0.0f, fA01 = 0.0f, fA11 = 0.0f;
+        float afB0[4] = {}, afB1[4] = {};
+        for(uint32_t iTexel = 0; iTexel < 16; iTexel++)
+        {
+            float fW = afWeights[iTexel];
+            float fInvW = 1.0f - fW;
+            fA00 += fInvW * fInvW;
+            fA01 += fInvW * fW;
+            fA11 += fW * fW;
+            for(uint32_t iChannel = 0; iChannel < iNumChannels; iChannel++)
+            {
+                afB0[iChannel] += fInvW * aafTexels[iTexel][iChannel];
+                afB1[iChannel] += fW * aafTexels[iTexel][iChannel];
+            }
+        }
+
+        float fDeterminant = fA00 * fA11 - fA01 * fA01;
+        if(fabsf(fDeterminant) < 1.0e-6f)
+        {
+            return false;
+        }
+
+        for(uint32_t iChannel = 0; iChannel < iNumChannels; iChannel++)
+        {
+            afEndpoint0[iChannel] = std::clamp((fA11 * afB0[iChannel] - fA01 * afB1[iChannel]) / fDeterminant, 0.0f, 255.0f);
+            afEndpoint1[iChannel] = std::clamp((fA00 * afB1[iChannel] - fA01 * afB0[iChannel]) / fDeterminant, 0.0f, 255.0f);
+        }
+
+        return true;
+    }
+
+    /*
+    **
+    */
+    static void loadTexels(
+        float (*aafTexels)[4],
+        uint8_t const* pTexels)
+    {
+        for(uint32_t iTexel = 0; iTexel < 16; iTexel++)
+        {
+            for(uint32_t iChannel = 0; iChannel < 4; iChannel++)
+            {
+                aafTexels[iTexel][iChannel] = (float)pTexels[iTexel * 4 + iChannel];
+            }
+        }
+    }
+
+    /*
+    **
+    */
+    // bc1 block with the given endpoints, returns the squared rgb error
+    struct BC1Result
+    {
+        uint16_t        miColor0 = 0;
+        uint16_t        miColor1 = 0;
+        uint8_t         maiIndices[16] = {};
+        uint32_t        miError = UINT32_MAX;
+    };
+
+    static BC1Result evaluateBC1(
+        float const* afEndpoint0,
+        float const* afEndpoint1,
+        uint8_t const* pTexels)
+    {
+        auto pack565 = [](float const* afColor)
+        {
+            uint32_t iR = (uint32_t)std::lround(afColor[0] * 31.0f / 255.0f);
+            uint32_t iG = (uint32_t)std::lround(afColor[1] * 63.0f / 255.0f);
+            uint32_t iB = (uint32_t)std::lround(afColor[2] * 31.0f / 255.0f);
+            return (uint16_t)((iR << 11) | (iG << 5) | iB);
+        };
+        auto unpack565 = [](int32_t* aiColor, uint16_t iColor)
+        {
+            int32_t iR = (iColor >> 11) & 31, iG = (iColor >> 5) & 63, iB = iColor & 31;
+            aiColor[0] = (iR << 3) | (iR >> 2);
+            aiColor[1] = (iG << 2) | (iG >> 4);
+            aiColor[2] = (iB << 3) | (iB >> 2);
+        };
+
+        BC1Result result;
+        result.miColor0 = pack565(afEndpoint1);
+        result.miColor1 = pack565(afEndpoint0);
+
+        // the 4 color mode needs color 0 above color 1
+        if(result.miColor0 < result.miColor1)
+        {
+            std::swap(result.miColor0, result.miColor1);
+        }
+
+        int32_t aaiPalette[4][3];
+        unpack565(aaiPalette[0], result.miColor0);
+        unpack565(aaiPalette[1], result.miColor1);
+        uint32_t iNumColors = (result.miColor0 == result.miColor1) ? 1 : 4;
+        for(uint32_t iChannel = 0; iChannel < 3; iChannel++)
+        {
+            aaiPalette[2][iChannel] = (2 * aaiPalette[0][iChannel] + aaiPalette[1][iChannel]) / 3;
+            aaiPalette[3][iChannel] = (aaiPalette[0][iChannel] + 2 * aaiPalette[1][iChannel]) / 3;
+        }
+
+        result.miError = 0;
+        for(uint32_t iTexel = 0; iTexel < 16; iTexel++)
+        {
+            uint32_t iBestError = UINT32_MAX;
+            for(uint32_t iColor = 0; iColor < iNumColors; iColor++)
+            {
+                uint32_t iError = 0;
+                for(uint32_t iChannel = 0; iChannel < 3; iChannel++)
+                {
+                    int32_t iDiff = (int32_t)pTexels[iTexel * 4 + iChannel] - aaiPalette[iColor][iChannel];
+                    iError += (uint32_t)(iDiff * iDiff);
+                }
+                if(iError < iBestError)
+                {
+                    iBestError = iError;
+                    result.maiIndices[iTexel] = (uint8_t)iColor;
+                }
+            }
+            result.miError += iBestError;
+        }
+
+        return result;
+    }
+
+    /*
+    **
+    */
+    void encodeBC1Block(
+        uint8_t* pBlock,
+        uint8_t const* pTexels,
+        Quality quality)
+    {
+        float aafTexels[16][4];
+        loadTexels(aafTexels, pTexels);
+
+        float afEndpoint0[4] = {}, afEndpoint1[4] = {};
+        computeEndpoints(afEndpoint0, afEndpoint1, aafTexels, 3, quality);
+        BC1Result best = evaluateBC1(afEndpoint0, afEndpoint1, pTexels);
+
+        // palette position of each index, color 0 is the high end
+        float const afIndexWeights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+        uint32_t iNumRefits = (quality == Quality::Fast) ? 0 : ((quality == Quality::Normal) ? 1 : 8);
+        for(uint32_t iRefit = 0; iRefit < iNumRefits && best.miError > 0; iRefit++)
+        {
+            float afWeights[16];
+            for(uint32_t iTexel = 0; iTexel < 16; iTexel++)
+            {
+                afWeights[iTexel] = afIndexWeights[best.maiIndices[iTexel]];
+            }
+            if(!refitEndpoints(afEndpoint0, afEndpoint1, aafTexels, afWeights, 3))
+            {
+                break;
+            }
+
+            BC1Result result = evaluateBC1(afEndpoint0, afEndpoint1, pTexels);
+            if(result.miError >= best.miError)
+            {
+                break;
+            }
+            best = result;
+        }
+
+        memset(pBlock, 0, 8);
+        BitWriter writer = {pBlock, 0};
+        writer.write(best.miColor0, 16);
+        writer.write(best.miColor1, 16);
+        for(uint32_t iTexel = 0; iTexel < 16; iTexel++)
+        {
+            writer.write(best.maiIndices[iTexel], 2);
+        }
+    }
+
+    /*
+    **
+    */
+    // bc7 mode 6 block with the given endpoints and p-bits, returns the squared rgba error
+    struct BC7Result
+    {
+        uint32_t        maiEndpoints[2][4] = {};
+        uint32_t        maiPBits[2] = {};
+        uint8_t         maiIndices[16] = {};
+        uint32_t        miError = UINT32_MAX;
+    };
+
+    static BC7Result evaluateBC7(
+        float const* afEndpoint0,
+        float const* afEndpoint1,
+        uint32_t iPBit0,
+        uint32_t iPBit1,
+        uint8_t const* pTexels)
+    {
+        BC7Result result;
+        result.maiPBits[0] = iPBit0;
+        result.maiPBits[1] = iPBit1;
+
+        int32_t aaiEndpoints[2][4];
+        float const* aafEndpoints[2] = {afEndpoint0, afEndpoint1};
+        for(uint32_t iEndpoint = 0; iEndpoint < 2; iEndpoint++)
+        {
+            for(uint32_t iChannel = 0; iChannel < 4; iChannel++)
+            {
+                int32_t iQuantized = (int32_t)std::lround((aafEndpoints[iEndpoint][iChannel] - (float)result.maiPBits[iEndpoint]) * 0.5f);
+                iQuantized = std::clamp(iQuantized, 0, 127);
+                result.maiEndpoints[iEndpoint][iChannel] = (uint32_t)iQuantized;
+                aaiEndpoints[iEndpoint][iChannel] = (iQuantized << 1) | (int32_t)result.maiPBits[iEndpoint];
+            }
+        }
+
+        int32_t aaiPalette[16][4];
+        for(uint32_t iIndex = 0; iIndex < 16; iIndex++)
+        {
+            int32_t iWeight = (int32_t)kaiBC7Weights[iIndex];
+            for(uint32_t iChannel = 0; iChannel < 4; iChannel++)
+            {
+                aaiPalette[iIndex][iChannel] = ((64 - iWeight) * aaiEndpoints[0][iChannel] + iWeight * aaiEndpoints[1][iChannel] + 32) >> 6;
+            }
+        }
+
+        result.miError = 0;
+        for(uint32_t iTexel = 0; iTexel < 16; iTexel++)
+        {
+            uint32_t iBestError = UINT32_MAX;
+            for(uint32_t iIndex = 0; iIndex < 16; iIndex++)
+            {
+                uint32_t iError = 0;
+                for(uint32_t iChannel = 0; iChannel < 4; iChannel++)
+                {
+                    int32_t iDiff = (int32_t)pTexels[iTexel * 4 + iChannel] - aaiPalette[iIndex][iChannel];
+                    iError += (uint32_t)(iDiff * iDiff);
+                }
+                if(iError < iBestError)
+                {
+                    iBestError = iError;
+                    result.maiIndices[iTexel] = (uint8_t)iIndex;
+                }
+            }
+            result.miError += iBestError;
+        }
+
+        return result;
+    }
+
+    /*
+    **
+    */
+    static BC7Result evaluateBC7PBits(
+        float const* afEndpoint0,
+        float const* afEndpoint1,
+        uint8_t const* pTexels,
+        Quality quality)
+    {
+        if(quality == Quality::Slow)
+        {
+            BC7Result best;
+            for(uint32_t iPBits = 0; iPBits < 4; iPBits++)
+            {
+                BC7Result result = evaluateBC7(afEndpoint0, afEndpoint1, iPBits & 1, iPBits >> 1, pTexels);
+                if(result.miError < best.miError)
+                {
+                    best = result;
+                }
+            }
+            return best;
+        }
+
+        // p-bit closest to each endpoint on its own
+        uint32_t aiPBits[2] = {};
+        float const* aafEndpoints[2] = {afEndpoint0, afEndpoint1};
+        for(uint32_t iEndpoint = 0; iEndpoint < 2; iEndpoint++)
+        {
+            float afErrors[2] = {};
+            for(uint32_t iPBit = 0; iPBit < 2; iPBit++)
+            {
+                for(uint32_t iChannel = 0; iChannel < 4; iChannel++)
+                {
+                    float fValue = aafEndpoints[iEndpoint][iChannel];
+                    int32_t iQuantized = std::clamp((int32_t)std::lround((fValue - (float)iPBit) * 0.5f), 0, 127);
+                    float fDiff = fValue - (float)((iQuantized << 1) | (int32_t)iPBit);
+                    afErrors[iPBit] += fDiff * fDiff;
+                }
+            }
+            aiPBits[iEndpoint] = (afErrors[1] < afErrors[0]) ? 1 : 0;
+        }
+
+        return evaluateBC7(afEndpoint0, afEndpoint1, aiPBits[0], aiPBits[1], pTexels);
+    }
+
+    /*
+    **
+    */
+    void encodeBC7Block(
+        uint8_t* pBlock,
+        uint8_t const* pTexels,
+        Quality quality)
+    {
+        float aafTexels[16][4];
+        loadTexels(aafTexels, pTexels);
+
+        float afEndpoint0[4] = {}, afEndpoint1[4] = {};
+        computeEndpoints(afEndpoint0, afEndpoint1, aafTexels, 4, quality);
+        BC7Result best = evaluateBC7PBits(afEndpoint0, afEndpoint1, pTexels, quality);
+
+        uint32_t iNumRefits = (quality == Quality::Fast) ? 0 : ((quality == Quality::Normal) ? 1 : 8);
+        for(uint32_t iRefit = 0; iRefit < iNumRefits && best.miError > 0; iRefit++)
+        {
+            float afWeights[16];
+            for(uint32_t iTexel = 0; iTexel < 16; iTexel++)
+            {
+                afWeights[iTexel] = (float)kaiBC7Weights[best.maiIndices[iTexel]] / 64.0f;
+            }
+            if(!refitEndpoints(afEndpoint0, afEndpoint1, aafTexels, afWeights, 4))
+            {
+                break;
+            }
+
+            BC7Result result = evaluateBC7PBits(afEndpoint0, afEndpoint1, pTexels, quality);
+            if(result.miError >= best.miError)
+            {
+                break;
+            }
+            best = result;
+        }
+
+        // the anchor index drops its top bit, swap the endpoints so it's clear
+        if(best.maiIndices[0] & 8)
+        {
+            for(uint32_t iChannel = 0; iChannel < 4; iChannel++)
+            {
+                std::swap(best.maiEndpoints[0][iChannel], best.maiEndpoints[1][iChannel]);
+            }
+            std::swap(best.maiPBits[0], best.maiPBits[1]);
+            for(uint32_t iTexel = 0; iTexel < 16; iTexel++)
+            {
+                best.maiIndices[iTexel] = (uint8_t)(15 - best.maiIndices[iTexel]);
+            }
+        }
+
+        memset(pBlock, 0, 16);
+        BitWriter writer = {pBlock, 0};
+        writer.write(1 << 6, 7);
+        for(uint32_t iChannel = 0; iChannel < 4; iChannel++)
+        {
+            writer.write(best.maiEndpoints[0][iChannel], 7);
+            writer.write(best.maiEndpoints[1][iChannel], 7);
+        }
+        writer.write(best.maiPBits[0], 1);
+        writer.write(best.maiPBits[1], 1);
+        writer.write(best.maiIndices[0], 3);
+        for(uint32_t iTexel = 1; iTexel < 16; iTexel++)
+        {
+            writer.write(best.maiIndices[iTexel], 4);
+        }
+        assert(writer.miBit == 128);
+    }
+
+    /*
+    **
+    */
+    void compressImage(
+        std::vector<uint8_t>& aiBlocks,
+        Format format,
+        uint8_t const* pImageData,
+        uint32_t iWidth,
+        uint32_t iHeight,
+        Quality quality,
+        uint32_t iNumThreads)
+    {
+        uint32_t iNumBlocksX = (iWidth + 3) / 4;
+        uint32_t iNumBlocksY = (iHeight + 3) / 4;
+        uint32_t iBytesPerBlock = (format == Format::BC1) ? 8 : 16;
+        aiBlocks.resize((size_t)iNumBlocksX * iNumBlocksY * iBytesPerBlock);
+
+        auto compressBlockRow = [&](uint32_t iBlockY)
+        {
+            uint8_t aiTexels[16 * 4];
+            for(uint32_t iBlockX = 0; iBlockX < iNumBlocksX; iBlockX++)
+            {
+                for(uint32_t iTexel = 0; iTexel < 16; iTexel++)
+                {
+                    uint32_t iX = std::min(iBlockX * 4 + (iTexel & 3), iWidth - 1);
+                    uint32_t iY = std::min(iBlockY * 4 + (iTexel >> 2), iHeight - 1);
+                    memcpy(&aiTexels[iTexel * 4], &pImageData[((size_t)iY * iWidth + iX) * 4], 4);
+                }
+
+                uint8_t* pBlock = &aiBlocks[((size_t)iBlockY * iNumBlocksX + iBlockX) * iBytesPerBlock];
+                if(format == Format::BC1)
+                {
+                    encodeBC1Block(pBlock, aiTexels, quality);
+                }
+                else
+                {
+                    encodeBC7Block(pBlock, aiTexels, quality);
+                }
+            }
+        };
+
+        Utils::CThreadPool threadPool;
+        threadPool.start(std::min(iNumThreads, iNumBlocksY), "BC Encode");
+        for(uint32_t iBlockY = 0; iBlockY < iNumBlocksY; iBlockY++)
+        {
+            threadPool.submit([&compressBlockRow, iBlockY]
+            {
+                compressBlockRow(iBlockY);
+            });
+        }
+        threadPool.waitIdle();
+        threadPool.stop();
+    }
+
+    /*
+    **
+    */
+    bool isOpaque(
+        uint8_t const* pImageData,
+        uint32_t iWidth,
+        uint32_t iHeight)
+    {
+        for(size_t iTexel = 0; iTexel < (size_t)iWidth * iHeight; iTexel++)
+        {
+            if(pImageData[iTexel * 4 + 3] != 255)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+}   // BCEncoder
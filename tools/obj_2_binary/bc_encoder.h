@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+
+#include <stdint.h>
+
+namespace BCEncoder
+{
+    enum class Format
+    {
+        BC1,                // 4 bpp RGB, opaque textures
+        BC7,                // 8 bpp RGBA
+    };
+
+    enum class Quality
+    {
+        Fast,               // bounding box endpoints
+        Normal,             // principal axis endpoints, one least squares refit
+        Slow,               // principal axis endpoints, least squares refits until no gain, every p-bit pair for BC7
+    };
+
+    // 4 x 4 block of RGBA8 texels in, 8 bytes for BC1 and 16 for BC7 out
+    void encodeBC1Block(
+        uint8_t* pBlock,
+        uint8_t const* pTexels,
+        Quality quality);
+
+    // single subset mode 6 with 7.7.7.7 endpoints, a p-bit each and 4 bit indices
+    void encodeBC7Block(
+        uint8_t* pBlock,
+        uint8_t const* pTexels,
+        Quality quality);
+
+    // blocks in rows, edge texels repeat into partial blocks, rows of blocks are spread over the threads
+    void compressImage(
+        std::vector<uint8_t>& aiBlocks,
+        Format format,
+        uint8_t const* pImageData,
+        uint32_t iWidth,
+        uint32_t iHeight,
+        Quality quality,
+        uint32_t iNumThreads);
+
+    // BC1 has no usable alpha in the 4 color mode
+    bool isOpaque(
+        uint8_t const* pImageData,
+        uint32_t iWidth,
+        uint32_t iHeight);
+
+}   // BCEncoder
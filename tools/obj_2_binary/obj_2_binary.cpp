@@ -7,11 +7,18 @@
 #include <sstream>
 #include <mutex>
 #include <map>
+#include <algorithm>
 
 #include <filesystem>
 
 #include <math/vec.h>
 #include <utils/LogPrint.h>
+#include <loader/mesh_codec.h>
+#include <loader/texture_cache.h>
+
+#include "texture_atlas_baker.h"
+#include "texture_array_shader.h"
+#include "virtual_texture_baker.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image/stb_image.h>
@@ -95,9 +102,25 @@ struct MeshExtent
     vec4            mMaxPosition;
 };
 
+static_assert(sizeof(Vertex) == sizeof(Loader::MeshCodec::Vertex));
+static_assert(sizeof(MeshRange) == sizeof(Loader::MeshCodec::Range));
+static_assert(sizeof(MeshExtent) == sizeof(Loader::MeshCodec::Extent));
+
+// command line options
+bool gbEncodeMesh = false;
+bool gbDeflateMesh = true;
+bool gbBakeTextureAtlas = false;
+bool gbCacheTextures = false;
+bool gbCacheMips = false;
+bool gbBakeVirtualTexture = false;
+std::string gTextureDirectory = "";
+std::vector<std::string> gaCacheImagePaths;
+AtlasBaker::Compression gAtlasCompression = AtlasBaker::Compression::None;
+BCEncoder::Quality gCompressionQuality = BCEncoder::Quality::Normal;
+
 
 void outputVerticesAndTriangles(
-    std::vector<Vertex> const& aTotalVertices,
+    std::vector<Vertex>& aTotalVertices,
     std::vector<std::vector<uint32_t>> const& aaiTriangleVertexIndices,
     std::vector<MeshExtent> const& aMeshExtents,
     std::string const& directory,
@@ -136,10 +159,111 @@ void outputMeshMaterialIDs(
 
 void convertNormalImages(std::string const& directory);
 
+bool writeTextureCache(
+    std::string const& imagePath,
+    uint32_t iNumMipLevels);
+
 
 int main(int argc, char* argv[])
 {
-    std::string fullPath = argv[1];
+    std::string fullPath = "";
+    for(int32_t iArg = 1; iArg < argc; iArg++)
+    {
+        std::string arg = argv[iArg];
+        if(arg == "--mesh-codec")
+        {
+            // write -triangles.bin with the quantized geometry codec instead of raw vertices and indices
+            gbEncodeMesh = true;
+        }
+        else if(arg == "--no-deflate")
+        {
+            gbDeflateMesh = false;
+        }
+        else if(arg == "--bake-atlas")
+        {
+            // pack the diffuse textures into -diffuse-atlas.png and -diffuse-atlas.bin
+            gbBakeTextureAtlas = true;
+        }
+        else if(arg == "--bake-virtual-texture")
+        {
+            // tile the diffuse textures' mip chains into -virtual-texture.bin for streaming
+            gbBakeVirtualTexture = true;
+        }
+        else if(arg == "--texture-dir" && iArg + 1 < argc)
+        {
+            gTextureDirectory = argv[++iArg];
+        }
+        else if(arg == "--cache-textures")
+        {
+            // pre-decoded .rtex next to each diffuse texture and baked atlas page
+            gbCacheTextures = true;
+        }
+        else if(arg == "--cache-image" && iArg + 1 < argc)
+        {
+            // any other image the renderer decodes, e.g. font-atlas.png or the blue noise
+            gaCacheImagePaths.push_back(argv[++iArg]);
+        }
+        else if(arg == "--cache-mips")
+        {
+            // full mip chain in the --cache-image files
+            gbCacheMips = true;
+        }
+        else if(arg == "--compress" && iArg + 1 < argc)
+        {
+            // block compressed atlas pages in -diffuse-atlas-<page>-bc.rtex, bc7, bc1 or auto for bc1 when opaque
+            std::string format = argv[++iArg];
+            if(format == "bc7")
+            {
+                gAtlasCompression = AtlasBaker::Compression::BC7;
+            }
+            else if(format == "bc1")
+            {
+                gAtlasCompression = AtlasBaker::Compression::BC1;
+            }
+            else if(format == "auto")
+            {
+                gAtlasCompression = AtlasBaker::Compression::Auto;
+            }
+            else
+            {
+                printf("!!! unknown compression format \"%s\", use bc7, bc1 or auto\n", format.c_str());
+            }
+        }
+        else if(arg == "--compress-quality" && iArg + 1 < argc)
+        {
+            std::string quality = argv[++iArg];
+            if(quality == "fast")
+            {
+                gCompressionQuality = BCEncoder::Quality::Fast;
+            }
+            else if(quality == "normal")
+            {
+                gCompressionQuality = BCEncoder::Quality::Normal;
+            }
+            else if(quality == "slow")
+            {
+                gCompressionQuality = BCEncoder::Quality::Slow;
+            }
+            else
+            {
+                printf("!!! unknown compression quality \"%s\", use fast, normal or slow\n", quality.c_str());
+            }
+        }
+        else if(fullPath.length() == 0)
+        {
+            fullPath = arg;
+        }
+    }
+
+    for(auto const& imagePath : gaCacheImagePaths)
+    {
+        writeTextureCache(imagePath, gbCacheMips ? UINT32_MAX : 1);
+    }
+    if(fullPath.length() == 0)
+    {
+        return 0;
+    }
+
     auto iter = fullPath.rfind("\\");
     if(iter == std::string::npos)
     {
@@ -712,6 +836,42 @@ int main(int argc, char* argv[])
 
         fclose(fp);
 
+        std::string textureDirectory = (gTextureDirectory.length() > 0) ? gTextureDirectory : directory + "/textures";
+        if(gbBakeTextureAtlas)
+        {
+            AtlasBaker::BakeDescriptor bakeDesc;
+            bakeDesc.mTextureDirectory = textureDirectory;
+            bakeDesc.mOutputDirectory = directory;
+            bakeDesc.mBaseName = baseName;
+            bakeDesc.mbWriteTextureCache = gbCacheTextures;
+            bakeDesc.mCompression = gAtlasCompression;
+            bakeDesc.mCompressionQuality = gCompressionQuality;
+            AtlasBaker::bakeDiffuseTextureAtlas(aDiffuseTextureNames, bakeDesc);
+        }
+
+        if(gbBakeVirtualTexture)
+        {
+            VirtualTextureBaker::BakeDescriptor bakeDesc;
+            bakeDesc.mTextureDirectory = textureDirectory;
+            bakeDesc.mOutputDirectory = directory;
+            bakeDesc.mBaseName = baseName;
+            VirtualTextureBaker::bakeVirtualTexture(aDiffuseTextureNames, bakeDesc);
+        }
+
+        if(!gbBakeTextureAtlas && gbCacheTextures)
+        {
+            // level 0 only, the atlas builds its mips from the padded textures
+            for(auto const& diffuseTextureName : aDiffuseTextureNames)
+            {
+                std::string convertedName = AtlasBaker::getConvertedTextureName(diffuseTextureName);
+                if(convertedName.length() > 0 && (convertedName[0] == '/' || convertedName[0] == '\\'))
+                {
+                    convertedName = convertedName.substr(1);
+                }
+                writeTextureCache(textureDirectory + "/" + convertedName, 1);
+            }
+        }
+
     }   // materials
 
     std::string outputPath = directory + "/" + baseName + "-mesh-instance-ids.bin";
@@ -839,7 +999,7 @@ void getPositionRange(
 **
 */
 void outputVerticesAndTriangles(
-    std::vector<Vertex> const& aTotalVertices,
+    std::vector<Vertex>& aTotalVertices,
     std::vector<std::vector<uint32_t>> const& aaiTriangleVertexIndices,
     std::vector<MeshExtent> const& aMeshExtents,
     std::string const& directory,
@@ -873,6 +1033,83 @@ void outputVerticesAndTriangles(
 
     uint32_t iTriangleStartOffset = iNumTotalVertices * iVertexSize + iTriangleRangeSize + sizeof(uint32_t) * 5 + iNumMeshes * sizeof(MeshExtent);
 
+    if(gbEncodeMesh)
+    {
+        std::vector<Loader::MeshCodec::Vertex> aCodecVertices(aTotalVertices.size());
+        for(uint32_t i = 0; i < (uint32_t)aTotalVertices.size(); i++)
+        {
+            aCodecVertices[i].mPosition = aTotalVertices[i].mPosition;
+            aCodecVertices[i].mUV = aTotalVertices[i].mUV;
+            aCodecVertices[i].mNormal = aTotalVertices[i].mNormal;
+        }
+        std::vector<Loader::MeshCodec::Range> aCodecRanges(iNumMeshes);
+        for(uint32_t i = 0; i < iNumMeshes; i++)
+        {
+            aCodecRanges[i].miStart = aMeshTriangleRanges[i].miStart;
+            aCodecRanges[i].miEnd = aMeshTriangleRanges[i].miEnd;
+        }
+        std::vector<Loader::MeshCodec::Extent> aCodecExtents(aMeshExtents.size());
+        for(uint32_t i = 0; i < (uint32_t)aMeshExtents.size(); i++)
+        {
+            aCodecExtents[i].mMinPosition = aMeshExtents[i].mMinPosition;
+            aCodecExtents[i].mMaxPosition = aMeshExtents[i].mMaxPosition;
+        }
+        std::vector<uint32_t> aiTotalTriangleIndices;
+        for(auto const& aiTriangleVertexIndices : aaiTriangleVertexIndices)
+        {
+            aiTotalTriangleIndices.insert(aiTotalTriangleIndices.end(), aiTriangleVertexIndices.begin(), aiTriangleVertexIndices.end());
+        }
+
+        Loader::MeshCodec::EncodeOptions options;
+        options.mbDeflate = gbDeflateMesh;
+        Loader::MeshCodec::EncodeStats stats;
+        std::vector<char> acEncoded;
+        if(Loader::MeshCodec::encode(
+            acEncoded,
+            stats,
+            aCodecVertices,
+            aCodecRanges,
+            aCodecExtents,
+            aiTotalTriangleIndices,
+            options))
+        {
+            FILE* fp = fopen(fullPath.c_str(), "wb");
+            fwrite(acEncoded.data(), sizeof(char), acEncoded.size(), fp);
+            fclose(fp);
+
+            // take the positions snapped to the codec's grid so the triangle positions the bvh is built from
+            // match what the renderer decodes
+            std::vector<Loader::MeshCodec::Range> aDecodedRanges;
+            std::vector<Loader::MeshCodec::Extent> aDecodedExtents;
+            std::vector<Loader::MeshCodec::Vertex> aDecodedVertices;
+            std::vector<uint32_t> aiDecodedTriangleIndices;
+            bool bDecoded = Loader::MeshCodec::decode(
+                aDecodedRanges,
+                aDecodedExtents,
+                aDecodedVertices,
+                aiDecodedTriangleIndices,
+                acEncoded.data(),
+                acEncoded.size());
+            assert(bDecoded);
+            for(uint32_t i = 0; i < (uint32_t)aTotalVertices.size(); i++)
+            {
+                aTotalVertices[i].mPosition = aDecodedVertices[i].mPosition;
+            }
+
+            DEBUG_PRINTF("wrote encoded mesh to %s num meshes: %d raw size: %llu encoded size: %llu (%.2f%%) float uvs: %d\n",
+                fullPath.c_str(),
+                iNumMeshes,
+                (unsigned long long)stats.miRawSize,
+                (unsigned long long)stats.miEncodedSize,
+                100.0f * (float)stats.miEncodedSize / (float)stats.miRawSize,
+                stats.mbFloatUVs);
+
+            return;
+        }
+
+        DEBUG_PRINTF("!!! mesh doesn\'t fit the mesh codec, writing raw triangles !!!\n");
+    }
+
     FILE* fp = fopen(fullPath.c_str(), "wb");
     fwrite(&iNumMeshes, sizeof(uint32_t), 1, fp);
     fwrite(&iNumTotalVertices, sizeof(uint32_t), 1, fp);
@@ -897,6 +1134,33 @@ void outputVerticesAndTriangles(
     fclose(fp);
 
     DEBUG_PRINTF("wrote to %s num meshes: %d\n", fullPath.c_str(), (int32_t)aaiTriangleVertexIndices.size());
+
+    // vertex span of each mesh, lets the renderer stream the raw file one mesh at a time
+    std::vector<MeshRange> aMeshVertexRanges(iNumMeshes);
+    for(uint32_t i = 0; i < iNumMeshes; i++)
+    {
+        uint32_t iMinVertex = UINT32_MAX, iMaxVertex = 0;
+        for(auto const& iVertex : aaiTriangleVertexIndices[i])
+        {
+            iMinVertex = std::min(iMinVertex, iVertex);
+            iMaxVertex = std::max(iMaxVertex, iVertex);
+        }
+
+        aMeshVertexRanges[i].miStart = (iMinVertex == UINT32_MAX) ? 0 : iMinVertex;
+        aMeshVertexRanges[i].miEnd = (iMinVertex == UINT32_MAX) ? 0 : iMaxVertex + 1;
+    }
+
+    std::string chunkFilePath = directory + "/" + baseName + "-mesh-chunks.bin";
+    fp = fopen(chunkFilePath.c_str(), "wb");
+    char const acChunkSignature[4] = {'M', 'C', 'H', 'K'};
+    fwrite(acChunkSignature, sizeof(char), 4, fp);
+    fwrite(&iNumMeshes, sizeof(uint32_t), 1, fp);
+    fwrite(&iNumTotalVertices, sizeof(uint32_t), 1, fp);
+    fwrite(&iNumTotalTriangles, sizeof(uint32_t), 1, fp);
+    fwrite(aMeshVertexRanges.data(), sizeof(MeshRange), iNumMeshes, fp);
+    fclose(fp);
+
+    DEBUG_PRINTF("wrote mesh chunks to %s\n", chunkFilePath.c_str());
 }
 
 /*
@@ -990,34 +1254,83 @@ void test(
     auto baseNameEnd = fileName.find_last_of(".");
     std::string baseName = fileName.substr(0, baseNameEnd);
 
-    uint64_t iFileSize = (uint64_t)fseek(fp, 0, SEEK_END);
-    fseek(fp, (long)iFileSize - 8, SEEK_SET);
-    float fTest = 0.0f;
-    fread(&fTest, sizeof(float), 1, fp);
+    fseek(fp, 0, SEEK_END);
+    uint64_t iFileSize = (uint64_t)ftell(fp);
     fseek(fp, 0, SEEK_SET);
 
-    fread(&iNumMeshes, sizeof(uint32_t), 1, fp);
-    fread(&iNumTotalVertices, sizeof(uint32_t), 1, fp);
-    fread(&iNumTotalTriangles, sizeof(uint32_t), 1, fp);
-    fread(&iVertexSize, sizeof(uint32_t), 1, fp);
-    fread(&iTriangleStartOffset, sizeof(uint32_t), 1, fp);
+    std::vector<char> acFileContent(iFileSize);
+    fread(acFileContent.data(), sizeof(char), iFileSize, fp);
+    fseek(fp, 0, SEEK_SET);
+
+    if(Loader::MeshCodec::isEncoded(acFileContent.data(), iFileSize))
+    {
+        std::vector<Loader::MeshCodec::Range> aCodecRanges;
+        std::vector<Loader::MeshCodec::Extent> aCodecExtents;
+        std::vector<Loader::MeshCodec::Vertex> aCodecVertices;
+        std::vector<uint32_t> aiTotalTriangleIndices;
+        bool bDecoded = Loader::MeshCodec::decode(
+            aCodecRanges,
+            aCodecExtents,
+            aCodecVertices,
+            aiTotalTriangleIndices,
+            acFileContent.data(),
+            iFileSize);
+        assert(bDecoded);
+
+        iNumMeshes = (uint32_t)aCodecRanges.size();
+        aMeshRanges.resize(iNumMeshes);
+        for(uint32_t i = 0; i < iNumMeshes; i++)
+        {
+            aMeshRanges[i].miStart = aCodecRanges[i].miStart;
+            aMeshRanges[i].miEnd = aCodecRanges[i].miEnd;
+        }
+        aMeshExtents.resize(aCodecExtents.size());
+        for(uint32_t i = 0; i < (uint32_t)aCodecExtents.size(); i++)
+        {
+            aMeshExtents[i].mMinPosition = aCodecExtents[i].mMinPosition;
+            aMeshExtents[i].mMaxPosition = aCodecExtents[i].mMaxPosition;
+        }
+        aTotalVertices.resize(aCodecVertices.size());
+        for(uint32_t i = 0; i < (uint32_t)aCodecVertices.size(); i++)
+        {
+            aTotalVertices[i].mPosition = aCodecVertices[i].mPosition;
+            aTotalVertices[i].mUV = aCodecVertices[i].mUV;
+            aTotalVertices[i].mNormal = aCodecVertices[i].mNormal;
+        }
+
+        for(uint32_t i = 0; i < iNumMeshes; i++)
+        {
+            MeshRange const& range = aMeshRanges[i];
+            aaiTriangleVertexIndices.push_back(std::vector<uint32_t>(
+                aiTotalTriangleIndices.begin() + range.miStart,
+                aiTotalTriangleIndices.begin() + range.miEnd));
+        }
+    }
+    else
+    {
+        fread(&iNumMeshes, sizeof(uint32_t), 1, fp);
+        fread(&iNumTotalVertices, sizeof(uint32_t), 1, fp);
+        fread(&iNumTotalTriangles, sizeof(uint32_t), 1, fp);
+        fread(&iVertexSize, sizeof(uint32_t), 1, fp);
+        fread(&iTriangleStartOffset, sizeof(uint32_t), 1, fp);
 
-    aMeshRanges.resize(iNumMeshes);
-    fread(aMeshRanges.data(), sizeof(MeshRange), iNumMeshes, fp);
+        aMeshRanges.resize(iNumMeshes);
+        fread(aMeshRanges.data(), sizeof(MeshRange), iNumMeshes, fp);
 
-    aMeshExtents.resize(iNumMeshes + 1);            // last mesh extent is the overall mesh
-    fread(aMeshExtents.data(), sizeof(MeshExtent), iNumMeshes + 1, fp);
+        aMeshExtents.resize(iNumMeshes + 1);            // last mesh extent is the overall mesh
+        fread(aMeshExtents.data(), sizeof(MeshExtent), iNumMeshes + 1, fp);
 
-    aTotalVertices.resize(iNumTotalVertices);
-    fread(aTotalVertices.data(), sizeof(Vertex), iNumTotalVertices, fp);
+        aTotalVertices.resize(iNumTotalVertices);
+        fread(aTotalVertices.data(), sizeof(Vertex), iNumTotalVertices, fp);
 
-    for(uint32_t i = 0; i < iNumMeshes; i++)
-    {
-        MeshRange const& range = aMeshRanges[i];
-        uint32_t iNumTriangleIndices = range.miEnd - range.miStart;
-        std::vector<uint32_t> aiTriangles(iNumTriangleIndices);
-        fread(aiTriangles.data(), sizeof(uint32_t), iNumTriangleIndices, fp);
-        aaiTriangleVertexIndices.push_back(aiTriangles);
+        for(uint32_t i = 0; i < iNumMeshes; i++)
+        {
+            MeshRange const& range = aMeshRanges[i];
+            uint32_t iNumTriangleIndices = range.miEnd - range.miStart;
+            std::vector<uint32_t> aiTriangles(iNumTriangleIndices);
+            fread(aiTriangles.data(), sizeof(uint32_t), iNumTriangleIndices, fp);
+            aaiTriangleVertexIndices.push_back(aiTriangles);
+        }
     }
 
     fclose(fp);
@@ -1334,71 +1647,37 @@ bool readMaterialFile(
 
     DEBUG_PRINTF("wrote to %s\n", outputFullPath.c_str());
 
-    // output texture selection from shader
+    // output texture selection from shader, one texture array per size class indexed by layer
     char szOutputShaderDirectory[256];
     sprintf(szOutputShaderDirectory, "%s\\shaders\\", directory.c_str());
     std::filesystem::create_directories(szOutputShaderDirectory);
-    char szOutputShaderFilePath[256];
-    sprintf(szOutputShaderFilePath, "%s\\%s-albedo.shader", szOutputShaderDirectory, baseName.c_str());
-    fp = fopen(szOutputShaderFilePath, "w");
-    uint32_t iLastGroup = 0;
-    for(uint32_t iPart = 0;; iPart++)
-    {
-        uint32_t iStartTextureIndex = iPart * 100;
-        if(iStartTextureIndex >= iNumAlbedoTextures)
-        {
-            break;
-        }
-        uint32_t iEndTextureIndex = iStartTextureIndex + 100;
-        if(iEndTextureIndex > iNumAlbedoTextures)
-        {
-            iEndTextureIndex = iNumAlbedoTextures;
-        }
-
-        uint32_t iGroup = iPart + 2;
-        for(uint32_t i = iStartTextureIndex; i < iEndTextureIndex; i++)
-        {
-            fprintf(fp, "@group(%d) @binding(%d)\nvar texture%d: texture_2d<f32>;\n", iGroup, i, i);
-        }
-        fprintf(fp, "\n\n//////\nfn sampleTexture%d(\n    iTextureID: u32,\n    uv: vec2<f32>) -> vec4<f32>\n{\n", iPart);
-        for(uint32_t i = iStartTextureIndex; i < iEndTextureIndex; i++)
-        {
-            fprintf(fp, "    if(iTextureID == %du)\n    {\n    ret = textureSample(texture%d, linearTextureSampler, uv);\n    }\n", i, i);
-        }
-        fprintf(fp, "}\n\n");
+    std::string textureDirectory = (gTextureDirectory.length() > 0) ? gTextureDirectory : directory + "/textures";
 
-        iLastGroup = iGroup;
+    std::vector<std::string> aAlbedoTextureNames;
+    for(auto const& keyValue : aTotalAlbedoTextureMap)
+    {
+        aAlbedoTextureNames.push_back(keyValue.first);
     }
-    fclose(fp);
+    TextureArrayShader::GenerateDescriptor generateDesc;
+    generateDesc.mTextureDirectory = textureDirectory;
+    generateDesc.mShaderPath = std::string(szOutputShaderDirectory) + baseName + "-albedo.shader";
+    generateDesc.mLayoutPath = directory + "/" + baseName + "-albedo-texture-arrays.bin";
+    generateDesc.mVariableName = "albedoTextures";
+    generateDesc.mFunctionName = "sampleTexture";
+    generateDesc.miGroup = 2;
+    TextureArrayShader::generate(aAlbedoTextureNames, generateDesc);
 
-    sprintf(szOutputShaderFilePath, "%s\\%s-normal.shader", szOutputShaderDirectory, baseName.c_str());
-    fp = fopen(szOutputShaderFilePath, "w");
-    for(uint32_t iPart = 0;; iPart++)
+    std::vector<std::string> aNormalTextureNames;
+    for(auto const& keyValue : aTotalNormalTextureMap)
     {
-        uint32_t iStartTextureIndex = iPart * 100;
-        if(iStartTextureIndex >= iNumNormalTextures)
-        {
-            break;
-        }
-        uint32_t iEndTextureIndex = iStartTextureIndex + 100;
-        if(iEndTextureIndex > iNumNormalTextures)
-        {
-            iEndTextureIndex = iNumNormalTextures;
-        }
-
-        uint32_t iGroup = iPart + iLastGroup;
-        for(uint32_t i = iStartTextureIndex; i < iEndTextureIndex; i++)
-        {
-            fprintf(fp, "@group(%d) @binding(%d)\nvar normalTexture%d: texture_2d<f32>;\n", iGroup, i, i);
-        }
-        fprintf(fp, "\n\n//////\nfn sampleNormalTexture%d(\n    iTextureID: u32,\n    uv: vec2<f32>) -> vec4<f32>\n{\n", iPart);
-        for(uint32_t i = iStartTextureIndex; i < iEndTextureIndex; i++)
-        {
-            fprintf(fp, "    if(iTextureID == %du)\n    {\n    ret = textureSample(normalTexture%d, linearTextureSampler, uv);\n    }\n", i, i);
-        }
-        fprintf(fp, "}\n\n");
+        aNormalTextureNames.push_back(keyValue.first);
     }
-    fclose(fp);
+    generateDesc.mShaderPath = std::string(szOutputShaderDirectory) + baseName + "-normal.shader";
+    generateDesc.mLayoutPath = directory + "/" + baseName + "-normal-texture-arrays.bin";
+    generateDesc.mVariableName = "normalTextures";
+    generateDesc.mFunctionName = "sampleNormalTexture";
+    generateDesc.miGroup = 3;
+    TextureArrayShader::generate(aNormalTextureNames, generateDesc);
 
     return true;
 }
@@ -1442,4 +1721,38 @@ void convertNormalImages(std::string const& directory)
         }
 
     }
-}
\ No newline at end of file
+}
+
+/*
+**
+*/
+bool writeTextureCache(
+    std::string const& imagePath,
+    uint32_t iNumMipLevels)
+{
+    int32_t iWidth = 0, iHeight = 0, iComp = 0;
+    stbi_uc* pImageData = stbi_load(imagePath.c_str(), &iWidth, &iHeight, &iComp, 4);
+    if(pImageData == nullptr)
+    {
+        printf("!!! can\'t load \"%s\" for the texture cache\n", imagePath.c_str());
+        return false;
+    }
+
+    std::vector<char> acCacheData;
+    Loader::TextureCache::encode(acCacheData, pImageData, (uint32_t)iWidth, (uint32_t)iHeight, iNumMipLevels);
+    stbi_image_free(pImageData);
+
+    std::string cachePath = Loader::TextureCache::getCachePath(imagePath);
+    FILE* fp = fopen(cachePath.c_str(), "wb");
+    if(fp == nullptr)
+    {
+        printf("!!! can\'t write \"%s\"\n", cachePath.c_str());
+        return false;
+    }
+    fwrite(acCacheData.data(), sizeof(char), acCacheData.size(), fp);
+    fclose(fp);
+
+    printf("cached \"%s\" (%d x %d) to \"%s\"\n", imagePath.c_str(), iWidth, iHeight, cachePath.c_str());
+
+    return true;
+}
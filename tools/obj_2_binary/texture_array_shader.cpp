@@ -0,0 +1,142 @@
+#include "texture_array_shader.h"
+#include "texture_atlas_baker.h"
+
+#include <stb_image/stb_image.h>
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+#include <stdio.h>
+
+namespace TextureArrayShader
+{
+    /*
+    **
+    */
+    static uint32_t roundUpToPowerOfTwo(uint32_t iValue)
+    {
+        uint32_t iResult = 1;
+        while(iResult < iValue)
+        {
+            iResult <<= 1;
+        }
+
+        return iResult;
+    }
+
+    /*
+    **
+    */
+    bool generate(
+        std::vector<std::string> const& aTextureNames,
+        GenerateDescriptor const& desc)
+    {
+        uint32_t iNumTextures = (uint32_t)aTextureNames.size();
+
+        // missing textures share a 1 x 1 class so their ids still resolve
+        std::map<std::pair<uint32_t, uint32_t>, uint32_t> aSizeClassMap;
+        std::vector<SizeClass> aSizeClasses;
+        std::vector<TextureSlot> aSlots(iNumTextures);
+        for(uint32_t iTexture = 0; iTexture < iNumTextures; iTexture++)
+        {
+            std::string convertedName = AtlasBaker::getConvertedTextureName(aTextureNames[iTexture]);
+            if(convertedName.length() > 0 && (convertedName[0] == '/' || convertedName[0] == '\\'))
+            {
+                convertedName = convertedName.substr(1);
+            }
+            std::string fullPath = desc.mTextureDirectory + "/" + convertedName;
+
+            int32_t iWidth = 1, iHeight = 1, iComp = 0;
+            if(!stbi_info(fullPath.c_str(), &iWidth, &iHeight, &iComp))
+            {
+                printf("!!! can\'t read \"%s\" for its size class\n", fullPath.c_str());
+                iWidth = iHeight = 1;
+            }
+
+            auto key = std::make_pair(
+                std::min(roundUpToPowerOfTwo((uint32_t)iWidth), desc.miMaxLayerSize),
+                std::min(roundUpToPowerOfTwo((uint32_t)iHeight), desc.miMaxLayerSize));
+            auto iter = aSizeClassMap.find(key);
+            if(iter == aSizeClassMap.end())
+            {
+                iter = aSizeClassMap.insert(std::make_pair(key, (uint32_t)aSizeClasses.size())).first;
+                aSizeClasses.push_back({key.first, key.second, 0});
+            }
+
+            SizeClass& sizeClass = aSizeClasses[iter->second];
+            aSlots[iTexture].miSizeClass = iter->second;
+            aSlots[iTexture].miLayer = sizeClass.miNumLayers++;
+        }
+
+        FILE* fp = fopen(desc.mShaderPath.c_str(), "w");
+        if(fp == nullptr)
+        {
+            printf("!!! can\'t write \"%s\"\n", desc.mShaderPath.c_str());
+            return false;
+        }
+
+        fprintf(fp, "// %d textures in %d size classes\n", iNumTextures, (uint32_t)aSizeClasses.size());
+        for(uint32_t iSizeClass = 0; iSizeClass < (uint32_t)aSizeClasses.size(); iSizeClass++)
+        {
+            SizeClass const& sizeClass = aSizeClasses[iSizeClass];
+            fprintf(fp, "@group(%d) @binding(%d)\nvar %s%d: texture_2d_array<f32>;     // %d x %d, %d layers\n",
+                desc.miGroup,
+                iSizeClass,
+                desc.mVariableName.c_str(),
+                iSizeClass,
+                sizeClass.miWidth,
+                sizeClass.miHeight,
+                sizeClass.miNumLayers);
+        }
+
+        // (size class, layer) per texture id
+        if(iNumTextures > 0)
+        {
+            fprintf(fp, "\nconst ka%sSlots = array<vec2<u32>, %d>(\n", desc.mVariableName.c_str(), iNumTextures);
+            for(uint32_t iTexture = 0; iTexture < iNumTextures; iTexture++)
+            {
+                fprintf(fp, "    vec2<u32>(%du, %du),\n", aSlots[iTexture].miSizeClass, aSlots[iTexture].miLayer);
+            }
+            fprintf(fp, ");\n");
+        }
+
+        // explicit gradients keep the sample valid in non-uniform control flow, the caller takes
+        // dpdx/dpdy of the uv before any branch on the texture id
+        fprintf(fp, "\n\n//////\nfn %s(\n    iTextureID: u32,\n    uv: vec2<f32>,\n    uvDdx: vec2<f32>,\n    uvDdy: vec2<f32>) -> vec4<f32>\n{\n",
+            desc.mFunctionName.c_str());
+        fprintf(fp, "    var ret: vec4<f32> = vec4<f32>(0.0f, 0.0f, 0.0f, 0.0f);\n");
+        if(iNumTextures > 0)
+        {
+            fprintf(fp, "    let slot: vec2<u32> = ka%sSlots[min(iTextureID, %du)];\n", desc.mVariableName.c_str(), iNumTextures - 1);
+            fprintf(fp, "    switch(slot.x)\n    {\n");
+            for(uint32_t iSizeClass = 0; iSizeClass < (uint32_t)aSizeClasses.size(); iSizeClass++)
+            {
+                fprintf(fp, "        case %du:\n        {\n            ret = textureSampleGrad(%s%d, linearTextureSampler, uv, slot.y, uvDdx, uvDdy);\n        }\n",
+                    iSizeClass,
+                    desc.mVariableName.c_str(),
+                    iSizeClass);
+            }
+            fprintf(fp, "        default:\n        {\n        }\n    }\n");
+        }
+        fprintf(fp, "    return ret;\n}\n\n");
+        fclose(fp);
+
+        fp = fopen(desc.mLayoutPath.c_str(), "wb");
+        if(fp == nullptr)
+        {
+            printf("!!! can\'t write \"%s\"\n", desc.mLayoutPath.c_str());
+            return false;
+        }
+        FileHeader header = {{'T', 'X', 'A', 'R'}, (uint32_t)aSizeClasses.size(), iNumTextures};
+        fwrite(&header, sizeof(FileHeader), 1, fp);
+        fwrite(aSizeClasses.data(), sizeof(SizeClass), aSizeClasses.size(), fp);
+        fwrite(aSlots.data(), sizeof(TextureSlot), aSlots.size(), fp);
+        fclose(fp);
+
+        printf("%d textures in %d texture arrays for \"%s\"\n", iNumTextures, (uint32_t)aSizeClasses.size(), desc.mShaderPath.c_str());
+
+        return true;
+    }
+
+}   // TextureArrayShader
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace TextureArrayShader
+{
+    // <base>-<name>-texture-arrays.bin, header, one entry per size class in binding order, then one
+    // slot per texture in texture name order. each layer holds its texture resized to the class size
+    struct FileHeader
+    {
+        char            macSignature[4];        // 'TXAR'
+        uint32_t        miNumSizeClasses;
+        uint32_t        miNumTextures;
+    };
+
+    struct SizeClass
+    {
+        uint32_t        miWidth;
+        uint32_t        miHeight;
+        uint32_t        miNumLayers;
+    };
+
+    struct TextureSlot
+    {
+        uint32_t        miSizeClass;
+        uint32_t        miLayer;
+    };
+
+    struct GenerateDescriptor
+    {
+        std::string     mTextureDirectory;
+        std::string     mShaderPath;
+        std::string     mLayoutPath;
+        std::string     mVariableName;          // albedoTextures -> albedoTextures0, albedoTextures1, ...
+        std::string     mFunctionName;          // sampleTexture
+        uint32_t        miGroup = 2;
+        uint32_t        miMaxLayerSize = 4096;
+    };
+
+    // textures are bucketed by their size rounded up to powers of two, one texture_2d_array binding
+    // per bucket, the shader looks up the texture's bucket and layer instead of branching on its id
+    bool generate(
+        std::vector<std::string> const& aTextureNames,
+        GenerateDescriptor const& desc);
+
+}   // TextureArrayShader
@@ -0,0 +1,306 @@
+#include "texture_atlas_baker.h"
+
+#include <loader/texture_cache.h>
+#include <utils/rect_packer.h>
+
+#include <stb_image/stb_image.h>
+#include <stb_image/stb_image_write.h>
+
+#include <algorithm>
+#include <thread>
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace AtlasBaker
+{
+    struct Image
+    {
+        uint8_t*                mpImageData = nullptr;
+        int32_t                 miWidth = 0;
+        int32_t                 miHeight = 0;
+    };
+
+    /*
+    **
+    */
+    std::string getConvertedTextureName(std::string const& textureName)
+    {
+        auto iter = textureName.rfind("/");
+        if(iter == std::string::npos)
+        {
+            iter = textureName.rfind("\\");
+        }
+
+        std::string baseName = textureName;
+        if(iter != std::string::npos)
+        {
+            baseName = textureName.substr(iter);
+        }
+        iter = baseName.rfind(".");
+        std::string noExtension = baseName.substr(0, iter);
+        std::string oldFileExtension = (iter != std::string::npos) ? baseName.substr(iter) : "";
+
+        if(oldFileExtension != ".jpeg" && oldFileExtension != ".png" && oldFileExtension != ".jpg")
+        {
+            noExtension += ".png";
+        }
+        else
+        {
+            noExtension += oldFileExtension;
+        }
+
+        return noExtension;
+    }
+
+    /*
+    **
+    */
+    // box filtered half size image, used for textures larger than a page
+    static void halveImage(Image& image)
+    {
+        int32_t iNewWidth = std::max(image.miWidth / 2, 1);
+        int32_t iNewHeight = std::max(image.miHeight / 2, 1);
+        uint8_t* pNewData = (uint8_t*)malloc((size_t)iNewWidth * iNewHeight * 4);
+        for(int32_t iY = 0; iY < iNewHeight; iY++)
+        {
+            for(int32_t iX = 0; iX < iNewWidth; iX++)
+            {
+                for(int32_t iChannel = 0; iChannel < 4; iChannel++)
+                {
+                    uint32_t iTotal = 0;
+                    for(int32_t iSample = 0; iSample < 4; iSample++)
+                    {
+                        int32_t iSrcX = std::min(iX * 2 + (iSample & 1), image.miWidth - 1);
+                        int32_t iSrcY = std::min(iY * 2 + (iSample >> 1), image.miHeight - 1);
+                        iTotal += image.mpImageData[((size_t)iSrcY * image.miWidth + iSrcX) * 4 + iChannel];
+                    }
+                    pNewData[((size_t)iY * iNewWidth + iX) * 4 + iChannel] = (uint8_t)((iTotal + 2) / 4);
+                }
+            }
+        }
+
+        free(image.mpImageData);
+        image.mpImageData = pNewData;
+        image.miWidth = iNewWidth;
+        image.miHeight = iNewHeight;
+    }
+
+    /*
+    **
+    */
+    bool bakeDiffuseTextureAtlas(
+        std::vector<std::string> const& aTextureNames,
+        BakeDescriptor const& desc)
+    {
+        uint32_t iNumTextures = (uint32_t)aTextureNames.size();
+        int32_t iMaxPageSize = (int32_t)desc.miMaxPageSize;
+
+        // rects start on a multiple of the block the last mip level reduces to a texel, the gutter
+        // is at least that block so no mip level mixes two textures
+        int32_t iAlignment = 1 << (desc.miNumMipLevels - 1);
+        int32_t iGutter = std::max((int32_t)desc.miGutter, iAlignment);
+        auto alignSize = [iAlignment](int32_t iSize)
+        {
+            return (iSize + iAlignment - 1) & ~(iAlignment - 1);
+        };
+
+        // stbi_image_free is free() without a custom allocator, halveImage relies on that
+        std::vector<Image> aImages(iNumTextures);
+        for(uint32_t iTexture = 0; iTexture < iNumTextures; iTexture++)
+        {
+            // the converted name keeps the path separator in front
+            std::string convertedName = getConvertedTextureName(aTextureNames[iTexture]);
+            if(convertedName.length() > 0 && (convertedName[0] == '/' || convertedName[0] == '\\'))
+            {
+                convertedName = convertedName.substr(1);
+            }
+            std::string fullPath = desc.mTextureDirectory + "/" + convertedName;
+
+            Image& image = aImages[iTexture];
+            int32_t iComp = 0;
+            image.mpImageData = stbi_load(fullPath.c_str(), &image.miWidth, &image.miHeight, &iComp, 4);
+            if(image.mpImageData == nullptr)
+            {
+                printf("!!! can\'t load \"%s\" for the atlas\n", fullPath.c_str());
+                image.miWidth = image.miHeight = 0;
+                continue;
+            }
+
+            while(alignSize(image.miWidth + iGutter * 2) > iMaxPageSize || alignSize(image.miHeight + iGutter * 2) > iMaxPageSize)
+            {
+                printf("\"%s\" (%d x %d) is larger than a page, halving it\n", fullPath.c_str(), image.miWidth, image.miHeight);
+                halveImage(image);
+            }
+        }
+
+        std::vector<Utils::PackRect> aRects(iNumTextures);
+        for(uint32_t iTexture = 0; iTexture < iNumTextures; iTexture++)
+        {
+            bool bValid = (aImages[iTexture].mpImageData != nullptr);
+            aRects[iTexture].miWidth = bValid ? alignSize(aImages[iTexture].miWidth + iGutter * 2) : 0;
+            aRects[iTexture].miHeight = bValid ? alignSize(aImages[iTexture].miHeight + iGutter * 2) : 0;
+        }
+
+        int32_t iPageWidth = 0, iPageHeight = 0;
+        uint32_t iNumPages = Utils::packRectsIntoPages(aRects, iMaxPageSize, iPageWidth, iPageHeight);
+        iNumPages = std::max(iNumPages, 1u);
+
+        // copy with the edge pixels repeated into the gutter
+        size_t iPageSize = (size_t)iPageWidth * iPageHeight * 4;
+        std::vector<uint8_t> aiPageData(iPageSize * iNumPages, 0);
+        std::vector<TextureAtlasInfo> aAtlasInfo(iNumTextures);
+        uint64_t iUsedArea = 0;
+        for(uint32_t iTexture = 0; iTexture < iNumTextures; iTexture++)
+        {
+            Image const& image = aImages[iTexture];
+            Utils::PackRect const& rect = aRects[iTexture];
+
+            TextureAtlasInfo& info = aAtlasInfo[iTexture];
+            memset(&info, 0, sizeof(info));
+            info.miTextureID = iTexture;
+            if(image.mpImageData == nullptr || rect.miPage >= iNumPages)
+            {
+                continue;
+            }
+
+            uint8_t* pPage = aiPageData.data() + iPageSize * rect.miPage;
+            for(int32_t iY = 0; iY < rect.miHeight; iY++)
+            {
+                int32_t iSrcY = std::clamp(iY - iGutter, 0, image.miHeight - 1);
+                for(int32_t iX = 0; iX < rect.miWidth; iX++)
+                {
+                    int32_t iSrcX = std::clamp(iX - iGutter, 0, image.miWidth - 1);
+                    memcpy(
+                        &pPage[((size_t)(rect.miY + iY) * iPageWidth + rect.miX + iX) * 4],
+                        &image.mpImageData[((size_t)iSrcY * image.miWidth + iSrcX) * 4],
+                        4);
+                }
+            }
+
+            info.miTextureCoordX = rect.miX + iGutter;
+            info.miTextureCoordY = rect.miY + iGutter;
+            info.mfU = float(info.miTextureCoordX) / float(iPageWidth);
+            info.mfV = float(info.miTextureCoordY) / float(iPageHeight);
+            info.miImageWidth = image.miWidth;
+            info.miImageHeight = image.miHeight;
+            info.miPage = rect.miPage;
+            iUsedArea += (uint64_t)image.miWidth * image.miHeight;
+        }
+
+        for(auto& image : aImages)
+        {
+            stbi_image_free(image.mpImageData);
+        }
+
+        // level 0 of each page, the renderer builds the mip chain from it unless it's cached
+        for(uint32_t iPage = 0; iPage < iNumPages; iPage++)
+        {
+            std::string pageImagePath = desc.mOutputDirectory + "/" + desc.mBaseName + "-diffuse-atlas-" + std::to_string(iPage) + ".png";
+            if(!stbi_write_png(pageImagePath.c_str(), iPageWidth, iPageHeight, 4, aiPageData.data() + iPageSize * iPage, iPageWidth * 4))
+            {
+                printf("!!! can\'t write \"%s\"\n", pageImagePath.c_str());
+                return false;
+            }
+
+            if(desc.mbWriteTextureCache)
+            {
+                std::vector<char> acCacheData;
+                Loader::TextureCache::encode(acCacheData, aiPageData.data() + iPageSize * iPage, iPageWidth, iPageHeight, desc.miNumMipLevels);
+
+                std::string cachePath = Loader::TextureCache::getCachePath(pageImagePath);
+                FILE* fp = fopen(cachePath.c_str(), "wb");
+                if(fp == nullptr)
+                {
+                    printf("!!! can\'t write \"%s\"\n", cachePath.c_str());
+                    return false;
+                }
+                fwrite(acCacheData.data(), sizeof(char), acCacheData.size(), fp);
+                fclose(fp);
+            }
+        }
+
+        // block compressed pages with their mip chains, loaded instead of the pngs when the device has BC
+        if(desc.mCompression != Compression::None)
+        {
+            bool bOpaque = true;
+            for(uint32_t iPage = 0; iPage < iNumPages && bOpaque; iPage++)
+            {
+                bOpaque = BCEncoder::isOpaque(aiPageData.data() + iPageSize * iPage, iPageWidth, iPageHeight);
+            }
+
+            BCEncoder::Format format = BCEncoder::Format::BC7;
+            if(desc.mCompression == Compression::BC1 || (desc.mCompression == Compression::Auto && bOpaque))
+            {
+                format = BCEncoder::Format::BC1;
+            }
+            if(format == BCEncoder::Format::BC1 && !bOpaque)
+            {
+                printf("atlas pages have alpha, BC1 drops it\n");
+            }
+            uint32_t iCacheFormat = (format == BCEncoder::Format::BC1) ?
+                Loader::TextureCache::Format::BC1RGBAUnorm :
+                Loader::TextureCache::Format::BC7RGBAUnorm;
+            uint32_t iNumThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+            for(uint32_t iPage = 0; iPage < iNumPages; iPage++)
+            {
+                std::vector<std::vector<uint8_t>> aaiLevels;
+                Loader::TextureCache::buildMipChain(aaiLevels, aiPageData.data() + iPageSize * iPage, iPageWidth, iPageHeight, desc.miNumMipLevels);
+                for(uint32_t iMip = 0; iMip < (uint32_t)aaiLevels.size(); iMip++)
+                {
+                    std::vector<uint8_t> aiBlocks;
+                    BCEncoder::compressImage(
+                        aiBlocks,
+                        format,
+                        aaiLevels[iMip].data(),
+                        std::max((uint32_t)iPageWidth >> iMip, 1u),
+                        std::max((uint32_t)iPageHeight >> iMip, 1u),
+                        desc.mCompressionQuality,
+                        iNumThreads);
+                    aaiLevels[iMip] = std::move(aiBlocks);
+                }
+
+                std::vector<char> acCacheData;
+                Loader::TextureCache::write(acCacheData, iCacheFormat, iPageWidth, iPageHeight, aaiLevels);
+
+                std::string compressedPath = desc.mOutputDirectory + "/" + desc.mBaseName + "-diffuse-atlas-" + std::to_string(iPage) + "-bc.rtex";
+                FILE* fp = fopen(compressedPath.c_str(), "wb");
+                if(fp == nullptr)
+                {
+                    printf("!!! can\'t write \"%s\"\n", compressedPath.c_str());
+                    return false;
+                }
+                fwrite(acCacheData.data(), sizeof(char), acCacheData.size(), fp);
+                fclose(fp);
+            }
+
+            printf("compressed %d atlas pages to %s\n", iNumPages, (format == BCEncoder::Format::BC1) ? "BC1" : "BC7");
+        }
+
+        std::string atlasInfoPath = desc.mOutputDirectory + "/" + desc.mBaseName + "-diffuse-atlas.bin";
+        FILE* fp = fopen(atlasInfoPath.c_str(), "wb");
+        if(fp == nullptr)
+        {
+            printf("!!! can\'t write \"%s\"\n", atlasInfoPath.c_str());
+            return false;
+        }
+        FileHeader header = {{'A', 'T', 'L', 'S'}, (uint32_t)iPageWidth, (uint32_t)iPageHeight, iNumTextures, iNumPages, desc.miNumMipLevels};
+        fwrite(&header, sizeof(FileHeader), 1, fp);
+        fwrite(aAtlasInfo.data(), sizeof(TextureAtlasInfo), iNumTextures, fp);
+        fclose(fp);
+
+        printf("baked %d textures into %d %d x %d atlas pages, %.1f%% used, %.2f MB\n",
+            iNumTextures,
+            iNumPages,
+            iPageWidth,
+            iPageHeight,
+            100.0 * (double)iUsedArea / ((double)iPageWidth * (double)iPageHeight * iNumPages),
+            (double)iPageSize * iNumPages / (1024.0 * 1024.0));
+
+        return true;
+    }
+
+}   // AtlasBaker
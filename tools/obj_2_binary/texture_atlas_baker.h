@@ -0,0 +1,68 @@
+#pragma once
+
+#include "bc_encoder.h"
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace AtlasBaker
+{
+    // -diffuse-atlas.bin, header followed by one entry per texture in texture name order,
+    // pages are in -diffuse-atlas-<page>.png
+    struct FileHeader
+    {
+        char            macSignature[4];        // 'ATLS'
+        uint32_t        miPageWidth;
+        uint32_t        miPageHeight;
+        uint32_t        miNumTextures;
+        uint32_t        miNumPages;
+        uint32_t        miNumMipLevels;
+    };
+
+    // same layout as TextureAtlasInfo in the renderer and shaders
+    struct TextureAtlasInfo
+    {
+        int32_t         miTextureCoordX;
+        int32_t         miTextureCoordY;
+        float           mfU;
+        float           mfV;
+        uint32_t        miTextureID;
+        uint32_t        miImageWidth;
+        uint32_t        miImageHeight;
+        uint32_t        miPage;
+    };
+
+    enum class Compression
+    {
+        None,
+        BC1,
+        BC7,
+        Auto,               // BC1 when every page is opaque, BC7 otherwise
+    };
+
+    struct BakeDescriptor
+    {
+        std::string     mTextureDirectory;
+        std::string     mOutputDirectory;
+        std::string     mBaseName;
+        uint32_t        miGutter = 8;
+        uint32_t        miMaxPageSize = 8192;
+        uint32_t        miNumMipLevels = 4;
+        bool            mbWriteTextureCache = false;
+        Compression     mCompression = Compression::None;
+        BCEncoder::Quality  mCompressionQuality = BCEncoder::Quality::Normal;
+    };
+
+    // name the renderer loads the texture file under
+    std::string getConvertedTextureName(std::string const& textureName);
+
+    // packs the diffuse textures into the smallest atlas page that fits or as many max size pages
+    // as needed, writes <base>-diffuse-atlas-<page>.png and <base>-diffuse-atlas.bin, the pages
+    // with their mip chains as .rtex and block compressed as -bc.rtex when asked to
+    bool bakeDiffuseTextureAtlas(
+        std::vector<std::string> const& aTextureNames,
+        BakeDescriptor const& desc);
+
+}   // AtlasBaker
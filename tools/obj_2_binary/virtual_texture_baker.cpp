@@ -0,0 +1,128 @@
+#include "virtual_texture_baker.h"
+#include "texture_atlas_baker.h"
+
+#include <loader/texture_cache.h>
+
+#include <stb_image/stb_image.h>
+
+#include <algorithm>
+
+#include <stdio.h>
+#include <string.h>
+
+namespace VirtualTextureBaker
+{
+    /*
+    **
+    */
+    bool bakeVirtualTexture(
+        std::vector<std::string> const& aTextureNames,
+        BakeDescriptor const& desc)
+    {
+        uint32_t iNumTextures = (uint32_t)aTextureNames.size();
+        uint32_t iTileSize = desc.miTileSize;
+
+        std::string outputPath = desc.mOutputDirectory + "/" + desc.mBaseName + "-virtual-texture.bin";
+        FILE* fp = fopen(outputPath.c_str(), "wb");
+        if(fp == nullptr)
+        {
+            printf("!!! can\'t write \"%s\"\n", outputPath.c_str());
+            return false;
+        }
+
+        // header and texture entries are filled in once all the tiles are out
+        std::vector<TextureInfo> aTextureInfo(iNumTextures);
+        memset(aTextureInfo.data(), 0, sizeof(TextureInfo) * iNumTextures);
+        FileHeader header = {{'V', 'T', 'E', 'X'}, iTileSize, iNumTextures, 0};
+        fwrite(&header, sizeof(FileHeader), 1, fp);
+        fwrite(aTextureInfo.data(), sizeof(TextureInfo), iNumTextures, fp);
+
+        std::vector<uint8_t> aiTile((size_t)iTileSize * iTileSize * 4);
+        std::vector<uint8_t> aiLevels[2];
+        uint64_t iTotalTexels = 0;
+        for(uint32_t iTexture = 0; iTexture < iNumTextures; iTexture++)
+        {
+            std::string convertedName = AtlasBaker::getConvertedTextureName(aTextureNames[iTexture]);
+            if(convertedName.length() > 0 && (convertedName[0] == '/' || convertedName[0] == '\\'))
+            {
+                convertedName = convertedName.substr(1);
+            }
+            std::string fullPath = desc.mTextureDirectory + "/" + convertedName;
+
+            TextureInfo& info = aTextureInfo[iTexture];
+            info.miTileBase = header.miNumTiles;
+
+            int32_t iWidth = 0, iHeight = 0, iComp = 0;
+            uint8_t* pImageData = stbi_load(fullPath.c_str(), &iWidth, &iHeight, &iComp, 4);
+            if(pImageData == nullptr)
+            {
+                printf("!!! can\'t load \"%s\" for the virtual texture\n", fullPath.c_str());
+                continue;
+            }
+            info.miWidth = (uint32_t)iWidth;
+            info.miHeight = (uint32_t)iHeight;
+
+            // down to the level that fits in one tile
+            info.miNumMipLevels = 1;
+            while(std::max(info.miWidth >> (info.miNumMipLevels - 1), info.miHeight >> (info.miNumMipLevels - 1)) > iTileSize)
+            {
+                ++info.miNumMipLevels;
+            }
+
+            aiLevels[0].assign(pImageData, pImageData + (size_t)iWidth * iHeight * 4);
+            stbi_image_free(pImageData);
+
+            for(uint32_t iMip = 0; iMip < info.miNumMipLevels; iMip++)
+            {
+                std::vector<uint8_t> const& aiLevel = aiLevels[iMip & 1];
+                uint32_t iLevelWidth = std::max(info.miWidth >> iMip, 1u);
+                uint32_t iLevelHeight = std::max(info.miHeight >> iMip, 1u);
+                uint32_t iNumTilesX = (iLevelWidth + iTileSize - 1) / iTileSize;
+                uint32_t iNumTilesY = (iLevelHeight + iTileSize - 1) / iTileSize;
+                for(uint32_t iTileY = 0; iTileY < iNumTilesY; iTileY++)
+                {
+                    for(uint32_t iTileX = 0; iTileX < iNumTilesX; iTileX++)
+                    {
+                        for(uint32_t iY = 0; iY < iTileSize; iY++)
+                        {
+                            uint32_t iSrcY = std::min(iTileY * iTileSize + iY, iLevelHeight - 1);
+                            for(uint32_t iX = 0; iX < iTileSize; iX++)
+                            {
+                                uint32_t iSrcX = std::min(iTileX * iTileSize + iX, iLevelWidth - 1);
+                                memcpy(
+                                    &aiTile[((size_t)iY * iTileSize + iX) * 4],
+                                    &aiLevel[((size_t)iSrcY * iLevelWidth + iSrcX) * 4],
+                                    4);
+                            }
+                        }
+                        fwrite(aiTile.data(), sizeof(uint8_t), aiTile.size(), fp);
+                        ++header.miNumTiles;
+                    }
+                }
+                iTotalTexels += (uint64_t)iLevelWidth * iLevelHeight;
+
+                if(iMip + 1 < info.miNumMipLevels)
+                {
+                    Loader::TextureCache::halveImage(aiLevels[(iMip + 1) & 1], aiLevel.data(), iLevelWidth, iLevelHeight);
+                }
+            }
+        }
+
+        fseek(fp, 0, SEEK_SET);
+        fwrite(&header, sizeof(FileHeader), 1, fp);
+        fwrite(aTextureInfo.data(), sizeof(TextureInfo), iNumTextures, fp);
+        fclose(fp);
+
+        uint64_t iTileBytes = (uint64_t)iTileSize * iTileSize * 4;
+        printf("baked %d textures into %d %d x %d virtual texture tiles, %.2f MB, %.1f%% used\n",
+            iNumTextures,
+            header.miNumTiles,
+            iTileSize,
+            iTileSize,
+            (double)(iTileBytes * header.miNumTiles) / (1024.0 * 1024.0),
+            (header.miNumTiles > 0) ? 100.0 * (double)iTotalTexels / (double)((uint64_t)header.miNumTiles * iTileSize * iTileSize) : 0.0);
+
+        return true;
+    }
+
+}   // VirtualTextureBaker
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace VirtualTextureBaker
+{
+    // -virtual-texture.bin, header, one entry per texture in texture name order, then the tiles of
+    // every texture's mip levels from the largest down in rows, each tile is miTileSize x miTileSize RGBA8
+    struct FileHeader
+    {
+        char            macSignature[4];        // 'VTEX'
+        uint32_t        miTileSize;
+        uint32_t        miNumTextures;
+        uint32_t        miNumTiles;
+    };
+
+    // same layout as VirtualTextureInfo in the renderer and shaders, the last level is a single tile
+    struct TextureInfo
+    {
+        uint32_t        miTileBase;
+        uint32_t        miWidth;
+        uint32_t        miHeight;
+        uint32_t        miNumMipLevels;
+    };
+
+    struct BakeDescriptor
+    {
+        std::string     mTextureDirectory;
+        std::string     mOutputDirectory;
+        std::string     mBaseName;
+        uint32_t        miTileSize = 128;
+    };
+
+    // textures are loaded one at a time and their tiles written out as they're cut, edge tiles repeat
+    // the last texel, missing textures get no levels
+    bool bakeVirtualTexture(
+        std::vector<std::string> const& aTextureNames,
+        BakeDescriptor const& desc);
+
+}   // VirtualTextureBaker
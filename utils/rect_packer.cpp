@@ -0,0 +1,235 @@
+#include <utils/rect_packer.h>
+
+#include <algorithm>
+#include <numeric>
+
+#include <assert.h>
+
+namespace Utils
+{
+    struct SkylineNode
+    {
+        int32_t         miX;
+        int32_t         miY;
+        int32_t         miWidth;
+    };
+
+    /*
+    **
+    */
+    // lowest top edge over the span starting at node iNode, -1 if the rect doesn't fit there
+    static int32_t fitSkyline(
+        std::vector<SkylineNode> const& aSkyline,
+        uint32_t iNode,
+        int32_t iWidth,
+        int32_t iHeight,
+        int32_t iPageWidth,
+        int32_t iPageHeight)
+    {
+        int32_t iX = aSkyline[iNode].miX;
+        if(iX + iWidth > iPageWidth)
+        {
+            return -1;
+        }
+
+        int32_t iY = 0;
+        int32_t iWidthLeft = iWidth;
+        for(uint32_t i = iNode; iWidthLeft > 0; i++)
+        {
+            if(i >= (uint32_t)aSkyline.size())
+            {
+                return -1;
+            }
+            iY = std::max(iY, aSkyline[i].miY);
+            if(iY + iHeight > iPageHeight)
+            {
+                return -1;
+            }
+            iWidthLeft -= aSkyline[i].miWidth;
+        }
+
+        return iY;
+    }
+
+    /*
+    **
+    */
+    static bool insertSkyline(
+        std::vector<SkylineNode>& aSkyline,
+        PackRect& rect,
+        int32_t iPageWidth,
+        int32_t iPageHeight)
+    {
+        // lowest resulting top edge, then the narrowest gap
+        int32_t iBestNode = -1;
+        int32_t iBestTop = INT32_MAX;
+        int32_t iBestWidth = INT32_MAX;
+        for(uint32_t iNode = 0; iNode < (uint32_t)aSkyline.size(); iNode++)
+        {
+            int32_t iY = fitSkyline(aSkyline, iNode, rect.miWidth, rect.miHeight, iPageWidth, iPageHeight);
+            if(iY < 0)
+            {
+                continue;
+            }
+
+            int32_t iTop = iY + rect.miHeight;
+            if(iTop < iBestTop || (iTop == iBestTop && aSkyline[iNode].miWidth < iBestWidth))
+            {
+                iBestNode = (int32_t)iNode;
+                iBestTop = iTop;
+                iBestWidth = aSkyline[iNode].miWidth;
+            }
+        }
+
+        if(iBestNode < 0)
+        {
+            return false;
+        }
+
+        rect.miX = aSkyline[iBestNode].miX;
+        rect.miY = iBestTop - rect.miHeight;
+
+        // new node over the rect, shrink or remove the nodes it covers
+        SkylineNode newNode = {rect.miX, iBestTop, rect.miWidth};
+        aSkyline.insert(aSkyline.begin() + iBestNode, newNode);
+        for(uint32_t i = (uint32_t)iBestNode + 1; i < (uint32_t)aSkyline.size();)
+        {
+            int32_t iCoveredEnd = newNode.miX + newNode.miWidth;
+            if(aSkyline[i].miX >= iCoveredEnd)
+            {
+                break;
+            }
+
+            int32_t iShrink = iCoveredEnd - aSkyline[i].miX;
+            aSkyline[i].miX += iShrink;
+            aSkyline[i].miWidth -= iShrink;
+            if(aSkyline[i].miWidth <= 0)
+            {
+                aSkyline.erase(aSkyline.begin() + i);
+                continue;
+            }
+            break;
+        }
+
+        // merge neighbours at the same height
+        for(uint32_t i = 0; i + 1 < (uint32_t)aSkyline.size();)
+        {
+            if(aSkyline[i].miY == aSkyline[i + 1].miY)
+            {
+                aSkyline[i].miWidth += aSkyline[i + 1].miWidth;
+                aSkyline.erase(aSkyline.begin() + i + 1);
+                continue;
+            }
+            ++i;
+        }
+
+        return true;
+    }
+
+    /*
+    **
+    */
+    uint32_t packRectsSkyline(
+        std::vector<PackRect>& aRects,
+        int32_t iPageWidth,
+        int32_t iPageHeight)
+    {
+        std::vector<uint32_t> aiOrder(aRects.size());
+        std::iota(aiOrder.begin(), aiOrder.end(), 0);
+        std::stable_sort(aiOrder.begin(), aiOrder.end(), [&](uint32_t iLeft, uint32_t iRight)
+        {
+            if(aRects[iLeft].miHeight != aRects[iRight].miHeight)
+            {
+                return aRects[iLeft].miHeight > aRects[iRight].miHeight;
+            }
+            return aRects[iLeft].miWidth > aRects[iRight].miWidth;
+        });
+
+        std::vector<std::vector<SkylineNode>> aaSkylines;
+        for(auto const& iRect : aiOrder)
+        {
+            PackRect& rect = aRects[iRect];
+            rect.miX = rect.miY = 0;
+            rect.miPage = 0;
+            if(rect.miWidth <= 0 || rect.miHeight <= 0)
+            {
+                continue;
+            }
+            if(rect.miWidth > iPageWidth || rect.miHeight > iPageHeight)
+            {
+                rect.miPage = UINT32_MAX;
+                continue;
+            }
+
+            uint32_t iPage = 0;
+            for(; iPage < (uint32_t)aaSkylines.size(); iPage++)
+            {
+                if(insertSkyline(aaSkylines[iPage], rect, iPageWidth, iPageHeight))
+                {
+                    break;
+                }
+            }
+
+            if(iPage == (uint32_t)aaSkylines.size())
+            {
+                aaSkylines.push_back({{0, 0, iPageWidth}});
+                bool bInserted = insertSkyline(aaSkylines.back(), rect, iPageWidth, iPageHeight);
+                assert(bInserted);
+            }
+            rect.miPage = iPage;
+        }
+
+        return (uint32_t)aaSkylines.size();
+    }
+
+    /*
+    **
+    */
+    uint32_t packRectsIntoPages(
+        std::vector<PackRect>& aRects,
+        int32_t iMaxPageSize,
+        int32_t& iPageWidth,
+        int32_t& iPageHeight)
+    {
+        uint64_t iTotalArea = 0;
+        int32_t iLargestWidth = 1, iLargestHeight = 1;
+        for(auto const& rect : aRects)
+        {
+            iTotalArea += (uint64_t)std::max(rect.miWidth, 0) * (uint64_t)std::max(rect.miHeight, 0);
+            iLargestWidth = std::max(iLargestWidth, std::min(rect.miWidth, iMaxPageSize));
+            iLargestHeight = std::max(iLargestHeight, std::min(rect.miHeight, iMaxPageSize));
+        }
+
+        // grow the smaller side until the area covers the rects, then until they pack into one page
+        iPageWidth = 1;
+        iPageHeight = 1;
+        while(iPageWidth < iLargestWidth)
+        {
+            iPageWidth *= 2;
+        }
+        while(iPageHeight < iLargestHeight)
+        {
+            iPageHeight *= 2;
+        }
+        while(iPageWidth <= iMaxPageSize && iPageHeight <= iMaxPageSize)
+        {
+            if((uint64_t)iPageWidth * iPageHeight >= iTotalArea && packRectsSkyline(aRects, iPageWidth, iPageHeight) <= 1)
+            {
+                return 1;
+            }
+
+            if(iPageWidth <= iPageHeight)
+            {
+                iPageWidth *= 2;
+            }
+            else
+            {
+                iPageHeight *= 2;
+            }
+        }
+
+        iPageWidth = iPageHeight = iMaxPageSize;
+        return packRectsSkyline(aRects, iPageWidth, iPageHeight);
+    }
+
+}   // Utils
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+
+#include <stdint.h>
+
+namespace Utils
+{
+    struct PackRect
+    {
+        int32_t         miWidth = 0;
+        int32_t         miHeight = 0;
+
+        // filled in by the packer, miPage is UINT32_MAX for rects that don't fit in a page
+        int32_t         miX = 0;
+        int32_t         miY = 0;
+        uint32_t        miPage = 0;
+    };
+
+    // bottom left skyline, tallest rects first with ties in list order so the result is the same every run,
+    // a rect goes in the first page it fits in, returns the number of pages used
+    uint32_t packRectsSkyline(
+        std::vector<PackRect>& aRects,
+        int32_t iPageWidth,
+        int32_t iPageHeight);
+
+    // smallest power of two page size that takes all the rects, pages of the max size when they don't fit in one
+    uint32_t packRectsIntoPages(
+        std::vector<PackRect>& aRects,
+        int32_t iMaxPageSize,
+        int32_t& iPageWidth,
+        int32_t& iPageHeight);
+
+}   // Utils
@@ -0,0 +1,252 @@
+#include <utils/task_graph.h>
+
+#include <algorithm>
+
+#include <assert.h>
+#include <stdio.h>
+
+namespace Utils
+{
+    /*
+    **
+    */
+    uint32_t CTaskGraph::addTask(
+        std::string const& name,
+        Affinity affinity,
+        std::vector<uint32_t> const& aiDependencies,
+        std::function<void()> const& function)
+    {
+        uint32_t iTask = (uint32_t)maTasks.size();
+        for(auto const& iDependency : aiDependencies)
+        {
+            // dependencies have to be added first, keeps the graph acyclic
+            assert(iDependency < iTask);
+        }
+
+        Task task;
+        task.mName = name;
+        task.mFunction = function;
+        task.mAffinity = affinity;
+        task.maiDependencies = aiDependencies;
+        maTasks.push_back(task);
+
+        return iTask;
+    }
+
+    /*
+    **
+    */
+    void CTaskGraph::run(CThreadPool& threadPool)
+    {
+        uint32_t iNumTasks = (uint32_t)maTasks.size();
+        maaiDependents.assign(iNumTasks, {});
+        maiNumDependenciesLeft.assign(iNumTasks, 0);
+        maiReadyMainThreadTasks.clear();
+        for(uint32_t iTask = 0; iTask < iNumTasks; iTask++)
+        {
+            maiNumDependenciesLeft[iTask] = (uint32_t)maTasks[iTask].maiDependencies.size();
+            for(auto const& iDependency : maTasks[iTask].maiDependencies)
+            {
+                maaiDependents[iDependency].push_back(iTask);
+            }
+        }
+        miNumTasksLeft = iNumTasks;
+        mStartTime = std::chrono::high_resolution_clock::now();
+
+        auto getTime = [&]()
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - mStartTime).count();
+        };
+
+        // workers start with the first worker stages, main thread stages are picked up in the loop below
+        std::vector<uint32_t> aiReadyWorkerTasks;
+        for(uint32_t iTask = 0; iTask < iNumTasks; iTask++)
+        {
+            if(maiNumDependenciesLeft[iTask] == 0)
+            {
+                if(maTasks[iTask].mAffinity == Affinity::MainThread)
+                {
+                    maiReadyMainThreadTasks.push_back(iTask);
+                }
+                else
+                {
+                    aiReadyWorkerTasks.push_back(iTask);
+                }
+            }
+        }
+
+        std::function<void(uint32_t)> runTask;
+        runTask = [&](uint32_t iTask)
+        {
+            Task& task = maTasks[iTask];
+            task.mfStartTime = getTime();
+            task.mFunction();
+            task.mfEndTime = getTime();
+
+            std::vector<uint32_t> aiNewWorkerTasks;
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                for(auto const& iDependent : maaiDependents[iTask])
+                {
+                    if(--maiNumDependenciesLeft[iDependent] == 0)
+                    {
+                        if(maTasks[iDependent].mAffinity == Affinity::MainThread)
+                        {
+                            maiReadyMainThreadTasks.push_back(iDependent);
+                        }
+                        else
+                        {
+                            aiNewWorkerTasks.push_back(iDependent);
+                        }
+                    }
+                }
+                --miNumTasksLeft;
+            }
+            mTaskDone.notify_all();
+
+            for(auto const& iNewTask : aiNewWorkerTasks)
+            {
+                threadPool.submit([&runTask, iNewTask] { runTask(iNewTask); });
+            }
+        };
+
+        for(auto const& iTask : aiReadyWorkerTasks)
+        {
+            threadPool.submit([&runTask, iTask] { runTask(iTask); });
+        }
+
+        for(;;)
+        {
+            uint32_t iMainThreadTask = UINT32_MAX;
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mTaskDone.wait(lock, [&]
+                {
+                    return miNumTasksLeft == 0 || maiReadyMainThreadTasks.size() > 0;
+                });
+
+                if(maiReadyMainThreadTasks.size() == 0)
+                {
+                    break;
+                }
+
+                // oldest ready stage first, keeps the device work in the order the stages were added
+                auto iter = std::min_element(maiReadyMainThreadTasks.begin(), maiReadyMainThreadTasks.end());
+                iMainThreadTask = *iter;
+                maiReadyMainThreadTasks.erase(iter);
+            }
+
+            runTask(iMainThreadTask);
+        }
+
+        // runTask is captured by reference in the pool's queue
+        threadPool.waitIdle();
+
+        mfTotalTime = getTime();
+        computeCriticalPath();
+    }
+
+    /*
+    **
+    */
+    void CTaskGraph::computeCriticalPath()
+    {
+        // tasks are stored in dependency order
+        for(auto& task : maTasks)
+        {
+            double fDuration = task.mfEndTime - task.mfStartTime;
+            task.mfCriticalPathTime = fDuration;
+            task.miCriticalPathParent = -1;
+            for(auto const& iDependency : task.maiDependencies)
+            {
+                double fPathTime = maTasks[iDependency].mfCriticalPathTime + fDuration;
+                if(fPathTime > task.mfCriticalPathTime)
+                {
+                    task.mfCriticalPathTime = fPathTime;
+                    task.miCriticalPathParent = (int32_t)iDependency;
+                }
+            }
+        }
+
+        // latest finish that keeps every stage after it on time, backwards over the dependents
+        double fCriticalPathTime = 0.0;
+        for(auto const& task : maTasks)
+        {
+            fCriticalPathTime = std::max(fCriticalPathTime, task.mfCriticalPathTime);
+        }
+
+        std::vector<double> afLatestFinishTimes(maTasks.size(), fCriticalPathTime);
+        for(int32_t iTask = (int32_t)maTasks.size() - 1; iTask >= 0; iTask--)
+        {
+            for(auto const& iDependent : maaiDependents[iTask])
+            {
+                double fDependentDuration = maTasks[iDependent].mfEndTime - maTasks[iDependent].mfStartTime;
+                afLatestFinishTimes[iTask] = std::min(afLatestFinishTimes[iTask], afLatestFinishTimes[iDependent] - fDependentDuration);
+            }
+
+            // latest start minus earliest start
+            maTasks[iTask].mfSlackTime = afLatestFinishTimes[iTask] - maTasks[iTask].mfCriticalPathTime;
+        }
+    }
+
+    /*
+    **
+    */
+    std::vector<uint32_t> CTaskGraph::getCriticalPath() const
+    {
+        std::vector<uint32_t> aiPath;
+        if(maTasks.size() == 0)
+        {
+            return aiPath;
+        }
+
+        auto iter = std::max_element(maTasks.begin(), maTasks.end(), [](Task const& left, Task const& right)
+        {
+            return left.mfCriticalPathTime < right.mfCriticalPathTime;
+        });
+
+        int32_t iTask = (int32_t)(iter - maTasks.begin());
+        while(iTask >= 0)
+        {
+            aiPath.push_back((uint32_t)iTask);
+            iTask = maTasks[iTask].miCriticalPathParent;
+        }
+        std::reverse(aiPath.begin(), aiPath.end());
+
+        return aiPath;
+    }
+
+    /*
+    **
+    */
+    void CTaskGraph::printReport() const
+    {
+        std::vector<uint32_t> aiCriticalPath = getCriticalPath();
+        double fCriticalPathTime = (aiCriticalPath.size() > 0) ? maTasks[aiCriticalPath.back()].mfCriticalPathTime : 0.0;
+
+        double fSerialTime = 0.0;
+        printf("%-36s %-8s %10s %10s %10s %10s\n", "stage", "thread", "start ms", "time ms", "path ms", "slack ms");
+        for(auto const& task : maTasks)
+        {
+            double fDuration = task.mfEndTime - task.mfStartTime;
+            fSerialTime += fDuration;
+            printf("%-36s %-8s %10.2f %10.2f %10.2f %10.2f\n",
+                task.mName.c_str(),
+                (task.mAffinity == Affinity::MainThread) ? "main" : "worker",
+                task.mfStartTime,
+                fDuration,
+                task.mfCriticalPathTime,
+                task.mfSlackTime);
+        }
+
+        std::string criticalPath;
+        for(auto const& iTask : aiCriticalPath)
+        {
+            criticalPath += (criticalPath.length() > 0) ? " -> " : "";
+            criticalPath += maTasks[iTask].mName;
+        }
+        printf("critical path %.2f ms: %s\n", fCriticalPathTime, criticalPath.c_str());
+        printf("wall time %.2f ms, stages back to back %.2f ms\n", mfTotalTime, fSerialTime);
+    }
+
+}   // Utils
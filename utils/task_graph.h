@@ -0,0 +1,95 @@
+#pragma once
+
+#include <utils/thread_pool.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace Utils
+{
+    /*
+    ** one shot graph of stages, worker stages go to the thread pool as soon as their
+    ** dependencies are done, main thread stages run on the thread calling run() so
+    ** everything touching the device stays serialized there
+    */
+    class CTaskGraph
+    {
+    public:
+        enum class Affinity
+        {
+            Worker = 0,
+            MainThread,
+        };
+
+        struct Task
+        {
+            std::string                 mName;
+            std::function<void()>       mFunction;
+            Affinity                    mAffinity = Affinity::Worker;
+            std::vector<uint32_t>       maiDependencies;
+
+            // milliseconds from the start of run()
+            double                      mfStartTime = 0.0;
+            double                      mfEndTime = 0.0;
+
+            // longest chain of stage durations ending at this stage, and the dependency it came through
+            double                      mfCriticalPathTime = 0.0;
+            int32_t                     miCriticalPathParent = -1;
+
+            // how much later the stage could start without lengthening the critical path
+            double                      mfSlackTime = 0.0;
+        };
+
+    public:
+        CTaskGraph() = default;
+        virtual ~CTaskGraph() = default;
+
+        uint32_t addTask(
+            std::string const& name,
+            Affinity affinity,
+            std::vector<uint32_t> const& aiDependencies,
+            std::function<void()> const& function);
+
+        void run(CThreadPool& threadPool);
+
+        // stage timings, slack against the critical path and the critical path itself
+        void printReport() const;
+
+        inline std::vector<Task> const& getTasks() const
+        {
+            return maTasks;
+        }
+
+        inline double getTotalTime() const
+        {
+            return mfTotalTime;
+        }
+
+        std::vector<uint32_t> getCriticalPath() const;
+
+    protected:
+        void taskFinished(uint32_t iTask);
+        void computeCriticalPath();
+
+    protected:
+        std::vector<Task>                           maTasks;
+        std::vector<std::vector<uint32_t>>          maaiDependents;
+        std::vector<uint32_t>                       maiNumDependenciesLeft;
+
+        std::vector<uint32_t>                       maiReadyMainThreadTasks;
+        uint32_t                                    miNumTasksLeft = 0;
+
+        std::mutex                                  mMutex;
+        std::condition_variable                     mTaskDone;
+
+        std::chrono::high_resolution_clock::time_point  mStartTime;
+        double                                      mfTotalTime = 0.0;
+    };
+
+}   // Utils
@@ -0,0 +1,141 @@
+#include <utils/thread_pool.h>
+
+#include <algorithm>
+
+#include <assert.h>
+#include <stdio.h>
+
+namespace Utils
+{
+    /*
+    **
+    */
+    CThreadPool::~CThreadPool()
+    {
+        stop();
+    }
+
+    /*
+    **
+    */
+    void CThreadPool::start(uint32_t iNumThreads, char const* szName)
+    {
+        mszName = szName;
+
+#if defined(THREAD_POOL_ENABLED)
+        assert(maThreads.size() == 0);
+        mbStopping = false;
+        for(uint32_t iThread = 0; iThread < iNumThreads; iThread++)
+        {
+            maThreads.emplace_back(&CThreadPool::workerLoop, this);
+        }
+
+        printf("%s : %d started \"%s\" with %d threads\n",
+            __FILE__,
+            __LINE__,
+            szName,
+            iNumThreads);
+#endif // THREAD_POOL_ENABLED
+    }
+
+    /*
+    **
+    */
+    void CThreadPool::stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mbStopping = true;
+        }
+        mTaskAvailable.notify_all();
+
+        for(auto& thread : maThreads)
+        {
+            thread.join();
+        }
+        maThreads.clear();
+    }
+
+    /*
+    **
+    */
+    void CThreadPool::submit(std::function<void()> const& task)
+    {
+        if(maThreads.size() == 0)
+        {
+            task();
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            maTasks.push_back(task);
+        }
+        mTaskAvailable.notify_one();
+    }
+
+    /*
+    **
+    */
+    void CThreadPool::waitIdle()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mIdle.wait(lock, [&]
+        {
+            return maTasks.size() == 0 && miNumActiveTasks == 0;
+        });
+    }
+
+    /*
+    **
+    */
+    void CThreadPool::workerLoop()
+    {
+        for(;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mTaskAvailable.wait(lock, [&]
+                {
+                    return mbStopping || maTasks.size() > 0;
+                });
+
+                if(maTasks.size() == 0)
+                {
+                    // stopping with nothing left to run
+                    break;
+                }
+
+                task = std::move(maTasks.front());
+                maTasks.pop_front();
+                ++miNumActiveTasks;
+            }
+
+            task();
+
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                --miNumActiveTasks;
+                if(maTasks.size() == 0 && miNumActiveTasks == 0)
+                {
+                    mIdle.notify_all();
+                }
+            }
+        }
+    }
+
+    /*
+    **
+    */
+    uint32_t getDefaultNumWorkerThreads()
+    {
+#if defined(THREAD_POOL_ENABLED)
+        uint32_t iNumCores = std::thread::hardware_concurrency();
+        return std::max(iNumCores, 2u) - 1;
+#else
+        return 0;
+#endif // THREAD_POOL_ENABLED
+    }
+
+}   // Utils
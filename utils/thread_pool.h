@@ -0,0 +1,52 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// web builds without pthreads run the submitted tasks inline
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+#define THREAD_POOL_ENABLED 1
+#endif // __EMSCRIPTEN_PTHREADS__
+
+namespace Utils
+{
+    class CThreadPool
+    {
+    public:
+        CThreadPool() = default;
+        virtual ~CThreadPool();
+
+        void start(uint32_t iNumThreads, char const* szName);
+        void stop();
+
+        void submit(std::function<void()> const& task);
+        void waitIdle();
+
+        inline uint32_t getNumThreads() const
+        {
+            return (uint32_t)maThreads.size();
+        }
+
+    protected:
+        void workerLoop();
+
+    protected:
+        std::vector<std::thread>                    maThreads;
+        std::deque<std::function<void()>>           maTasks;
+
+        std::mutex                                  mMutex;
+        std::condition_variable                     mTaskAvailable;
+        std::condition_variable                     mIdle;
+
+        uint32_t                                    miNumActiveTasks = 0;
+        bool                                        mbStopping = false;
+        char const*                                 mszName = "";
+    };
+
+    uint32_t getDefaultNumWorkerThreads();
+
+}   // Utils